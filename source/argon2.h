@@ -0,0 +1,819 @@
+/*
+ * argon2.h - implementation of the Argon2id password hash
+ *
+ * Written by Hampus Fridholm
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc9106
+ *
+ * Last updated: 2026-10-19
+ *
+ *
+ * In main compilation unit; define ARGON2_IMPLEMENT
+ *
+ * The program has to be linked with -pthread
+ *
+ *
+ * Argon2id fills memory blocks, which depend on earlier blocks,
+ * in a number of passes. Every pass is split into 4 slices, and
+ * within a slice the lanes don't depend on each other,
+ * so every lane is filled by its own thread
+ *
+ * The block compression, BlaMka, is done with AVX2 if the cpu supports it
+ *
+ *
+ * These are the available funtions:
+ *
+ * int argon2id(uint8_t* tag, size_t tsize, const void* password, size_t psize, const void* salt, size_t ssize, const argon2_params_t* params, size_t threads)
+ */
+
+/*
+ * From here on, until ARGON2_IMPLEMENT,
+ * it is like a normal header file with declarations
+ */
+
+#ifndef ARGON2_H
+#define ARGON2_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ARGON2_SALT_SIZE 16
+
+/*
+ * The cost parameters
+ *
+ * The memory is in KiB, and is at least 8 KiB per lane
+ */
+typedef struct
+{
+  uint32_t memory;
+  uint32_t time;
+  uint32_t lanes;
+} argon2_params_t;
+
+extern int argon2id(uint8_t* tag, size_t tsize, const void* password, size_t psize, const void* salt, size_t ssize, const argon2_params_t* params, size_t threads);
+
+#endif // ARGON2_H
+
+/*
+ * This header library file uses _IMPLEMENT guards
+ *
+ * If ARGON2_IMPLEMENT is defined, the definitions will be included
+ */
+
+#ifdef ARGON2_IMPLEMENT
+
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "blake2b.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ARGON2_SIMD
+#include <immintrin.h>
+#endif
+
+#define ARGON2_VERSION 0x13
+#define ARGON2_TYPE_ID 2
+
+#define ARGON2_BLOCK_SIZE 1024
+#define ARGON2_WORDS      128
+
+#define ARGON2_SLICES 4
+
+// The amount of pseudo-random values in one address block
+#define ARGON2_ADDRESSES 128
+
+typedef struct
+{
+  uint64_t v[ARGON2_WORDS];
+} argon2_block_t;
+
+/*
+ * The memory and the sizes of one Argon2id computation
+ */
+typedef struct
+{
+  argon2_block_t* blocks;
+  uint32_t        memory;          // The amount of blocks, m'
+  uint32_t        lane_length;     // The amount of blocks in every lane
+  uint32_t        segment_length;  // The amount of blocks in every slice of a lane
+  uint32_t        lanes;
+  uint32_t        passes;
+  bool            avx2;
+} argon2_instance_t;
+
+/*
+ * The part of a slice that one thread fills
+ */
+typedef struct
+{
+  argon2_instance_t* instance;
+  uint32_t           pass;
+  uint32_t           slice;
+  uint32_t           lane;            // The first lane
+  uint32_t           step;            // The distance between the lanes
+} argon2_job_t;
+
+/*
+ * Write a 32-bit word as little-endian bytes
+ */
+static inline void argon2_word32_write(uint8_t bytes[4], uint32_t word)
+{
+  for(uint8_t index = 0; index < 4; index++)
+  {
+    bytes[index] = (uint8_t) (word >> (8 * index));
+  }
+}
+
+/*
+ * Read a 64-bit little-endian word
+ */
+static inline uint64_t argon2_word64_read(const uint8_t bytes[8])
+{
+  uint64_t word = 0;
+
+  for(uint8_t index = 8; index-- > 0;)
+  {
+    word = (word << 8) | bytes[index];
+  }
+
+  return word;
+}
+
+/*
+ * Add a 32-bit little-endian word to the hash
+ */
+static inline void argon2_word32_update(blake2b_ctx_t* ctx, uint32_t word)
+{
+  uint8_t bytes[4];
+
+  argon2_word32_write(bytes, word);
+
+  blake2b_update(ctx, bytes, 4);
+}
+
+/*
+ * The variable-length hash function H'
+ *
+ * Longer digests than 64 bytes are made by chaining BLAKE2b,
+ * taking the first half of every digest
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc9106#section-3.3
+ */
+static void argon2_hash_long(uint8_t* digest, uint32_t dsize, const void* message, size_t msize)
+{
+  blake2b_ctx_t ctx;
+
+  if(dsize <= BLAKE2B_DIGEST_SIZE)
+  {
+    blake2b_init(&ctx, dsize);
+
+    argon2_word32_update(&ctx, dsize);
+
+    blake2b_update(&ctx, message, msize);
+
+    blake2b_final(digest, &ctx);
+
+    return;
+  }
+
+  uint8_t v[BLAKE2B_DIGEST_SIZE];
+
+  blake2b_init(&ctx, BLAKE2B_DIGEST_SIZE);
+
+  argon2_word32_update(&ctx, dsize);
+
+  blake2b_update(&ctx, message, msize);
+
+  blake2b_final(v, &ctx);
+
+  uint32_t rest = dsize;
+
+  while(rest > BLAKE2B_DIGEST_SIZE)
+  {
+    memcpy(digest, v, 32);
+
+    digest += 32;
+    rest   -= 32;
+
+    blake2b_init(&ctx, (rest > BLAKE2B_DIGEST_SIZE) ? BLAKE2B_DIGEST_SIZE : rest);
+
+    blake2b_update(&ctx, v, BLAKE2B_DIGEST_SIZE);
+
+    blake2b_final(v, &ctx);
+  }
+
+  memcpy(digest, v, rest);
+
+  memset(v, '\0', sizeof(v));
+}
+
+#define ARGON2_RROTATE(a, b) (((a) >> (b)) | ((a) << (64 - (b))))
+
+/*
+ * The BlaMka multiplication, x + y + 2 * lo(x) * lo(y)
+ */
+#define ARGON2_FBLAMKA(x, y) ((x) + (y) + 2 * (uint64_t) (uint32_t) (x) * (uint32_t) (y))
+
+/*
+ * The BLAKE2b G function, with the additions replaced by BlaMka
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc9106#section-3.6
+ */
+#define ARGON2_GB(V, A, B, C, D) \
+  do { \
+    V[A] = ARGON2_FBLAMKA(V[A], V[B]); V[D] = ARGON2_RROTATE(V[D] ^ V[A], 32); \
+    V[C] = ARGON2_FBLAMKA(V[C], V[D]); V[B] = ARGON2_RROTATE(V[B] ^ V[C], 24); \
+    V[A] = ARGON2_FBLAMKA(V[A], V[B]); V[D] = ARGON2_RROTATE(V[D] ^ V[A], 16); \
+    V[C] = ARGON2_FBLAMKA(V[C], V[D]); V[B] = ARGON2_RROTATE(V[B] ^ V[C], 63); \
+  } while(0)
+
+/*
+ * The permutation P, on 16 words
+ */
+static inline void argon2_permute(uint64_t v[16])
+{
+  ARGON2_GB(v, 0, 4,  8, 12);
+  ARGON2_GB(v, 1, 5,  9, 13);
+  ARGON2_GB(v, 2, 6, 10, 14);
+  ARGON2_GB(v, 3, 7, 11, 15);
+  ARGON2_GB(v, 0, 5, 10, 15);
+  ARGON2_GB(v, 1, 6, 11, 12);
+  ARGON2_GB(v, 2, 7,  8, 13);
+  ARGON2_GB(v, 3, 4,  9, 14);
+}
+
+/*
+ * The compression function G, next = P(prev ^ ref) ^ prev ^ ref
+ *
+ * P is first applied to the 8 rows of 16 words, and then to the
+ * 8 columns, which are made of pairs of words from every row
+ *
+ * PARAMS
+ * - argon2_block_t* next       | The result, can be the same as ref
+ * - const argon2_block_t* prev | The previous block
+ * - const argon2_block_t* ref  | The reference block
+ * - bool with_xor              | Xor the result into next, in the later passes
+ */
+static void argon2_compress_portable(argon2_block_t* next, const argon2_block_t* prev, const argon2_block_t* ref, bool with_xor)
+{
+  uint64_t r[ARGON2_WORDS], q[ARGON2_WORDS];
+
+  for(uint8_t index = 0; index < ARGON2_WORDS; index++)
+  {
+    r[index] = q[index] = prev->v[index] ^ ref->v[index];
+  }
+
+  uint64_t v[16];
+
+  for(uint8_t row = 0; row < 8; row++)
+  {
+    argon2_permute(q + (row * 16));
+  }
+
+  for(uint8_t column = 0; column < 8; column++)
+  {
+    for(uint8_t index = 0; index < 8; index++)
+    {
+      v[2 * index]     = q[(2 * column) + (16 * index)];
+      v[2 * index + 1] = q[(2 * column) + (16 * index) + 1];
+    }
+
+    argon2_permute(v);
+
+    for(uint8_t index = 0; index < 8; index++)
+    {
+      q[(2 * column) + (16 * index)]     = v[2 * index];
+      q[(2 * column) + (16 * index) + 1] = v[2 * index + 1];
+    }
+  }
+
+  for(uint8_t index = 0; index < ARGON2_WORDS; index++)
+  {
+    uint64_t word = q[index] ^ r[index];
+
+    next->v[index] = with_xor ? (next->v[index] ^ word) : word;
+  }
+}
+
+#ifdef ARGON2_SIMD
+
+/*
+ * The BlaMka multiplication on 4 words
+ */
+#define ARGON2_AVX2_FBLAMKA(x, y) \
+  _mm256_add_epi64(_mm256_add_epi64(x, y), _mm256_slli_epi64(_mm256_mul_epu32(x, y), 1))
+
+#define ARGON2_AVX2_ROTATE32(x) _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1))
+#define ARGON2_AVX2_ROTATE24(x) _mm256_shuffle_epi8(x, rotate24)
+#define ARGON2_AVX2_ROTATE16(x) _mm256_shuffle_epi8(x, rotate16)
+#define ARGON2_AVX2_ROTATE63(x) _mm256_xor_si256(_mm256_srli_epi64(x, 63), _mm256_add_epi64(x, x))
+
+/*
+ * 4 G functions at the same time, on the columns or the diagonals
+ */
+#define ARGON2_AVX2_GB(A, B, C, D) \
+  do { \
+    A = ARGON2_AVX2_FBLAMKA(A, B); D = ARGON2_AVX2_ROTATE32(_mm256_xor_si256(D, A)); \
+    C = ARGON2_AVX2_FBLAMKA(C, D); B = ARGON2_AVX2_ROTATE24(_mm256_xor_si256(B, C)); \
+    A = ARGON2_AVX2_FBLAMKA(A, B); D = ARGON2_AVX2_ROTATE16(_mm256_xor_si256(D, A)); \
+    C = ARGON2_AVX2_FBLAMKA(C, D); B = ARGON2_AVX2_ROTATE63(_mm256_xor_si256(B, C)); \
+  } while(0)
+
+/*
+ * The permutation P, with the 16 words in 4 vectors
+ *
+ * The diagonals are lined up as columns, by rotating the words
+ * of the vectors, and are rotated back afterwards
+ */
+#define ARGON2_AVX2_PERMUTE(A, B, C, D) \
+  do { \
+    ARGON2_AVX2_GB(A, B, C, D); \
+    B = _mm256_permute4x64_epi64(B, _MM_SHUFFLE(0, 3, 2, 1)); \
+    C = _mm256_permute4x64_epi64(C, _MM_SHUFFLE(1, 0, 3, 2)); \
+    D = _mm256_permute4x64_epi64(D, _MM_SHUFFLE(2, 1, 0, 3)); \
+    ARGON2_AVX2_GB(A, B, C, D); \
+    B = _mm256_permute4x64_epi64(B, _MM_SHUFFLE(2, 1, 0, 3)); \
+    C = _mm256_permute4x64_epi64(C, _MM_SHUFFLE(1, 0, 3, 2)); \
+    D = _mm256_permute4x64_epi64(D, _MM_SHUFFLE(0, 3, 2, 1)); \
+  } while(0)
+
+/*
+ * Load two 128-bit pairs of words into one vector
+ */
+#define ARGON2_AVX2_LOAD2(LO, HI) \
+  _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*) (LO))), \
+                          _mm_loadu_si128((const __m128i*) (HI)), 1)
+
+#define ARGON2_AVX2_STORE2(LO, HI, X) \
+  do { \
+    _mm_storeu_si128((__m128i*) (LO), _mm256_castsi256_si128(X)); \
+    _mm_storeu_si128((__m128i*) (HI), _mm256_extracti128_si256(X, 1)); \
+  } while(0)
+
+/*
+ * The compression function G, using AVX2
+ *
+ * A row is 4 whole vectors, and a column is 4 vectors
+ * of word pairs from two rows each
+ */
+__attribute__((target("avx2")))
+static void argon2_compress_avx2(argon2_block_t* next, const argon2_block_t* prev, const argon2_block_t* ref, bool with_xor)
+{
+  const __m256i rotate24 = _mm256_setr_epi8(
+    3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+    3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+
+  const __m256i rotate16 = _mm256_setr_epi8(
+    2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+    2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+
+  __m256i r[ARGON2_WORDS / 4];
+
+  uint64_t q[ARGON2_WORDS] __attribute__((aligned(32)));
+
+  for(uint8_t index = 0; index < ARGON2_WORDS / 4; index++)
+  {
+    __m256i a = _mm256_loadu_si256((const __m256i*) (prev->v + (index * 4)));
+    __m256i b = _mm256_loadu_si256((const __m256i*) (ref->v  + (index * 4)));
+
+    r[index] = _mm256_xor_si256(a, b);
+
+    _mm256_store_si256((__m256i*) (q + (index * 4)), r[index]);
+  }
+
+  for(uint8_t row = 0; row < 8; row++)
+  {
+    uint64_t* w = q + (row * 16);
+
+    __m256i a = _mm256_load_si256((const __m256i*) (w + 0));
+    __m256i b = _mm256_load_si256((const __m256i*) (w + 4));
+    __m256i c = _mm256_load_si256((const __m256i*) (w + 8));
+    __m256i d = _mm256_load_si256((const __m256i*) (w + 12));
+
+    ARGON2_AVX2_PERMUTE(a, b, c, d);
+
+    _mm256_store_si256((__m256i*) (w + 0),  a);
+    _mm256_store_si256((__m256i*) (w + 4),  b);
+    _mm256_store_si256((__m256i*) (w + 8),  c);
+    _mm256_store_si256((__m256i*) (w + 12), d);
+  }
+
+  for(uint8_t column = 0; column < 8; column++)
+  {
+    uint64_t* w = q + (column * 2);
+
+    __m256i a = ARGON2_AVX2_LOAD2(w + 0,  w + 16);
+    __m256i b = ARGON2_AVX2_LOAD2(w + 32, w + 48);
+    __m256i c = ARGON2_AVX2_LOAD2(w + 64, w + 80);
+    __m256i d = ARGON2_AVX2_LOAD2(w + 96, w + 112);
+
+    ARGON2_AVX2_PERMUTE(a, b, c, d);
+
+    ARGON2_AVX2_STORE2(w + 0,  w + 16,  a);
+    ARGON2_AVX2_STORE2(w + 32, w + 48,  b);
+    ARGON2_AVX2_STORE2(w + 64, w + 80,  c);
+    ARGON2_AVX2_STORE2(w + 96, w + 112, d);
+  }
+
+  for(uint8_t index = 0; index < ARGON2_WORDS / 4; index++)
+  {
+    __m256i word = _mm256_xor_si256(_mm256_load_si256((const __m256i*) (q + (index * 4))), r[index]);
+
+    if(with_xor)
+    {
+      word = _mm256_xor_si256(word, _mm256_loadu_si256((const __m256i*) (next->v + (index * 4))));
+    }
+
+    _mm256_storeu_si256((__m256i*) (next->v + (index * 4)), word);
+  }
+}
+
+#endif // ARGON2_SIMD
+
+/*
+ * The compression function G, using the widest kernel the cpu supports
+ */
+static inline void argon2_compress(const argon2_instance_t* instance, argon2_block_t* next, const argon2_block_t* prev, const argon2_block_t* ref, bool with_xor)
+{
+#ifdef ARGON2_SIMD
+  if(instance->avx2)
+  {
+    argon2_compress_avx2(next, prev, ref, with_xor);
+
+    return;
+  }
+#endif // ARGON2_SIMD
+
+  argon2_compress_portable(next, prev, ref, with_xor);
+}
+
+/*
+ * Create the next block of pseudo-random values,
+ * for the data-independent addressing
+ */
+static inline void argon2_addresses_next(const argon2_instance_t* instance, argon2_block_t* addresses, argon2_block_t* input)
+{
+  static const argon2_block_t zero = { { 0 } };
+
+  input->v[6]++;
+
+  argon2_compress(instance, addresses, &zero, input, false);
+  argon2_compress(instance, addresses, &zero, addresses, false);
+}
+
+/*
+ * Get the index of the reference block, in the reference lane
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc9106#section-3.4.2
+ */
+static inline uint32_t argon2_reference_index(const argon2_instance_t* instance, const argon2_job_t* job, uint32_t index, uint32_t j1, bool same_lane)
+{
+  uint32_t segment_length = instance->segment_length;
+
+  // 1. Get the size of the area of blocks that can be referenced
+  uint32_t area_size;
+
+  if(job->pass == 0)
+  {
+    if(same_lane)
+    {
+      area_size = (job->slice * segment_length) + index - 1;
+    }
+    else area_size = (job->slice * segment_length) - (index == 0 ? 1 : 0);
+  }
+  else
+  {
+    if(same_lane)
+    {
+      area_size = instance->lane_length - segment_length + index - 1;
+    }
+    else area_size = instance->lane_length - segment_length - (index == 0 ? 1 : 0);
+  }
+
+  // 2. Map j1 to a position, with a bias towards the newer blocks
+  uint64_t position = ((uint64_t) j1 * j1) >> 32;
+
+  position = area_size - 1 - (((uint64_t) area_size * position) >> 32);
+
+  // 3. The area starts after the current slice, in the later passes
+  uint32_t start = 0;
+
+  if(job->pass != 0 && job->slice != ARGON2_SLICES - 1)
+  {
+    start = (job->slice + 1) * segment_length;
+  }
+
+  return (uint32_t) ((start + position) % instance->lane_length);
+}
+
+/*
+ * Fill one segment, the blocks of one lane in one slice
+ *
+ * The first two slices of the first pass are data-independent,
+ * the rest use the previous block to choose the reference block
+ */
+static void argon2_segment_fill(const argon2_instance_t* instance, const argon2_job_t* job, uint32_t lane)
+{
+  bool independent = (job->pass == 0 && job->slice < ARGON2_SLICES / 2);
+
+  argon2_block_t addresses, input;
+
+  if(independent)
+  {
+    memset(&input, 0, sizeof(input));
+
+    input.v[0] = job->pass;
+    input.v[1] = lane;
+    input.v[2] = job->slice;
+    input.v[3] = instance->memory;
+    input.v[4] = instance->passes;
+    input.v[5] = ARGON2_TYPE_ID;
+  }
+
+  // The first two blocks of every lane are already filled
+  uint32_t start = (job->pass == 0 && job->slice == 0) ? 2 : 0;
+
+  if(independent && start != 0)
+  {
+    argon2_addresses_next(instance, &addresses, &input);
+  }
+
+  uint32_t offset = (lane * instance->lane_length) + (job->slice * instance->segment_length) + start;
+
+  for(uint32_t index = start; index < instance->segment_length; index++, offset++)
+  {
+    // 1. The previous block wraps around to the end of the lane
+    uint32_t prev = (offset % instance->lane_length == 0) ? (offset + instance->lane_length - 1) : (offset - 1);
+
+    // 2. Get the pseudo-random value, choosing the reference block
+    uint64_t random;
+
+    if(independent)
+    {
+      if(index % ARGON2_ADDRESSES == 0)
+      {
+        argon2_addresses_next(instance, &addresses, &input);
+      }
+
+      random = addresses.v[index % ARGON2_ADDRESSES];
+    }
+    else random = instance->blocks[prev].v[0];
+
+    uint32_t ref_lane = (uint32_t) ((random >> 32) % instance->lanes);
+
+    // The first slice of the first pass can only reference its own lane
+    if(job->pass == 0 && job->slice == 0) ref_lane = lane;
+
+    uint32_t ref_index = argon2_reference_index(instance, job, index, (uint32_t) random, ref_lane == lane);
+
+    const argon2_block_t* ref = &instance->blocks[(ref_lane * instance->lane_length) + ref_index];
+
+    // 3. Compress, and xor with the old block in the later passes
+    argon2_compress(instance, &instance->blocks[offset], &instance->blocks[prev], ref, job->pass != 0);
+  }
+}
+
+/*
+ * This is the thread function, filling its lanes of the slice
+ */
+static void* argon2_slice_thread(void* arg)
+{
+  argon2_job_t* job = arg;
+
+  for(uint32_t lane = job->lane; lane < job->instance->lanes; lane += job->step)
+  {
+    argon2_segment_fill(job->instance, job, lane);
+  }
+
+  return NULL;
+}
+
+/*
+ * Fill one slice, with the lanes split over a number of threads
+ *
+ * The calling thread fills the first lanes. If a thread can't be
+ * created, its lanes are filled by the calling thread instead.
+ */
+static void argon2_slice_fill(argon2_instance_t* instance, uint32_t pass, uint32_t slice, size_t threads)
+{
+  argon2_job_t jobs[threads];
+  pthread_t    thread_ids[threads];
+  bool         created[threads];
+
+  for(size_t index = 0; index < threads; index++)
+  {
+    jobs[index] = (argon2_job_t) {
+      .instance = instance,
+      .pass     = pass,
+      .slice    = slice,
+      .lane     = (uint32_t) index,
+      .step     = (uint32_t) threads
+    };
+
+    created[index] = false;
+
+    if(index > 0)
+    {
+      created[index] = (pthread_create(&thread_ids[index], NULL, argon2_slice_thread, &jobs[index]) == 0);
+    }
+  }
+
+  for(size_t index = 0; index < threads; index++)
+  {
+    if(index == 0 || !created[index])
+    {
+      argon2_slice_thread(&jobs[index]);
+    }
+  }
+
+  for(size_t index = 1; index < threads; index++)
+  {
+    if(created[index]) pthread_join(thread_ids[index], NULL);
+  }
+}
+
+/*
+ * Hash the password with all the inputs of Argon2id
+ *
+ * The secret and the associated data are not used by symcpt,
+ * but are part of H0
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 3 | Failed to allocate memory
+ */
+static int argon2id_hash(uint8_t* tag, size_t tsize, const void* password, size_t psize, const void* salt, size_t ssize, const void* secret, size_t ksize, const void* data, size_t dsize, const argon2_params_t* params, size_t threads)
+{
+  // 1. The memory is rounded down to a multiple of 4 blocks per lane
+  argon2_instance_t instance = {
+    .memory  = 4 * params->lanes * (params->memory / (4 * params->lanes)),
+    .lanes   = params->lanes,
+    .passes  = params->time,
+    .avx2    = false
+  };
+
+  instance.lane_length    = instance.memory / instance.lanes;
+  instance.segment_length = instance.lane_length / ARGON2_SLICES;
+
+#ifdef ARGON2_SIMD
+  instance.avx2 = __builtin_cpu_supports("avx2");
+#endif // ARGON2_SIMD
+
+  instance.blocks = malloc(sizeof(argon2_block_t) * instance.memory);
+
+  if(!instance.blocks)
+  {
+    errno = ENOMEM; // Out of memory
+
+    return 3;
+  }
+
+  // 2. Hash all the inputs and parameters to H0
+  uint8_t h0[BLAKE2B_DIGEST_SIZE + 8];
+
+  blake2b_ctx_t ctx;
+
+  blake2b_init(&ctx, BLAKE2B_DIGEST_SIZE);
+
+  argon2_word32_update(&ctx, params->lanes);
+  argon2_word32_update(&ctx, (uint32_t) tsize);
+  argon2_word32_update(&ctx, params->memory);
+  argon2_word32_update(&ctx, params->time);
+  argon2_word32_update(&ctx, ARGON2_VERSION);
+  argon2_word32_update(&ctx, ARGON2_TYPE_ID);
+
+  argon2_word32_update(&ctx, (uint32_t) psize);
+  blake2b_update(&ctx, password, psize);
+
+  argon2_word32_update(&ctx, (uint32_t) ssize);
+  blake2b_update(&ctx, salt, ssize);
+
+  argon2_word32_update(&ctx, (uint32_t) ksize);
+  blake2b_update(&ctx, secret, ksize);
+
+  argon2_word32_update(&ctx, (uint32_t) dsize);
+  blake2b_update(&ctx, data, dsize);
+
+  blake2b_final(h0, &ctx);
+
+  // 3. The first two blocks of every lane come from H0
+  uint8_t bytes[ARGON2_BLOCK_SIZE];
+
+  for(uint32_t lane = 0; lane < instance.lanes; lane++)
+  {
+    for(uint32_t index = 0; index < 2; index++)
+    {
+      argon2_word32_write(h0 + BLAKE2B_DIGEST_SIZE,     index);
+      argon2_word32_write(h0 + BLAKE2B_DIGEST_SIZE + 4, lane);
+
+      argon2_hash_long(bytes, ARGON2_BLOCK_SIZE, h0, sizeof(h0));
+
+      argon2_block_t* block = &instance.blocks[(lane * instance.lane_length) + index];
+
+      for(uint8_t word = 0; word < ARGON2_WORDS; word++)
+      {
+        block->v[word] = argon2_word64_read(bytes + (word * 8));
+      }
+    }
+  }
+
+  memset(h0, '\0', sizeof(h0));
+
+  // 4. Fill the blocks, one slice at a time
+  if(threads > instance.lanes) threads = instance.lanes;
+
+  for(uint32_t pass = 0; pass < instance.passes; pass++)
+  {
+    for(uint32_t slice = 0; slice < ARGON2_SLICES; slice++)
+    {
+      argon2_slice_fill(&instance, pass, slice, threads);
+    }
+  }
+
+  // 5. The tag is the hash of the xor of the last blocks of the lanes
+  argon2_block_t final = instance.blocks[instance.lane_length - 1];
+
+  for(uint32_t lane = 1; lane < instance.lanes; lane++)
+  {
+    const argon2_block_t* last = &instance.blocks[(lane * instance.lane_length) + instance.lane_length - 1];
+
+    for(uint8_t word = 0; word < ARGON2_WORDS; word++)
+    {
+      final.v[word] ^= last->v[word];
+    }
+  }
+
+  for(uint8_t word = 0; word < ARGON2_WORDS; word++)
+  {
+    for(uint8_t index = 0; index < 8; index++)
+    {
+      bytes[(word * 8) + index] = (uint8_t) (final.v[word] >> (8 * index));
+    }
+  }
+
+  argon2_hash_long(tag, (uint32_t) tsize, bytes, ARGON2_BLOCK_SIZE);
+
+  memset(bytes, '\0', sizeof(bytes));
+  memset(&final, '\0', sizeof(final));
+
+  memset(instance.blocks, '\0', sizeof(argon2_block_t) * instance.memory);
+
+  free(instance.blocks);
+
+  return 0;
+}
+
+/*
+ * Hash the password with Argon2id
+ *
+ * PARAMS
+ * - uint8_t* tag                  | The "will be created"-tag
+ * - size_t tsize                  | The size of the tag, at least 4 bytes
+ * - const void* password          | The password
+ * - size_t psize                  | The size of the password
+ * - const void* salt              | The salt, at least 8 bytes
+ * - size_t ssize                  | The size of the salt
+ * - const argon2_params_t* params | The memory, time and lanes
+ * - size_t threads                | The amount of threads, 0 for all cores
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Invalid parameters
+ * - 3 | Failed to allocate memory
+ */
+int argon2id(uint8_t* tag, size_t tsize, const void* password, size_t psize, const void* salt, size_t ssize, const argon2_params_t* params, size_t threads)
+{
+  if(!tag || (!password && psize > 0) || !salt || !params)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  if(tsize < 4 || tsize > UINT32_MAX || ssize < 8 || ssize > UINT32_MAX || psize > UINT32_MAX ||
+     params->time < 1 || params->lanes < 1 || params->lanes > 0xFFFFFF ||
+     params->memory / 8 < params->lanes)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  if(threads == 0)
+  {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    threads = (cores > 0) ? cores : 1;
+  }
+
+  return argon2id_hash(tag, tsize, password, psize, salt, ssize, NULL, 0, NULL, 0, params, threads);
+}
+
+#endif // ARGON2_IMPLEMENT
@@ -3,7 +3,7 @@
  *
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-11-21
+ * Last updated: 2026-10-19
  */
 
 #define RSA_IMPLEMENT
@@ -18,22 +18,93 @@
 #define FILE_IMPLEMENT
 #include "file.h"
 
+#define CRC32C_IMPLEMENT
+#include "crc32c.h"
+
 #define DEBUG_IMPLEMENT
 #include "debug.h"
 
+#define SHA256_IMPLEMENT
+#include "sha256.h"
+
+#ifdef RSA_MONT
+#define MONT_IMPLEMENT
+#include "mont.h"
+#endif // RSA_MONT
+
+#define X25519_IMPLEMENT
+#include "x25519.h"
+
+#define ED25519_IMPLEMENT
+#include "ed25519.h"
+
+#define SHA512_IMPLEMENT
+#include "sha512.h"
+
+#define MLKEM_IMPLEMENT
+#include "mlkem.h"
+
+#define SHA3_IMPLEMENT
+#include "sha3.h"
+
+#define KEYRING_IMPLEMENT
+#include "keyring.h"
+
+#define KEYAGENT_IMPLEMENT
+#include "keyagent.h"
+
+#define RANDOM_IMPLEMENT
+#include "random.h"
+
+#define CHACHA20POLY1305_IMPLEMENT
+#include "chacha20poly1305.h"
+
 #include <stdbool.h>
 #include <argp.h>
 #include <stdio.h>
 #include <string.h>
-#include <time.h>
 #include <stdlib.h>
+#include <errno.h>
 
 
 #define SKEY_FILE "skey"
 #define PKEY_FILE "pkey"
 
+// The X25519, Ed25519 and ML-KEM keys are kept next to the other keys
+#define X25519_SKEY_FILE  "skey.x25519"
+#define X25519_PKEY_FILE  "pkey.x25519"
+
+#define ED25519_SKEY_FILE "skey.ed25519"
+#define ED25519_PKEY_FILE "pkey.ed25519"
+
+#define MLKEM_SKEY_FILE   "skey.mlkem"
+#define MLKEM_PKEY_FILE   "pkey.mlkem"
+
 #define KEY_DIR "."
 
+// The encrypted file starts with the fingerprint of the key
+#define FINGERPRINT_SIZE 32
+
+typedef enum
+{
+  MODE_ENCRYPT,
+  MODE_DECRYPT,
+  MODE_SIGN,
+  MODE_VERIFY
+} amode_t;
+
+/*
+ * The cipher used for the message, with the wrapped key
+ *
+ * The value is the cipher id, written in front of the message
+ */
+typedef enum
+{
+  CIPHER_NONE     = 0,
+  CIPHER_AES256   = 1,
+  CIPHER_CHACHA20 = 2
+} cipher_t;
+
 
 static char doc[] = "asmcpt - asymetric cryptography utillity";
 
@@ -44,8 +115,15 @@ static struct argp_option options[] =
   { "secret",  's', "FILE", 0, "Secret key file" },
   { "public",  'p', "FILE", 0, "Public key file" },
   { "dir",     'D', "DIR",  0, "Key directory" },
+  { "keyring", 'k', "FILE", 0, "Keyring file, instead of key files" },
+  { "name",    'n', "NAME", 0, "Name of the keyring key to use" },
+  { "agent",   'a', "SOCKET", OPTION_ARG_OPTIONAL, "Decrypt with the key agent, if it is running" },
+  { "mlkem",   'm', 0,      0, "Wrap the AES key with the ML-KEM-768 keys, skey.mlkem and pkey.mlkem" },
+  { "cipher",  'c', "STRING", 0, "Message cipher: aes256 (default) or chacha20" },
   { "encrypt", 'e', 0,      0, "Encrypt file" },
   { "decrypt", 'd', 0,      0, "Decrypt file" },
+  { "sign",    'S', 0,      0, "Sign file or directory, OUTPUT is the signature or directory of signatures" },
+  { "verify",  'V', 0,      0, "Verify file or directory, OUTPUT is the signature or directory of signatures" },
   { "quiet",   'q', 0,      0, "Don't produce any output" },
   { "debug",   'x', 0,      0, "Output debug messages" },
   { 0 }
@@ -53,21 +131,37 @@ static struct argp_option options[] =
 
 struct args
 {
-  char* args[2];
-  char* secret;
-  char* public;
-  char* dir;
-  bool  encrypt;
-  bool  quiet;
-  bool  debug;
+  char*   args[2];
+  char*   secret;
+  char*   public;
+  bool    secret_named; // If the secret key file is given with -s
+  bool    public_named; // If the public key file is given with -p
+  char*   dir;
+  char*   keyring;
+  char*   name;
+  bool    agent;
+  char*   socket;
+  bool    mlkem;
+  cipher_t cipher;
+  amode_t mode;
+  bool    quiet;
+  bool    debug;
 };
 
 struct args args =
 {
-  .secret  = SKEY_FILE,
-  .public  = PKEY_FILE,
+  .secret  = NULL,
+  .public  = NULL,
+  .secret_named = false,
+  .public_named = false,
   .dir     = KEY_DIR,
-  .encrypt = true,
+  .keyring = NULL,
+  .name    = NULL,
+  .agent   = false,
+  .socket  = NULL,
+  .mlkem   = false,
+  .cipher  = CIPHER_NONE,
+  .mode    = MODE_ENCRYPT,
   .quiet   = false,
   .debug   = false
 };
@@ -83,24 +177,63 @@ static error_t opt_parse(int key, char* arg, struct argp_state* state)
   {
     case 's':
       args->secret = arg;
+      args->secret_named = true;
       break;
 
     case 'p':
       args->public = arg;
+      args->public_named = true;
       break;
 
     case 'd':
-      args->encrypt = false;
+      args->mode = MODE_DECRYPT;
       break;
 
     case 'e':
-      args->encrypt = true;
+      args->mode = MODE_ENCRYPT;
+      break;
+
+    case 'S':
+      args->mode = MODE_SIGN;
+      break;
+
+    case 'V':
+      args->mode = MODE_VERIFY;
       break;
 
     case 'D':
       args->dir = arg;
       break;
 
+    case 'k':
+      args->keyring = arg;
+      break;
+
+    case 'n':
+      args->name = arg;
+      break;
+
+    case 'a':
+      args->agent  = true;
+      args->socket = arg;
+      break;
+
+    case 'm':
+      args->mlkem = true;
+      break;
+
+    case 'c':
+      if(strcmp(arg, "aes256") == 0)
+      {
+        args->cipher = CIPHER_AES256;
+      }
+      else if(strcmp(arg, "chacha20") == 0)
+      {
+        args->cipher = CIPHER_CHACHA20;
+      }
+      else argp_usage(state);
+      break;
+
     case 'q':
       if(args->debug) argp_usage(state);
 
@@ -121,6 +254,10 @@ static error_t opt_parse(int key, char* arg, struct argp_state* state)
 
     case ARGP_KEY_END:
       if(state->arg_num < 2) argp_usage(state);
+
+      // The default key files depend on the kind of keys
+      if(!args->secret) args->secret = args->mlkem ? MLKEM_SKEY_FILE : SKEY_FILE;
+      if(!args->public) args->public = args->mlkem ? MLKEM_PKEY_FILE : PKEY_FILE;
       break;
 
     default:
@@ -180,11 +317,68 @@ static int base64_pkey_decode(pkey_t* key, const void* message, size_t size)
   return 0;
 }
 
+/*
+ * Get a key from the keyring, by fingerprint or else by name
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to open keyring
+ * - 2 | The key was not found
+ * - 3 | Failed to decode the key
+ */
+static int keyring_key_load(void* key, uint32_t type, const uint8_t* fingerprint)
+{
+  keyring_t keyring;
+
+  if(keyring_open(&keyring, args.keyring) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Failed to open keyring\n");
+
+    return 1;
+  }
+
+  keyring_key_t found;
+
+  int status;
+
+  if(fingerprint)
+  {
+    status = keyring_fingerprint_find(&found, &keyring, fingerprint, type);
+  }
+  else status = keyring_name_find(&found, &keyring, args.name ? args.name : "", type);
+
+  if(status != 0)
+  {
+    keyring_close(&keyring);
+
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Key is not in keyring\n");
+
+    return 2;
+  }
+
+  if(type == KEYRING_PUBLIC)
+  {
+    status = rsa_pkey_decode(key, found.key, found.size);
+  }
+  else status = rsa_skey_decode(key, found.key, found.size);
+
+  keyring_close(&keyring);
+
+  return (status == 0) ? 0 : 3;
+}
+
 /*
  *
  */
 static int pkey_get(pkey_t* key)
 {
+  if(args.keyring)
+  {
+    return keyring_key_load(key, KEYRING_PUBLIC, NULL);
+  }
+
   size_t file_size = dir_file_size_get(args.dir, args.public);
 
   char base64[file_size];
@@ -209,10 +403,25 @@ static int pkey_get(pkey_t* key)
 }
 
 /*
+ * Get the secret key
  *
+ * If a fingerprint is given, the keyring key with
+ * that fingerprint is used, otherwise the named key
  */
-static int skey_get(skey_t* key)
+static int skey_get(skey_t* key, const uint8_t* fingerprint)
 {
+  if(args.keyring)
+  {
+    return keyring_key_load(key, KEYRING_SECRET, fingerprint);
+  }
+
+  // A key in the extended format is mapped, instead of decoded
+  char filepath[strlen(args.dir) + strlen(args.secret) + 2];
+
+  sprintf(filepath, "%s/%s", args.dir, args.secret);
+
+  if(rsa_skey_ext_load(key, filepath) == 0) return 0;
+
   size_t file_size = dir_file_size_get(args.dir, args.secret);
 
   char base64[file_size];
@@ -231,230 +440,1689 @@ static int skey_get(skey_t* key)
 }
 
 /*
- * Generate random bytes as the key used for encryption
+ * Read and base64 decode a key file in the key directory
+ *
+ * This function allocates size bytes memory to buffer
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to read the file
+ * - 2 | Failed to decode base64
  */
-static void aes_key_gen(char buffer[32])
+static int key_file_read(char** buffer, size_t* size, const char* name)
 {
-  for(size_t index = 0; index < 32; index++)
+  size_t file_size = dir_file_size_get(args.dir, name);
+
+  if(file_size == 0) return 1;
+
+  char base64[file_size];
+
+  if(dir_file_read(base64, file_size, args.dir, name) == 0)
+  {
+    return 1;
+  }
+
+  if(base64_decode(buffer, size, base64, file_size) != 0)
   {
-    buffer[index] = rand() % 0xFF; 
+    return 2;
   }
+
+  return 0;
 }
 
 /*
- * Asymetric encrypt the message
+ * Get the file of a kind of key in the key directory
  *
- * This function allocates rsize bytes memory to result
+ * A key file given with -s or -p is used for every kind of key,
+ * otherwise every kind of key has its own file
+ */
+static const char* key_name_get(bool secret, const char* kind_name)
+{
+  if(secret) return args.secret_named ? args.secret : kind_name;
+
+  return args.public_named ? args.public : kind_name;
+}
+
+/*
+ * Read an X25519 or Ed25519 key from the key directory
+ *
+ * The key_decode function is x25519_key_decode or ed25519_key_decode
  *
  * RETURN (int status)
  * - 0 | Success
- * - 1 | Supplied arguments invalid
+ * - 1 | Failed to read the file
+ * - 2 | The file is not that kind of key
  */
-static int asm_encrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, pkey_t* pkey)
+static int curve_key_load(uint8_t key[32], const char* name, int (*key_decode)(uint8_t*, const void*, size_t))
 {
-  if(!result || !message || !pkey) return 1;
+  char*  buffer;
+  size_t buffer_size;
 
-  // 1. Generate AES key
-  char aes_key[32];
+  int status = key_file_read(&buffer, &buffer_size, name);
 
-  aes_key_gen(aes_key);
+  if(status != 0) return status;
 
-  // 2. Encrypt the AES key using RSA
-  char aes_key_enc[ENCRYPT_SIZE];
+  status = key_decode(key, buffer, buffer_size);
 
-  size_t rsa_size;
+  memset(buffer, '\0', buffer_size);
 
-  rsa_encrypt(aes_key_enc, &rsa_size, aes_key, 32, pkey);
+  free(buffer);
 
+  return (status == 0) ? 0 : 2;
+}
 
-  // 3. Encrypt the message using the AES key
-  size_t aes_size;
-  uint8_t* aes_message;
+/*
+ * Read an ML-KEM secret or public key, of size bytes, from the key directory
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to read the file
+ * - 2 | The file is not that kind of key
+ */
+static int mlkem_key_load(uint8_t* key, size_t size, const char* name)
+{
+  char*  buffer;
+  size_t buffer_size;
 
-  if(aes_encrypt(&aes_message, &aes_size, message, msize, aes_key, AES_256) != 0)
-  {
-    return 2;
-  }
+  int status = key_file_read(&buffer, &buffer_size, name);
 
+  if(status != 0) return status;
 
-  // 4. Concatonate the different variables to a result
-  size_t result_size = (1 + rsa_size + aes_size);
+  status = mlkem_key_decode(key, size, buffer, buffer_size);
 
-  if(rsize) *rsize = result_size;
+  memset(buffer, '\0', buffer_size);
 
-  *result = malloc(sizeof(uint8_t) * result_size);
+  free(buffer);
 
-  // 1. First comes the RSA encrypted size
-  *result[0] = (uint8_t) rsa_size;
+  return (status == 0) ? 0 : 2;
+}
 
-  // 2. Then comes the RSA encrypted AES key
-  memcpy(*result + 1, aes_key_enc, rsa_size);
+/*
+ * Get the fingerprint of an X25519 public key
+ *
+ * The fingerprint is the SHA-256 digest of the encoded public key
+ */
+static void x25519_fingerprint(uint8_t fingerprint[FINGERPRINT_SIZE], const uint8_t pkey[X25519_KEY_SIZE])
+{
+  uint8_t encoded[X25519_ENCODED_SIZE];
 
-  // 3. Then comes the AES encrypted message
-  memcpy(*result + 1 + rsa_size, aes_message, aes_size);
+  x25519_key_encode(encoded, pkey);
 
-  free(aes_message);
+  sha256_ctx_t ctx;
 
-  return 0;
+  sha256_init(&ctx);
+
+  sha256_update(&ctx, encoded, sizeof(encoded));
+
+  sha256_final(fingerprint, &ctx);
 }
 
 /*
- * Decrypt the asymetric encrypted message
- *
- * This function allocates rsize bytes memory to result
+ * Derive the AES key from the X25519 shared secret
  *
- * RETURN (int status)
- * - 0 | Success
- * - 1 | Supplied arguments invalid
+ * The key is the SHA-256 digest of the shared secret, the
+ * ephemeral public key and the recipient's public key
  */
-static int asm_decrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, skey_t* skey)
+static void x25519_aes_key_derive(char aes_key[32], const uint8_t shared[X25519_KEY_SIZE], const uint8_t epkey[X25519_KEY_SIZE], const uint8_t pkey[X25519_KEY_SIZE])
 {
-  if(!result || !message || !skey) return 1;
+  sha256_ctx_t ctx;
 
-  // Check if the message is large enough
-  if(msize < (1 + ENCRYPT_SIZE + AES_SIZE(1)))
-  {
-    if(!args.quiet)
-      fprintf(stderr, "asmcpt: File is to small\n");
+  sha256_init(&ctx);
 
-    return 2;
-  }
+  sha256_update(&ctx, shared, X25519_KEY_SIZE);
+  sha256_update(&ctx, epkey,  X25519_KEY_SIZE);
+  sha256_update(&ctx, pkey,   X25519_KEY_SIZE);
 
-  // 1. Get the size of the RSA encryption
-  size_t rsa_size = (size_t) *((char*) message);
+  sha256_final((uint8_t*) aes_key, &ctx);
+}
 
+/*
+ * Get the fingerprint of an ML-KEM public key
+ *
+ * The fingerprint is the SHA-256 digest of the encoded public key
+ */
+static void mlkem_fingerprint(uint8_t fingerprint[FINGERPRINT_SIZE], const uint8_t pkey[MLKEM_PKEY_SIZE])
+{
+  uint8_t encoded[MLKEM_ENCODED_SIZE(MLKEM_PKEY_SIZE)];
 
-  // 2. Then comes the RSA encrypted AES key
-  char aes_key[ENCRYPT_SIZE]; // Eigentlich MESSAGE_SIZE
+  mlkem_key_encode(encoded, pkey, MLKEM_PKEY_SIZE);
 
-  memset(aes_key, '\0', sizeof(aes_key));
+  sha256_ctx_t ctx;
 
-  rsa_decrypt(aes_key, NULL, message + 1, rsa_size, skey);
+  sha256_init(&ctx);
 
+  sha256_update(&ctx, encoded, sizeof(encoded));
 
-  // 3. Then comes the AES encrypted message
-  size_t aes_size = (msize - 1 - rsa_size);
+  sha256_final(fingerprint, &ctx);
+}
 
-  if(aes_decrypt(result, rsize, message + 1 + rsa_size, aes_size, aes_key, AES_256) != 0)
+/*
+ * Get the name of the cipher, as given with -c
+ */
+static const char* cipher_name(cipher_t cipher)
+{
+  switch(cipher)
   {
-    return 2;
+    case CIPHER_AES256:   return "aes256";
+    case CIPHER_CHACHA20: return "chacha20";
+    default:              return "unknown";
   }
-
-  return 0;
 }
 
 /*
+ * Encrypt the message with the wrapped key, using the chosen cipher
+ *
+ * The result is: cipher id (1), encrypted message
  *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to encrypt the message
+ * - 2 | Failed to allocate memory
  */
-static void encrypt_routine(const void* message, size_t size)
+static int message_encrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const char key[32])
 {
-  pkey_t pkey;
+  cipher_t cipher = (args.cipher == CIPHER_NONE) ? CIPHER_AES256 : args.cipher;
 
-  if(pkey_get(&pkey) != 0)
-  {
-    if(!args.quiet)
-      fprintf(stderr, "asmcpt: Failed to get public key\n");
+  uint8_t* cipher_message;
+  size_t cipher_size;
+
+  int status;
 
-    return;
+  if(cipher == CIPHER_CHACHA20)
+  {
+    status = chacha20poly1305_encrypt(&cipher_message, &cipher_size, message, msize, key);
   }
+  else status = aes_encrypt(&cipher_message, &cipher_size, message, msize, key, AES_256);
 
-  uint8_t* result;
-  size_t rsize;
+  if(status != 0) return 1;
+
+  *result = malloc(sizeof(uint8_t) * (1 + cipher_size));
 
-  if(asm_encrypt(&result, &rsize, message, size, &pkey) == 0)
+  if(!(*result))
   {
-    file_write(result, rsize, args.args[1]);
+    free(cipher_message);
 
-    free(result);
+    errno = ENOMEM; // Out of memory
+
+    return 2;
   }
 
-  rsa_pkey_free(&pkey);
+  (*result)[0] = (uint8_t) cipher;
+
+  memcpy(*result + 1, cipher_message, cipher_size);
+
+  free(cipher_message);
+
+  if(rsize) *rsize = 1 + cipher_size;
+
+  return 0;
 }
 
 /*
+ * Decrypt the message with the unwrapped key, using the cipher
+ * of the cipher id in front of it
+ *
+ * A ChaCha20-Poly1305 message is authenticated before it is decrypted
  *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to decrypt the message
+ * - 2 | The cipher is unknown, or not the one chosen with -c
  */
-static void decrypt_routine(const void* message, size_t size)
+static int message_decrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const char key[32])
 {
-  skey_t skey;
+  const uint8_t* bytes = message;
+
+  if(msize < 1) return 1;
 
-  if(skey_get(&skey) != 0)
+  cipher_t cipher = bytes[0];
+
+  if(cipher != CIPHER_AES256 && cipher != CIPHER_CHACHA20)
   {
     if(!args.quiet)
-      fprintf(stderr, "asmcpt: Failed to get secret key\n");
+      fprintf(stderr, "asmcpt: Message has unknown cipher id %d\n", (int) bytes[0]);
 
-    return;
+    return 2;
   }
 
-  uint8_t* result;
-  size_t rsize;
+  if(args.cipher != CIPHER_NONE && args.cipher != cipher)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Message is encrypted with %s, not %s\n", cipher_name(cipher), cipher_name(args.cipher));
+
+    return 2;
+  }
 
-  if(asm_decrypt(&result, &rsize, message, size, &skey) == 0)
+  int status;
+
+  if(cipher == CIPHER_CHACHA20)
   {
-    file_write(result, rsize, args.args[1]);
+    status = chacha20poly1305_decrypt(result, rsize, bytes + 1, msize - 1, key);
 
-    free(result);
+    if(status == 2 && !args.quiet)
+      fprintf(stderr, "asmcpt: Message is damaged or encrypted with another key\n");
   }
+  else status = aes_decrypt(result, rsize, bytes + 1, msize - 1, key, AES_256);
 
-  rsa_skey_free(&skey);
+  return (status == 0) ? 0 : 1;
 }
 
-static struct argp argp = { options, opt_parse, args_doc, doc };
-
 /*
+ * Asymetric encrypt the message
+ *
+ * The AES key is wrapped with RSAES-OAEP, so the wrapped key
+ * is always the size of the modulus
+ *
+ * This function allocates rsize bytes memory to result
+ *
  * RETURN (int status)
  * - 0 | Success
+ * - 1 | Supplied arguments invalid
+ * - 2 | Failed to encrypt the message
+ * - 3 | Failed to allocate memory
  */
-int main(int argc, char* argv[])
+static int asm_encrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, pkey_t* pkey)
 {
-  argp_parse(&argp, argc, argv, 0, 0, &args);
-
-  srand(time(NULL));
-
-  if(args.debug)
-    info_print("Start of main");
+  if(!result || !message || !pkey) return 1;
 
-  /*
-  printf("skey: %s/%s\n", args.dir, args.secret);
-  printf("pkey: %s/%s\n", args.dir, args.public);
-  */
+  // 1. Generate AES key
+  char aes_key[32];
 
-  // Get the size of the inputted file
-  // If the size is 0 (no data), the file is of no use
-  size_t size = file_size_get(args.args[0]);
+  if(random_bytes(aes_key, 32) != 0) return 2;
 
-  if(size == 0)
-  {
-    if(!args.quiet)
-      fprintf(stderr, "asmcpt: Inputted file has no data\n");
-  
-    return 1;
-  }
+  // 2. Encrypt the AES key using RSA
+  char aes_key_enc[pkey->size];
 
-  // Read the file and store the data as the message
-  char* message = malloc(sizeof(char) * size);
+  size_t rsa_size;
 
-  if(file_read(message, size, args.args[0]) == 0)
+  if(rsa_encrypt(aes_key_enc, &rsa_size, aes_key, 32, pkey) != 0)
   {
-    if(!args.quiet)
-      fprintf(stderr, "asmcpt: Failed to read file\n");
+    memset(aes_key, '\0', sizeof(aes_key));
 
     return 2;
   }
 
-  if(args.encrypt) 
-  {
-    encrypt_routine(message, size);
-  }
-  else
-  {
-    decrypt_routine(message, size);
-  }
 
-  free(message);
+  // 3. Encrypt the message using the AES key
+  size_t aes_size;
+  uint8_t* aes_message;
+
+  int status = message_encrypt(&aes_message, &aes_size, message, msize, aes_key);
+
+  memset(aes_key, '\0', sizeof(aes_key));
+
+  if(status != 0) return 2;
+
+
+  // 4. Concatonate the different variables to a result
+  size_t result_size = (FINGERPRINT_SIZE + 2 + rsa_size + aes_size);
+
+  if(rsize) *rsize = result_size;
+
+  *result = malloc(sizeof(uint8_t) * result_size);
+
+  if(!(*result))
+  {
+    free(aes_message);
+
+    errno = ENOMEM; // Out of memory
+
+    return 3;
+  }
+
+  uint8_t* header = *result;
+
+  // 1. First comes the fingerprint of the public key
+  rsa_pkey_fingerprint(header, pkey);
+
+  header += FINGERPRINT_SIZE;
+
+  // 2. Then comes the RSA encrypted size (2 bytes, big-endian)
+  header[0] = (uint8_t) (rsa_size >> 8);
+  header[1] = (uint8_t)  rsa_size;
+
+  // 3. Then comes the RSA encrypted AES key
+  memcpy(header + 2, aes_key_enc, rsa_size);
+
+  // 4. Then comes the AES encrypted message
+  memcpy(header + 2 + rsa_size, aes_message, aes_size);
+
+  free(aes_message);
+
+  return 0;
+}
+
+/*
+ * Decrypt the asymetric encrypted message
+ *
+ * This function allocates rsize bytes memory to result
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Supplied arguments invalid
+ * - 2 | The message is invalid
+ * - 3 | Failed to decrypt the AES key
+ * - 4 | The agent failed to decrypt the AES key
+ *
+ * Without a secret key, the AES key is decrypted by the agent
+ */
+static int asm_decrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, skey_t* skey, int agent)
+{
+  if(!result || !message || (!skey && agent == -1)) return 1;
+
+  // The fingerprint is checked before, when getting the secret key
+  if(msize < FINGERPRINT_SIZE)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: File is to small\n");
+
+    return 2;
+  }
+
+  const uint8_t* bytes = (uint8_t*) message + FINGERPRINT_SIZE;
+
+  msize -= FINGERPRINT_SIZE;
+
+  // Check if the message is large enough
+  if(msize < 2)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: File is to small\n");
+
+    return 2;
+  }
+
+  // 1. Get the size of the RSA encryption
+  size_t rsa_size = ((size_t) bytes[0] << 8) | bytes[1];
+
+  size_t max_size = skey ? skey->size : (RSA_MODULUS_MAX / 8);
+
+  if(rsa_size > max_size || msize < (2 + rsa_size + 1 + AES_SIZE(1)))
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: File is to small\n");
+
+    return 2;
+  }
+
+
+  // 2. Then comes the RSA encrypted AES key
+  char buffer[max_size];
+
+  size_t key_size;
+
+  if(skey)
+  {
+    if(rsa_decrypt(buffer, &key_size, bytes + 2, rsa_size, skey) != 0)
+    {
+      if(!args.quiet)
+        fprintf(stderr, "asmcpt: Invalid decryption\n");
+
+      return 3;
+    }
+  }
+  else if(keyagent_decrypt(buffer, &key_size, max_size, agent, message, bytes + 2, rsa_size) != 0)
+  {
+    return 4;
+  }
+
+  if(key_size != 32)
+  {
+    memset(buffer, '\0', max_size);
+
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Invalid decryption\n");
+
+    return 3;
+  }
+
+  char aes_key[32];
+
+  memcpy(aes_key, buffer, sizeof(aes_key));
+
+  memset(buffer, '\0', max_size);
+
+
+  // 3. Then comes the AES encrypted message
+  size_t aes_size = (msize - 2 - rsa_size);
+
+  if(message_decrypt(result, rsize, bytes + 2 + rsa_size, aes_size, aes_key) != 0)
+  {
+    return 2;
+  }
+
+  return 0;
+}
+
+/*
+ * Asymetric encrypt the message to an X25519 public key
+ *
+ * An ephemeral key pair is generated for every message, and the AES key
+ * is derived from its shared secret with the recipient's public key
+ *
+ * The result is: fingerprint (32), ephemeral public key (32), AES message
+ *
+ * This function allocates rsize bytes memory to result
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Supplied arguments invalid
+ * - 2 | Failed to encrypt the message
+ * - 3 | Failed to allocate memory
+ */
+static int x25519_asm_encrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const uint8_t pkey[X25519_KEY_SIZE])
+{
+  if(!result || !message || !pkey) return 1;
+
+  // 1. Generate the ephemeral keys, and the shared secret
+  uint8_t eskey[X25519_KEY_SIZE];
+  uint8_t epkey[X25519_KEY_SIZE];
+  uint8_t shared[X25519_KEY_SIZE];
+
+  if(x25519_keys_gen(eskey, epkey) != 0 || x25519(shared, eskey, pkey) != 0)
+  {
+    memset(eskey, '\0', sizeof(eskey));
+
+    return 2;
+  }
+
+  // 2. Derive the AES key from the shared secret
+  char aes_key[32];
+
+  x25519_aes_key_derive(aes_key, shared, epkey, pkey);
+
+  memset(eskey,  '\0', sizeof(eskey));
+  memset(shared, '\0', sizeof(shared));
+
+  // 3. Encrypt the message using the AES key
+  size_t aes_size;
+  uint8_t* aes_message;
+
+  int status = message_encrypt(&aes_message, &aes_size, message, msize, aes_key);
+
+  memset(aes_key, '\0', sizeof(aes_key));
+
+  if(status != 0) return 2;
+
+  // 4. Concatonate the fingerprint, the ephemeral public key and the message
+  size_t result_size = (FINGERPRINT_SIZE + X25519_KEY_SIZE + aes_size);
+
+  if(rsize) *rsize = result_size;
+
+  *result = malloc(sizeof(uint8_t) * result_size);
+
+  if(!(*result))
+  {
+    free(aes_message);
+
+    errno = ENOMEM; // Out of memory
+
+    return 3;
+  }
+
+  x25519_fingerprint(*result, pkey);
+
+  memcpy(*result + FINGERPRINT_SIZE, epkey, X25519_KEY_SIZE);
+
+  memcpy(*result + FINGERPRINT_SIZE + X25519_KEY_SIZE, aes_message, aes_size);
+
+  free(aes_message);
+
+  return 0;
+}
+
+/*
+ * Decrypt the message encrypted to an X25519 public key
+ *
+ * This function allocates rsize bytes memory to result
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Supplied arguments invalid
+ * - 2 | The message is invalid
+ */
+static int x25519_asm_decrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const uint8_t skey[X25519_KEY_SIZE])
+{
+  if(!result || !message || !skey) return 1;
+
+  // The fingerprint is checked before, when getting the secret key
+  if(msize < (FINGERPRINT_SIZE + X25519_KEY_SIZE + 1 + AES_SIZE(1)))
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: File is to small\n");
+
+    return 2;
+  }
+
+  const uint8_t* epkey = (uint8_t*) message + FINGERPRINT_SIZE;
+
+  // 1. Calculate the shared secret with the ephemeral public key
+  uint8_t pkey[X25519_KEY_SIZE];
+  uint8_t shared[X25519_KEY_SIZE];
+
+  x25519_pkey_get(pkey, skey);
+
+  if(x25519(shared, skey, epkey) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Invalid decryption\n");
+
+    return 2;
+  }
+
+  // 2. Derive the AES key from the shared secret
+  char aes_key[32];
+
+  x25519_aes_key_derive(aes_key, shared, epkey, pkey);
+
+  memset(shared, '\0', sizeof(shared));
+
+  // 3. Then comes the AES encrypted message
+  size_t aes_size = (msize - FINGERPRINT_SIZE - X25519_KEY_SIZE);
+
+  int status = message_decrypt(result, rsize, epkey + X25519_KEY_SIZE, aes_size, aes_key);
+
+  memset(aes_key, '\0', sizeof(aes_key));
+
+  return (status == 0) ? 0 : 2;
+}
+
+/*
+ * Asymetric encrypt the message to an ML-KEM public key
+ *
+ * A shared secret is encapsulated for every message,
+ * and is used directly as the AES key
+ *
+ * The result is: fingerprint (32), ML-KEM ciphertext (1088), AES message
+ *
+ * This function allocates rsize bytes memory to result
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Supplied arguments invalid
+ * - 2 | Failed to encrypt the message
+ * - 3 | Failed to allocate memory
+ */
+static int mlkem_asm_encrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const uint8_t pkey[MLKEM_PKEY_SIZE])
+{
+  if(!result || !message || !pkey) return 1;
+
+  // 1. Encapsulate the AES key
+  uint8_t ciphertext[MLKEM_CIPHERTEXT_SIZE];
+  char aes_key[32];
+
+  if(mlkem_encaps(ciphertext, (uint8_t*) aes_key, pkey) != 0)
+  {
+    return 2;
+  }
+
+  // 2. Encrypt the message using the AES key
+  size_t aes_size;
+  uint8_t* aes_message;
+
+  int status = message_encrypt(&aes_message, &aes_size, message, msize, aes_key);
+
+  memset(aes_key, '\0', sizeof(aes_key));
+
+  if(status != 0) return 2;
+
+  // 3. Concatonate the fingerprint, the ciphertext and the message
+  size_t result_size = (FINGERPRINT_SIZE + MLKEM_CIPHERTEXT_SIZE + aes_size);
+
+  if(rsize) *rsize = result_size;
+
+  *result = malloc(sizeof(uint8_t) * result_size);
+
+  if(!(*result))
+  {
+    free(aes_message);
+
+    errno = ENOMEM; // Out of memory
+
+    return 3;
+  }
+
+  mlkem_fingerprint(*result, pkey);
+
+  memcpy(*result + FINGERPRINT_SIZE, ciphertext, MLKEM_CIPHERTEXT_SIZE);
+
+  memcpy(*result + FINGERPRINT_SIZE + MLKEM_CIPHERTEXT_SIZE, aes_message, aes_size);
+
+  free(aes_message);
+
+  return 0;
+}
+
+/*
+ * Decrypt the message encrypted to an ML-KEM public key
+ *
+ * A damaged ciphertext decapsulates to a wrong AES key,
+ * which the AES decryption then fails on
+ *
+ * This function allocates rsize bytes memory to result
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Supplied arguments invalid
+ * - 2 | The message is invalid
+ */
+static int mlkem_asm_decrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const uint8_t skey[MLKEM_SKEY_SIZE])
+{
+  if(!result || !message || !skey) return 1;
+
+  // The fingerprint is checked before, when getting the secret key
+  if(msize < (FINGERPRINT_SIZE + MLKEM_CIPHERTEXT_SIZE + 1 + AES_SIZE(1)))
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: File is to small\n");
+
+    return 2;
+  }
+
+  const uint8_t* ciphertext = (uint8_t*) message + FINGERPRINT_SIZE;
+
+  // 1. Decapsulate the AES key
+  char aes_key[32];
+
+  if(mlkem_decaps((uint8_t*) aes_key, ciphertext, skey) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Invalid secret key\n");
+
+    return 2;
+  }
+
+  // 2. Then comes the AES encrypted message
+  size_t aes_size = (msize - FINGERPRINT_SIZE - MLKEM_CIPHERTEXT_SIZE);
+
+  int status = message_decrypt(result, rsize, ciphertext + MLKEM_CIPHERTEXT_SIZE, aes_size, aes_key);
+
+  memset(aes_key, '\0', sizeof(aes_key));
+
+  return (status == 0) ? 0 : 2;
+}
+
+/*
+ * Check the chunk checksums in front of the encrypted message
+ *
+ * This is done before decrypting, to catch a damaged file early
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The checksum table is damaged
+ * - 2 | Some chunks are damaged
+ * - 3 | Failed to allocate memory
+ */
+static int chunks_check(size_t* offset, const void* message, size_t size)
+{
+  size_t* damaged;
+  size_t  count;
+
+  int status = crc32c_table_check(offset, &damaged, &count, message, size);
+
+  if(status == 3)
+  {
+    if(!args.quiet)
+    {
+      for(size_t index = 0; index < count; index++)
+      {
+        fprintf(stderr, "asmcpt: Chunk %zu is damaged\n", damaged[index]);
+      }
+    }
+
+    free(damaged);
+
+    return 2;
+  }
+  else if(status == 4)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Failed to allocate memory\n");
+
+    return 3;
+  }
+  else if(status != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Checksum table is damaged\n");
+
+    return 1;
+  }
+
+  return 0;
+}
+
+/*
+ * Write the encrypted message, with the chunk checksums in front of it
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to add checksums
+ * - 2 | Failed to write file
+ */
+static int chunks_write(const void* message, size_t size, const char* filepath)
+{
+  uint8_t* result;
+  size_t rsize;
+
+  if(crc32c_table_add(&result, &rsize, message, size) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Failed to add checksums\n");
+
+    return 1;
+  }
+
+  size_t write_size = file_write(result, rsize, filepath);
+
+  free(result);
+
+  if(write_size != rsize)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Failed to write file\n");
+
+    return 2;
+  }
+
+  return 0;
+}
+
+/*
+ * Encrypt the message, and write it to the output file
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to encrypt the file
+ */
+static int encrypt_routine(const void* message, size_t size)
+{
+  uint8_t* result;
+  size_t rsize;
+
+  int status;
+
+  // The ML-KEM keys are only used when asked for
+  if(args.mlkem)
+  {
+    uint8_t mlkem_pkey[MLKEM_PKEY_SIZE];
+
+    if(mlkem_key_load(mlkem_pkey, MLKEM_PKEY_SIZE, args.public) != 0)
+    {
+      if(!args.quiet)
+        fprintf(stderr, "asmcpt: Failed to get ML-KEM public key\n");
+
+      return 1;
+    }
+
+    if(mlkem_asm_encrypt(&result, &rsize, message, size, mlkem_pkey) != 0)
+    {
+      if(!args.quiet)
+        fprintf(stderr, "asmcpt: Failed to encrypt file\n");
+
+      return 1;
+    }
+
+    status = chunks_write(result, rsize, args.args[1]);
+
+    free(result);
+
+    return (status == 0) ? 0 : 1;
+  }
+
+  // If the public key is an X25519 key, the message is wrapped with it
+  uint8_t x25519_pkey[X25519_KEY_SIZE];
+
+  if(!args.keyring && curve_key_load(x25519_pkey, key_name_get(false, X25519_PKEY_FILE), x25519_key_decode) == 0)
+  {
+    if(x25519_asm_encrypt(&result, &rsize, message, size, x25519_pkey) != 0)
+    {
+      if(!args.quiet)
+        fprintf(stderr, "asmcpt: Failed to encrypt file\n");
+
+      return 1;
+    }
+
+    status = chunks_write(result, rsize, args.args[1]);
+
+    free(result);
+
+    return (status == 0) ? 0 : 1;
+  }
+
+  uint8_t ed25519_pkey[ED25519_KEY_SIZE];
+
+  // An Ed25519 key in its own file is only used to sign
+  if(!args.keyring && args.public_named && curve_key_load(ed25519_pkey, args.public, ed25519_key_decode) == 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Ed25519 keys can't encrypt\n");
+
+    return 1;
+  }
+
+  pkey_t pkey;
+
+  if(pkey_get(&pkey) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Failed to get public key\n");
+
+    return 1;
+  }
+
+  status = asm_encrypt(&result, &rsize, message, size, &pkey);
+
+  rsa_pkey_free(&pkey);
+
+  if(status != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Failed to encrypt file\n");
+
+    return 1;
+  }
+
+  status = chunks_write(result, rsize, args.args[1]);
+
+  free(result);
+
+  return (status == 0) ? 0 : 1;
+}
+
+/*
+ * Write the decrypted message to the output file, and free it
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to write file
+ */
+static int result_write(uint8_t* result, size_t rsize)
+{
+  size_t write_size = file_write(result, rsize, args.args[1]);
+
+  free(result);
+
+  if(write_size != rsize)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Failed to write file\n");
+
+    return 1;
+  }
+
+  return 0;
+}
+
+/*
+ * Decrypt the message with the key agent
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 4 | The agent is not running, or doesn't have the key
+ * - 1-3 as asm_decrypt
+ */
+static int agent_decrypt(uint8_t** result, size_t* rsize, const void* message, size_t size)
+{
+  char path[108];
+
+  if(args.socket)
+  {
+    snprintf(path, sizeof(path), "%s", args.socket);
+  }
+  else keyagent_socket_path(path, sizeof(path));
+
+  int agent = keyagent_connect(path);
+
+  if(agent == -1)
+  {
+    if(args.debug)
+      info_print("Key agent is not running");
+
+    return 4;
+  }
+
+  int status = asm_decrypt(result, rsize, message, size, NULL, agent);
+
+  close(agent);
+
+  if(status == 4 && args.debug)
+    info_print("Key agent doesn't have the key");
+
+  return status;
+}
+
+/*
+ * Decrypt the message, which starts at offset, with the ML-KEM secret key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to decrypt the file
+ */
+static int mlkem_decrypt_routine(const void* message, size_t size, size_t offset)
+{
+  const uint8_t* fingerprint = (uint8_t*) message + offset;
+
+  // The secret key is large, and is kept off the stack
+  uint8_t* skey = malloc(MLKEM_SKEY_SIZE);
+
+  if(!skey || mlkem_key_load(skey, MLKEM_SKEY_SIZE, args.secret) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Failed to get ML-KEM secret key\n");
+
+    free(skey);
+
+    return 1;
+  }
+
+  uint8_t pkey[MLKEM_PKEY_SIZE];
+  uint8_t skey_fingerprint[FINGERPRINT_SIZE];
+
+  mlkem_pkey_get(pkey, skey);
+
+  mlkem_fingerprint(skey_fingerprint, pkey);
+
+  int status = 1;
+
+  if(memcmp(skey_fingerprint, fingerprint, FINGERPRINT_SIZE) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: File is encrypted to another key\n");
+  }
+  else
+  {
+    uint8_t* result;
+    size_t rsize;
+
+    if(mlkem_asm_decrypt(&result, &rsize, message + offset, size - offset, skey) == 0)
+    {
+      status = result_write(result, rsize);
+    }
+    else if(!args.quiet)
+      fprintf(stderr, "asmcpt: Failed to decrypt file\n");
+  }
+
+  memset(skey, '\0', MLKEM_SKEY_SIZE);
+
+  free(skey);
+
+  return status;
+}
+
+/*
+ * Decrypt the message, and write it to the output file
+ *
+ * The file is decrypted with the agent, if asked for and it has the key,
+ * or else with the secret key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to decrypt the file
+ */
+static int decrypt_routine(const void* message, size_t size)
+{
+  // Check the chunk checksums, before getting the secret key
+  size_t offset;
+
+  if(chunks_check(&offset, message, size) != 0) return 1;
+
+  if(size - offset < FINGERPRINT_SIZE)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: File is to small\n");
+
+    return 1;
+  }
+
+  // The file says which key it is encrypted to
+  const uint8_t* fingerprint = (uint8_t*) message + offset;
+
+  uint8_t* result;
+  size_t rsize;
+
+  if(args.mlkem)
+  {
+    return mlkem_decrypt_routine(message, size, offset);
+  }
+
+  // 1. The agent only holds RSA keys, so an X25519 secret key is tried first
+  uint8_t x25519_skey[X25519_KEY_SIZE];
+
+  bool is_x25519 = (!args.keyring && curve_key_load(x25519_skey, key_name_get(true, X25519_SKEY_FILE), x25519_key_decode) == 0);
+
+  if(is_x25519)
+  {
+    uint8_t x25519_pkey[X25519_KEY_SIZE];
+    uint8_t skey_fingerprint[FINGERPRINT_SIZE];
+
+    x25519_pkey_get(x25519_pkey, x25519_skey);
+
+    x25519_fingerprint(skey_fingerprint, x25519_pkey);
+
+    if(memcmp(skey_fingerprint, fingerprint, FINGERPRINT_SIZE) == 0)
+    {
+      int status = x25519_asm_decrypt(&result, &rsize, message + offset, size - offset, x25519_skey);
+
+      memset(x25519_skey, '\0', sizeof(x25519_skey));
+
+      return (status == 0) ? result_write(result, rsize) : 1;
+    }
+
+    memset(x25519_skey, '\0', sizeof(x25519_skey));
+  }
+
+  // 2. Let the agent decrypt, if it is running and has the key
+  if(args.agent)
+  {
+    int status = agent_decrypt(&result, &rsize, message + offset, size - offset);
+
+    if(status == 0) return result_write(result, rsize);
+
+    if(status != 4) return 1;
+  }
+
+  // 3. Otherwise, decrypt with the secret key
+  if(is_x25519 && args.secret_named)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: File is encrypted to another key\n");
+
+    return 1;
+  }
+
+  uint8_t ed25519_skey[ED25519_KEY_SIZE];
+
+  if(!args.keyring && args.secret_named && curve_key_load(ed25519_skey, args.secret, ed25519_key_decode) == 0)
+  {
+    memset(ed25519_skey, '\0', sizeof(ed25519_skey));
+
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Ed25519 keys can't decrypt\n");
+
+    return 1;
+  }
+
+  skey_t skey;
+
+  if(skey_get(&skey, fingerprint) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Failed to get secret key\n");
+
+    return 1;
+  }
+
+  uint8_t skey_fingerprint[FINGERPRINT_SIZE];
+
+  if(rsa_skey_fingerprint(skey_fingerprint, &skey) != 0 ||
+     memcmp(skey_fingerprint, fingerprint, FINGERPRINT_SIZE) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: File is encrypted to another key\n");
+
+    rsa_skey_free(&skey);
+
+    return 1;
+  }
+
+  int status = asm_decrypt(&result, &rsize, message + offset, size - offset, &skey, -1);
+
+  rsa_skey_free(&skey);
+
+  return (status == 0) ? result_write(result, rsize) : 1;
+}
+
+/*
+ * The key of the sign and verify routines, either Ed25519 or RSA
+ */
+typedef struct
+{
+  bool    ed25519;
+  uint8_t key[ED25519_KEY_SIZE];
+  skey_t  skey;
+  pkey_t  pkey;
+  bool    secret;
+} sign_key_t;
+
+/*
+ * Get the secret or the public key, to sign or verify with
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to get the key
+ */
+static int sign_key_get(sign_key_t* key, bool secret)
+{
+  const char* name = key_name_get(secret, secret ? ED25519_SKEY_FILE : ED25519_PKEY_FILE);
+
+  key->secret = secret;
+
+  if(args.mlkem)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: ML-KEM keys can't %s\n", secret ? "sign" : "verify");
+
+    return 1;
+  }
+
+  key->ed25519 = (!args.keyring && curve_key_load(key->key, name, ed25519_key_decode) == 0);
+
+  if(key->ed25519) return 0;
+
+  uint8_t x25519_key[X25519_KEY_SIZE];
+
+  // An X25519 key in its own file is only used to encrypt
+  bool named = secret ? args.secret_named : args.public_named;
+
+  if(!args.keyring && named && curve_key_load(x25519_key, name, x25519_key_decode) == 0)
+  {
+    memset(x25519_key, '\0', sizeof(x25519_key));
+
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: X25519 keys can't %s\n", secret ? "sign" : "verify");
+
+    return 1;
+  }
+
+  if((secret ? skey_get(&key->skey, NULL) : pkey_get(&key->pkey)) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Failed to get %s key\n", secret ? "secret" : "public");
+
+    return 1;
+  }
+
+  return 0;
+}
+
+/*
+ * Free the key of the sign and verify routines
+ */
+static void sign_key_free(sign_key_t* key)
+{
+  if(key->ed25519)
+  {
+    memset(key->key, '\0', sizeof(key->key));
+  }
+  else if(key->secret)
+  {
+    rsa_skey_free(&key->skey);
+  }
+  else rsa_pkey_free(&key->pkey);
+}
+
+/*
+ * Get the size of the signatures of the key
+ */
+static size_t sign_key_size(const sign_key_t* key)
+{
+  if(key->ed25519) return ED25519_SIGNATURE_SIZE;
+
+  return key->secret ? key->skey.size : key->pkey.size;
+}
+
+/*
+ * Sign the message with the secret key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to sign the message
+ */
+static int key_sign(void* signature, size_t* ssize, const void* message, size_t size, sign_key_t* key)
+{
+  if(key->ed25519)
+  {
+    *ssize = ED25519_SIGNATURE_SIZE;
+
+    return ed25519_sign(signature, message, size, key->key);
+  }
+
+  return rsa_sign(signature, ssize, message, size, &key->skey);
+}
+
+/*
+ * Sign the message, and write the signature to the output file
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to sign the file
+ */
+static int sign_routine(const void* message, size_t size)
+{
+  sign_key_t key;
+
+  if(sign_key_get(&key, true) != 0) return 1;
+
+  char signature[sign_key_size(&key)];
+  size_t ssize;
+
+  int status = 0;
+
+  if(key_sign(signature, &ssize, message, size, &key) != 0 ||
+     file_write(signature, ssize, args.args[1]) != ssize)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Failed to sign file\n");
+
+    status = 1;
+  }
+
+  sign_key_free(&key);
+
+  return status;
+}
+
+/*
+ * Verify the signature in the output file of the message
+ *
+ * RETURN (int status)
+ * - 0 | The signature is valid
+ * - 1 | Failed to verify the signature
+ * - 2 | The signature is invalid
+ */
+static int verify_routine(const void* message, size_t size)
+{
+  sign_key_t key;
+
+  if(sign_key_get(&key, false) != 0) return 1;
+
+  size_t ssize = file_size_get(args.args[1]);
+
+  char signature[ssize + 1];
+
+  if(ssize == 0 || file_read(signature, ssize, args.args[1]) != ssize)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Failed to read signature\n");
+
+    sign_key_free(&key);
+
+    return 1;
+  }
+
+  int status;
+
+  if(key.ed25519)
+  {
+    status = (ssize == ED25519_SIGNATURE_SIZE) ? ed25519_verify((uint8_t*) signature, message, size, key.key) : 2;
+  }
+  else status = rsa_verify(signature, ssize, message, size, &key.pkey);
+
+  sign_key_free(&key);
+
+  if(status == 0)
+  {
+    if(!args.quiet)
+      printf("asmcpt: Signature is valid\n");
+
+    return 0;
+  }
+  else if(status == 2)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Signature is invalid\n");
+
+    return 2;
+  }
+
+  if(!args.quiet)
+    fprintf(stderr, "asmcpt: Failed to verify signature\n");
+
+  return 1;
+}
+
+/*
+ * The files of the input directory, and their signatures
+ */
+typedef struct
+{
+  char**  files;
+  size_t  count;
+  void**  messages;
+  size_t* sizes;
+  void**  signatures;
+  size_t* ssizes;
+} sign_dir_t;
+
+/*
+ * Get the name of the file, without its directory
+ */
+static const char* file_name_get(const char* path)
+{
+  const char* name = strrchr(path, '/');
+
+  return name ? (name + 1) : path;
+}
+
+/*
+ * Free the files of the input directory
+ */
+static void sign_dir_free(sign_dir_t* dir)
+{
+  for(size_t index = 0; index < dir->count; index++)
+  {
+    free(dir->messages[index]);
+    free(dir->signatures[index]);
+  }
+
+  free(dir->messages);
+  free(dir->sizes);
+  free(dir->signatures);
+  free(dir->ssizes);
+
+  files_free(dir->files, dir->count);
+}
+
+/*
+ * Read the files of the input directory, and if verify is true,
+ * their signatures of the same name in the output directory
+ *
+ * A file without a signature gets a NULL signature
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to read the directory
+ */
+static int sign_dir_read(sign_dir_t* dir, bool verify)
+{
+  memset(dir, 0, sizeof(sign_dir_t));
+
+  if(files_get(&dir->files, &dir->count, args.args[0], 1) == 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Inputted directory has no files\n");
+
+    return 1;
+  }
+
+  dir->messages   = calloc(dir->count, sizeof(void*));
+  dir->sizes      = calloc(dir->count, sizeof(size_t));
+  dir->signatures = calloc(dir->count, sizeof(void*));
+  dir->ssizes     = calloc(dir->count, sizeof(size_t));
+
+  if(!dir->messages || !dir->sizes || !dir->signatures || !dir->ssizes)
+  {
+    sign_dir_free(dir);
+
+    return 1;
+  }
+
+  for(size_t index = 0; index < dir->count; index++)
+  {
+    size_t size = file_size_get(dir->files[index]);
+
+    // An empty file is still signed, so it has at least one byte of memory
+    dir->messages[index] = malloc(size + 1);
+
+    if(!dir->messages[index] || (size > 0 && file_read(dir->messages[index], size, dir->files[index]) != size))
+    {
+      if(!args.quiet)
+        fprintf(stderr, "asmcpt: Failed to read %s\n", dir->files[index]);
+
+      sign_dir_free(dir);
+
+      return 1;
+    }
+
+    dir->sizes[index] = size;
+
+    if(!verify) continue;
+
+    const char* name = file_name_get(dir->files[index]);
+
+    size_t ssize = dir_file_size_get(args.args[1], name);
+
+    if(ssize == 0) continue;
+
+    dir->signatures[index] = malloc(ssize);
+
+    if(dir->signatures[index] && dir_file_read(dir->signatures[index], ssize, args.args[1], name) == ssize)
+    {
+      dir->ssizes[index] = ssize;
+    }
+    else
+    {
+      free(dir->signatures[index]);
+
+      dir->signatures[index] = NULL;
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Sign every file in the input directory, and write the
+ * signatures with the same names to the output directory
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to sign some files
+ */
+static int sign_dir_routine(void)
+{
+  sign_key_t key;
+
+  if(sign_key_get(&key, true) != 0) return 1;
+
+  sign_dir_t dir;
+
+  if(sign_dir_read(&dir, false) != 0)
+  {
+    sign_key_free(&key);
+
+    return 1;
+  }
+
+  int status = 0;
+
+  char signature[sign_key_size(&key)];
+  size_t ssize;
+
+  for(size_t index = 0; index < dir.count; index++)
+  {
+    const char* name = file_name_get(dir.files[index]);
+
+    if(key_sign(signature, &ssize, dir.messages[index], dir.sizes[index], &key) != 0 ||
+       dir_file_write(signature, ssize, args.args[1], name) != ssize)
+    {
+      if(!args.quiet)
+        fprintf(stderr, "asmcpt: Failed to sign %s\n", dir.files[index]);
+
+      status = 1;
+    }
+  }
+
+  sign_dir_free(&dir);
+
+  sign_key_free(&key);
+
+  return status;
+}
+
+/*
+ * Verify every file in the input directory, with the signatures
+ * of the same names in the output directory, all in one batch
+ *
+ * RETURN (int status)
+ * - 0 | Every signature is valid
+ * - 1 | Failed to verify the signatures
+ * - 2 | Some signatures are invalid
+ */
+static int verify_dir_routine(void)
+{
+  sign_key_t key;
+
+  if(sign_key_get(&key, false) != 0) return 1;
+
+  sign_dir_t dir;
+
+  if(sign_dir_read(&dir, true) != 0)
+  {
+    sign_key_free(&key);
+
+    return 1;
+  }
+
+  int results[dir.count];
+
+  int status;
+
+  if(key.ed25519)
+  {
+    // Every signature has the same public key, and is checked with one multiplication
+    const uint8_t* pkeys[dir.count];
+
+    for(size_t index = 0; index < dir.count; index++)
+    {
+      pkeys[index] = key.key;
+
+      // A missing or wrongly sized signature is invalid, but the others are still checked
+      if(dir.ssizes[index] != ED25519_SIGNATURE_SIZE)
+      {
+        free(dir.signatures[index]);
+
+        dir.signatures[index] = calloc(1, ED25519_SIGNATURE_SIZE);
+      }
+    }
+
+    status = ed25519_verify_batch(results, (const uint8_t**) dir.signatures, (const void**) dir.messages, dir.sizes, pkeys, dir.count);
+  }
+  else
+  {
+    pkey_t* keys[dir.count];
+
+    for(size_t index = 0; index < dir.count; index++)
+    {
+      keys[index] = &key.pkey;
+    }
+
+    status = rsa_verify_batch(results, (const void**) dir.signatures, dir.ssizes, (const void**) dir.messages, dir.sizes, keys, dir.count, 0);
+  }
+
+  if(status == 2 && !args.quiet)
+  {
+    for(size_t index = 0; index < dir.count; index++)
+    {
+      if(results[index] != 0)
+        fprintf(stderr, "asmcpt: Signature of %s is invalid\n", dir.files[index]);
+    }
+  }
+  else if(status == 0 && !args.quiet)
+    printf("asmcpt: %zu signatures are valid\n", dir.count);
+  else if(status != 0 && !args.quiet)
+    fprintf(stderr, "asmcpt: Failed to verify signatures\n");
+
+  sign_dir_free(&dir);
+
+  sign_key_free(&key);
+
+  return status;
+}
+
+static struct argp argp = { options, opt_parse, args_doc, doc };
+
+/*
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Inputted file has no data
+ * - 2 | Failed to read file
+ * - 3 | Failed to verify the signature
+ * - 4 | The signature is invalid
+ * - 5 | Failed to encrypt, decrypt or sign
+ */
+int main(int argc, char* argv[])
+{
+  argp_parse(&argp, argc, argv, 0, 0, &args);
+
+  if(args.debug)
+    info_print("Start of main");
+
+  /*
+  printf("skey: %s/%s\n", args.dir, args.secret);
+  printf("pkey: %s/%s\n", args.dir, args.public);
+  */
+
+  // A directory is signed or verified file by file, into the output directory
+  if(path_type_get(args.args[0]) == TYPE_DIR)
+  {
+    int status = 0;
+
+    if(args.mode == MODE_SIGN)
+    {
+      if(sign_dir_routine() != 0) status = 5;
+    }
+    else if(args.mode == MODE_VERIFY)
+    {
+      status = verify_dir_routine();
+
+      if(status != 0) status += 2;
+    }
+    else
+    {
+      if(!args.quiet)
+        fprintf(stderr, "asmcpt: Only files can be encrypted and decrypted\n");
+
+      status = 5;
+    }
+
+    if(args.debug)
+      info_print("End of main");
+
+    return status;
+  }
+
+  // Get the size of the inputted file
+  // If the size is 0 (no data), the file is of no use
+  size_t size = file_size_get(args.args[0]);
+
+  if(size == 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Inputted file has no data\n");
+  
+    return 1;
+  }
+
+  // Read the file and store the data as the message
+  char* message = malloc(sizeof(char) * size);
+
+  if(file_read(message, size, args.args[0]) == 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "asmcpt: Failed to read file\n");
+
+    return 2;
+  }
+
+  int status = 0;
+
+  switch(args.mode)
+  {
+    case MODE_ENCRYPT:
+      if(encrypt_routine(message, size) != 0) status = 5;
+      break;
+
+    case MODE_DECRYPT:
+      if(decrypt_routine(message, size) != 0) status = 5;
+      break;
+
+    case MODE_SIGN:
+      if(sign_routine(message, size) != 0) status = 5;
+      break;
+
+    case MODE_VERIFY:
+      status = verify_routine(message, size);
+
+      if(status != 0) status += 2;
+      break;
+  }
+
+  free(message);
 
   if(args.debug)
     info_print("End of main");
 
-  return 0;
+  return status;
 }
@@ -4,13 +4,20 @@
  * Written by Hampus Fridholm
  *
  * Credit: https://en.wikipedia.org/wiki/Base64
+ *         http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html
+ *         http://0x80.pl/notesen/2016-01-17-sse-base64-decoding.html
  *
- * Last updated: 2024-12-06
+ * Last updated: 2026-10-19
  *
  *
  * In main compilation unit; define BASE64_IMPLEMENT
  *
  *
+ * Where the CPU has AVX2, 24 bytes are encoded to 32 symbols, and
+ * 32 symbols are decoded to 24 bytes, at a time. The rest of the
+ * message is encoded and decoded 3 bytes at a time, with tables.
+ *
+ *
  * These are the available functions:
  *
  * int base64_encode(char** result, size_t* rsize, const void* message, size_t msize)
@@ -43,54 +50,219 @@ extern int base64_decode(char** result, size_t* rsize, const void* message, size
 #ifdef BASE64_IMPLEMENT
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#define B64_AVX2
+#include <immintrin.h>
+#endif
+
 /*
  * These are the symbols of base 64
  */
 static const char B64_SYMBOLS[64] =
 {
   'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H',
-	'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
-	'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X',
-	'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
-	'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n',
-	'o', 'p', 'q', 'r', 's', 't', 'u', 'v',
-	'w', 'x', 'y', 'z', '0', '1', '2', '3',
-	'4', '5', '6', '7', '8', '9', '+', '/',
+  'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
+  'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X',
+  'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
+  'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n',
+  'o', 'p', 'q', 'r', 's', 't', 'u', 'v',
+  'w', 'x', 'y', 'z', '0', '1', '2', '3',
+  '4', '5', '6', '7', '8', '9', '+', '/',
+};
+
+/*
+ * The index of every symbol in base 64
+ *
+ * Every other character, including '=', is 0xff,
+ * so a group of symbols is validated with one check
+ */
+static const uint8_t B64_INDEXES[256] =
+{
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+  0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+  0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+  0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
 };
 
+#ifdef B64_AVX2
+
+#define B64_AVX2_TARGET __attribute__((target("avx2")))
+
 /*
- * Map 3 8-bit chunks into 4 6-bit chunks
+ * Encode 24 bytes at a time, as long as 28 bytes can be read
+ *
+ * The two lanes each get 12 bytes, which are spread out to
+ * 16 6-bit indexes, and the indexes are turned into symbols
+ * by adding an offset depending on the range of the index
+ *
+ * RETURN (size_t size)
+ * - The amount of encoded bytes, a multiple of 24
  */
-static inline void b64_map_encode(uint8_t buffer[4], const uint8_t tmp[3])
+static inline B64_AVX2_TARGET size_t b64_encode_avx2(char* result, const uint8_t* bytes, size_t size)
 {
-  buffer[0] = ( tmp[0] & 0xfc) >> 2;
-  buffer[1] = ((tmp[0] & 0x03) << 4) + ((tmp[1] & 0xf0) >> 4);
-  buffer[2] = ((tmp[1] & 0x0f) << 2) + ((tmp[2] & 0xc0) >> 6);
-  buffer[3] =   tmp[2] & 0x3f;
+  const __m256i shuffle = _mm256_setr_epi8(
+     1,  0,  2,  1,  4,  3,  5,  4,  7,  6,  8,  7, 10,  9, 11, 10,
+     1,  0,  2,  1,  4,  3,  5,  4,  7,  6,  8,  7, 10,  9, 11, 10);
+
+  // The offset from an index to its symbol, by range of the index
+  const __m256i offsets = _mm256_setr_epi8(
+    'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+    '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A',      0,        0,
+    'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+    '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A',      0,        0);
+
+  size_t index = 0;
+
+  for(; index + 28 <= size; index += 24)
+  {
+    __m128i low  = _mm_loadu_si128((const __m128i*) (bytes + index));
+    __m128i high = _mm_loadu_si128((const __m128i*) (bytes + index + 12));
+
+    __m256i input = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+
+    // 1. Every 32-bit word gets 3 bytes, and is split into 4 indexes
+    input = _mm256_shuffle_epi8(input, shuffle);
+
+    __m256i first  = _mm256_mulhi_epu16(_mm256_and_si256(input, _mm256_set1_epi32(0x0fc0fc00)),
+                                         _mm256_set1_epi32(0x04000040));
+
+    __m256i second = _mm256_mullo_epi16(_mm256_and_si256(input, _mm256_set1_epi32(0x003f03f0)),
+                                         _mm256_set1_epi32(0x01000010));
+
+    __m256i indexes = _mm256_or_si256(first, second);
+
+    // 2. 0-25 gets range 13, 26-51 gets range 0, and 52-63 gets range 1-12
+    __m256i ranges = _mm256_subs_epu8(indexes, _mm256_set1_epi8(51));
+
+    __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indexes);
+
+    ranges = _mm256_or_si256(ranges, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+
+    __m256i symbols = _mm256_add_epi8(indexes, _mm256_shuffle_epi8(offsets, ranges));
+
+    _mm256_storeu_si256((__m256i*) (result + (index / 3 * 4)), symbols);
+  }
+
+  return index;
 }
 
 /*
- * Encode the mapped numbers to symbols of base 64
+ * Decode 32 symbols at a time, until a block has a character
+ * that is not a symbol, like the padding
+ *
+ * The nibbles of every character are looked up in two tables of
+ * bit masks, which only have a bit in common for invalid characters
+ *
+ * RETURN (size_t size)
+ * - The amount of decoded symbols, a multiple of 32
  */
-static inline void b64_symbols_encode(void* result, size_t r_index, uint8_t buffer[4], int bytes)
+static inline B64_AVX2_TARGET size_t b64_decode_avx2(uint8_t* result, const char* symbols, size_t size)
 {
-  // 1. Encode the mapped numbers
-  for(int index = 0; index < bytes; index++)
+  const __m256i lows = _mm256_setr_epi8(
+    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+
+  const __m256i highs = _mm256_setr_epi8(
+    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+
+  // The offset from a symbol to its index, by high nibble ('/' is 0x2f)
+  const __m256i offsets = _mm256_setr_epi8(
+    0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+
+  const __m256i shuffle = _mm256_setr_epi8(
+     2,  1,  0,  6,  5,  4, 10,  9,  8, 14, 13, 12, -1, -1, -1, -1,
+     2,  1,  0,  6,  5,  4, 10,  9,  8, 14, 13, 12, -1, -1, -1, -1);
+
+  const __m256i mask = _mm256_set1_epi8(0x2f);
+
+  size_t index = 0;
+
+  for(; index + 32 <= size; index += 32)
   {
-    char symbol = B64_SYMBOLS[buffer[index]];
+    __m256i input = _mm256_loadu_si256((const __m256i*) (symbols + index));
+
+    // 1. Validate the characters
+    __m256i high_nibbles = _mm256_and_si256(_mm256_srli_epi32(input, 4), mask);
+    __m256i low_nibbles  = _mm256_and_si256(input, mask);
+
+    __m256i high = _mm256_shuffle_epi8(highs, high_nibbles);
+    __m256i low  = _mm256_shuffle_epi8(lows,  low_nibbles);
+
+    if(!_mm256_testz_si256(low, high)) break;
+
+    // 2. Turn the symbols into indexes
+    __m256i slash = _mm256_cmpeq_epi8(input, mask);
 
-    ((char*) result)[r_index + index] = symbol;
+    __m256i offset = _mm256_shuffle_epi8(offsets, _mm256_add_epi8(slash, high_nibbles));
+
+    __m256i indexes = _mm256_add_epi8(input, offset);
+
+    // 3. Merge every 4 indexes into 3 bytes, at the bottom of the lanes
+    __m256i pairs = _mm256_maddubs_epi16(indexes, _mm256_set1_epi32(0x01400140));
+
+    __m256i words = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+
+    words = _mm256_shuffle_epi8(words, shuffle);
+
+    words = _mm256_permutevar8x32_epi32(words, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+
+    uint8_t* output = result + (index / 4 * 3);
+
+    _mm_storeu_si128((__m128i*) output, _mm256_castsi256_si128(words));
+
+    _mm_storel_epi64((__m128i*) (output + 16), _mm256_extracti128_si256(words, 1));
   }
 
-  // 2. Add padding if not all 4 bytes were encoded
-  for(int index = bytes; index < 4; index++)
+  return index;
+}
+
+/*
+ * Check if the processor supports AVX2, only once
+ */
+static inline bool b64_avx2_supported(void)
+{
+  static int supported = -1;
+
+  if(supported == -1)
   {
-    ((char*) result)[r_index + index] = '=';
+    supported = __builtin_cpu_supports("avx2") ? 1 : 0;
   }
+
+  return supported;
+}
+
+#endif // B64_AVX2
+
+/*
+ * Encode 3 bytes into 4 symbols
+ */
+static inline void b64_group_encode(char* result, const uint8_t* bytes)
+{
+  uint32_t value = ((uint32_t) bytes[0] << 16) | ((uint32_t) bytes[1] << 8) | bytes[2];
+
+  result[0] = B64_SYMBOLS[(value >> 18) & 0x3f];
+  result[1] = B64_SYMBOLS[(value >> 12) & 0x3f];
+  result[2] = B64_SYMBOLS[(value >>  6) & 0x3f];
+  result[3] = B64_SYMBOLS[ value        & 0x3f];
 }
 
 /*
@@ -106,42 +278,47 @@ int base64_encode(char** result, size_t* rsize, const void* message, size_t msiz
   if(!result || !message) return 1;
 
   // 1. Allocate memory to result
-  size_t result_size = ((msize * 4 / 3) + 3) & ~3;
+  size_t result_size = (msize + 2) / 3 * 4;
 
-  *result = malloc(sizeof(char) * result_size);
+  *result = malloc(sizeof(char) * (result_size + 1));
 
   if(!(*result)) return 2;
 
 
-  size_t m_index, r_index = 0;
+  const uint8_t* bytes = message;
 
-  uint8_t tmp[3];    // 3 8-bit chunks of data
-  uint8_t buffer[4]; // 4 6-bit chunks of base 64 symbols
+  size_t m_index = 0, r_index = 0;
 
-  // 1. Encode the main part of the message
-  for(m_index = 0; m_index + 3 <= msize; m_index += 3)
+  // 2. Encode the main part of the message
+#ifdef B64_AVX2
+  if(b64_avx2_supported())
   {
-    memcpy(tmp, message + m_index, 3);
+    m_index = b64_encode_avx2(*result, bytes, msize);
 
-    b64_map_encode(buffer, tmp);
+    r_index = m_index / 3 * 4;
+  }
+#endif
 
-    b64_symbols_encode(*result, r_index, buffer, 4);
+  for(; m_index + 3 <= msize; m_index += 3)
+  {
+    b64_group_encode(*result + r_index, bytes + m_index);
 
     r_index += 4;
   }
 
-  // 2. Encode the rest of the message
+  // 3. Encode the rest of the message, and add padding
   if(msize > m_index)
   {
-    memset(tmp, 0, 3);
-
-    memcpy(tmp, message, msize - m_index);
+    uint8_t rest[3] = { 0 };
 
-    b64_map_encode(buffer, tmp);
+    memcpy(rest, bytes + m_index, msize - m_index);
 
-    size_t bytes = (msize - m_index) + 1;
+    b64_group_encode(*result + r_index, rest);
 
-    b64_symbols_encode(*result, r_index, buffer, bytes);
+    for(size_t index = (msize - m_index) + 1; index < 4; index++)
+    {
+      (*result)[r_index + index] = '=';
+    }
 
     r_index += 4;
   }
@@ -152,96 +329,116 @@ int base64_encode(char** result, size_t* rsize, const void* message, size_t msiz
 }
 
 /*
- * Get the index of a symbol in base 64
+ * Decode 4 symbols into 3 bytes
  *
- * RETURN (int index)
- * - >= 0 | Index of symbol
- * -   -1 | Symbol does not exist
+ * RETURN (bool result)
+ * - true  | Success
+ * - false | Invalid symbol
  */
-static inline int b64_symbol_index_get(char symbol)
+static inline bool b64_group_decode(uint8_t* result, const uint8_t* symbols)
 {
-  for(int index = 0; index < 64; index++)
-  {
-    if (B64_SYMBOLS[index] == symbol) return index;
-  }
-
-  return -1;
-}
+  uint8_t a = B64_INDEXES[symbols[0]];
+  uint8_t b = B64_INDEXES[symbols[1]];
+  uint8_t c = B64_INDEXES[symbols[2]];
+  uint8_t d = B64_INDEXES[symbols[3]];
 
-/*
- * Map 4 8-bit chunks into 3 8-bit chunks
- */
-static inline void b64_map_decode(uint8_t buffer[3], uint8_t tmp[4])
-{
-  buffer[0] =  (tmp[0] << 2) +        ((tmp[1] & 0x30) >> 4);
-  buffer[1] = ((tmp[1] & 0xf) << 4) + ((tmp[2] & 0x3c) >> 2);
-  buffer[2] = ((tmp[2] & 0x3) << 6) +   tmp[3];
-}
+  if((a | b | c | d) & 0x80) return false;
 
-/*
- * The function returns the amount of bytes decoded
- *
- * RETURN (int bytes)
- * - -1 | Invalid symbol
- */
-static inline int b64_symbols_decode(uint8_t tmp[4], const void* message, size_t m_index)
-{
-  int bytes;
-
-  for(bytes = 0; bytes < 4; bytes++)
-  {
-    char symbol = ((char*) message)[m_index + bytes];
+  uint32_t value = ((uint32_t) a << 18) | ((uint32_t) b << 12) | ((uint32_t) c << 6) | d;
 
-    if(symbol == '=') return bytes;
+  result[0] = value >> 16;
+  result[1] = value >>  8;
+  result[2] = value;
 
-    int index = b64_symbol_index_get(symbol);
-
-    if(index == -1) return -1;
-
-    tmp[bytes] = index;
-  }
-
-  return bytes;
+  return true;
 }
 
 /*
  * Decode a base64 message
  *
+ * Newlines at the end of the message are ignored,
+ * and the last group can be without padding
+ *
  * RETURN (int status)
  * - 0 | Success
  * - 1 | Bad input
  * - 2 | Failed to malloc memory
+ * - 3 | Invalid symbol
  */
 int base64_decode(char** result, size_t* rsize, const void* message, size_t msize)
 {
   if(!result || !message) return 1;
 
+  const uint8_t* symbols = message;
+
+  while(msize > 0 && (symbols[msize - 1] == '\n' || symbols[msize - 1] == '\r'))
+  {
+    msize--;
+  }
+
   // 1. Allocate memory to result
-  size_t result_size = (msize * 3 / 4);
+  size_t result_size = (msize / 4 + 1) * 3;
 
   *result = malloc(sizeof(char) * result_size);
 
   if(!(*result)) return 2;
 
 
-  size_t m_index, r_index = 0;
+  uint8_t* bytes = (uint8_t*) *result;
+
+  size_t m_index = 0, r_index = 0;
+
+  // The last group can have padding, so it is decoded by itself
+  size_t main_size = (msize > 0) ? (msize - 1) & ~((size_t) 3) : 0;
+
+  // 2. Decode the main part of the message
+#ifdef B64_AVX2
+  if(b64_avx2_supported())
+  {
+    m_index = b64_decode_avx2(bytes, message, main_size);
+
+    r_index = m_index / 4 * 3;
+  }
+#endif
+
+  for(; m_index < main_size; m_index += 4)
+  {
+    if(!b64_group_decode(bytes + r_index, symbols + m_index)) break;
+
+    r_index += 3;
+  }
+
+  // 3. Decode the last group, without its padding
+  size_t rest_size = msize - m_index;
 
-  uint8_t tmp[4];    // 4 6-bit chunks of base 64 symbols
-  uint8_t buffer[3]; // 3 8-bit chunks of data
+  if(rest_size == 4 && symbols[m_index + 3] == '=') rest_size--;
+  if(rest_size == 3 && symbols[m_index + 2] == '=') rest_size--;
 
-  // 2. Decode the message
-  for(m_index = 0; m_index + 4 <= msize; m_index += 4)
+  if(m_index < main_size || rest_size == 1)
   {
-    int bytes = b64_symbols_decode(tmp, message, m_index);
+    free(*result);
+
+    return 3;
+  }
+
+  if(rest_size > 0)
+  {
+    uint8_t rest[4] = { 'A', 'A', 'A', 'A' };
+
+    memcpy(rest, symbols + m_index, rest_size);
+
+    uint8_t buffer[3];
 
-    // Handle error better in the future:
-    if(bytes == -1) break;
+    if(!b64_group_decode(buffer, rest))
+    {
+      free(*result);
 
-    b64_map_decode(buffer, tmp);
+      return 3;
+    }
 
-    memcpy(*result + r_index, buffer, bytes - 1);
+    memcpy(bytes + r_index, buffer, rest_size - 1);
 
-    r_index += bytes - 1;
+    r_index += rest_size - 1;
   }
 
   if(rsize) *rsize = r_index;
@@ -0,0 +1,310 @@
+/*
+ * blake2b.h - implementation of the BLAKE2b algorithm
+ *
+ * Written by Hampus Fridholm
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc7693
+ *
+ * Last updated: 2026-10-19
+ *
+ *
+ * In main compilation unit; define BLAKE2B_IMPLEMENT
+ *
+ *
+ * These are the available funtions:
+ *
+ * char* blake2b(char hash[128], const void* message, size_t size)
+ *
+ *
+ * void  blake2b_init(blake2b_ctx_t* ctx, size_t digest_size)
+ *
+ * void  blake2b_update(blake2b_ctx_t* ctx, const void* message, size_t size)
+ *
+ * void  blake2b_final(uint8_t* digest, blake2b_ctx_t* ctx)
+ */
+
+/*
+ * From here on, until BLAKE2B_IMPLEMENT,
+ * it is like a normal header file with declarations
+ */
+
+#ifndef BLAKE2B_H
+#define BLAKE2B_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BLAKE2B_BLOCK_SIZE  128
+#define BLAKE2B_DIGEST_SIZE 64
+
+/*
+ * Streaming context, used to hash a message piece by piece
+ */
+typedef struct
+{
+  uint64_t hs[8];                        // The "h"-values
+  uint64_t size;                         // The amount of hashed bytes
+  uint8_t  block[BLAKE2B_BLOCK_SIZE];    // The bytes not yet hashed
+  size_t   block_size;                   // The amount of bytes in block
+  size_t   digest_size;                  // The size of the digest, 1 to 64
+} blake2b_ctx_t;
+
+extern char* blake2b(char hash[128], const void* message, size_t size);
+
+
+extern void  blake2b_init(blake2b_ctx_t* ctx, size_t digest_size);
+
+extern void  blake2b_update(blake2b_ctx_t* ctx, const void* message, size_t size);
+
+extern void  blake2b_final(uint8_t* digest, blake2b_ctx_t* ctx);
+
+#endif // BLAKE2B_H
+
+/*
+ * This header library file uses _IMPLEMENT guards
+ *
+ * If BLAKE2B_IMPLEMENT is defined, the definitions will be included
+ */
+
+#ifdef BLAKE2B_IMPLEMENT
+
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+
+// Same as the initial "h"-values of SHA512
+static const uint64_t BLAKE2B_IV[8] = {
+  0x6a09e667f3bcc908, 0xbb67ae8584caa73b,
+  0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+  0x510e527fade682d1, 0x9b05688c2b3e6c1f,
+  0x1f83d9abfb41bd6b, 0x5be0cd19137e2179
+};
+
+static const uint8_t BLAKE2B_SIGMA[12][16] = {
+  {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+  { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+  { 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
+  {  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
+  {  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
+  {  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
+  { 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
+  { 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
+  {  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
+  { 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 },
+  {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+  { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 }
+};
+
+#define BLAKE2B_RROTATE(a, b) (((a) >> (b)) | ((a) << (64 - (b))))
+
+/*
+ * The G function, mixing two message words into four state words
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc7693#section-3.1
+ */
+#define BLAKE2B_G(V, A, B, C, D, X, Y) \
+  do { \
+    V[A] = V[A] + V[B] + (X); V[D] = BLAKE2B_RROTATE(V[D] ^ V[A], 32); \
+    V[C] = V[C] + V[D];       V[B] = BLAKE2B_RROTATE(V[B] ^ V[C], 24); \
+    V[A] = V[A] + V[B] + (Y); V[D] = BLAKE2B_RROTATE(V[D] ^ V[A], 16); \
+    V[C] = V[C] + V[D];       V[B] = BLAKE2B_RROTATE(V[B] ^ V[C], 63); \
+  } while(0)
+
+/*
+ * Read a 64-bit little-endian word
+ */
+static inline uint64_t blake2b_word_read(const uint8_t* bytes)
+{
+  uint64_t word = 0;
+
+  for(uint8_t index = 8; index-- > 0;)
+  {
+    word = (word << 8) | bytes[index];
+  }
+
+  return word;
+}
+
+/*
+ * Compress one block into the "h"-values
+ *
+ * PARAMS
+ * - uint64_t hs[8]           | The "will be updated" h-values
+ * - const uint8_t block[128] | The block, padded with zeros
+ * - uint64_t size            | The amount of hashed bytes, including the block
+ * - bool last                | If the block is the last block
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc7693#section-3.2
+ */
+static inline void blake2b_compress(uint64_t hs[8], const uint8_t block[128], uint64_t size, bool last)
+{
+  uint64_t m[16];
+
+  for(uint8_t index = 0; index < 16; index++)
+  {
+    m[index] = blake2b_word_read(block + (index * 8));
+  }
+
+  uint64_t v[16];
+
+  memcpy(v,     hs,         sizeof(uint64_t) * 8);
+  memcpy(v + 8, BLAKE2B_IV, sizeof(uint64_t) * 8);
+
+  // The size is at most 2^64 bytes, so the high word is always 0
+  v[12] ^= size;
+
+  if(last) v[14] = ~v[14];
+
+  for(uint8_t round = 0; round < 12; round++)
+  {
+    const uint8_t* s = BLAKE2B_SIGMA[round];
+
+    BLAKE2B_G(v, 0, 4,  8, 12, m[s[ 0]], m[s[ 1]]);
+    BLAKE2B_G(v, 1, 5,  9, 13, m[s[ 2]], m[s[ 3]]);
+    BLAKE2B_G(v, 2, 6, 10, 14, m[s[ 4]], m[s[ 5]]);
+    BLAKE2B_G(v, 3, 7, 11, 15, m[s[ 6]], m[s[ 7]]);
+    BLAKE2B_G(v, 0, 5, 10, 15, m[s[ 8]], m[s[ 9]]);
+    BLAKE2B_G(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+    BLAKE2B_G(v, 2, 7,  8, 13, m[s[12]], m[s[13]]);
+    BLAKE2B_G(v, 3, 4,  9, 14, m[s[14]], m[s[15]]);
+  }
+
+  for(uint8_t index = 0; index < 8; index++)
+  {
+    hs[index] ^= v[index] ^ v[index + 8];
+  }
+}
+
+/*
+ * Initialize the context, for a digest of digest_size bytes (1 to 64)
+ */
+void blake2b_init(blake2b_ctx_t* ctx, size_t digest_size)
+{
+  if(!ctx) return;
+
+  if(digest_size < 1 || digest_size > BLAKE2B_DIGEST_SIZE)
+  {
+    digest_size = BLAKE2B_DIGEST_SIZE;
+  }
+
+  memcpy(ctx->hs, BLAKE2B_IV, sizeof(BLAKE2B_IV));
+
+  // The parameter block: digest size, no key, fanout and depth 1
+  ctx->hs[0] ^= 0x01010000 ^ (uint64_t) digest_size;
+
+  ctx->size        = 0;
+  ctx->block_size  = 0;
+  ctx->digest_size = digest_size;
+}
+
+/*
+ * Add more of the message to the hash
+ *
+ * The last block is kept until blake2b_final,
+ * because it is compressed differently
+ */
+void blake2b_update(blake2b_ctx_t* ctx, const void* message, size_t size)
+{
+  if(!ctx || (!message && size > 0)) return;
+
+  const uint8_t* bytes = message;
+
+  while(size > 0)
+  {
+    if(ctx->block_size == BLAKE2B_BLOCK_SIZE)
+    {
+      ctx->size += BLAKE2B_BLOCK_SIZE;
+
+      blake2b_compress(ctx->hs, ctx->block, ctx->size, false);
+
+      ctx->block_size = 0;
+    }
+
+    // Whole blocks are compressed directly from the message
+    if(ctx->block_size == 0 && size > BLAKE2B_BLOCK_SIZE)
+    {
+      ctx->size += BLAKE2B_BLOCK_SIZE;
+
+      blake2b_compress(ctx->hs, bytes, ctx->size, false);
+
+      bytes += BLAKE2B_BLOCK_SIZE;
+      size  -= BLAKE2B_BLOCK_SIZE;
+
+      continue;
+    }
+
+    size_t fill = BLAKE2B_BLOCK_SIZE - ctx->block_size;
+
+    if(fill > size) fill = size;
+
+    memcpy(ctx->block + ctx->block_size, bytes, fill);
+
+    ctx->block_size += fill;
+    bytes           += fill;
+    size            -= fill;
+  }
+}
+
+/*
+ * Compress the last block and write the digest
+ *
+ * PARAMS
+ * - uint8_t* digest    | The digest, of the size given to blake2b_init
+ * - blake2b_ctx_t* ctx | The context, which can't be used afterwards
+ */
+void blake2b_final(uint8_t* digest, blake2b_ctx_t* ctx)
+{
+  if(!digest || !ctx) return;
+
+  ctx->size += ctx->block_size;
+
+  memset(ctx->block + ctx->block_size, 0, BLAKE2B_BLOCK_SIZE - ctx->block_size);
+
+  blake2b_compress(ctx->hs, ctx->block, ctx->size, true);
+
+  for(size_t index = 0; index < ctx->digest_size; index++)
+  {
+    digest[index] = (uint8_t) (ctx->hs[index / 8] >> (8 * (index % 8)));
+  }
+}
+
+/*
+ * Create a BLAKE2b-512 hash of the inputted message
+ *
+ * The created hash is not null terminated
+ *
+ * PARAMS
+ * - char hash[128]      | A pointer to the "will be created"-hash
+ * - const void* message | The message to hash
+ * - size_t size         | The amount of bytes (8 bits)
+ *
+ * RETURN (char* hash)
+ * - NULL | Failed to hash the message
+ */
+char* blake2b(char hash[128], const void* message, size_t size)
+{
+  if(!hash || (!message && size > 0)) return NULL;
+
+  blake2b_ctx_t ctx;
+
+  blake2b_init(&ctx, BLAKE2B_DIGEST_SIZE);
+
+  blake2b_update(&ctx, message, size);
+
+  uint8_t digest[BLAKE2B_DIGEST_SIZE];
+
+  blake2b_final(digest, &ctx);
+
+  char temp_hash[128 + 1];
+
+  for(uint8_t index = 0; index < BLAKE2B_DIGEST_SIZE; index++)
+  {
+    sprintf(temp_hash + (index * 2), "%02x", digest[index]);
+  }
+
+  memcpy(hash, temp_hash, sizeof(char) * 128);
+
+  return hash;
+}
+
+#endif // BLAKE2B_IMPLEMENT
@@ -0,0 +1,864 @@
+/*
+ * blake3.h - implementation of the BLAKE3 algorithm
+ *
+ * Written by Hampus Fridholm
+ *
+ * Credit: https://github.com/BLAKE3-team/BLAKE3-specs
+ *
+ * Last updated: 2026-10-18
+ *
+ *
+ * In main compilation unit; define BLAKE3_IMPLEMENT
+ *
+ * The program has to be linked with -pthread
+ *
+ *
+ * These are the available funtions:
+ *
+ * char* blake3(char hash[64], const void* message, size_t size)
+ *
+ * int   blake3_digest(uint8_t digest[32], const void* message, size_t size, size_t threads)
+ */
+
+/*
+ * From here on, until BLAKE3_IMPLEMENT,
+ * it is like a normal header file with declarations
+ */
+
+#ifndef BLAKE3_H
+#define BLAKE3_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+extern char* blake3(char hash[64], const void* message, size_t size);
+
+extern int   blake3_digest(uint8_t digest[32], const void* message, size_t size, size_t threads);
+
+#endif // BLAKE3_H
+
+/*
+ * This header library file uses _IMPLEMENT guards
+ *
+ * If BLAKE3_IMPLEMENT is defined, the definitions will be included
+ */
+
+#ifdef BLAKE3_IMPLEMENT
+
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define B3_SIMD
+#include <immintrin.h>
+#endif
+
+#define B3_BLOCK_SIZE 64
+#define B3_CHUNK_SIZE 1024
+
+#define B3_CHUNK_START (1 << 0)
+#define B3_CHUNK_END   (1 << 1)
+#define B3_PARENT      (1 << 2)
+#define B3_ROOT        (1 << 3)
+
+/*
+ * The least amount of inputs every thread has to compress,
+ * otherwise the work is not worth the cost of a thread
+ */
+#define B3_THREAD_INPUTS 256
+
+// Same as the initial "h"-values of SHA256
+static const uint32_t B3_IV[8] = {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+  0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+// The message words used in every round, permuted between rounds
+static const uint8_t B3_SCHEDULE[7][16] = {
+  {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+  {  2,  6,  3, 10,  7,  0,  4, 13,  1, 11, 12,  5,  9, 14, 15,  8 },
+  {  3,  4, 10, 12, 13,  2,  7, 14,  6,  5,  9,  0, 11, 15,  8,  1 },
+  { 10,  7, 12,  9, 14,  3, 13, 15,  4,  0, 11,  2,  5,  8,  1,  6 },
+  { 12, 13,  9, 11, 15, 10, 14,  8,  7,  2,  5,  3,  0,  1,  6,  4 },
+  {  9, 14, 11,  5,  8, 12, 15,  1, 13,  3,  0, 10,  2,  6,  4,  7 },
+  { 11, 15,  5,  0,  1,  9,  8,  6, 14, 10,  2, 12,  3,  4,  7, 13 }
+};
+
+/*
+ * Read a little-endian 32-bit word from bytes
+ */
+#define B3_WORD_READ(BYTES) \
+  (((uint32_t) (BYTES)[3] << 24) | ((uint32_t) (BYTES)[2] << 16) | \
+   ((uint32_t) (BYTES)[1] <<  8) |  (uint32_t) (BYTES)[0])
+
+/*
+ * Write a 32-bit word as little-endian bytes
+ */
+#define B3_WORD_WRITE(BYTES, WORD) \
+  do { \
+    (BYTES)[0] = (uint8_t)  (WORD);        \
+    (BYTES)[1] = (uint8_t) ((WORD) >>  8); \
+    (BYTES)[2] = (uint8_t) ((WORD) >> 16); \
+    (BYTES)[3] = (uint8_t) ((WORD) >> 24); \
+  } while(0)
+
+#define B3_RROTATE(a, b) (((a) >> (b)) | ((a) << (32 - (b))))
+
+/*
+ * The G function, mixing two message words into four state words
+ *
+ * The same macro is used for the scalar and the vector kernels,
+ * by supplying the ADD, XOR and ROTATE operations
+ */
+#define B3_G(V, A, B, C, D, X, Y, ADD, XOR, ROTATE) \
+  do { \
+    V[A] = ADD(ADD(V[A], V[B]), X); \
+    V[D] = ROTATE(XOR(V[D], V[A]), 16); \
+    V[C] = ADD(V[C], V[D]); \
+    V[B] = ROTATE(XOR(V[B], V[C]), 12); \
+    V[A] = ADD(ADD(V[A], V[B]), Y); \
+    V[D] = ROTATE(XOR(V[D], V[A]), 8); \
+    V[C] = ADD(V[C], V[D]); \
+    V[B] = ROTATE(XOR(V[B], V[C]), 7); \
+  } while(0)
+
+/*
+ * One round, first mixing the columns and then the diagonals
+ */
+#define B3_ROUND(V, M, S, ADD, XOR, ROTATE) \
+  do { \
+    B3_G(V, 0, 4,  8, 12, M[S[ 0]], M[S[ 1]], ADD, XOR, ROTATE); \
+    B3_G(V, 1, 5,  9, 13, M[S[ 2]], M[S[ 3]], ADD, XOR, ROTATE); \
+    B3_G(V, 2, 6, 10, 14, M[S[ 4]], M[S[ 5]], ADD, XOR, ROTATE); \
+    B3_G(V, 3, 7, 11, 15, M[S[ 6]], M[S[ 7]], ADD, XOR, ROTATE); \
+    B3_G(V, 0, 5, 10, 15, M[S[ 8]], M[S[ 9]], ADD, XOR, ROTATE); \
+    B3_G(V, 1, 6, 11, 12, M[S[10]], M[S[11]], ADD, XOR, ROTATE); \
+    B3_G(V, 2, 7,  8, 13, M[S[12]], M[S[13]], ADD, XOR, ROTATE); \
+    B3_G(V, 3, 4,  9, 14, M[S[14]], M[S[15]], ADD, XOR, ROTATE); \
+  } while(0)
+
+#define B3_ADD(a, b) ((a) + (b))
+#define B3_XOR(a, b) ((a) ^ (b))
+
+/*
+ * Compress one block into the chaining value
+ *
+ * PARAMS
+ * - uint32_t cv[8]          | The "will be updated" chaining value
+ * - const uint8_t block[64] | The block, padded with zeros
+ * - uint8_t size            | The amount of bytes in the block
+ * - uint64_t counter        | The chunk counter
+ * - uint8_t flags           | The domain separation flags
+ */
+static inline void b3_compress(uint32_t cv[8], const uint8_t block[64], uint8_t size, uint64_t counter, uint8_t flags)
+{
+  uint32_t m[16];
+
+  for(uint8_t index = 0; index < 16; index++)
+  {
+    m[index] = B3_WORD_READ(block + (index * 4));
+  }
+
+  uint32_t v[16] = {
+    cv[0], cv[1], cv[2], cv[3],
+    cv[4], cv[5], cv[6], cv[7],
+    B3_IV[0], B3_IV[1], B3_IV[2], B3_IV[3],
+    (uint32_t) counter, (uint32_t) (counter >> 32), size, flags
+  };
+
+  for(uint8_t round = 0; round < 7; round++)
+  {
+    B3_ROUND(v, m, B3_SCHEDULE[round], B3_ADD, B3_XOR, B3_RROTATE);
+  }
+
+  for(uint8_t index = 0; index < 8; index++)
+  {
+    cv[index] = v[index] ^ v[index + 8];
+  }
+}
+
+/*
+ * Compute the chaining value of a (possibly partial) chunk
+ *
+ * If the chunk is the only chunk, root should be B3_ROOT
+ *
+ * PARAMS
+ * - uint32_t cv[8]       | The "will be created" chaining value
+ * - const uint8_t* input | The bytes of the chunk
+ * - size_t size          | The amount of bytes, at most 1024
+ * - uint64_t counter     | The chunk counter
+ * - uint8_t root         | B3_ROOT or 0
+ */
+static inline void b3_chunk_cv(uint32_t cv[8], const uint8_t* input, size_t size, uint64_t counter, uint8_t root)
+{
+  memcpy(cv, B3_IV, sizeof(B3_IV));
+
+  uint8_t flags = B3_CHUNK_START;
+
+  // 1. Compress every block except the last one
+  for(; size > B3_BLOCK_SIZE; input += B3_BLOCK_SIZE, size -= B3_BLOCK_SIZE)
+  {
+    b3_compress(cv, input, B3_BLOCK_SIZE, counter, flags);
+
+    flags = 0;
+  }
+
+  // 2. Compress the last block, padded with zeros
+  uint8_t block[B3_BLOCK_SIZE] = { 0 };
+
+  memcpy(block, input, size);
+
+  b3_compress(cv, block, size, counter, flags | B3_CHUNK_END | root);
+}
+
+/*
+ * Write the chaining value as little-endian bytes
+ */
+static inline void b3_cv_write(uint8_t* out, const uint32_t cv[8])
+{
+  for(uint8_t index = 0; index < 8; index++)
+  {
+    B3_WORD_WRITE(out + (index * 4), cv[index]);
+  }
+}
+
+/*
+ * The arguments of compressing many inputs of the same length
+ *
+ * The inputs are stride bytes apart, and every input has blocks blocks.
+ * Whole chunks use 16 blocks, and parent nodes use 1 block (two cvs).
+ */
+typedef struct
+{
+  const uint8_t* input;
+  size_t         stride;
+  size_t         count;
+  size_t         blocks;
+  uint64_t       counter;
+  bool           increment;
+  uint8_t        flags;
+  uint8_t        flags_start;
+  uint8_t        flags_end;
+  uint8_t*       out;
+} b3_job_t;
+
+/*
+ * Compress the inputs of the job one by one
+ */
+static inline void b3_hash_many_portable(const b3_job_t* job)
+{
+  for(size_t index = 0; index < job->count; index++)
+  {
+    const uint8_t* input = job->input + (index * job->stride);
+
+    uint64_t counter = job->counter + (job->increment ? index : 0);
+
+    uint32_t cv[8];
+
+    memcpy(cv, B3_IV, sizeof(B3_IV));
+
+    for(size_t block = 0; block < job->blocks; block++)
+    {
+      uint8_t flags = job->flags;
+
+      if(block == 0)               flags |= job->flags_start;
+      if(block == job->blocks - 1) flags |= job->flags_end;
+
+      b3_compress(cv, input + (block * B3_BLOCK_SIZE), B3_BLOCK_SIZE, counter, flags);
+    }
+
+    b3_cv_write(job->out + (index * 32), cv);
+  }
+}
+
+#ifdef B3_SIMD
+
+/*
+ * The vector kernels compress 4, 8 or 16 inputs at the same time,
+ * with one input in every 32-bit lane of the vectors
+ */
+
+#define B3_SSE41_ADD(a, b) _mm_add_epi32(a, b)
+#define B3_SSE41_XOR(a, b) _mm_xor_si128(a, b)
+#define B3_SSE41_ROTATE(a, b) \
+  _mm_or_si128(_mm_srli_epi32(a, b), _mm_slli_epi32(a, 32 - (b)))
+
+/*
+ * Transpose the 4 x 4 words, so that every vector holds one word of every lane
+ */
+__attribute__((target("sse4.1")))
+static inline void b3_transpose_sse41(__m128i vecs[4])
+{
+  __m128i ab_01 = _mm_unpacklo_epi32(vecs[0], vecs[1]);
+  __m128i ab_23 = _mm_unpackhi_epi32(vecs[0], vecs[1]);
+  __m128i cd_01 = _mm_unpacklo_epi32(vecs[2], vecs[3]);
+  __m128i cd_23 = _mm_unpackhi_epi32(vecs[2], vecs[3]);
+
+  vecs[0] = _mm_unpacklo_epi64(ab_01, cd_01);
+  vecs[1] = _mm_unpackhi_epi64(ab_01, cd_01);
+  vecs[2] = _mm_unpacklo_epi64(ab_23, cd_23);
+  vecs[3] = _mm_unpackhi_epi64(ab_23, cd_23);
+}
+
+/*
+ * Compress 4 inputs of the job at the same time, using SSE4.1
+ */
+__attribute__((target("sse4.1")))
+static void b3_hash4_sse41(const b3_job_t* job)
+{
+  uint32_t counter_lo[4], counter_hi[4];
+
+  for(uint8_t lane = 0; lane < 4; lane++)
+  {
+    uint64_t counter = job->counter + (job->increment ? lane : 0);
+
+    counter_lo[lane] = (uint32_t) counter;
+    counter_hi[lane] = (uint32_t) (counter >> 32);
+  }
+
+  __m128i h[8];
+
+  for(uint8_t index = 0; index < 8; index++)
+  {
+    h[index] = _mm_set1_epi32(B3_IV[index]);
+  }
+
+  for(size_t block = 0; block < job->blocks; block++)
+  {
+    // 1. Load the message words of every lane
+    __m128i m[16];
+
+    for(uint8_t part = 0; part < 4; part++)
+    {
+      for(uint8_t lane = 0; lane < 4; lane++)
+      {
+        const uint8_t* input = job->input + (lane * job->stride) + (block * B3_BLOCK_SIZE);
+
+        m[(part * 4) + lane] = _mm_loadu_si128((const __m128i*) (input + (part * 16)));
+      }
+
+      b3_transpose_sse41(m + (part * 4));
+    }
+
+    // 2. Compress the block in every lane
+    uint8_t flags = job->flags;
+
+    if(block == 0)               flags |= job->flags_start;
+    if(block == job->blocks - 1) flags |= job->flags_end;
+
+    __m128i v[16] = {
+      h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+      _mm_set1_epi32(B3_IV[0]), _mm_set1_epi32(B3_IV[1]),
+      _mm_set1_epi32(B3_IV[2]), _mm_set1_epi32(B3_IV[3]),
+      _mm_loadu_si128((const __m128i*) counter_lo),
+      _mm_loadu_si128((const __m128i*) counter_hi),
+      _mm_set1_epi32(B3_BLOCK_SIZE), _mm_set1_epi32(flags)
+    };
+
+    for(uint8_t round = 0; round < 7; round++)
+    {
+      B3_ROUND(v, m, B3_SCHEDULE[round], B3_SSE41_ADD, B3_SSE41_XOR, B3_SSE41_ROTATE);
+    }
+
+    for(uint8_t index = 0; index < 8; index++)
+    {
+      h[index] = _mm_xor_si128(v[index], v[index + 8]);
+    }
+  }
+
+  // 3. Transpose the chaining values back, and store them
+  b3_transpose_sse41(h);
+  b3_transpose_sse41(h + 4);
+
+  for(uint8_t lane = 0; lane < 4; lane++)
+  {
+    _mm_storeu_si128((__m128i*) (job->out + (lane * 32)),      h[lane]);
+    _mm_storeu_si128((__m128i*) (job->out + (lane * 32) + 16), h[lane + 4]);
+  }
+}
+
+#define B3_AVX2_ADD(a, b) _mm256_add_epi32(a, b)
+#define B3_AVX2_XOR(a, b) _mm256_xor_si256(a, b)
+#define B3_AVX2_ROTATE(a, b) \
+  _mm256_or_si256(_mm256_srli_epi32(a, b), _mm256_slli_epi32(a, 32 - (b)))
+
+/*
+ * Compress 8 inputs of the job at the same time, using AVX2
+ *
+ * The message words are gathered from the inputs, stride bytes apart
+ */
+__attribute__((target("avx2")))
+static void b3_hash8_avx2(const b3_job_t* job)
+{
+  uint32_t counter_lo[8], counter_hi[8];
+
+  for(uint8_t lane = 0; lane < 8; lane++)
+  {
+    uint64_t counter = job->counter + (job->increment ? lane : 0);
+
+    counter_lo[lane] = (uint32_t) counter;
+    counter_hi[lane] = (uint32_t) (counter >> 32);
+  }
+
+  const int stride = (int) job->stride;
+
+  __m256i offsets = _mm256_setr_epi32(
+    0 * stride, 1 * stride, 2 * stride, 3 * stride,
+    4 * stride, 5 * stride, 6 * stride, 7 * stride);
+
+  __m256i h[8];
+
+  for(uint8_t index = 0; index < 8; index++)
+  {
+    h[index] = _mm256_set1_epi32(B3_IV[index]);
+  }
+
+  for(size_t block = 0; block < job->blocks; block++)
+  {
+    const uint8_t* input = job->input + (block * B3_BLOCK_SIZE);
+
+    __m256i m[16];
+
+    for(uint8_t index = 0; index < 16; index++)
+    {
+      m[index] = _mm256_i32gather_epi32((const int*) (input + (index * 4)), offsets, 1);
+    }
+
+    uint8_t flags = job->flags;
+
+    if(block == 0)               flags |= job->flags_start;
+    if(block == job->blocks - 1) flags |= job->flags_end;
+
+    __m256i v[16] = {
+      h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+      _mm256_set1_epi32(B3_IV[0]), _mm256_set1_epi32(B3_IV[1]),
+      _mm256_set1_epi32(B3_IV[2]), _mm256_set1_epi32(B3_IV[3]),
+      _mm256_loadu_si256((const __m256i*) counter_lo),
+      _mm256_loadu_si256((const __m256i*) counter_hi),
+      _mm256_set1_epi32(B3_BLOCK_SIZE), _mm256_set1_epi32(flags)
+    };
+
+    for(uint8_t round = 0; round < 7; round++)
+    {
+      B3_ROUND(v, m, B3_SCHEDULE[round], B3_AVX2_ADD, B3_AVX2_XOR, B3_AVX2_ROTATE);
+    }
+
+    for(uint8_t index = 0; index < 8; index++)
+    {
+      h[index] = _mm256_xor_si256(v[index], v[index + 8]);
+    }
+  }
+
+  uint32_t words[8][8];
+
+  for(uint8_t index = 0; index < 8; index++)
+  {
+    _mm256_storeu_si256((__m256i*) words[index], h[index]);
+  }
+
+  for(uint8_t lane = 0; lane < 8; lane++)
+  {
+    for(uint8_t index = 0; index < 8; index++)
+    {
+      B3_WORD_WRITE(job->out + (lane * 32) + (index * 4), words[index][lane]);
+    }
+  }
+}
+
+#define B3_AVX512_ADD(a, b) _mm512_add_epi32(a, b)
+#define B3_AVX512_XOR(a, b) _mm512_xor_si512(a, b)
+#define B3_AVX512_ROTATE(a, b) _mm512_ror_epi32(a, b)
+
+/*
+ * Compress 16 inputs of the job at the same time, using AVX-512
+ *
+ * The message words are gathered from the inputs, stride bytes apart
+ */
+__attribute__((target("avx512f")))
+static void b3_hash16_avx512(const b3_job_t* job)
+{
+  uint32_t counter_lo[16], counter_hi[16];
+
+  int32_t offsets_array[16];
+
+  for(uint8_t lane = 0; lane < 16; lane++)
+  {
+    uint64_t counter = job->counter + (job->increment ? lane : 0);
+
+    counter_lo[lane] = (uint32_t) counter;
+    counter_hi[lane] = (uint32_t) (counter >> 32);
+
+    offsets_array[lane] = (int32_t) (lane * job->stride);
+  }
+
+  __m512i offsets = _mm512_loadu_si512(offsets_array);
+
+  __m512i h[8];
+
+  for(uint8_t index = 0; index < 8; index++)
+  {
+    h[index] = _mm512_set1_epi32(B3_IV[index]);
+  }
+
+  for(size_t block = 0; block < job->blocks; block++)
+  {
+    const uint8_t* input = job->input + (block * B3_BLOCK_SIZE);
+
+    __m512i m[16];
+
+    for(uint8_t index = 0; index < 16; index++)
+    {
+      m[index] = _mm512_i32gather_epi32(offsets, (const void*) (input + (index * 4)), 1);
+    }
+
+    uint8_t flags = job->flags;
+
+    if(block == 0)               flags |= job->flags_start;
+    if(block == job->blocks - 1) flags |= job->flags_end;
+
+    __m512i v[16] = {
+      h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+      _mm512_set1_epi32(B3_IV[0]), _mm512_set1_epi32(B3_IV[1]),
+      _mm512_set1_epi32(B3_IV[2]), _mm512_set1_epi32(B3_IV[3]),
+      _mm512_loadu_si512(counter_lo),
+      _mm512_loadu_si512(counter_hi),
+      _mm512_set1_epi32(B3_BLOCK_SIZE), _mm512_set1_epi32(flags)
+    };
+
+    for(uint8_t round = 0; round < 7; round++)
+    {
+      B3_ROUND(v, m, B3_SCHEDULE[round], B3_AVX512_ADD, B3_AVX512_XOR, B3_AVX512_ROTATE);
+    }
+
+    for(uint8_t index = 0; index < 8; index++)
+    {
+      h[index] = _mm512_xor_si512(v[index], v[index + 8]);
+    }
+  }
+
+  uint32_t words[8][16];
+
+  for(uint8_t index = 0; index < 8; index++)
+  {
+    _mm512_storeu_si512(words[index], h[index]);
+  }
+
+  for(uint8_t lane = 0; lane < 16; lane++)
+  {
+    for(uint8_t index = 0; index < 8; index++)
+    {
+      B3_WORD_WRITE(job->out + (lane * 32) + (index * 4), words[index][lane]);
+    }
+  }
+}
+
+#endif // B3_SIMD
+
+/*
+ * Compress the inputs of the job, using the widest kernel the cpu supports
+ */
+static inline void b3_hash_many(const b3_job_t* job)
+{
+  b3_job_t part = *job;
+
+#ifdef B3_SIMD
+  // The kernels gather with 32-bit offsets
+  if(part.stride <= B3_CHUNK_SIZE)
+  {
+    if(__builtin_cpu_supports("avx512f"))
+    {
+      for(; part.count >= 16; part.count -= 16)
+      {
+        b3_hash16_avx512(&part);
+
+        part.input += 16 * part.stride;
+        part.out   += 16 * 32;
+
+        if(part.increment) part.counter += 16;
+      }
+    }
+
+    if(__builtin_cpu_supports("avx2"))
+    {
+      for(; part.count >= 8; part.count -= 8)
+      {
+        b3_hash8_avx2(&part);
+
+        part.input += 8 * part.stride;
+        part.out   += 8 * 32;
+
+        if(part.increment) part.counter += 8;
+      }
+    }
+
+    if(__builtin_cpu_supports("sse4.1"))
+    {
+      for(; part.count >= 4; part.count -= 4)
+      {
+        b3_hash4_sse41(&part);
+
+        part.input += 4 * part.stride;
+        part.out   += 4 * 32;
+
+        if(part.increment) part.counter += 4;
+      }
+    }
+  }
+#endif // B3_SIMD
+
+  b3_hash_many_portable(&part);
+}
+
+/*
+ * This is the thread function, compressing its part of the job
+ */
+static void* b3_hash_many_thread(void* arg)
+{
+  b3_hash_many((b3_job_t*) arg);
+
+  return NULL;
+}
+
+/*
+ * Split the job over a number of threads
+ *
+ * Every thread gets a part of the inputs, and the calling thread
+ * compresses the first part. If a thread can't be created,
+ * that part is compressed by the calling thread instead.
+ */
+static inline void b3_hash_many_threads(const b3_job_t* job, size_t threads)
+{
+  size_t max_threads = job->count / B3_THREAD_INPUTS;
+
+  if(threads > max_threads) threads = max_threads;
+
+  if(threads <= 1)
+  {
+    b3_hash_many(job);
+
+    return;
+  }
+
+  // Round every part up to a multiple of the widest kernel
+  size_t part_count = (((job->count + threads - 1) / threads) + 15) & ~((size_t) 15);
+
+  b3_job_t  parts[threads];
+  pthread_t thread_ids[threads];
+  bool      created[threads];
+
+  for(size_t index = 0; index < threads; index++)
+  {
+    size_t start = index * part_count;
+
+    parts[index] = *job;
+
+    parts[index].input   += start * job->stride;
+    parts[index].out     += start * 32;
+    parts[index].counter += job->increment ? start : 0;
+
+    if(start >= job->count)
+    {
+      parts[index].count = 0;
+    }
+    else if(job->count - start < part_count)
+    {
+      parts[index].count = job->count - start;
+    }
+    else parts[index].count = part_count;
+
+    created[index] = false;
+
+    if(index > 0 && parts[index].count > 0)
+    {
+      created[index] = (pthread_create(&thread_ids[index], NULL, b3_hash_many_thread, &parts[index]) == 0);
+    }
+  }
+
+  for(size_t index = 0; index < threads; index++)
+  {
+    if(index == 0 || !created[index])
+    {
+      b3_hash_many(&parts[index]);
+    }
+  }
+
+  for(size_t index = 1; index < threads; index++)
+  {
+    if(created[index]) pthread_join(thread_ids[index], NULL);
+  }
+}
+
+/*
+ * Create a BLAKE3 digest of the inputted message
+ *
+ * First the chaining values of all chunks are computed,
+ * then pairs of chaining values are merged into parent nodes
+ * until only the root is left. Every step compresses many
+ * inputs at once, spread over the threads and SIMD lanes.
+ *
+ * PARAMS
+ * - uint8_t digest[32]  | The "will be created"-digest
+ * - const void* message | The message to hash
+ * - size_t size         | The amount of bytes (8 bits)
+ * - size_t threads      | The amount of threads, 0 for all cores
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to allocate memory
+ */
+int blake3_digest(uint8_t digest[32], const void* message, size_t size, size_t threads)
+{
+  if(!digest || (!message && size > 0))
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  const uint8_t* input = message;
+
+  uint32_t cv[8];
+
+  // If the message is only one chunk, that chunk is the root
+  if(size <= B3_CHUNK_SIZE)
+  {
+    b3_chunk_cv(cv, input, size, 0, B3_ROOT);
+
+    b3_cv_write(digest, cv);
+
+    return 0;
+  }
+
+  if(threads == 0)
+  {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    threads = (cores > 0) ? cores : 1;
+  }
+
+  size_t chunks = (size + B3_CHUNK_SIZE - 1) / B3_CHUNK_SIZE;
+
+  uint8_t* cvs   = malloc(sizeof(uint8_t) * chunks * 32);
+  uint8_t* nodes = malloc(sizeof(uint8_t) * ((chunks + 1) / 2) * 32);
+
+  if(!cvs || !nodes)
+  {
+    free(cvs);
+    free(nodes);
+
+    errno = ENOMEM; // Out of memory
+
+    return 2;
+  }
+
+  // 1. Compute the chaining values of the whole chunks
+  size_t whole = size / B3_CHUNK_SIZE;
+
+  if(whole == chunks) whole--;
+
+  b3_job_t job = {
+    .input       = input,
+    .stride      = B3_CHUNK_SIZE,
+    .count       = whole,
+    .blocks      = B3_CHUNK_SIZE / B3_BLOCK_SIZE,
+    .counter     = 0,
+    .increment   = true,
+    .flags       = 0,
+    .flags_start = B3_CHUNK_START,
+    .flags_end   = B3_CHUNK_END,
+    .out         = cvs
+  };
+
+  b3_hash_many_threads(&job, threads);
+
+  // 2. Compute the chaining value of the last chunk, which may be partial
+  size_t offset = whole * B3_CHUNK_SIZE;
+
+  b3_chunk_cv(cv, input + offset, size - offset, whole, 0);
+
+  b3_cv_write(cvs + (whole * 32), cv);
+
+  // 3. Merge pairs of chaining values until only two are left
+  for(size_t count = chunks; count > 2; count = (count + 1) / 2)
+  {
+    job = (b3_job_t) {
+      .input       = cvs,
+      .stride      = 64,
+      .count       = count / 2,
+      .blocks      = 1,
+      .counter     = 0,
+      .increment   = false,
+      .flags       = B3_PARENT,
+      .flags_start = 0,
+      .flags_end   = 0,
+      .out         = nodes
+    };
+
+    b3_hash_many_threads(&job, threads);
+
+    // An odd chaining value is carried up to the next level
+    if(count & 1)
+    {
+      memcpy(nodes + ((count / 2) * 32), cvs + ((count - 1) * 32), 32);
+    }
+
+    uint8_t* temp = cvs;
+
+    cvs   = nodes;
+    nodes = temp;
+  }
+
+  // 4. The last two chaining values are merged into the root
+  memcpy(cv, B3_IV, sizeof(B3_IV));
+
+  b3_compress(cv, cvs, 64, 0, B3_PARENT | B3_ROOT);
+
+  b3_cv_write(digest, cv);
+
+  free(cvs);
+  free(nodes);
+
+  return 0;
+}
+
+/*
+ * Create a BLAKE3 hash of the inputted message
+ *
+ * The created hash is not null terminated
+ *
+ * PARAMS
+ * - char hash[64]       | A pointer to the "will be created"-hash
+ * - const void* message | The message to hash
+ * - size_t size         | The amount of bytes (8 bits)
+ *
+ * RETURN (char* hash)
+ * - NULL | Failed to hash the message
+ */
+char* blake3(char hash[64], const void* message, size_t size)
+{
+  uint8_t digest[32];
+
+  if(blake3_digest(digest, message, size, 0) != 0)
+  {
+    return NULL;
+  }
+
+  char temp_hash[64 + 1];
+
+  for(uint8_t index = 0; index < 32; index++)
+  {
+    sprintf(temp_hash + (index * 2), "%02x", digest[index]);
+  }
+
+  memcpy(hash, temp_hash, sizeof(char) * 64);
+
+  return hash;
+}
+
+#endif // BLAKE3_IMPLEMENT
@@ -0,0 +1,866 @@
+/*
+ * chacha20poly1305.h - implementation of the ChaCha20-Poly1305 AEAD
+ *
+ * Written by Hampus Fridholm
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc8439
+ *         https://github.com/floodyberry/poly1305-donna
+ *
+ * Last updated: 2026-10-19
+ *
+ *
+ * In main compilation unit; define CHACHA20POLY1305_IMPLEMENT
+ *
+ *
+ * ChaCha20 only adds, rotates and xors, so unlike the table lookups
+ * in aes.h, its time doesn't depend on the key or the message
+ *
+ * The keystream is made 16 blocks at a time with AVX-512,
+ * 8 blocks at a time with AVX2, and one block at a time otherwise
+ *
+ *
+ * These are the available funtions:
+ *
+ * void chacha20_xor(uint8_t* result, const void* message, size_t size, const uint8_t key[32], const uint8_t nonce[12], uint32_t counter)
+ *
+ * void poly1305(uint8_t tag[16], const void* message, size_t size, const uint8_t key[32])
+ *
+ *
+ * void chacha20poly1305_seal(uint8_t* result, uint8_t tag[16], const void* message, size_t msize, const void* aad, size_t asize, const uint8_t key[32], const uint8_t nonce[12])
+ *
+ * int  chacha20poly1305_open(uint8_t* result, const void* message, size_t msize, const uint8_t tag[16], const void* aad, size_t asize, const uint8_t key[32], const uint8_t nonce[12])
+ *
+ *
+ * int  chacha20poly1305_encrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const void* key)
+ *
+ * int  chacha20poly1305_decrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const void* key)
+ */
+
+/*
+ * From here on, until CHACHA20POLY1305_IMPLEMENT,
+ * it is like a normal header file with declarations
+ */
+
+#ifndef CHACHA20POLY1305_H
+#define CHACHA20POLY1305_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CHACHA20_KEY_SIZE   32
+#define CHACHA20_NONCE_SIZE 12
+
+#define POLY1305_TAG_SIZE   16
+
+/*
+ * The encrypted message is
+ *
+ * - 12 bytes | The random nonce
+ * - n bytes  | The encrypted message
+ * - 16 bytes | The Poly1305 tag
+ */
+#define CHACHA20POLY1305_SIZE(SIZE) (CHACHA20_NONCE_SIZE + (SIZE) + POLY1305_TAG_SIZE)
+
+extern void chacha20_xor(uint8_t* result, const void* message, size_t size, const uint8_t key[32], const uint8_t nonce[12], uint32_t counter);
+
+extern void poly1305(uint8_t tag[16], const void* message, size_t size, const uint8_t key[32]);
+
+
+extern void chacha20poly1305_seal(uint8_t* result, uint8_t tag[16], const void* message, size_t msize, const void* aad, size_t asize, const uint8_t key[32], const uint8_t nonce[12]);
+
+extern int  chacha20poly1305_open(uint8_t* result, const void* message, size_t msize, const uint8_t tag[16], const void* aad, size_t asize, const uint8_t key[32], const uint8_t nonce[12]);
+
+
+extern int  chacha20poly1305_encrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const void* key);
+
+extern int  chacha20poly1305_decrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const void* key);
+
+#endif // CHACHA20POLY1305_H
+
+/*
+ * This header library file uses _IMPLEMENT guards
+ *
+ * If CHACHA20POLY1305_IMPLEMENT is defined, the definitions will be included
+ */
+
+#ifdef CHACHA20POLY1305_IMPLEMENT
+
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sys/random.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CHACHA_SIMD
+#include <immintrin.h>
+#endif
+
+#define CHACHA_BLOCK_SIZE 64
+
+/*
+ * Read a 32-bit little-endian word
+ */
+#define CHACHA_WORD_READ(BYTES) \
+  (((uint32_t) (BYTES)[3] << 24) | ((uint32_t) (BYTES)[2] << 16) | \
+   ((uint32_t) (BYTES)[1] <<  8) |  (uint32_t) (BYTES)[0])
+
+/*
+ * Write a 32-bit word as little-endian bytes
+ */
+#define CHACHA_WORD_WRITE(BYTES, WORD) \
+  do { \
+    (BYTES)[0] = (uint8_t)  (WORD);        \
+    (BYTES)[1] = (uint8_t) ((WORD) >>  8); \
+    (BYTES)[2] = (uint8_t) ((WORD) >> 16); \
+    (BYTES)[3] = (uint8_t) ((WORD) >> 24); \
+  } while(0)
+
+#define CHACHA_LROTATE(a, b) (((a) << (b)) | ((a) >> (32 - (b))))
+
+/*
+ * The quarter round, mixing four state words
+ *
+ * The same macro is used for the scalar and the vector kernels,
+ * by supplying the ADD, XOR and ROTATE operations
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc8439#section-2.1
+ */
+#define CHACHA_QR(V, A, B, C, D, ADD, XOR, ROTATE) \
+  do { \
+    V[A] = ADD(V[A], V[B]); V[D] = ROTATE(XOR(V[D], V[A]), 16); \
+    V[C] = ADD(V[C], V[D]); V[B] = ROTATE(XOR(V[B], V[C]), 12); \
+    V[A] = ADD(V[A], V[B]); V[D] = ROTATE(XOR(V[D], V[A]),  8); \
+    V[C] = ADD(V[C], V[D]); V[B] = ROTATE(XOR(V[B], V[C]),  7); \
+  } while(0)
+
+/*
+ * Two rounds, first mixing the columns and then the diagonals
+ */
+#define CHACHA_DOUBLE_ROUND(V, ADD, XOR, ROTATE) \
+  do { \
+    CHACHA_QR(V, 0, 4,  8, 12, ADD, XOR, ROTATE); \
+    CHACHA_QR(V, 1, 5,  9, 13, ADD, XOR, ROTATE); \
+    CHACHA_QR(V, 2, 6, 10, 14, ADD, XOR, ROTATE); \
+    CHACHA_QR(V, 3, 7, 11, 15, ADD, XOR, ROTATE); \
+    CHACHA_QR(V, 0, 5, 10, 15, ADD, XOR, ROTATE); \
+    CHACHA_QR(V, 1, 6, 11, 12, ADD, XOR, ROTATE); \
+    CHACHA_QR(V, 2, 7,  8, 13, ADD, XOR, ROTATE); \
+    CHACHA_QR(V, 3, 4,  9, 14, ADD, XOR, ROTATE); \
+  } while(0)
+
+#define CHACHA_ADD(a, b) ((a) + (b))
+#define CHACHA_XOR(a, b) ((a) ^ (b))
+
+/*
+ * Set up the initial state: constants, key, counter and nonce
+ */
+static inline void chacha20_state_init(uint32_t state[16], const uint8_t key[32], const uint8_t nonce[12], uint32_t counter)
+{
+  // "expand 32-byte k"
+  state[0] = 0x61707865;
+  state[1] = 0x3320646e;
+  state[2] = 0x79622d32;
+  state[3] = 0x6b206574;
+
+  for(uint8_t index = 0; index < 8; index++)
+  {
+    state[4 + index] = CHACHA_WORD_READ(key + (index * 4));
+  }
+
+  state[12] = counter;
+
+  for(uint8_t index = 0; index < 3; index++)
+  {
+    state[13 + index] = CHACHA_WORD_READ(nonce + (index * 4));
+  }
+}
+
+/*
+ * Create one keystream block
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc8439#section-2.3
+ */
+static inline void chacha20_block(uint8_t block[64], const uint32_t state[16])
+{
+  uint32_t v[16];
+
+  memcpy(v, state, sizeof(v));
+
+  for(uint8_t round = 0; round < 10; round++)
+  {
+    CHACHA_DOUBLE_ROUND(v, CHACHA_ADD, CHACHA_XOR, CHACHA_LROTATE);
+  }
+
+  for(uint8_t index = 0; index < 16; index++)
+  {
+    CHACHA_WORD_WRITE(block + (index * 4), v[index] + state[index]);
+  }
+}
+
+#ifdef CHACHA_SIMD
+
+#define CHACHA_AVX2_ADD(a, b) _mm256_add_epi32(a, b)
+#define CHACHA_AVX2_XOR(a, b) _mm256_xor_si256(a, b)
+#define CHACHA_AVX2_ROTATE(a, b) \
+  _mm256_or_si256(_mm256_slli_epi32(a, b), _mm256_srli_epi32(a, 32 - (b)))
+
+/*
+ * Xor 8 blocks of the message with the keystream, using AVX2
+ *
+ * Every lane of the vectors is one block, and the blocks are
+ * transposed back to bytes in registers before being xored
+ *
+ * PARAMS
+ * - uint8_t* result        | The 512 bytes of result
+ * - const uint8_t* message | The 512 bytes of message
+ * - uint32_t state[16]     | The state, with the counter of the first block
+ */
+__attribute__((target("avx2")))
+static void chacha20_xor8_avx2(uint8_t* result, const uint8_t* message, const uint32_t state[16])
+{
+  __m256i s[16], v[16];
+
+  for(uint8_t index = 0; index < 16; index++)
+  {
+    s[index] = _mm256_set1_epi32(state[index]);
+  }
+
+  s[12] = _mm256_add_epi32(s[12], _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+
+  memcpy(v, s, sizeof(v));
+
+  for(uint8_t round = 0; round < 10; round++)
+  {
+    CHACHA_DOUBLE_ROUND(v, CHACHA_AVX2_ADD, CHACHA_AVX2_XOR, CHACHA_AVX2_ROTATE);
+  }
+
+  for(uint8_t index = 0; index < 16; index++)
+  {
+    v[index] = _mm256_add_epi32(v[index], s[index]);
+  }
+
+  // Transpose every group of 4 words, within the 128-bit lanes
+  __m256i u[16];
+
+  for(uint8_t group = 0; group < 16; group += 4)
+  {
+    __m256i t0 = _mm256_unpacklo_epi32(v[group + 0], v[group + 1]);
+    __m256i t1 = _mm256_unpackhi_epi32(v[group + 0], v[group + 1]);
+    __m256i t2 = _mm256_unpacklo_epi32(v[group + 2], v[group + 3]);
+    __m256i t3 = _mm256_unpackhi_epi32(v[group + 2], v[group + 3]);
+
+    u[group + 0] = _mm256_unpacklo_epi64(t0, t2);
+    u[group + 1] = _mm256_unpackhi_epi64(t0, t2);
+    u[group + 2] = _mm256_unpacklo_epi64(t1, t3);
+    u[group + 3] = _mm256_unpackhi_epi64(t1, t3);
+  }
+
+  // Block (4 * lane + index) is the 128-bit lane of the 4 groups
+  for(uint8_t index = 0; index < 4; index++)
+  {
+    __m256i lo[2] = {
+      _mm256_permute2x128_si256(u[index], u[index + 4], 0x20),
+      _mm256_permute2x128_si256(u[index], u[index + 4], 0x31)
+    };
+
+    __m256i hi[2] = {
+      _mm256_permute2x128_si256(u[index + 8], u[index + 12], 0x20),
+      _mm256_permute2x128_si256(u[index + 8], u[index + 12], 0x31)
+    };
+
+    for(uint8_t lane = 0; lane < 2; lane++)
+    {
+      size_t offset = (4 * lane + index) * CHACHA_BLOCK_SIZE;
+
+      __m256i m0 = _mm256_loadu_si256((const __m256i*) (message + offset));
+      __m256i m1 = _mm256_loadu_si256((const __m256i*) (message + offset + 32));
+
+      _mm256_storeu_si256((__m256i*) (result + offset),      _mm256_xor_si256(m0, lo[lane]));
+      _mm256_storeu_si256((__m256i*) (result + offset + 32), _mm256_xor_si256(m1, hi[lane]));
+    }
+  }
+}
+
+#define CHACHA_AVX512_ADD(a, b) _mm512_add_epi32(a, b)
+#define CHACHA_AVX512_XOR(a, b) _mm512_xor_si512(a, b)
+#define CHACHA_AVX512_ROTATE(a, b) _mm512_rol_epi32(a, b)
+
+/*
+ * Xor 16 blocks of the message with the keystream, using AVX-512
+ *
+ * PARAMS
+ * - uint8_t* result        | The 1024 bytes of result
+ * - const uint8_t* message | The 1024 bytes of message
+ * - uint32_t state[16]     | The state, with the counter of the first block
+ */
+__attribute__((target("avx512f")))
+static void chacha20_xor16_avx512(uint8_t* result, const uint8_t* message, const uint32_t state[16])
+{
+  __m512i s[16], v[16];
+
+  for(uint8_t index = 0; index < 16; index++)
+  {
+    s[index] = _mm512_set1_epi32(state[index]);
+  }
+
+  s[12] = _mm512_add_epi32(s[12], _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+
+  memcpy(v, s, sizeof(v));
+
+  for(uint8_t round = 0; round < 10; round++)
+  {
+    CHACHA_DOUBLE_ROUND(v, CHACHA_AVX512_ADD, CHACHA_AVX512_XOR, CHACHA_AVX512_ROTATE);
+  }
+
+  for(uint8_t index = 0; index < 16; index++)
+  {
+    v[index] = _mm512_add_epi32(v[index], s[index]);
+  }
+
+  // Transpose every group of 4 words, within the 128-bit lanes
+  __m512i u[16];
+
+  for(uint8_t group = 0; group < 16; group += 4)
+  {
+    __m512i t0 = _mm512_unpacklo_epi32(v[group + 0], v[group + 1]);
+    __m512i t1 = _mm512_unpackhi_epi32(v[group + 0], v[group + 1]);
+    __m512i t2 = _mm512_unpacklo_epi32(v[group + 2], v[group + 3]);
+    __m512i t3 = _mm512_unpackhi_epi32(v[group + 2], v[group + 3]);
+
+    u[group + 0] = _mm512_unpacklo_epi64(t0, t2);
+    u[group + 1] = _mm512_unpackhi_epi64(t0, t2);
+    u[group + 2] = _mm512_unpacklo_epi64(t1, t3);
+    u[group + 3] = _mm512_unpackhi_epi64(t1, t3);
+  }
+
+  // Then transpose the 4x4 128-bit lanes of the groups
+  for(uint8_t index = 0; index < 4; index++)
+  {
+    __m512i a = _mm512_shuffle_i32x4(u[index],     u[index + 4],  0x44);
+    __m512i b = _mm512_shuffle_i32x4(u[index],     u[index + 4],  0xEE);
+    __m512i c = _mm512_shuffle_i32x4(u[index + 8], u[index + 12], 0x44);
+    __m512i d = _mm512_shuffle_i32x4(u[index + 8], u[index + 12], 0xEE);
+
+    __m512i blocks[4] = {
+      _mm512_shuffle_i32x4(a, c, 0x88),
+      _mm512_shuffle_i32x4(a, c, 0xDD),
+      _mm512_shuffle_i32x4(b, d, 0x88),
+      _mm512_shuffle_i32x4(b, d, 0xDD)
+    };
+
+    for(uint8_t lane = 0; lane < 4; lane++)
+    {
+      size_t offset = (4 * lane + index) * CHACHA_BLOCK_SIZE;
+
+      __m512i m = _mm512_loadu_si512(message + offset);
+
+      _mm512_storeu_si512(result + offset, _mm512_xor_si512(m, blocks[lane]));
+    }
+  }
+}
+
+#endif // CHACHA_SIMD
+
+/*
+ * Xor the message with the ChaCha20 keystream, encrypting or decrypting it
+ *
+ * The whole blocks are done with the widest kernel the cpu supports
+ *
+ * PARAMS
+ * - uint8_t* result         | The result, can be the same as the message
+ * - const void* message     | The message
+ * - size_t size             | The size of the message
+ * - const uint8_t key[32]   | The key
+ * - const uint8_t nonce[12] | The nonce
+ * - uint32_t counter        | The counter of the first block
+ */
+void chacha20_xor(uint8_t* result, const void* message, size_t size, const uint8_t key[32], const uint8_t nonce[12], uint32_t counter)
+{
+  if(!result || !message || !key || !nonce) return;
+
+  const uint8_t* input = message;
+
+  uint32_t state[16];
+
+  chacha20_state_init(state, key, nonce, counter);
+
+#ifdef CHACHA_SIMD
+  if(__builtin_cpu_supports("avx512f"))
+  {
+    for(; size >= 16 * CHACHA_BLOCK_SIZE; size -= 16 * CHACHA_BLOCK_SIZE)
+    {
+      chacha20_xor16_avx512(result, input, state);
+
+      input  += 16 * CHACHA_BLOCK_SIZE;
+      result += 16 * CHACHA_BLOCK_SIZE;
+
+      state[12] += 16;
+    }
+  }
+
+  if(__builtin_cpu_supports("avx2"))
+  {
+    for(; size >= 8 * CHACHA_BLOCK_SIZE; size -= 8 * CHACHA_BLOCK_SIZE)
+    {
+      chacha20_xor8_avx2(result, input, state);
+
+      input  += 8 * CHACHA_BLOCK_SIZE;
+      result += 8 * CHACHA_BLOCK_SIZE;
+
+      state[12] += 8;
+    }
+  }
+#endif // CHACHA_SIMD
+
+  uint8_t block[CHACHA_BLOCK_SIZE];
+
+  while(size > 0)
+  {
+    chacha20_block(block, state);
+
+    size_t block_size = (size < CHACHA_BLOCK_SIZE) ? size : CHACHA_BLOCK_SIZE;
+
+    for(size_t index = 0; index < block_size; index++)
+    {
+      result[index] = input[index] ^ block[index];
+    }
+
+    input  += block_size;
+    result += block_size;
+    size   -= block_size;
+
+    state[12]++;
+  }
+
+  memset(block, '\0', sizeof(block));
+  memset(state, '\0', sizeof(state));
+}
+
+/*
+ * The Poly1305 state, with h and r in 44, 44 and 42 bit limbs
+ */
+typedef struct
+{
+  uint64_t r[3];
+  uint64_t h[3];
+  uint64_t pad[2];
+  uint8_t  buffer[16];
+  size_t   size;
+} poly1305_ctx_t;
+
+#define POLY1305_MASK44 0xfffffffffffULL
+#define POLY1305_MASK42 0x3ffffffffffULL
+
+/*
+ * Read a 64-bit little-endian word
+ */
+static inline uint64_t poly1305_word_read(const uint8_t bytes[8])
+{
+  return ((uint64_t) CHACHA_WORD_READ(bytes + 4) << 32) | CHACHA_WORD_READ(bytes);
+}
+
+/*
+ * Initialize the context with the one-time key, clamping r
+ */
+static inline void poly1305_init(poly1305_ctx_t* ctx, const uint8_t key[32])
+{
+  uint64_t t0 = poly1305_word_read(key);
+  uint64_t t1 = poly1305_word_read(key + 8);
+
+  ctx->r[0] = ( t0                     ) & 0xffc0fffffffULL;
+  ctx->r[1] = ((t0 >> 44) | (t1 << 20)) & 0xfffffc0ffffULL;
+  ctx->r[2] = ( t1 >> 24               ) & 0x00ffffffc0fULL;
+
+  ctx->h[0] = ctx->h[1] = ctx->h[2] = 0;
+
+  ctx->pad[0] = poly1305_word_read(key + 16);
+  ctx->pad[1] = poly1305_word_read(key + 24);
+
+  ctx->size = 0;
+}
+
+/*
+ * Add the 16-byte blocks to h, and multiply h by r mod 2^130 - 5
+ *
+ * The last partial block is padded by the caller, without the high bit
+ *
+ * Credit: https://github.com/floodyberry/poly1305-donna/blob/master/poly1305-donna-64.h
+ */
+static inline void poly1305_blocks(poly1305_ctx_t* ctx, const uint8_t* message, size_t size, uint64_t hibit)
+{
+  const uint64_t r0 = ctx->r[0];
+  const uint64_t r1 = ctx->r[1];
+  const uint64_t r2 = ctx->r[2];
+
+  // 2^130 = 5 mod p, and the limbs are shifted 2 bits
+  const uint64_t s1 = r1 * (5 << 2);
+  const uint64_t s2 = r2 * (5 << 2);
+
+  uint64_t h0 = ctx->h[0];
+  uint64_t h1 = ctx->h[1];
+  uint64_t h2 = ctx->h[2];
+
+  for(; size >= 16; size -= 16, message += 16)
+  {
+    uint64_t t0 = poly1305_word_read(message);
+    uint64_t t1 = poly1305_word_read(message + 8);
+
+    h0 += ( t0                     ) & POLY1305_MASK44;
+    h1 += ((t0 >> 44) | (t1 << 20)) & POLY1305_MASK44;
+    h2 += (((t1 >> 24)             ) & POLY1305_MASK42) | hibit;
+
+    unsigned __int128 d0 = (unsigned __int128) h0 * r0 + (unsigned __int128) h1 * s2 + (unsigned __int128) h2 * s1;
+    unsigned __int128 d1 = (unsigned __int128) h0 * r1 + (unsigned __int128) h1 * r0 + (unsigned __int128) h2 * s2;
+    unsigned __int128 d2 = (unsigned __int128) h0 * r2 + (unsigned __int128) h1 * r1 + (unsigned __int128) h2 * r0;
+
+    uint64_t c;
+
+    c = (uint64_t) (d0 >> 44); h0 = (uint64_t) d0 & POLY1305_MASK44;
+    d1 += c;
+    c = (uint64_t) (d1 >> 44); h1 = (uint64_t) d1 & POLY1305_MASK44;
+    d2 += c;
+    c = (uint64_t) (d2 >> 42); h2 = (uint64_t) d2 & POLY1305_MASK42;
+
+    h0 += c * 5;
+    c = (h0 >> 44); h0 &= POLY1305_MASK44;
+    h1 += c;
+  }
+
+  ctx->h[0] = h0;
+  ctx->h[1] = h1;
+  ctx->h[2] = h2;
+}
+
+/*
+ * Add more of the message to the tag
+ */
+static inline void poly1305_update(poly1305_ctx_t* ctx, const void* message, size_t size)
+{
+  const uint8_t* bytes = message;
+
+  // 1. Fill up the buffered block
+  if(ctx->size > 0)
+  {
+    size_t fill = 16 - ctx->size;
+
+    if(fill > size) fill = size;
+
+    memcpy(ctx->buffer + ctx->size, bytes, fill);
+
+    ctx->size += fill;
+    bytes     += fill;
+    size      -= fill;
+
+    if(ctx->size < 16) return;
+
+    poly1305_blocks(ctx, ctx->buffer, 16, 1ULL << 40);
+
+    ctx->size = 0;
+  }
+
+  // 2. Process the whole blocks directly from the message
+  size_t whole = size & ~((size_t) 15);
+
+  poly1305_blocks(ctx, bytes, whole, 1ULL << 40);
+
+  // 3. Buffer the rest
+  memcpy(ctx->buffer, bytes + whole, size - whole);
+
+  ctx->size = size - whole;
+}
+
+/*
+ * Create the tag, by reducing h fully and adding the pad
+ */
+static inline void poly1305_final(uint8_t tag[16], poly1305_ctx_t* ctx)
+{
+  // 1. The last partial block is padded with a 1 and zeros
+  if(ctx->size > 0)
+  {
+    ctx->buffer[ctx->size] = 1;
+
+    memset(ctx->buffer + ctx->size + 1, 0, 16 - ctx->size - 1);
+
+    poly1305_blocks(ctx, ctx->buffer, 16, 0);
+  }
+
+  uint64_t h0 = ctx->h[0];
+  uint64_t h1 = ctx->h[1];
+  uint64_t h2 = ctx->h[2];
+
+  uint64_t c;
+
+  // 2. Carry h fully
+               c = (h1 >> 44); h1 &= POLY1305_MASK44;
+  h2 += c;     c = (h2 >> 42); h2 &= POLY1305_MASK42;
+  h0 += c * 5; c = (h0 >> 44); h0 &= POLY1305_MASK44;
+  h1 += c;     c = (h1 >> 44); h1 &= POLY1305_MASK44;
+  h2 += c;     c = (h2 >> 42); h2 &= POLY1305_MASK42;
+  h0 += c * 5; c = (h0 >> 44); h0 &= POLY1305_MASK44;
+  h1 += c;
+
+  // 3. Compute g = h - p, and select it with a mask if it didn't underflow
+  uint64_t g0 = h0 + 5; c = (g0 >> 44); g0 &= POLY1305_MASK44;
+  uint64_t g1 = h1 + c; c = (g1 >> 44); g1 &= POLY1305_MASK44;
+  uint64_t g2 = h2 + c - (1ULL << 42);
+
+  uint64_t mask = (g2 >> 63) - 1;
+
+  h0 = (h0 & ~mask) | (g0 & mask);
+  h1 = (h1 & ~mask) | (g1 & mask);
+  h2 = (h2 & ~mask) | (g2 & mask);
+
+  // 4. Add the pad, mod 2^128
+  uint64_t t0 = ctx->pad[0];
+  uint64_t t1 = ctx->pad[1];
+
+  h0 += ( t0                     ) & POLY1305_MASK44;     c = (h0 >> 44); h0 &= POLY1305_MASK44;
+  h1 += (((t0 >> 44) | (t1 << 20)) & POLY1305_MASK44) + c; c = (h1 >> 44); h1 &= POLY1305_MASK44;
+  h2 += (((t1 >> 24)             ) & POLY1305_MASK42) + c;                h2 &= POLY1305_MASK42;
+
+  h0 = (h0      ) | (h1 << 44);
+  h1 = (h1 >> 20) | (h2 << 24);
+
+  for(uint8_t index = 0; index < 8; index++)
+  {
+    tag[index]     = (uint8_t) (h0 >> (8 * index));
+    tag[index + 8] = (uint8_t) (h1 >> (8 * index));
+  }
+
+  memset(ctx, '\0', sizeof(poly1305_ctx_t));
+}
+
+/*
+ * Create the Poly1305 tag of a message, with a one-time key
+ */
+void poly1305(uint8_t tag[16], const void* message, size_t size, const uint8_t key[32])
+{
+  if(!tag || !message || !key) return;
+
+  poly1305_ctx_t ctx;
+
+  poly1305_init(&ctx, key);
+
+  poly1305_update(&ctx, message, size);
+
+  poly1305_final(tag, &ctx);
+}
+
+/*
+ * Create the AEAD tag of the additional data and the encrypted message
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc8439#section-2.8
+ */
+static void chacha20poly1305_tag(uint8_t tag[16], const uint8_t* message, size_t msize, const void* aad, size_t asize, const uint8_t key[32], const uint8_t nonce[12])
+{
+  static const uint8_t zeros[16] = { 0 };
+
+  // 1. The one-time key is the first half of the block with counter 0
+  uint8_t otk[64] = { 0 };
+
+  chacha20_xor(otk, otk, sizeof(otk), key, nonce, 0);
+
+  poly1305_ctx_t ctx;
+
+  poly1305_init(&ctx, otk);
+
+  memset(otk, '\0', sizeof(otk));
+
+  // 2. The additional data and the message are padded to 16 bytes
+  if(asize > 0) poly1305_update(&ctx, aad, asize);
+
+  poly1305_update(&ctx, zeros, (16 - (asize % 16)) % 16);
+
+  if(msize > 0) poly1305_update(&ctx, message, msize);
+
+  poly1305_update(&ctx, zeros, (16 - (msize % 16)) % 16);
+
+  // 3. Lastly come the two sizes, as 64-bit little-endian words
+  uint8_t sizes[16];
+
+  for(uint8_t index = 0; index < 8; index++)
+  {
+    sizes[index]     = (uint8_t) ((uint64_t) asize >> (8 * index));
+    sizes[index + 8] = (uint8_t) ((uint64_t) msize >> (8 * index));
+  }
+
+  poly1305_update(&ctx, sizes, sizeof(sizes));
+
+  poly1305_final(tag, &ctx);
+}
+
+/*
+ * Encrypt the message, and create the tag of it and the additional data
+ *
+ * PARAMS
+ * - uint8_t* result         | The msize bytes of encrypted message
+ * - uint8_t tag[16]         | The tag
+ * - const void* message     | The message
+ * - size_t msize            | The size of the message
+ * - const void* aad         | The additional data, or NULL
+ * - size_t asize            | The size of the additional data
+ * - const uint8_t key[32]   | The key
+ * - const uint8_t nonce[12] | The nonce, which must never be reused with the key
+ */
+void chacha20poly1305_seal(uint8_t* result, uint8_t tag[16], const void* message, size_t msize, const void* aad, size_t asize, const uint8_t key[32], const uint8_t nonce[12])
+{
+  if(!result || !tag || !message || (!aad && asize > 0) || !key || !nonce) return;
+
+  chacha20_xor(result, message, msize, key, nonce, 1);
+
+  chacha20poly1305_tag(tag, result, msize, aad, asize, key, nonce);
+}
+
+/*
+ * Check the tag, and decrypt the message if it is valid
+ *
+ * The tag is compared in constant time,
+ * and nothing is decrypted if it doesn't match
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The tag doesn't match
+ */
+int chacha20poly1305_open(uint8_t* result, const void* message, size_t msize, const uint8_t tag[16], const void* aad, size_t asize, const uint8_t key[32], const uint8_t nonce[12])
+{
+  if(!result || !message || !tag || (!aad && asize > 0) || !key || !nonce)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  uint8_t expected[16];
+
+  chacha20poly1305_tag(expected, message, msize, aad, asize, key, nonce);
+
+  uint8_t diff = 0;
+
+  for(uint8_t index = 0; index < 16; index++)
+  {
+    diff |= expected[index] ^ tag[index];
+  }
+
+  if(diff != 0)
+  {
+    errno = EBADMSG; // Bad message
+
+    return 2;
+  }
+
+  chacha20_xor(result, message, msize, key, nonce, 1);
+
+  return 0;
+}
+
+/*
+ * Encrypt message using ChaCha20-Poly1305, with a random nonce
+ *
+ * The result is: nonce (12), encrypted message, tag (16)
+ *
+ * Note: The allocated result must be freed by the caller
+ *
+ * On failure, errno will be sat to indicate error
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to get random bytes
+ * - 3 | Failed to allocate memory
+ */
+int chacha20poly1305_encrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const void* key)
+{
+  if(!result || !message || !key)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  // 1. Generate the nonce
+  uint8_t nonce[CHACHA20_NONCE_SIZE];
+
+  if(getrandom(nonce, sizeof(nonce), 0) != sizeof(nonce)) return 2;
+
+  // 2. Allocate memory for the result
+  uint8_t* temp_result = malloc(sizeof(uint8_t) * CHACHA20POLY1305_SIZE(msize));
+
+  if(!temp_result)
+  {
+    errno = ENOMEM; // Out of memory
+
+    return 3;
+  }
+
+  // 3. Write the nonce, the encrypted message and the tag
+  memcpy(temp_result, nonce, CHACHA20_NONCE_SIZE);
+
+  chacha20poly1305_seal(temp_result + CHACHA20_NONCE_SIZE, temp_result + CHACHA20_NONCE_SIZE + msize, message, msize, NULL, 0, key, nonce);
+
+  *result = temp_result;
+
+  if(rsize) *rsize = CHACHA20POLY1305_SIZE(msize);
+
+  return 0;
+}
+
+/*
+ * Decrypt message encrypted with ChaCha20-Poly1305
+ *
+ * Note: The allocated result must be freed by the caller
+ *
+ * On failure, errno will be sat to indicate error
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The message is damaged, or the key is wrong
+ * - 3 | Failed to allocate memory
+ */
+int chacha20poly1305_decrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const void* key)
+{
+  if(!result || !message || !key)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  if(msize < CHACHA20POLY1305_SIZE(0))
+  {
+    errno = EBADMSG; // Bad message
+
+    return 2;
+  }
+
+  const uint8_t* nonce = message;
+
+  size_t size = msize - CHACHA20POLY1305_SIZE(0);
+
+  // 1. Allocate memory for the result, at least one byte
+  uint8_t* temp_result = malloc(sizeof(uint8_t) * (size + 1));
+
+  if(!temp_result)
+  {
+    errno = ENOMEM; // Out of memory
+
+    return 3;
+  }
+
+  // 2. Check the tag and decrypt the message
+  if(chacha20poly1305_open(temp_result, nonce + CHACHA20_NONCE_SIZE, size, nonce + CHACHA20_NONCE_SIZE + size, NULL, 0, key, nonce) != 0)
+  {
+    free(temp_result);
+
+    return 2;
+  }
+
+  *result = temp_result;
+
+  if(rsize) *rsize = size;
+
+  return 0;
+}
+
+#endif // CHACHA20POLY1305_IMPLEMENT
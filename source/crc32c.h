@@ -0,0 +1,396 @@
+/*
+ * crc32c.h - implementation of the CRC32C checksum
+ *
+ * Written by Hampus Fridholm
+ *
+ * Credit: https://en.wikipedia.org/wiki/Cyclic_redundancy_check
+ *         https://datatracker.ietf.org/doc/html/rfc3720#appendix-B.4
+ *
+ * Last updated: 2026-10-19
+ *
+ *
+ * In main compilation unit; define CRC32C_IMPLEMENT
+ *
+ * The program has to be linked with -pthread
+ *
+ *
+ * These are the available funtions:
+ *
+ * uint32_t crc32c(uint32_t crc, const void* message, size_t size)
+ *
+ *
+ * int      crc32c_table_add(uint8_t** result, size_t* rsize, const void* message, size_t msize)
+ *
+ * int      crc32c_table_check(size_t* offset, size_t** damaged, size_t* count, const void* message, size_t msize)
+ */
+
+/*
+ * From here on, until CRC32C_IMPLEMENT,
+ * it is like a normal header file with declarations
+ */
+
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The message is split into chunks of this size,
+ * and every chunk gets its own checksum in the table
+ */
+#define CRC32C_CHUNK_SIZE (1 << 20)
+
+/*
+ * The table is: chunk size, chunk count, the checksums
+ * and lastly the checksum of the table itself
+ */
+#define CRC32C_TABLE_SIZE(COUNT) (4 + 4 + (4 * (COUNT)) + 4)
+
+extern uint32_t crc32c(uint32_t crc, const void* message, size_t size);
+
+
+extern int      crc32c_table_add(uint8_t** result, size_t* rsize, const void* message, size_t msize);
+
+extern int      crc32c_table_check(size_t* offset, size_t** damaged, size_t* count, const void* message, size_t msize);
+
+#endif // CRC32C_H
+
+/*
+ * This header library file uses _IMPLEMENT guards
+ *
+ * If CRC32C_IMPLEMENT is defined, the definitions will be included
+ */
+
+#ifdef CRC32C_IMPLEMENT
+
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <pthread.h>
+
+#if defined(__x86_64__)
+#define CRC_SSE42
+#include <immintrin.h>
+#endif
+
+// The reversed Castagnoli polynomial
+#define CRC_POLYNOMIAL 0x82f63b78
+
+/*
+ * The slicing-by-8 tables, table[0] is the normal byte table
+ */
+static uint32_t crc_tables[8][256];
+
+static pthread_once_t crc_tables_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Create the slicing-by-8 tables
+ *
+ * This function is only called once, by pthread_once
+ */
+static void crc_tables_create(void)
+{
+  for(uint32_t index = 0; index < 256; index++)
+  {
+    uint32_t crc = index;
+
+    for(uint8_t bit = 0; bit < 8; bit++)
+    {
+      crc = (crc & 1) ? (crc >> 1) ^ CRC_POLYNOMIAL : (crc >> 1);
+    }
+
+    crc_tables[0][index] = crc;
+  }
+
+  for(uint32_t index = 0; index < 256; index++)
+  {
+    for(uint8_t table = 1; table < 8; table++)
+    {
+      uint32_t crc = crc_tables[table - 1][index];
+
+      crc_tables[table][index] = (crc >> 8) ^ crc_tables[0][crc & 0xff];
+    }
+  }
+}
+
+/*
+ * Read a little-endian 32-bit word from bytes
+ */
+#define CRC_WORD_READ(BYTES) \
+  (((uint32_t) (BYTES)[3] << 24) | ((uint32_t) (BYTES)[2] << 16) | \
+   ((uint32_t) (BYTES)[1] <<  8) |  (uint32_t) (BYTES)[0])
+
+/*
+ * Write a 32-bit word as little-endian bytes
+ */
+#define CRC_WORD_WRITE(BYTES, WORD) \
+  do { \
+    (BYTES)[0] = (uint8_t)  (WORD);        \
+    (BYTES)[1] = (uint8_t) ((WORD) >>  8); \
+    (BYTES)[2] = (uint8_t) ((WORD) >> 16); \
+    (BYTES)[3] = (uint8_t) ((WORD) >> 24); \
+  } while(0)
+
+/*
+ * Update the (inverted) crc with the message, 8 bytes at a time
+ *
+ * Credit: https://create.stephan-brumme.com/crc32/#slicing-by-8-overview
+ */
+static inline uint32_t crc_slicing8_update(uint32_t crc, const uint8_t* bytes, size_t size)
+{
+  pthread_once(&crc_tables_once, crc_tables_create);
+
+  for(; size >= 8; bytes += 8, size -= 8)
+  {
+    uint32_t one = CRC_WORD_READ(bytes) ^ crc;
+    uint32_t two = CRC_WORD_READ(bytes + 4);
+
+    crc = crc_tables[7][ one        & 0xff] ^
+          crc_tables[6][(one >>  8) & 0xff] ^
+          crc_tables[5][(one >> 16) & 0xff] ^
+          crc_tables[4][ one >> 24        ] ^
+          crc_tables[3][ two        & 0xff] ^
+          crc_tables[2][(two >>  8) & 0xff] ^
+          crc_tables[1][(two >> 16) & 0xff] ^
+          crc_tables[0][ two >> 24        ];
+  }
+
+  for(; size > 0; bytes++, size--)
+  {
+    crc = (crc >> 8) ^ crc_tables[0][(crc ^ *bytes) & 0xff];
+  }
+
+  return crc;
+}
+
+#ifdef CRC_SSE42
+
+/*
+ * Update the (inverted) crc with the message, using the crc32 instruction
+ */
+__attribute__((target("sse4.2")))
+static uint32_t crc_sse42_update(uint32_t crc, const uint8_t* bytes, size_t size)
+{
+  uint64_t crc64 = crc;
+
+  for(; size >= 8; bytes += 8, size -= 8)
+  {
+    uint64_t word;
+
+    memcpy(&word, bytes, 8);
+
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+
+  crc = (uint32_t) crc64;
+
+  for(; size > 0; bytes++, size--)
+  {
+    crc = _mm_crc32_u8(crc, *bytes);
+  }
+
+  return crc;
+}
+
+#endif // CRC_SSE42
+
+/*
+ * Calculate the CRC32C checksum of the message
+ *
+ * The checksum of a long message can be calculated piece by piece,
+ * by passing the checksum of the last piece as crc (start with 0)
+ *
+ * PARAMS
+ * - uint32_t crc        | The checksum so far
+ * - const void* message | The message
+ * - size_t size         | The amount of bytes
+ *
+ * RETURN (uint32_t crc)
+ */
+uint32_t crc32c(uint32_t crc, const void* message, size_t size)
+{
+  crc = ~crc;
+
+#ifdef CRC_SSE42
+  if(__builtin_cpu_supports("sse4.2"))
+  {
+    return ~crc_sse42_update(crc, message, size);
+  }
+#endif // CRC_SSE42
+
+  return ~crc_slicing8_update(crc, message, size);
+}
+
+/*
+ * Add a table of chunk checksums in front of the message
+ *
+ * The allocated result must be freed by the caller
+ *
+ * PARAMS
+ * - uint8_t** result    | The table followed by the message
+ * - size_t* rsize       | The size of the result
+ * - const void* message | The message
+ * - size_t msize        | The size of the message
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to allocate memory
+ */
+int crc32c_table_add(uint8_t** result, size_t* rsize, const void* message, size_t msize)
+{
+  if(!result || !message)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  size_t count = (msize + CRC32C_CHUNK_SIZE - 1) / CRC32C_CHUNK_SIZE;
+
+  size_t table_size = CRC32C_TABLE_SIZE(count);
+
+  uint8_t* temp_result = malloc(sizeof(uint8_t) * (table_size + msize));
+
+  if(!temp_result)
+  {
+    errno = ENOMEM; // Out of memory
+
+    return 2;
+  }
+
+  // 1. Write the chunk size and the chunk count
+  CRC_WORD_WRITE(temp_result,     CRC32C_CHUNK_SIZE);
+  CRC_WORD_WRITE(temp_result + 4, (uint32_t) count);
+
+  // 2. Write the checksum of every chunk
+  for(size_t index = 0; index < count; index++)
+  {
+    size_t start = index * CRC32C_CHUNK_SIZE;
+
+    size_t size = (msize - start < CRC32C_CHUNK_SIZE) ? msize - start : CRC32C_CHUNK_SIZE;
+
+    uint32_t crc = crc32c(0, (uint8_t*) message + start, size);
+
+    CRC_WORD_WRITE(temp_result + 8 + (index * 4), crc);
+  }
+
+  // 3. Write the checksum of the table itself
+  uint32_t crc = crc32c(0, temp_result, table_size - 4);
+
+  CRC_WORD_WRITE(temp_result + table_size - 4, crc);
+
+  memcpy(temp_result + table_size, message, msize);
+
+  *result = temp_result;
+
+  if(rsize) *rsize = table_size + msize;
+
+  return 0;
+}
+
+/*
+ * Check the chunks of the message against the table in front of it
+ *
+ * If chunks are damaged, their indexes are allocated to damaged,
+ * which must be freed by the caller. Chunk index i covers the bytes
+ * offset + i * chunk size, and onwards, of the message.
+ *
+ * PARAMS
+ * - size_t* offset      | The offset of the message after the table
+ * - size_t** damaged    | The indexes of the damaged chunks
+ * - size_t* count       | The amount of damaged chunks
+ * - const void* message | The table followed by the message
+ * - size_t msize        | The size of the table and the message
+ *
+ * RETURN (int status)
+ * - 0 | Success, no chunk is damaged
+ * - 1 | Bad input
+ * - 2 | The table is damaged
+ * - 3 | Some chunks are damaged
+ * - 4 | Failed to allocate memory
+ */
+int crc32c_table_check(size_t* offset, size_t** damaged, size_t* count, const void* message, size_t msize)
+{
+  if(!offset || !damaged || !count || !message)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  const uint8_t* bytes = message;
+
+  // 1. Check that the table is intact
+  if(msize < CRC32C_TABLE_SIZE(0))
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  size_t chunk_size  = CRC_WORD_READ(bytes);
+  size_t chunk_count = CRC_WORD_READ(bytes + 4);
+
+  if(chunk_size == 0 || chunk_count > (msize - CRC32C_TABLE_SIZE(0)) / 4)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  size_t table_size = CRC32C_TABLE_SIZE(chunk_count);
+
+  if(crc32c(0, bytes, table_size - 4) != CRC_WORD_READ(bytes + table_size - 4))
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  size_t size = msize - table_size;
+
+  if((size + chunk_size - 1) / chunk_size != chunk_count)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  *offset = table_size;
+
+  // 2. Check the checksum of every chunk
+  *damaged = NULL;
+  *count   = 0;
+
+  for(size_t index = 0; index < chunk_count; index++)
+  {
+    size_t start = index * chunk_size;
+
+    size_t part = (size - start < chunk_size) ? size - start : chunk_size;
+
+    uint32_t crc = crc32c(0, bytes + table_size + start, part);
+
+    if(crc == CRC_WORD_READ(bytes + 8 + (index * 4))) continue;
+
+    size_t* new_damaged = realloc(*damaged, sizeof(size_t) * (*count + 1));
+
+    if(!new_damaged)
+    {
+      free(*damaged);
+
+      errno = ENOMEM; // Out of memory
+
+      return 4;
+    }
+
+    *damaged = new_damaged;
+
+    (*damaged)[(*count)++] = index;
+  }
+
+  return (*count > 0) ? 3 : 0;
+}
+
+#endif // CRC32C_IMPLEMENT
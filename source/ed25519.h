@@ -0,0 +1,1302 @@
+/*
+ * ed25519.h - implementation of the Ed25519 signatures
+ *
+ * Written by Hampus Fridholm
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc8032
+ *         https://ed25519.cr.yp.to
+ *
+ * Last updated: 2026-10-19
+ *
+ *
+ * In main compilation unit; define ED25519_IMPLEMENT
+ *
+ * The signatures use sha512.h, so define SHA512_IMPLEMENT as well
+ *
+ * The secret keys come from random.h, so define RANDOM_IMPLEMENT as well
+ *
+ * The program has to be linked with -pthread
+ *
+ *
+ * The points are in extended twisted Edwards coordinates, with the field
+ * arithmetic of fe25519.h. Everything that touches the secret key is
+ * constant-time: the base point is multiplied with a table of signed
+ * 4-bit windows, selected with masks, and the scalars are reduced
+ * with Barrett reduction
+ *
+ * The verification is cofactored, [8][S]B = [8]R + [8][k]A, so a
+ * signature that is valid in a batch is valid on its own as well
+ *
+ * The batch verification checks every signature with one multi-scalar
+ * multiplication, weighted by random 128-bit scalars z:
+ *
+ *   [8]([sum z S]B - sum [z]R - sum [z k]A) = 0
+ *
+ * If the batch fails, the signatures are verified one at a time,
+ * to find the invalid ones
+ *
+ *
+ * These are the available funtions:
+ *
+ * int  ed25519_keys_gen(uint8_t skey[32], uint8_t pkey[32])
+ *
+ * int  ed25519_pkey_get(uint8_t pkey[32], const uint8_t skey[32])
+ *
+ *
+ * int  ed25519_sign(uint8_t signature[64], const void* message, size_t size, const uint8_t skey[32])
+ *
+ * int  ed25519_verify(const uint8_t signature[64], const void* message, size_t size, const uint8_t pkey[32])
+ *
+ * int  ed25519_verify_batch(int results[], const uint8_t* signatures[], const void* messages[], const size_t sizes[], const uint8_t* pkeys[], size_t count)
+ *
+ *
+ * int  ed25519_key_encode(uint8_t result[ED25519_ENCODED_SIZE], const uint8_t key[32])
+ *
+ * int  ed25519_key_decode(uint8_t key[32], const void* message, size_t size)
+ */
+
+/*
+ * From here on, until ED25519_IMPLEMENT,
+ * it is like a normal header file with declarations
+ */
+
+#ifndef ED25519_H
+#define ED25519_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sha512.h"
+
+/*
+ * The size of the keys, and of the signatures
+ *
+ * The secret key is the 32 byte seed of RFC 8032
+ */
+#define ED25519_KEY_SIZE       32
+#define ED25519_SIGNATURE_SIZE 64
+
+/*
+ * The encoded keys are
+ *
+ * - 4 bytes  | ED25519_KEY_ID (big-endian)
+ * - 32 bytes | The key
+ */
+#define ED25519_KEY_ID 0x0ED25519
+
+#define ED25519_ENCODED_SIZE (4 + ED25519_KEY_SIZE)
+
+extern int  ed25519_keys_gen(uint8_t skey[32], uint8_t pkey[32]);
+
+extern int  ed25519_pkey_get(uint8_t pkey[32], const uint8_t skey[32]);
+
+
+extern int  ed25519_sign(uint8_t signature[64], const void* message, size_t size, const uint8_t skey[32]);
+
+extern int  ed25519_verify(const uint8_t signature[64], const void* message, size_t size, const uint8_t pkey[32]);
+
+extern int  ed25519_verify_batch(int results[], const uint8_t* signatures[], const void* messages[], const size_t sizes[], const uint8_t* pkeys[], size_t count);
+
+
+extern int  ed25519_key_encode(uint8_t result[ED25519_ENCODED_SIZE], const uint8_t key[32]);
+
+extern int  ed25519_key_decode(uint8_t key[32], const void* message, size_t size);
+
+#endif // ED25519_H
+
+/*
+ * This header library file uses _IMPLEMENT guards
+ *
+ * If ED25519_IMPLEMENT is defined, the definitions will be included
+ */
+
+#ifdef ED25519_IMPLEMENT
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "random.h"
+
+#include "fe25519.h"
+
+/*
+ * A point in extended coordinates, x = X/Z, y = Y/Z, x y = T/Z
+ */
+typedef struct
+{
+  fe_t X, Y, Z, T;
+} ge_t;
+
+/*
+ * A point prepared to be added to another point
+ */
+typedef struct
+{
+  fe_t YplusX, YminusX, Z, T2d;
+} ge_cached_t;
+
+// d = -121665 / 121666
+static const fe_t ED25519_D = {
+  0x34dca135978a3, 0x1a8283b156ebd, 0x5e7a26001c029, 0x739c663a03cbb, 0x52036cee2b6ff
+};
+
+// 2 * d
+static const fe_t ED25519_D2 = {
+  0x69b9426b2f159, 0x35050762add7a, 0x3cf44c0038052, 0x6738cc7407977, 0x2406d9dc56dff
+};
+
+// sqrt(-1) = 2^((p - 1) / 4)
+static const fe_t ED25519_SQRTM1 = {
+  0x61b274a0ea0b0, 0x0d5a5fc8f189d, 0x7ef5e9cbd0c60, 0x78595a6804c9e, 0x2b8324804fc1d
+};
+
+// The base point B, with y = 4/5 and a positive x
+static const ge_t ED25519_BASE = {
+  .X = { 0x62d608f25d51a, 0x412a4b4f6592a, 0x75b7171a4b31d, 0x1ff60527118fe, 0x216936d3cd6e5 },
+  .Y = { 0x6666666666658, 0x4cccccccccccc, 0x1999999999999, 0x3333333333333, 0x6666666666666 },
+  .Z = { 1 },
+  .T = { 0x68ab3a5b7dda3, 0x00eea2a5eadbb, 0x2af8df483c27e, 0x332b375274732, 0x67875f0fd78b7 }
+};
+
+// The order of the base point, L = 2^252 + 27742317777372353535851937790883648493
+static const uint64_t ED25519_L[4] = {
+  0x5812631a5cf5d3ed, 0x14def9dea2f79cd6, 0x0000000000000000, 0x1000000000000000
+};
+
+/*
+ * p = (0 : 1 : 1 : 0), the neutral point
+ */
+static inline void ge_identity(ge_t* p)
+{
+  memset(p, 0, sizeof(ge_t));
+
+  p->Y[0] = 1;
+  p->Z[0] = 1;
+}
+
+/*
+ * Prepare the point p to be added to other points
+ */
+static inline void ge_cached_get(ge_cached_t* c, const ge_t* p)
+{
+  fe_add(c->YplusX,  p->Y, p->X);
+  fe_sub(c->YminusX, p->Y, p->X);
+
+  memcpy(c->Z, p->Z, sizeof(fe_t));
+
+  fe_mul(c->T2d, p->T, ED25519_D2);
+}
+
+/*
+ * r = p + q, or r = p - q if negate is true
+ *
+ * The formulas are complete, so p and q can be the same point or the neutral point
+ *
+ * Credit: https://hyperelliptic.org/EFD/g1p/auto-twisted-extended-1.html#addition-add-2008-hwcd-3
+ */
+static inline void ge_add_cached(ge_t* r, const ge_t* p, const ge_cached_t* q, bool negate)
+{
+  fe_t a, b, c, d, e, f, g, h;
+
+  fe_sub(a, p->Y, p->X);
+  fe_add(b, p->Y, p->X);
+
+  // -q has YplusX and YminusX swapped, and T2d negated
+  fe_mul(a, a, negate ? q->YplusX  : q->YminusX);
+  fe_mul(b, b, negate ? q->YminusX : q->YplusX);
+
+  fe_mul(c, p->T, q->T2d);
+
+  fe_mul(d, p->Z, q->Z);
+  fe_add(d, d, d);
+
+  fe_sub(e, b, a);
+  fe_add(h, b, a);
+
+  if(negate)
+  {
+    fe_add(f, d, c);
+    fe_sub(g, d, c);
+  }
+  else
+  {
+    fe_sub(f, d, c);
+    fe_add(g, d, c);
+  }
+
+  fe_mul(r->X, e, f);
+  fe_mul(r->Y, g, h);
+  fe_mul(r->T, e, h);
+  fe_mul(r->Z, f, g);
+}
+
+/*
+ * r = p + q
+ */
+static inline void ge_add(ge_t* r, const ge_t* p, const ge_cached_t* q)
+{
+  ge_add_cached(r, p, q, false);
+}
+
+/*
+ * r = p - q
+ */
+static inline void ge_sub(ge_t* r, const ge_t* p, const ge_cached_t* q)
+{
+  ge_add_cached(r, p, q, true);
+}
+
+/*
+ * r = 2 p
+ *
+ * Credit: https://hyperelliptic.org/EFD/g1p/auto-twisted-extended-1.html#doubling-dbl-2008-hwcd
+ */
+static inline void ge_dbl(ge_t* r, const ge_t* p)
+{
+  fe_t a, b, c, e, f, g, h;
+
+  fe_sq(a, p->X);
+  fe_sq(b, p->Y);
+
+  fe_sq(c, p->Z);
+  fe_add(c, c, c);
+
+  fe_add(h, a, b);
+
+  fe_add(e, p->X, p->Y);
+  fe_sq(e, e);
+  fe_sub(e, h, e);
+
+  fe_sub(g, a, b);
+  fe_add(f, c, g);
+
+  fe_mul(r->X, e, f);
+  fe_mul(r->Y, g, h);
+  fe_mul(r->T, e, h);
+  fe_mul(r->Z, f, g);
+}
+
+/*
+ * r = -p
+ */
+static inline void ge_neg(ge_t* r, const ge_t* p)
+{
+  fe_neg(r->X, p->X);
+
+  memcpy(r->Y, p->Y, sizeof(fe_t));
+  memcpy(r->Z, p->Z, sizeof(fe_t));
+
+  fe_neg(r->T, p->T);
+}
+
+/*
+ * Check if [8]p is the neutral point, ignoring the small order part of p
+ */
+static inline bool ge_small_order(const ge_t* p)
+{
+  ge_t q;
+
+  ge_dbl(&q, p);
+  ge_dbl(&q, &q);
+  ge_dbl(&q, &q);
+
+  return fe_iszero(q.X) && fe_equal(q.Y, q.Z);
+}
+
+/*
+ * Write the point as y, with the sign of x in the top bit
+ */
+static inline void ge_write(uint8_t bytes[32], const ge_t* p)
+{
+  fe_t zinv, x, y;
+
+  fe_invert(zinv, p->Z);
+
+  fe_mul(x, p->X, zinv);
+  fe_mul(y, p->Y, zinv);
+
+  fe_write(bytes, y);
+
+  bytes[31] ^= fe_isnegative(x) << 7;
+}
+
+/*
+ * Read the point, recovering x from y and the sign bit
+ *
+ * x^2 = (y^2 - 1) / (d y^2 + 1) = u / v, and the candidate root
+ * is x = u v^3 (u v^7)^((p - 5) / 8), which is fixed by sqrt(-1)
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The bytes are not a point
+ */
+static inline int ge_read(ge_t* p, const uint8_t bytes[32])
+{
+  static const fe_t one = { 1 };
+
+  fe_read(p->Y, bytes);
+
+  // y has to be less than p
+  uint8_t check[32];
+
+  fe_write(check, p->Y);
+
+  if(memcmp(check, bytes, 31) != 0 || check[31] != (bytes[31] & 0x7F))
+  {
+    return 1;
+  }
+
+  fe_t u, v, v3, x, vxx, neg_u;
+
+  fe_sq(u, p->Y);
+  fe_mul(v, u, ED25519_D);
+  fe_sub(u, u, one);
+  fe_add(v, v, one);
+
+  fe_sq(v3, v);
+  fe_mul(v3, v3, v);
+
+  fe_sq(x, v3);
+  fe_mul(x, x, v);
+  fe_mul(x, x, u);
+
+  fe_pow22523(x, x);
+
+  fe_mul(x, x, v3);
+  fe_mul(x, x, u);
+
+  fe_sq(vxx, x);
+  fe_mul(vxx, vxx, v);
+
+  if(!fe_equal(vxx, u))
+  {
+    fe_neg(neg_u, u);
+
+    if(!fe_equal(vxx, neg_u)) return 1;
+
+    fe_mul(x, x, ED25519_SQRTM1);
+  }
+
+  bool sign = (bytes[31] >> 7);
+
+  if(sign && fe_iszero(x)) return 1;
+
+  if(fe_isnegative(x) != sign) fe_neg(x, x);
+
+  memcpy(p->X, x, sizeof(fe_t));
+  memcpy(p->Z, one, sizeof(fe_t));
+
+  fe_mul(p->T, p->X, p->Y);
+
+  return 0;
+}
+
+/*
+ * The multiples of the base point, table[i][j] = (j + 1) 16^i B
+ */
+static ge_cached_t ed25519_base_table[64][8];
+
+static pthread_once_t ed25519_base_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Create the table of the base point, once for the whole program
+ */
+static void ed25519_base_table_init(void)
+{
+  ge_t base = ED25519_BASE;
+
+  for(int window = 0; window < 64; window++)
+  {
+    ge_t point = base;
+
+    ge_cached_t cached;
+
+    ge_cached_get(&cached, &base);
+
+    for(int digit = 0; digit < 8; digit++)
+    {
+      ge_cached_get(&ed25519_base_table[window][digit], &point);
+
+      ge_add(&point, &point, &cached);
+    }
+
+    // The next window starts at 16 times this window's base
+    for(int index = 0; index < 4; index++)
+    {
+      ge_dbl(&base, &base);
+    }
+  }
+}
+
+/*
+ * Select digit times the window's base, where the digit is between -8 and 8
+ *
+ * Every entry is read, and the sign is applied with masks, so the digit doesn't leak
+ */
+static inline void ge_cached_select(ge_cached_t* c, const ge_cached_t table[8], int8_t digit)
+{
+  uint64_t negative = ((uint64_t) (int64_t) digit) >> 63;
+
+  uint64_t absolute = (uint64_t) (digit - ((-negative & (uint64_t) digit) << 1));
+
+  // The neutral point, (Y + X, Y - X, Z, 2dT) = (1, 1, 1, 0)
+  memset(c, 0, sizeof(ge_cached_t));
+
+  c->YplusX[0]  = 1;
+  c->YminusX[0] = 1;
+  c->Z[0]       = 1;
+
+  for(uint64_t index = 0; index < 8; index++)
+  {
+    uint64_t move = ((index + 1) ^ absolute) - 1;
+
+    move >>= 63;
+
+    fe_cmov(c->YplusX,  table[index].YplusX,  move);
+    fe_cmov(c->YminusX, table[index].YminusX, move);
+    fe_cmov(c->Z,       table[index].Z,       move);
+    fe_cmov(c->T2d,     table[index].T2d,     move);
+  }
+
+  // -c has YplusX and YminusX swapped, and T2d negated
+  fe_t minus_t2d;
+
+  fe_neg(minus_t2d, c->T2d);
+
+  fe_cswap(c->YplusX, c->YminusX, negative);
+
+  fe_cmov(c->T2d, minus_t2d, negative);
+}
+
+/*
+ * r = [scalar]B, in constant time
+ *
+ * The scalar is written with 64 signed 4-bit digits, between -8 and 8,
+ * so every window only needs the multiples 1 to 8 of its base
+ */
+static void ge_base_mul(ge_t* r, const uint8_t scalar[32])
+{
+  pthread_once(&ed25519_base_once, ed25519_base_table_init);
+
+  int8_t digits[64];
+
+  for(int index = 0; index < 32; index++)
+  {
+    digits[2 * index]     = scalar[index] & 0xF;
+    digits[2 * index + 1] = scalar[index] >> 4;
+  }
+
+  // Move 16 from every digit above 7 to the next digit
+  int8_t carry = 0;
+
+  for(int index = 0; index < 63; index++)
+  {
+    digits[index] += carry;
+
+    carry = (digits[index] + 8) >> 4;
+
+    digits[index] -= carry << 4;
+  }
+
+  digits[63] += carry;
+
+  ge_identity(r);
+
+  ge_cached_t cached;
+
+  for(int window = 0; window < 64; window++)
+  {
+    ge_cached_select(&cached, ed25519_base_table[window], digits[window]);
+
+    ge_add(r, r, &cached);
+  }
+
+  memset(digits, 0, sizeof(digits));
+}
+
+/*
+ * Calculate the width 5 NAF of the public scalar
+ *
+ * Every digit is zero or odd, between -15 and 15,
+ * and there are at least 4 zeros after every non-zero digit
+ *
+ * RETURN (size_t length)
+ */
+static size_t sc_wnaf(int8_t naf[256], const uint8_t scalar[32])
+{
+  uint64_t k[5] = { 0 };
+
+  for(int index = 0; index < 4; index++)
+  {
+    k[index] = fe_word_read(scalar + (index * 8));
+  }
+
+  memset(naf, 0, 256);
+
+  size_t length = 0;
+
+  for(size_t bit = 0; bit < 256 && (k[0] | k[1] | k[2] | k[3] | k[4]); bit++)
+  {
+    if(k[0] & 1)
+    {
+      int digit = (int) (k[0] & 31);
+
+      if(digit >= 16) digit -= 32;
+
+      naf[bit] = digit;
+
+      length = bit + 1;
+
+      // k -= digit, which makes the lowest 5 bits zero
+      if(digit > 0)
+      {
+        uint64_t borrow = (k[0] < (uint64_t) digit);
+
+        k[0] -= digit;
+
+        for(int index = 1; index < 5 && borrow; index++)
+        {
+          borrow = (k[index] == 0);
+
+          k[index]--;
+        }
+      }
+      else
+      {
+        uint64_t carry = ((k[0] += (uint64_t) -digit) < (uint64_t) -digit);
+
+        for(int index = 1; index < 5 && carry; index++)
+        {
+          carry = (++k[index] == 0);
+        }
+      }
+    }
+
+    for(int index = 0; index < 4; index++)
+    {
+      k[index] = (k[index] >> 1) | (k[index + 1] << 63);
+    }
+
+    k[4] >>= 1;
+  }
+
+  return length;
+}
+
+/*
+ * r = sum [scalars[i]]points[i], of public scalars and points
+ *
+ * Every point gets a table of its odd multiples P, 3P, .., 15P, and the
+ * points share the doublings (Straus' method). This is not constant-time
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to allocate memory
+ */
+static int ge_multi_mul(ge_t* r, const uint8_t (*scalars)[32], const ge_t* points, size_t count)
+{
+  ge_cached_t (*tables)[8] = malloc(sizeof(*tables) * count);
+
+  int8_t (*nafs)[256] = malloc(sizeof(*nafs) * count);
+
+  if(!tables || !nafs)
+  {
+    free(tables);
+    free(nafs);
+
+    return 1;
+  }
+
+  size_t length = 0;
+
+  // 1. Create the tables of odd multiples, and the NAFs of the scalars
+  for(size_t index = 0; index < count; index++)
+  {
+    size_t naf_length = sc_wnaf(nafs[index], scalars[index]);
+
+    if(naf_length > length) length = naf_length;
+
+    ge_t point = points[index], twice;
+
+    ge_dbl(&twice, &point);
+
+    ge_cached_t cached_twice;
+
+    ge_cached_get(&cached_twice, &twice);
+
+    ge_cached_get(&tables[index][0], &point);
+
+    for(int multiple = 1; multiple < 8; multiple++)
+    {
+      ge_add(&point, &point, &cached_twice);
+
+      ge_cached_get(&tables[index][multiple], &point);
+    }
+  }
+
+  // 2. Double once per bit, and add the multiples of the non-zero digits
+  ge_identity(r);
+
+  for(size_t bit = length; bit-- > 0;)
+  {
+    ge_dbl(r, r);
+
+    for(size_t index = 0; index < count; index++)
+    {
+      int digit = nafs[index][bit];
+
+      if(digit > 0)
+      {
+        ge_add(r, r, &tables[index][digit / 2]);
+      }
+      else if(digit < 0)
+      {
+        ge_sub(r, r, &tables[index][-digit / 2]);
+      }
+    }
+  }
+
+  free(tables);
+  free(nafs);
+
+  return 0;
+}
+
+// mu = floor(2^512 / L), for the Barrett reduction
+static const uint64_t ED25519_MU[5] = {
+  0xed9ce5a30a2c131b, 0x2106215d086329a7, 0xffffffffffffffeb, 0xffffffffffffffff, 0x000000000000000f
+};
+
+/*
+ * r = r - L if that doesn't borrow, without branching
+ */
+static inline void sc_sub_l(uint64_t r[5])
+{
+  uint64_t t[5], borrow = 0;
+
+  for(int index = 0; index < 5; index++)
+  {
+    uint64_t limb = (index < 4) ? ED25519_L[index] : 0;
+
+    uint64_t diff = r[index] - limb;
+
+    uint64_t below = (r[index] < limb);
+
+    t[index] = diff - borrow;
+
+    borrow = below | (diff < borrow);
+  }
+
+  uint64_t mask = borrow - 1;
+
+  for(int index = 0; index < 5; index++)
+  {
+    r[index] = (t[index] & mask) | (r[index] & ~mask);
+  }
+}
+
+/*
+ * Reduce the little-endian number of at most 64 bytes modulo L, in constant time
+ *
+ * Barrett: q = ((x >> 192) mu) >> 320 is at most 2 below x / L,
+ * so r = x - q L (mod 2^320) needs at most two subtractions of L
+ *
+ * Credit: Handbook of Applied Cryptography, algorithm 14.42
+ */
+static void sc_reduce(uint8_t result[32], const uint8_t* bytes, size_t size)
+{
+  uint8_t padded[64] = { 0 };
+
+  memcpy(padded, bytes, size);
+
+  uint64_t x[8];
+
+  for(int index = 0; index < 8; index++)
+  {
+    x[index] = fe_word_read(padded + (index * 8));
+  }
+
+  // 1. q = ((x >> 192) mu) >> 320
+  uint64_t product[10] = { 0 };
+
+  for(int i = 0; i < 5; i++)
+  {
+    unsigned __int128 carry = 0;
+
+    for(int j = 0; j < 5; j++)
+    {
+      carry += (unsigned __int128) x[3 + i] * ED25519_MU[j] + product[i + j];
+
+      product[i + j] = (uint64_t) carry;
+
+      carry >>= 64;
+    }
+
+    product[i + 5] = (uint64_t) carry;
+  }
+
+  const uint64_t* q = product + 5;
+
+  // 2. r = x - q L, modulo 2^320
+  uint64_t ql[5] = { 0 };
+
+  for(int i = 0; i < 5; i++)
+  {
+    unsigned __int128 carry = 0;
+
+    for(int j = 0; i + j < 5 && j < 4; j++)
+    {
+      carry += (unsigned __int128) q[i] * ED25519_L[j] + ql[i + j];
+
+      ql[i + j] = (uint64_t) carry;
+
+      carry >>= 64;
+    }
+
+    if(i + 4 < 5) ql[i + 4] += (uint64_t) carry;
+  }
+
+  uint64_t r[5], borrow = 0;
+
+  for(int index = 0; index < 5; index++)
+  {
+    uint64_t diff = x[index] - ql[index];
+
+    uint64_t below = (x[index] < ql[index]);
+
+    r[index] = diff - borrow;
+
+    borrow = below | (diff < borrow);
+  }
+
+  // 3. r is less than 3 L
+  sc_sub_l(r);
+  sc_sub_l(r);
+
+  for(int index = 0; index < 4; index++)
+  {
+    fe_word_write(result + (index * 8), r[index]);
+  }
+
+  memset(padded, 0, sizeof(padded));
+}
+
+/*
+ * result = (a b + c) mod L, in constant time
+ */
+static void sc_muladd(uint8_t result[32], const uint8_t a[32], const uint8_t b[32], const uint8_t c[32])
+{
+  uint64_t x[4], y[4], z[8] = { 0 };
+
+  for(int index = 0; index < 4; index++)
+  {
+    x[index] = fe_word_read(a + (index * 8));
+    y[index] = fe_word_read(b + (index * 8));
+    z[index] = fe_word_read(c + (index * 8));
+  }
+
+  for(int i = 0; i < 4; i++)
+  {
+    unsigned __int128 carry = 0;
+
+    for(int j = 0; j < 4; j++)
+    {
+      carry += (unsigned __int128) x[i] * y[j] + z[i + j];
+
+      z[i + j] = (uint64_t) carry;
+
+      carry >>= 64;
+    }
+
+    for(int index = i + 4; index < 8 && carry; index++)
+    {
+      carry += z[index];
+
+      z[index] = (uint64_t) carry;
+
+      carry >>= 64;
+    }
+  }
+
+  uint8_t bytes[64];
+
+  for(int index = 0; index < 8; index++)
+  {
+    fe_word_write(bytes + (index * 8), z[index]);
+  }
+
+  sc_reduce(result, bytes, sizeof(bytes));
+}
+
+/*
+ * Check if the scalar is less than L
+ */
+static inline bool sc_canonical(const uint8_t s[32])
+{
+  for(int index = 3; index >= 0; index--)
+  {
+    uint64_t word = fe_word_read(s + (index * 8));
+
+    if(word != ED25519_L[index]) return (word < ED25519_L[index]);
+  }
+
+  return false;
+}
+
+/*
+ * k = SHA-512(R || A || message) mod L
+ */
+static inline void ed25519_challenge(uint8_t k[32], const uint8_t R[32], const uint8_t A[32], const void* message, size_t size)
+{
+  sha512_ctx_t ctx;
+
+  sha512_init(&ctx);
+
+  sha512_update(&ctx, R, 32);
+  sha512_update(&ctx, A, 32);
+  sha512_update(&ctx, message, size);
+
+  uint8_t digest[64];
+
+  sha512_final(digest, &ctx);
+
+  sc_reduce(k, digest, sizeof(digest));
+}
+
+/*
+ * Expand the secret key to the clamped scalar a and the prefix
+ */
+static inline void ed25519_skey_expand(uint8_t a[32], uint8_t prefix[32], const uint8_t skey[32])
+{
+  sha512_ctx_t ctx;
+
+  sha512_init(&ctx);
+
+  sha512_update(&ctx, skey, 32);
+
+  uint8_t digest[64];
+
+  sha512_final(digest, &ctx);
+
+  digest[0]  &= 248;
+  digest[31] &= 127;
+  digest[31] |= 64;
+
+  memcpy(a, digest, 32);
+
+  if(prefix) memcpy(prefix, digest + 32, 32);
+
+  memset(digest, 0, sizeof(digest));
+}
+
+/*
+ * Get the public key of the secret key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ */
+int ed25519_pkey_get(uint8_t pkey[32], const uint8_t skey[32])
+{
+  if(!pkey || !skey)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  uint8_t a[32];
+
+  ed25519_skey_expand(a, NULL, skey);
+
+  ge_t A;
+
+  ge_base_mul(&A, a);
+
+  ge_write(pkey, &A);
+
+  memset(a, 0, sizeof(a));
+
+  return 0;
+}
+
+/*
+ * Generate a random secret key and its public key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to get random bytes
+ */
+int ed25519_keys_gen(uint8_t skey[32], uint8_t pkey[32])
+{
+  if(!skey || !pkey)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  if(random_bytes(skey, 32) != 0) return 2;
+
+  return ed25519_pkey_get(pkey, skey);
+}
+
+/*
+ * Sign the message
+ *
+ * PARAMS
+ * - uint8_t signature[64]  | The signature, R and S
+ * - const void* message    | The message to sign
+ * - size_t size            | The size of the message
+ * - const uint8_t skey[32] | The secret key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ */
+int ed25519_sign(uint8_t signature[64], const void* message, size_t size, const uint8_t skey[32])
+{
+  if(!signature || (!message && size > 0) || !skey)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  uint8_t a[32], prefix[32], pkey[32];
+
+  ed25519_skey_expand(a, prefix, skey);
+
+  ge_t point;
+
+  ge_base_mul(&point, a);
+
+  ge_write(pkey, &point);
+
+  // 1. r = SHA-512(prefix || message) mod L, and R = [r]B
+  sha512_ctx_t ctx;
+
+  sha512_init(&ctx);
+
+  sha512_update(&ctx, prefix, 32);
+  sha512_update(&ctx, message, size);
+
+  uint8_t digest[64], r[32];
+
+  sha512_final(digest, &ctx);
+
+  sc_reduce(r, digest, sizeof(digest));
+
+  ge_base_mul(&point, r);
+
+  ge_write(signature, &point);
+
+  // 2. S = (r + k a) mod L
+  uint8_t k[32];
+
+  ed25519_challenge(k, signature, pkey, message, size);
+
+  sc_muladd(signature + 32, k, a, r);
+
+  memset(a,      0, sizeof(a));
+  memset(prefix, 0, sizeof(prefix));
+  memset(digest, 0, sizeof(digest));
+  memset(r,      0, sizeof(r));
+
+  return 0;
+}
+
+/*
+ * Verify the signature of the message
+ *
+ * RETURN (int status)
+ * - 0 | The signature is valid
+ * - 1 | Bad input
+ * - 2 | The signature is invalid
+ */
+int ed25519_verify(const uint8_t signature[64], const void* message, size_t size, const uint8_t pkey[32])
+{
+  if(!signature || (!message && size > 0) || !pkey)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  ge_t points[2], R;
+
+  if(ge_read(&points[1], pkey) != 0 || ge_read(&R, signature) != 0)
+  {
+    return 2;
+  }
+
+  if(!sc_canonical(signature + 32)) return 2;
+
+  uint8_t scalars[2][32];
+
+  // [S]B - [k]A
+  points[0] = ED25519_BASE;
+
+  ge_neg(&points[1], &points[1]);
+
+  memcpy(scalars[0], signature + 32, 32);
+
+  ed25519_challenge(scalars[1], signature, pkey, message, size);
+
+  ge_t check;
+
+  if(ge_multi_mul(&check, scalars, points, 2) != 0) return 1;
+
+  // [8]([S]B - [k]A - R) = 0
+  ge_cached_t cached;
+
+  ge_cached_get(&cached, &R);
+
+  ge_sub(&check, &check, &cached);
+
+  return ge_small_order(&check) ? 0 : 2;
+}
+
+/*
+ * Get random 128-bit scalars, for the batch verification
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to get random bytes
+ */
+static int ed25519_weights_gen(uint8_t (*weights)[32], size_t count)
+{
+  for(size_t index = 0; index < count; index++)
+  {
+    memset(weights[index], 0, 32);
+
+    if(random_bytes(weights[index], 16) != 0) return 1;
+
+    // A zero weight would let the signature through unchecked
+    weights[index][0] |= 1;
+  }
+
+  return 0;
+}
+
+/*
+ * Verify a batch of signatures, with one multi-scalar multiplication
+ *
+ * Invalid points and scalars are marked before the batch, and
+ * if the batch fails, every signature is verified by itself
+ *
+ * Following signatures of the same public key share one point in the
+ * multiplication, so a batch by one signer is cheaper still
+ *
+ * PARAMS
+ * - int results[]               | The status of every signature, as ed25519_verify
+ * - const uint8_t* signatures[] | The signatures
+ * - const void* messages[]      | The signed messages
+ * - const size_t sizes[]        | The sizes of the messages
+ * - const uint8_t* pkeys[]      | The public keys
+ * - size_t count                | The amount of signatures
+ *
+ * RETURN (int status)
+ * - 0 | Every signature is valid
+ * - 1 | Bad input
+ * - 2 | Some signatures are invalid
+ */
+int ed25519_verify_batch(int results[], const uint8_t* signatures[], const void* messages[], const size_t sizes[], const uint8_t* pkeys[], size_t count)
+{
+  if(!results || !signatures || !messages || !sizes || !pkeys)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  if(count == 0) return 0;
+
+  // The base point, and R and A of every signature
+  size_t points_count = 1 + 2 * count;
+
+  ge_t*    points  = malloc(sizeof(ge_t) * points_count);
+  uint8_t (*scalars)[32] = malloc(sizeof(*scalars) * points_count);
+  uint8_t (*weights)[32] = malloc(sizeof(*weights) * count);
+
+  if(!points || !scalars || !weights || ed25519_weights_gen(weights, count) != 0)
+  {
+    free(points);
+    free(scalars);
+    free(weights);
+
+    return 1;
+  }
+
+  static const uint8_t zero[32] = { 0 };
+
+  points[0] = ED25519_BASE;
+
+  memset(scalars[0], 0, 32);
+
+  size_t used = 1;
+
+  // The slot of the last public key, which is shared by the following signatures of that key
+  size_t key_slot = 0;
+
+  const uint8_t* key = NULL;
+
+  bool failed = false;
+
+  // 1. sum [z S]B - sum [z]R - sum [z k]A
+  for(size_t index = 0; index < count; index++)
+  {
+    const uint8_t* signature = signatures[index];
+
+    if(!signature || !pkeys[index] || (!messages[index] && sizes[index] > 0))
+    {
+      results[index] = 1;
+
+      failed = true;
+
+      continue;
+    }
+
+    bool same_key = (key && memcmp(key, pkeys[index], 32) == 0);
+
+    ge_t* R = &points[used];
+    ge_t* A = &points[used + 1];
+
+    if(ge_read(R, signature) != 0 || !sc_canonical(signature + 32) ||
+       (!same_key && ge_read(A, pkeys[index]) != 0))
+    {
+      results[index] = 2;
+
+      failed = true;
+
+      continue;
+    }
+
+    results[index] = 0;
+
+    uint8_t k[32];
+
+    ed25519_challenge(k, signature, pkeys[index], messages[index], sizes[index]);
+
+    sc_muladd(scalars[0], weights[index], signature + 32, scalars[0]);
+
+    ge_neg(R, R);
+
+    memcpy(scalars[used], weights[index], 32);
+
+    used += 1;
+
+    // Signatures of the same key add their [z k] to the key's scalar
+    if(same_key)
+    {
+      sc_muladd(scalars[key_slot], weights[index], k, scalars[key_slot]);
+    }
+    else
+    {
+      ge_neg(A, A);
+
+      key_slot = used;
+
+      key = pkeys[index];
+
+      sc_muladd(scalars[key_slot], weights[index], k, zero);
+
+      used += 1;
+    }
+  }
+
+  ge_t check;
+
+  int status = ge_multi_mul(&check, scalars, points, used);
+
+  free(points);
+  free(scalars);
+  free(weights);
+
+  if(status != 0) return 1;
+
+  if(ge_small_order(&check)) return failed ? 2 : 0;
+
+  // 2. Some signature is invalid, find it by verifying them one by one
+  for(size_t index = 0; index < count; index++)
+  {
+    if(results[index] != 0) continue;
+
+    results[index] = ed25519_verify(signatures[index], messages[index], sizes[index], pkeys[index]);
+  }
+
+  return 2;
+}
+
+/*
+ * Encode a secret or public key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ */
+int ed25519_key_encode(uint8_t result[ED25519_ENCODED_SIZE], const uint8_t key[32])
+{
+  if(!result || !key)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  result[0] = (uint8_t) (ED25519_KEY_ID >> 24);
+  result[1] = (uint8_t) (ED25519_KEY_ID >> 16);
+  result[2] = (uint8_t) (ED25519_KEY_ID >>  8);
+  result[3] = (uint8_t)  ED25519_KEY_ID;
+
+  memcpy(result + 4, key, ED25519_KEY_SIZE);
+
+  return 0;
+}
+
+/*
+ * Decode an encoded secret or public key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The message is not an Ed25519 key
+ */
+int ed25519_key_decode(uint8_t key[32], const void* message, size_t size)
+{
+  if(!key || !message)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  const uint8_t* bytes = message;
+
+  if(size != ED25519_ENCODED_SIZE)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  uint32_t id = ((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16) |
+                ((uint32_t) bytes[2] <<  8) |  (uint32_t) bytes[3];
+
+  if(id != ED25519_KEY_ID)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  memcpy(key, bytes + 4, ED25519_KEY_SIZE);
+
+  return 0;
+}
+
+#endif // ED25519_IMPLEMENT
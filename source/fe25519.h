@@ -0,0 +1,393 @@
+/*
+ * fe25519.h - arithmetic in the field of 2^255 - 19
+ *
+ * Written by Hampus Fridholm
+ *
+ * Credit: https://cr.yp.to/ecdh.html
+ *
+ * Last updated: 2026-10-19
+ *
+ *
+ * This header is included by the implementations of x25519.h and
+ * ed25519.h. Every function is static inline, so it has no _IMPLEMENT guard
+ *
+ *
+ * A field element is five limbs of 51 bits. Additions don't carry, so
+ * an element can be the sum of two or three carried elements, before
+ * it is multiplied, squared or subtracted
+ */
+
+#ifndef FE25519_H
+#define FE25519_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/*
+ * A field element modulo p = 2^255 - 19,
+ * value = f[0] + f[1] 2^51 + f[2] 2^102 + f[3] 2^153 + f[4] 2^204
+ */
+typedef uint64_t fe_t[5];
+
+#define FE_MASK ((((uint64_t) 1) << 51) - 1)
+
+typedef unsigned __int128 fe_wide_t;
+
+/*
+ * Read a little-endian 64-bit word from bytes
+ */
+static inline uint64_t fe_word_read(const uint8_t* bytes)
+{
+  uint64_t word = 0;
+
+  for(int index = 7; index >= 0; index--)
+  {
+    word = (word << 8) | bytes[index];
+  }
+
+  return word;
+}
+
+/*
+ * Write a 64-bit word as little-endian bytes
+ */
+static inline void fe_word_write(uint8_t* bytes, uint64_t word)
+{
+  for(int index = 0; index < 8; index++)
+  {
+    bytes[index] = (uint8_t) (word >> (8 * index));
+  }
+}
+
+/*
+ * Read the field element from 32 bytes, ignoring the top bit
+ */
+static inline void fe_read(fe_t f, const uint8_t bytes[32])
+{
+  f[0] =  fe_word_read(bytes)              & FE_MASK;
+  f[1] = (fe_word_read(bytes +  6) >>  3) & FE_MASK;
+  f[2] = (fe_word_read(bytes + 12) >>  6) & FE_MASK;
+  f[3] = (fe_word_read(bytes + 19) >>  1) & FE_MASK;
+  f[4] = (fe_word_read(bytes + 24) >> 12) & FE_MASK;
+}
+
+/*
+ * Carry the limbs, so they are 51 bits again
+ */
+static inline void fe_carry(fe_t f)
+{
+  for(int index = 0; index < 4; index++)
+  {
+    f[index + 1] += f[index] >> 51;
+
+    f[index] &= FE_MASK;
+  }
+
+  f[0] += 19 * (f[4] >> 51);
+
+  f[4] &= FE_MASK;
+}
+
+/*
+ * Write the fully reduced field element as 32 bytes
+ */
+static inline void fe_write(uint8_t bytes[32], const fe_t f)
+{
+  fe_t h;
+
+  memcpy(h, f, sizeof(fe_t));
+
+  fe_carry(h);
+  fe_carry(h);
+
+  // q is 1 if h is at least p, then h - p = h + 19 - 2^255
+  uint64_t q = (h[0] + 19) >> 51;
+
+  for(int index = 1; index < 5; index++)
+  {
+    q = (h[index] + q) >> 51;
+  }
+
+  h[0] += 19 * q;
+
+  for(int index = 0; index < 4; index++)
+  {
+    h[index + 1] += h[index] >> 51;
+
+    h[index] &= FE_MASK;
+  }
+
+  h[4] &= FE_MASK;
+
+  fe_word_write(bytes,       h[0]        | (h[1] << 51));
+  fe_word_write(bytes +  8, (h[1] >> 13) | (h[2] << 38));
+  fe_word_write(bytes + 16, (h[2] >> 26) | (h[3] << 25));
+  fe_word_write(bytes + 24, (h[3] >> 39) | (h[4] << 12));
+}
+
+/*
+ * r = a + b
+ */
+static inline void fe_add(fe_t r, const fe_t a, const fe_t b)
+{
+  for(int index = 0; index < 5; index++)
+  {
+    r[index] = a[index] + b[index];
+  }
+}
+
+/*
+ * r = a - b, by adding 4p first so no limb goes below zero
+ */
+static inline void fe_sub(fe_t r, const fe_t a, const fe_t b)
+{
+  r[0] = (a[0] + 0x1FFFFFFFFFFFB4) - b[0];
+  r[1] = (a[1] + 0x1FFFFFFFFFFFFC) - b[1];
+  r[2] = (a[2] + 0x1FFFFFFFFFFFFC) - b[2];
+  r[3] = (a[3] + 0x1FFFFFFFFFFFFC) - b[3];
+  r[4] = (a[4] + 0x1FFFFFFFFFFFFC) - b[4];
+
+  fe_carry(r);
+}
+
+/*
+ * Carry the wide limbs of a product into r
+ */
+static inline void fe_wide_carry(fe_t r, fe_wide_t t[5])
+{
+  for(int index = 0; index < 4; index++)
+  {
+    t[index + 1] += (uint64_t) (t[index] >> 51);
+
+    r[index] = (uint64_t) t[index] & FE_MASK;
+  }
+
+  r[4] = (uint64_t) t[4] & FE_MASK;
+
+  r[0] += 19 * (uint64_t) (t[4] >> 51);
+
+  r[1] += r[0] >> 51;
+
+  r[0] &= FE_MASK;
+}
+
+/*
+ * r = a * b
+ *
+ * The limbs above 2^255 are folded back, multiplied by 19
+ */
+static inline void fe_mul(fe_t r, const fe_t a, const fe_t b)
+{
+  uint64_t b1 = 19 * b[1], b2 = 19 * b[2], b3 = 19 * b[3], b4 = 19 * b[4];
+
+  fe_wide_t t[5];
+
+  t[0] = (fe_wide_t) a[0] * b[0] + (fe_wide_t) a[1] * b4   + (fe_wide_t) a[2] * b3   + (fe_wide_t) a[3] * b2   + (fe_wide_t) a[4] * b1;
+  t[1] = (fe_wide_t) a[0] * b[1] + (fe_wide_t) a[1] * b[0] + (fe_wide_t) a[2] * b4   + (fe_wide_t) a[3] * b3   + (fe_wide_t) a[4] * b2;
+  t[2] = (fe_wide_t) a[0] * b[2] + (fe_wide_t) a[1] * b[1] + (fe_wide_t) a[2] * b[0] + (fe_wide_t) a[3] * b4   + (fe_wide_t) a[4] * b3;
+  t[3] = (fe_wide_t) a[0] * b[3] + (fe_wide_t) a[1] * b[2] + (fe_wide_t) a[2] * b[1] + (fe_wide_t) a[3] * b[0] + (fe_wide_t) a[4] * b4;
+  t[4] = (fe_wide_t) a[0] * b[4] + (fe_wide_t) a[1] * b[3] + (fe_wide_t) a[2] * b[2] + (fe_wide_t) a[3] * b[1] + (fe_wide_t) a[4] * b[0];
+
+  fe_wide_carry(r, t);
+}
+
+/*
+ * r = a * a
+ *
+ * The products of different limbs are calculated once, and doubled
+ */
+static inline void fe_sq(fe_t r, const fe_t a)
+{
+  uint64_t a0_2 = 2 * a[0], a1_2 = 2 * a[1];
+
+  uint64_t a3_19 = 19 * a[3], a4_19 = 19 * a[4];
+
+  fe_wide_t t[5];
+
+  t[0] = (fe_wide_t) a[0] * a[0]  + (fe_wide_t) a1_2 * a4_19 + (fe_wide_t) (2 * a[2]) * a3_19;
+  t[1] = (fe_wide_t) a0_2 * a[1]  + (fe_wide_t) (2 * a[2]) * a4_19 + (fe_wide_t) a[3] * a3_19;
+  t[2] = (fe_wide_t) a0_2 * a[2]  + (fe_wide_t) a[1] * a[1]  + (fe_wide_t) (2 * a[3]) * a4_19;
+  t[3] = (fe_wide_t) a0_2 * a[3]  + (fe_wide_t) a1_2 * a[2]  + (fe_wide_t) a[4] * a4_19;
+  t[4] = (fe_wide_t) a0_2 * a[4]  + (fe_wide_t) a1_2 * a[3]  + (fe_wide_t) a[2] * a[2];
+
+  fe_wide_carry(r, t);
+}
+
+/*
+ * r = a * small
+ */
+static inline void fe_mul_small(fe_t r, const fe_t a, uint64_t small)
+{
+  fe_wide_t t[5];
+
+  for(int index = 0; index < 5; index++)
+  {
+    t[index] = (fe_wide_t) a[index] * small;
+  }
+
+  fe_wide_carry(r, t);
+}
+
+/*
+ * r = a^(2^count)
+ */
+static inline void fe_sq_times(fe_t r, const fe_t a, int count)
+{
+  fe_sq(r, a);
+
+  for(int index = 1; index < count; index++)
+  {
+    fe_sq(r, r);
+  }
+}
+
+/*
+ * r = a^(2^250 - 1), and a11 = a^11
+ *
+ * This is the shared part of the inversion and the square root
+ *
+ * Credit: the addition chain of ref10, https://cr.yp.to/ecdh.html
+ */
+static inline void fe_pow_250(fe_t r, fe_t a11, const fe_t a)
+{
+  fe_t a2, a9, a5_0, a10_0, a20_0, a50_0, a100_0, t;
+
+  fe_sq(a2, a);                 // a^2
+  fe_sq_times(t, a2, 2);        // a^8
+  fe_mul(a9, t, a);             // a^9
+  fe_mul(a11, a9, a2);          // a^11
+  fe_sq(t, a11);                // a^22
+  fe_mul(a5_0, t, a9);          // a^(2^5 - 1)
+
+  fe_sq_times(t, a5_0, 5);
+  fe_mul(a10_0, t, a5_0);       // a^(2^10 - 1)
+
+  fe_sq_times(t, a10_0, 10);
+  fe_mul(a20_0, t, a10_0);      // a^(2^20 - 1)
+
+  fe_sq_times(t, a20_0, 20);
+  fe_mul(t, t, a20_0);          // a^(2^40 - 1)
+
+  fe_sq_times(t, t, 10);
+  fe_mul(a50_0, t, a10_0);      // a^(2^50 - 1)
+
+  fe_sq_times(t, a50_0, 50);
+  fe_mul(a100_0, t, a50_0);     // a^(2^100 - 1)
+
+  fe_sq_times(t, a100_0, 100);
+  fe_mul(t, t, a100_0);         // a^(2^200 - 1)
+
+  fe_sq_times(t, t, 50);
+  fe_mul(r, t, a50_0);          // a^(2^250 - 1)
+}
+
+/*
+ * r = a^-1 = a^(p - 2) = a^(2^255 - 21)
+ */
+static inline void fe_invert(fe_t r, const fe_t a)
+{
+  fe_t t, a11;
+
+  fe_pow_250(t, a11, a);
+
+  fe_sq_times(t, t, 5);
+  fe_mul(r, t, a11);
+}
+
+/*
+ * r = a^((p - 5) / 8) = a^(2^252 - 3), used for square roots
+ */
+static inline void fe_pow22523(fe_t r, const fe_t a)
+{
+  fe_t t, a11;
+
+  fe_pow_250(t, a11, a);
+
+  fe_sq_times(t, t, 2);
+  fe_mul(r, t, a);
+}
+
+/*
+ * Swap a and b if swap is 1, without branching
+ */
+static inline void fe_cswap(fe_t a, fe_t b, uint64_t swap)
+{
+  uint64_t mask = -swap;
+
+  for(int index = 0; index < 5; index++)
+  {
+    uint64_t diff = mask & (a[index] ^ b[index]);
+
+    a[index] ^= diff;
+    b[index] ^= diff;
+  }
+}
+
+/*
+ * Copy b to a if move is 1, without branching
+ */
+static inline void fe_cmov(fe_t a, const fe_t b, uint64_t move)
+{
+  uint64_t mask = -move;
+
+  for(int index = 0; index < 5; index++)
+  {
+    a[index] ^= mask & (a[index] ^ b[index]);
+  }
+}
+
+/*
+ * r = -a
+ */
+static inline void fe_neg(fe_t r, const fe_t a)
+{
+  static const fe_t zero = { 0 };
+
+  fe_sub(r, zero, a);
+}
+
+/*
+ * Check if the fully reduced a is zero
+ */
+static inline bool fe_iszero(const fe_t a)
+{
+  uint8_t bytes[32];
+
+  fe_write(bytes, a);
+
+  uint8_t bits = 0;
+
+  for(int index = 0; index < 32; index++)
+  {
+    bits |= bytes[index];
+  }
+
+  return (bits == 0);
+}
+
+/*
+ * Check if the fully reduced a is odd, which is "negative" in the encodings
+ */
+static inline bool fe_isnegative(const fe_t a)
+{
+  uint8_t bytes[32];
+
+  fe_write(bytes, a);
+
+  return (bytes[0] & 1);
+}
+
+/*
+ * Check if a and b are the same field element
+ */
+static inline bool fe_equal(const fe_t a, const fe_t b)
+{
+  fe_t diff;
+
+  fe_sub(diff, a, b);
+
+  return fe_iszero(diff);
+}
+
+#endif // FE25519_H
@@ -0,0 +1,863 @@
+/*
+ * keyagent - resident agent, decrypting with secret keys
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ */
+
+// For struct ucred and accept4
+#define _GNU_SOURCE
+
+#define RSA_IMPLEMENT
+#include "rsa.h"
+
+#define BASE64_IMPLEMENT
+#include "base64.h"
+
+#define FILE_IMPLEMENT
+#include "file.h"
+
+#define DEBUG_IMPLEMENT
+#include "debug.h"
+
+#define SHA256_IMPLEMENT
+#include "sha256.h"
+
+#ifdef RSA_MONT
+#define MONT_IMPLEMENT
+#include "mont.h"
+#endif // RSA_MONT
+
+#define KEYRING_IMPLEMENT
+#include "keyring.h"
+
+#define KEYAGENT_IMPLEMENT
+#include "keyagent.h"
+
+#define RANDOM_IMPLEMENT
+#include "random.h"
+
+#define CHACHA20POLY1305_IMPLEMENT
+#include "chacha20poly1305.h"
+
+#include <stdbool.h>
+#include <argp.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+
+#define SKEY_FILE "skey"
+
+#define KEY_DIR "."
+
+// The most secret key files that can be given
+#define SKEY_FILES_MAX 64
+
+
+static char doc[] = "keyagent - resident agent, decrypting with secret keys";
+
+static char args_doc[] = "";
+
+static struct argp_option options[] =
+{
+  { "secret",  's', "FILE",   0, "Secret key file, can be given many times" },
+  { "dir",     'D', "DIR",    0, "Key directory" },
+  { "keyring", 'k', "FILE",   0, "Keyring file, every secret key is loaded" },
+  { "socket",  'S', "SOCKET", 0, "Path to the socket" },
+  { "quiet",   'q', 0,        0, "Don't produce any output" },
+  { "debug",   'x', 0,        0, "Output debug messages" },
+  { 0 }
+};
+
+struct args
+{
+  char*  secrets[SKEY_FILES_MAX];
+  size_t secret_count;
+  char*  dir;
+  char*  keyring;
+  char*  socket;
+  bool   quiet;
+  bool   debug;
+};
+
+struct args args =
+{
+  .secret_count = 0,
+  .dir          = KEY_DIR,
+  .keyring      = NULL,
+  .socket       = NULL,
+  .quiet        = false,
+  .debug        = false
+};
+
+/*
+ * This is the option parsing function used by argp
+ */
+static error_t opt_parse(int key, char* arg, struct argp_state* state)
+{
+  struct args* args = state->input;
+
+  switch(key)
+  {
+    case 's':
+      if(args->secret_count >= SKEY_FILES_MAX) argp_usage(state);
+
+      args->secrets[args->secret_count++] = arg;
+      break;
+
+    case 'D':
+      args->dir = arg;
+      break;
+
+    case 'k':
+      args->keyring = arg;
+      break;
+
+    case 'S':
+      args->socket = arg;
+      break;
+
+    case 'q':
+      if(args->debug) argp_usage(state);
+
+      args->quiet = true;
+      break;
+
+    case 'x':
+      if(args->quiet) argp_usage(state);
+
+      args->debug = true;
+      break;
+
+    case ARGP_KEY_ARG:
+      argp_usage(state);
+      break;
+
+    case ARGP_KEY_END:
+      break;
+
+    default:
+      return ARGP_ERR_UNKNOWN;
+  }
+
+  return 0;
+}
+
+/*
+ * A loaded secret key
+ *
+ * The context is bound to the key once, and is then
+ * used by one connection at a time. The batch requests
+ * bind their own contexts to the key, one for every thread.
+ */
+typedef struct
+{
+  uint8_t         fingerprint[32];
+  skey_t          skey;
+  rsa_ctx_t       ctx;
+  pthread_mutex_t lock;
+} agent_key_t;
+
+static agent_key_t* keys = NULL;
+
+static size_t key_count = 0;
+
+static volatile sig_atomic_t running = 1;
+
+/*
+ * The memory functions of GMP, which clear the memory before freeing it
+ *
+ * That way, the freed key values are not left in the heap
+ */
+static void* gmp_clear_realloc(void* pointer, size_t old_size, size_t new_size)
+{
+  void* new_pointer = malloc(new_size);
+
+  if(!new_pointer) return NULL;
+
+  memcpy(new_pointer, pointer, (old_size < new_size) ? old_size : new_size);
+
+  explicit_bzero(pointer, old_size);
+
+  free(pointer);
+
+  return new_pointer;
+}
+
+static void gmp_clear_free(void* pointer, size_t size)
+{
+  explicit_bzero(pointer, size);
+
+  free(pointer);
+}
+
+/*
+ * Add the secret key to the loaded keys
+ *
+ * The key is bound to a context, and is kept for the batch requests.
+ * On success, the loaded keys own the key, and it is freed by keys_free.
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The key is already loaded
+ * - 2 | Failed to load the key
+ */
+static int key_add(skey_t* skey)
+{
+  uint8_t fingerprint[32];
+
+  if(rsa_skey_fingerprint(fingerprint, skey) != 0) return 2;
+
+  for(size_t index = 0; index < key_count; index++)
+  {
+    if(memcmp(keys[index].fingerprint, fingerprint, 32) == 0) return 1;
+  }
+
+  agent_key_t* new_keys = realloc(keys, sizeof(agent_key_t) * (key_count + 1));
+
+  if(!new_keys) return 2;
+
+  keys = new_keys;
+
+  agent_key_t* key = &keys[key_count];
+
+  if(rsa_ctx_skey_init(&key->ctx, skey) != 0) return 2;
+
+  key->skey = *skey;
+
+  memcpy(key->fingerprint, fingerprint, 32);
+
+  key_count++;
+
+  return 0;
+}
+
+/*
+ * Find the loaded key with the fingerprint
+ */
+static agent_key_t* key_find(const uint8_t fingerprint[32])
+{
+  for(size_t index = 0; index < key_count; index++)
+  {
+    if(memcmp(keys[index].fingerprint, fingerprint, 32) == 0) return &keys[index];
+  }
+
+  return NULL;
+}
+
+/*
+ * Free the loaded keys
+ */
+static void keys_free(void)
+{
+  for(size_t index = 0; index < key_count; index++)
+  {
+    rsa_ctx_free(&keys[index].ctx);
+
+    rsa_skey_free(&keys[index].skey);
+
+    pthread_mutex_destroy(&keys[index].lock);
+  }
+
+  free(keys);
+
+  keys = NULL;
+
+  key_count = 0;
+}
+
+/*
+ * Decode a base64 encoded secret key
+ *
+ * The decoded buffer is erased before it is freed
+ *
+ * PARAMS
+ * - skey_t* key         | The decoded secret key
+ * - const void* message | The base64 encoded key
+ * - size_t size         | The size of the encoded key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to decode base64
+ * - 2 | Failed to decode the secret key
+ */
+static int base64_skey_decode(skey_t* key, const void* message, size_t size)
+{
+  char*  buffer;
+  size_t buffer_size;
+
+  if(base64_decode(&buffer, &buffer_size, message, size) != 0)
+  {
+    return 1;
+  }
+
+  int status = rsa_skey_decode(key, buffer, buffer_size);
+
+  explicit_bzero(buffer, buffer_size);
+
+  free(buffer);
+
+  return (status == 0) ? 0 : 2;
+}
+
+/*
+ * Load the secret key in the key file
+ */
+static int file_key_load(const char* name)
+{
+  skey_t skey;
+
+  // A key in the extended format is mapped, instead of decoded
+  char filepath[strlen(args.dir) + strlen(name) + 2];
+
+  sprintf(filepath, "%s/%s", args.dir, name);
+
+  int status = rsa_skey_ext_load(&skey, filepath);
+
+  if(status != 0)
+  {
+    size_t file_size = dir_file_size_get(args.dir, name);
+
+    char base64[file_size + 1];
+
+    if(file_size == 0 || dir_file_read(base64, file_size, args.dir, name) == 0)
+    {
+      if(!args.quiet)
+        fprintf(stderr, "keyagent: Failed to read %s\n", name);
+
+      return 1;
+    }
+
+    status = base64_skey_decode(&skey, base64, file_size);
+
+    explicit_bzero(base64, file_size);
+
+    if(status != 0)
+    {
+      if(!args.quiet)
+        fprintf(stderr, "keyagent: Failed to decode %s\n", name);
+
+      return 2;
+    }
+  }
+
+  status = key_add(&skey);
+
+  if(status != 0) rsa_skey_free(&skey);
+
+  if(status == 2)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keyagent: Failed to load %s\n", name);
+
+    return 3;
+  }
+
+  return 0;
+}
+
+/*
+ * Load every secret key in the keyring
+ */
+static int keyring_keys_load(const char* path)
+{
+  keyring_t keyring;
+
+  if(keyring_open(&keyring, path) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keyagent: Failed to open keyring\n");
+
+    return 1;
+  }
+
+  int status = 0;
+
+  for(size_t index = 0; index < keyring.count; index++)
+  {
+    keyring_key_t found;
+
+    if(keyring_key_get(&found, &keyring, index) != 0)
+    {
+      status = 2;
+
+      break;
+    }
+
+    if(found.type != KEYRING_SECRET) continue;
+
+    skey_t skey;
+
+    if(rsa_skey_decode(&skey, found.key, found.size) != 0)
+    {
+      if(!args.quiet)
+        fprintf(stderr, "keyagent: Failed to decode key %s\n", found.name);
+
+      status = 2;
+
+      continue;
+    }
+
+    int add_status = key_add(&skey);
+
+    if(add_status != 0) rsa_skey_free(&skey);
+
+    if(add_status == 2)
+    {
+      if(!args.quiet)
+        fprintf(stderr, "keyagent: Failed to load key %s\n", found.name);
+
+      status = 2;
+    }
+  }
+
+  keyring_close(&keyring);
+
+  return status;
+}
+
+/*
+ * Answer one batch request, decrypting the messages with all cores
+ *
+ * The response has the status and the result of every message.
+ * A message that is larger than any key closes the connection.
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The connection failed
+ */
+static int batch_request_handle(int fd, const uint8_t fingerprint[32])
+{
+  uint8_t count_bytes[2];
+
+  if(keyagent_read(fd, count_bytes, sizeof(count_bytes)) != 0) return 1;
+
+  size_t count = ((size_t) count_bytes[0] << 8) | count_bytes[1];
+
+  if(count == 0 || count > KEYAGENT_BATCH_MAX)
+  {
+    uint8_t response[1 + 2] = { KEYAGENT_INVALID, 0, 0 };
+
+    keyagent_write(fd, response, sizeof(response));
+
+    return 1;
+  }
+
+  // 1. Read the messages, every message and result fits the largest key
+  const size_t slot = RSA_MODULUS_MAX / 8;
+
+  uint8_t* buffer = malloc(sizeof(uint8_t) * 2 * slot * count);
+
+  if(!buffer) return 1;
+
+  void*       results[count];
+  size_t      rsizes[count];
+  const void* messages[count];
+  size_t      sizes[count];
+
+  int status = 0;
+
+  for(size_t index = 0; index < count; index++)
+  {
+    uint8_t size_bytes[2];
+
+    messages[index] = buffer + (2 * index) * slot;
+    results[index]  = buffer + (2 * index + 1) * slot;
+
+    if(keyagent_read(fd, size_bytes, sizeof(size_bytes)) != 0)
+    {
+      status = 1;
+
+      break;
+    }
+
+    sizes[index] = ((size_t) size_bytes[0] << 8) | size_bytes[1];
+
+    if(sizes[index] > slot)
+    {
+      uint8_t response[1 + 2] = { KEYAGENT_INVALID, 0, 0 };
+
+      keyagent_write(fd, response, sizeof(response));
+
+      status = 1;
+
+      break;
+    }
+
+    if(keyagent_read(fd, (void*) messages[index], sizes[index]) != 0)
+    {
+      status = 1;
+
+      break;
+    }
+  }
+
+  if(status != 0)
+  {
+    free(buffer);
+
+    return 1;
+  }
+
+  // 2. Decrypt the messages, the failed messages get the size SIZE_MAX
+  agent_key_t* key = key_find(fingerprint);
+
+  uint8_t batch_status = KEYAGENT_SUCCESS;
+
+  if(!key)
+  {
+    batch_status = KEYAGENT_NO_KEY;
+  }
+  else
+  {
+    for(size_t index = 0; index < count; index++)
+    {
+      if(sizes[index] == 0 || sizes[index] > key->ctx.size)
+      {
+        sizes[index] = 0;
+      }
+    }
+
+    int decrypt_status = rsa_decrypt_batch(results, rsizes, messages, sizes, count, &key->skey, 0);
+
+    if(decrypt_status != 0 && decrypt_status != 3) batch_status = KEYAGENT_FAILED;
+  }
+
+  // 3. Write the response, with the result of every message
+  uint8_t response[1 + 2] = { batch_status, 0, 0 };
+
+  if(batch_status == KEYAGENT_SUCCESS)
+  {
+    response[1] = (uint8_t) (count >> 8);
+    response[2] = (uint8_t)  count;
+  }
+
+  status = keyagent_write(fd, response, sizeof(response));
+
+  for(size_t index = 0; status == 0 && batch_status == KEYAGENT_SUCCESS && index < count; index++)
+  {
+    size_t rsize = (rsizes[index] == SIZE_MAX) ? 0 : rsizes[index];
+
+    uint8_t result_status = (rsizes[index] == SIZE_MAX) ? KEYAGENT_FAILED : KEYAGENT_SUCCESS;
+
+    uint8_t header[1 + 2] = { result_status, (uint8_t) (rsize >> 8), (uint8_t) rsize };
+
+    status = (keyagent_write(fd, header, sizeof(header)) == 0 &&
+              keyagent_write(fd, results[index], rsize) == 0) ? 0 : 1;
+  }
+
+  explicit_bzero(buffer, sizeof(uint8_t) * 2 * slot * count);
+
+  free(buffer);
+
+  return status;
+}
+
+/*
+ * Answer one request, with the decrypted message or an error status
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The connection failed
+ */
+static int request_handle(int fd)
+{
+  uint8_t header[32 + 2];
+
+  if(keyagent_read(fd, header, sizeof(header)) != 0) return 1;
+
+  size_t size = ((size_t) header[32] << 8) | header[33];
+
+  // The message size 0 is the start of a batch request
+  if(size == 0) return batch_request_handle(fd, header);
+
+  uint8_t message[size + 1];
+
+  if(keyagent_read(fd, message, size) != 0) return 1;
+
+  uint8_t result[RSA_MODULUS_MAX / 8];
+
+  size_t rsize = 0;
+
+  uint8_t status = KEYAGENT_SUCCESS;
+
+  agent_key_t* key = key_find(header);
+
+  if(!key)
+  {
+    status = KEYAGENT_NO_KEY;
+  }
+  else if(size > key->ctx.size)
+  {
+    status = KEYAGENT_INVALID;
+  }
+  else
+  {
+    pthread_mutex_lock(&key->lock);
+
+    if(rsa_ctx_decrypt(result, &rsize, message, size, &key->ctx) != 0)
+    {
+      status = KEYAGENT_FAILED;
+    }
+
+    pthread_mutex_unlock(&key->lock);
+  }
+
+  if(status != KEYAGENT_SUCCESS) rsize = 0;
+
+  uint8_t response[1 + 2] = { status, (uint8_t) (rsize >> 8), (uint8_t) rsize };
+
+  int result_status = (keyagent_write(fd, response, sizeof(response)) == 0 &&
+                       keyagent_write(fd, result, rsize) == 0) ? 0 : 1;
+
+  explicit_bzero(result, sizeof(result));
+
+  return result_status;
+}
+
+/*
+ * This is the thread function, answering the requests of one connection
+ */
+static void* connection_thread(void* arg)
+{
+  int fd = (int) (intptr_t) arg;
+
+  while(running && request_handle(fd) == 0);
+
+  close(fd);
+
+  return NULL;
+}
+
+/*
+ * Check that the connecting process is run by the same user
+ */
+static bool connection_allowed(int fd)
+{
+  struct ucred credentials;
+
+  socklen_t size = sizeof(credentials);
+
+  if(getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &size) != 0)
+  {
+    return false;
+  }
+
+  return (credentials.uid == getuid());
+}
+
+/*
+ * Stop the agent, when it is interrupted or terminated
+ */
+static void stop_handler(int signal)
+{
+  running = 0;
+}
+
+/*
+ * Create the socket, that only the user can connect to
+ *
+ * An old socket is replaced, unless another agent is listening on it
+ *
+ * RETURN (int fd)
+ * - -1 | Failed to create socket
+ */
+static int socket_create(const char* path)
+{
+  struct sockaddr_un address = { .sun_family = AF_UNIX };
+
+  if(strlen(path) >= sizeof(address.sun_path)) return -1;
+
+  strcpy(address.sun_path, path);
+
+  int other = keyagent_connect(path);
+
+  if(other != -1)
+  {
+    close(other);
+
+    if(!args.quiet)
+      fprintf(stderr, "keyagent: Another agent is running\n");
+
+    return -1;
+  }
+
+  unlink(path);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+  if(fd == -1) return -1;
+
+  mode_t mask = umask(0077);
+
+  int status = bind(fd, (struct sockaddr*) &address, sizeof(address));
+
+  umask(mask);
+
+  if(status != 0 || listen(fd, 64) != 0)
+  {
+    close(fd);
+
+    return -1;
+  }
+
+  return fd;
+}
+
+/*
+ * Accept connections until the agent is stopped
+ *
+ * Every connection is answered by its own thread
+ */
+static void connections_accept(int socket_fd)
+{
+  pthread_attr_t attr;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+  while(running)
+  {
+    int fd = accept4(socket_fd, NULL, NULL, SOCK_CLOEXEC);
+
+    if(fd == -1) continue;
+
+    if(!connection_allowed(fd))
+    {
+      close(fd);
+
+      continue;
+    }
+
+    pthread_t thread;
+
+    if(pthread_create(&thread, &attr, connection_thread, (void*) (intptr_t) fd) != 0)
+    {
+      close(fd);
+    }
+  }
+
+  pthread_attr_destroy(&attr);
+}
+
+static struct argp argp = { options, opt_parse, args_doc, doc };
+
+/*
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to load keys
+ * - 2 | Failed to create socket
+ */
+int main(int argc, char* argv[])
+{
+  argp_parse(&argp, argc, argv, 0, 0, &args);
+
+  if(args.debug)
+    info_print("Start of main");
+
+  // The key memory is cleared when GMP frees it
+  mp_set_memory_functions(NULL, gmp_clear_realloc, gmp_clear_free);
+
+  // The keys can't be read from a core dump or by ptrace
+  prctl(PR_SET_DUMPABLE, 0);
+
+  // 1. Load the secret keys
+  if(args.keyring)
+  {
+    keyring_keys_load(args.keyring);
+  }
+
+  for(size_t index = 0; index < args.secret_count; index++)
+  {
+    file_key_load(args.secrets[index]);
+  }
+
+  if(!args.keyring && args.secret_count == 0)
+  {
+    file_key_load(SKEY_FILE);
+  }
+
+  if(key_count == 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keyagent: No secret key is loaded\n");
+
+    free(keys);
+
+    return 1;
+  }
+
+  // The keys are not moved anymore, so the locks can be created
+  for(size_t index = 0; index < key_count; index++)
+  {
+    pthread_mutex_init(&keys[index].lock, NULL);
+  }
+
+  // 2. Lock the loaded keys, and the memory of the requests, so they are never swapped out
+  if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keyagent: Failed to lock keys in memory\n");
+  }
+
+  // 3. Create the socket
+  char path[sizeof(((struct sockaddr_un*) 0)->sun_path)];
+
+  if(args.socket)
+  {
+    snprintf(path, sizeof(path), "%s", args.socket);
+  }
+  else keyagent_socket_path(path, sizeof(path));
+
+  int socket_fd = socket_create(path);
+
+  if(socket_fd == -1)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keyagent: Failed to create socket\n");
+
+    keys_free();
+
+    return 2;
+  }
+
+  struct sigaction action = { .sa_handler = stop_handler };
+
+  sigemptyset(&action.sa_mask);
+
+  // Without SA_RESTART, accept is interrupted by the signal
+  sigaction(SIGINT,  &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+
+  signal(SIGPIPE, SIG_IGN);
+
+  if(!args.quiet)
+    printf("keyagent: Serving %zu keys on %s\n", key_count, path);
+
+  fflush(stdout);
+
+  // 4. Answer the requests until stopped
+  connections_accept(socket_fd);
+
+  close(socket_fd);
+
+  unlink(path);
+
+  // The keys are not freed, because detached threads can still use them
+
+  if(args.debug)
+    info_print("End of main");
+
+  return 0;
+}
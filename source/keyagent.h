@@ -0,0 +1,393 @@
+/*
+ * keyagent.h - protocol of the key agent, and the client side of it
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ *
+ *
+ * In main compilation unit; define KEYAGENT_IMPLEMENT
+ *
+ *
+ * The key agent keeps decoded secret keys in memory, and decrypts
+ * RSA encrypted messages for the programs that connect to its socket.
+ *
+ * A request is:  fingerprint (32), message size (2), message
+ *
+ * A response is: status (1), result size (2), result
+ *
+ * A batch request has the message size 0, and many messages:
+ * fingerprint (32), 0 (2), count (2), then for every message:
+ * message size (2), message
+ *
+ * A batch response is: status (1), count (2), then for every message:
+ * status (1), result size (2), result
+ *
+ * Every value is big-endian, and a connection can be used for many requests
+ *
+ *
+ * These are the available funtions:
+ *
+ * int  keyagent_socket_path(char* path, size_t size)
+ *
+ * int  keyagent_connect(const char* path)
+ *
+ * int  keyagent_decrypt(void* result, size_t* rsize, size_t max, int fd, const uint8_t fingerprint[32], const void* message, size_t size)
+ *
+ * int  keyagent_decrypt_batch(void* results[], size_t rsizes[], size_t max, int fd, const uint8_t fingerprint[32], const void* messages[], const size_t sizes[], size_t count)
+ *
+ *
+ * int  keyagent_read(int fd, void* buffer, size_t size)
+ *
+ * int  keyagent_write(int fd, const void* buffer, size_t size)
+ */
+
+/*
+ * From here on, until KEYAGENT_IMPLEMENT,
+ * it is like a normal header file with declarations
+ */
+
+#ifndef KEYAGENT_H
+#define KEYAGENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The environment variable with the path to the socket
+ */
+#define KEYAGENT_SOCKET_ENV "KEYAGENT_SOCKET"
+
+/*
+ * The largest message and result of a request
+ */
+#define KEYAGENT_MESSAGE_MAX 0xFFFF
+
+/*
+ * The most messages in a batch request
+ */
+#define KEYAGENT_BATCH_MAX 256
+
+/*
+ * The status of a response
+ */
+#define KEYAGENT_SUCCESS 0
+#define KEYAGENT_NO_KEY  1
+#define KEYAGENT_INVALID 2
+#define KEYAGENT_FAILED  3
+
+extern int  keyagent_socket_path(char* path, size_t size);
+
+extern int  keyagent_connect(const char* path);
+
+extern int  keyagent_decrypt(void* result, size_t* rsize, size_t max, int fd, const uint8_t fingerprint[32], const void* message, size_t size);
+
+extern int  keyagent_decrypt_batch(void* results[], size_t rsizes[], size_t max, int fd, const uint8_t fingerprint[32], const void* messages[], const size_t sizes[], size_t count);
+
+
+extern int  keyagent_read(int fd, void* buffer, size_t size);
+
+extern int  keyagent_write(int fd, const void* buffer, size_t size);
+
+#endif // KEYAGENT_H
+
+/*
+ * This header library file uses _IMPLEMENT guards
+ *
+ * If KEYAGENT_IMPLEMENT is defined, the definitions will be included
+ */
+
+#ifdef KEYAGENT_IMPLEMENT
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+/*
+ * Get the path to the socket of the key agent
+ *
+ * The path is taken from KEYAGENT_SOCKET, or else it is
+ * keyagent.sock in XDG_RUNTIME_DIR, or in /tmp with the user id
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The path does not fit
+ */
+int keyagent_socket_path(char* path, size_t size)
+{
+  const char* socket = getenv(KEYAGENT_SOCKET_ENV);
+
+  const char* runtime = getenv("XDG_RUNTIME_DIR");
+
+  int length;
+
+  if(socket && *socket)
+  {
+    length = snprintf(path, size, "%s", socket);
+  }
+  else if(runtime && *runtime)
+  {
+    length = snprintf(path, size, "%s/keyagent.sock", runtime);
+  }
+  else length = snprintf(path, size, "/tmp/keyagent-%d.sock", (int) getuid());
+
+  return (length < 0 || (size_t) length >= size) ? 1 : 0;
+}
+
+/*
+ * Read exactly size bytes from the connection
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The connection was closed or failed
+ */
+int keyagent_read(int fd, void* buffer, size_t size)
+{
+  size_t done = 0;
+
+  while(done < size)
+  {
+    ssize_t result = read(fd, (uint8_t*) buffer + done, size - done);
+
+    if(result < 0 && errno == EINTR) continue;
+
+    if(result <= 0) return 1;
+
+    done += result;
+  }
+
+  return 0;
+}
+
+/*
+ * Write exactly size bytes to the connection
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The connection was closed or failed
+ */
+int keyagent_write(int fd, const void* buffer, size_t size)
+{
+  size_t done = 0;
+
+  while(done < size)
+  {
+    ssize_t result = send(fd, (uint8_t*) buffer + done, size - done, MSG_NOSIGNAL);
+
+    if(result < 0 && errno == EINTR) continue;
+
+    if(result <= 0) return 1;
+
+    done += result;
+  }
+
+  return 0;
+}
+
+/*
+ * Connect to the key agent
+ *
+ * The socket has to be owned by the user, so the
+ * encrypted keys are not sent to another user's agent
+ *
+ * RETURN (int fd)
+ * - -1 | The agent is not available
+ */
+int keyagent_connect(const char* path)
+{
+  struct sockaddr_un address = { .sun_family = AF_UNIX };
+
+  if(!path || strlen(path) >= sizeof(address.sun_path)) return -1;
+
+  strcpy(address.sun_path, path);
+
+  struct stat info;
+
+  if(lstat(path, &info) != 0 || !S_ISSOCK(info.st_mode) || info.st_uid != getuid())
+  {
+    return -1;
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+  if(fd == -1) return -1;
+
+  if(connect(fd, (struct sockaddr*) &address, sizeof(address)) != 0)
+  {
+    close(fd);
+
+    return -1;
+  }
+
+  return fd;
+}
+
+/*
+ * Decrypt an RSA encrypted message, with the key agent's secret key
+ *
+ * PARAMS
+ * - void* result                  | The decrypted message
+ * - size_t* rsize                 | The size of the decrypted message
+ * - size_t max                    | The room in result
+ * - int fd                        | The connection to the agent
+ * - const uint8_t fingerprint[32] | The fingerprint of the key
+ * - const void* message           | The encrypted message
+ * - size_t size                   | The size of the encrypted message
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The connection failed
+ * - 3 | The agent does not have the key
+ * - 4 | The agent failed to decrypt the message
+ */
+int keyagent_decrypt(void* result, size_t* rsize, size_t max, int fd, const uint8_t fingerprint[32], const void* message, size_t size)
+{
+  // The message size 0 is the start of a batch request
+  if(!result || !rsize || !fingerprint || !message || size == 0 || size > KEYAGENT_MESSAGE_MAX)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 1;
+  }
+
+  // 1. Send the request
+  uint8_t header[32 + 2];
+
+  memcpy(header, fingerprint, 32);
+
+  header[32] = (uint8_t) (size >> 8);
+  header[33] = (uint8_t)  size;
+
+  if(keyagent_write(fd, header, sizeof(header)) != 0 || keyagent_write(fd, message, size) != 0)
+  {
+    return 2;
+  }
+
+  // 2. Receive the response
+  uint8_t response[1 + 2];
+
+  if(keyagent_read(fd, response, sizeof(response)) != 0) return 2;
+
+  size_t result_size = ((size_t) response[1] << 8) | response[2];
+
+  if(response[0] == KEYAGENT_NO_KEY) return 3;
+
+  if(response[0] != KEYAGENT_SUCCESS) return 4;
+
+  if(result_size > max) return 2;
+
+  if(keyagent_read(fd, result, result_size) != 0) return 2;
+
+  *rsize = result_size;
+
+  return 0;
+}
+
+/*
+ * Decrypt many RSA encrypted messages in one request, with the key agent's
+ * secret key. The agent decrypts the messages in parallel.
+ *
+ * The size of a message that the agent failed to decrypt is set to SIZE_MAX
+ *
+ * PARAMS
+ * - void* results[]               | The decrypted messages
+ * - size_t rsizes[]               | The sizes of the decrypted messages
+ * - size_t max                    | The room in every result
+ * - int fd                        | The connection to the agent
+ * - const uint8_t fingerprint[32] | The fingerprint of the key
+ * - const void* messages[]        | The encrypted messages
+ * - const size_t sizes[]          | The sizes of the encrypted messages
+ * - size_t count                  | The amount of messages
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The connection failed
+ * - 3 | The agent does not have the key
+ * - 4 | The agent failed to decrypt the messages
+ */
+int keyagent_decrypt_batch(void* results[], size_t rsizes[], size_t max, int fd, const uint8_t fingerprint[32], const void* messages[], const size_t sizes[], size_t count)
+{
+  if(!results || !rsizes || !fingerprint || !messages || !sizes || count == 0 || count > KEYAGENT_BATCH_MAX)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 1;
+  }
+
+  for(size_t index = 0; index < count; index++)
+  {
+    if(!results[index] || !messages[index] || sizes[index] == 0 || sizes[index] > KEYAGENT_MESSAGE_MAX)
+    {
+      errno = EINVAL; // Invalid argument
+
+      return 1;
+    }
+  }
+
+  // 1. Send the request
+  uint8_t header[32 + 2 + 2];
+
+  memcpy(header, fingerprint, 32);
+
+  header[32] = 0;
+  header[33] = 0;
+  header[34] = (uint8_t) (count >> 8);
+  header[35] = (uint8_t)  count;
+
+  if(keyagent_write(fd, header, sizeof(header)) != 0) return 2;
+
+  for(size_t index = 0; index < count; index++)
+  {
+    uint8_t size[2] = { (uint8_t) (sizes[index] >> 8), (uint8_t) sizes[index] };
+
+    if(keyagent_write(fd, size, sizeof(size)) != 0 || keyagent_write(fd, messages[index], sizes[index]) != 0)
+    {
+      return 2;
+    }
+  }
+
+  // 2. Receive the response
+  uint8_t response[1 + 2];
+
+  if(keyagent_read(fd, response, sizeof(response)) != 0) return 2;
+
+  if(response[0] == KEYAGENT_NO_KEY) return 3;
+
+  if(response[0] != KEYAGENT_SUCCESS) return 4;
+
+  if((((size_t) response[1] << 8) | response[2]) != count) return 2;
+
+  // 3. Receive the result of every message
+  for(size_t index = 0; index < count; index++)
+  {
+    if(keyagent_read(fd, response, sizeof(response)) != 0) return 2;
+
+    size_t result_size = ((size_t) response[1] << 8) | response[2];
+
+    if(response[0] != KEYAGENT_SUCCESS)
+    {
+      if(result_size != 0) return 2;
+
+      rsizes[index] = SIZE_MAX;
+
+      continue;
+    }
+
+    if(result_size > max) return 2;
+
+    if(keyagent_read(fd, results[index], result_size) != 0) return 2;
+
+    rsizes[index] = result_size;
+  }
+
+  return 0;
+}
+
+#endif // KEYAGENT_IMPLEMENT
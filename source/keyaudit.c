@@ -0,0 +1,729 @@
+/*
+ * keyaudit - find RSA keys that share a prime
+ *
+ * Written by Hampus Fridholm
+ *
+ * Credit: https://factorable.net/weakkeys12.extended.pdf
+ *
+ * Last updated: 2026-10-19
+ *
+ *
+ * Two moduli that share a prime are both factored by their gcd.
+ * Instead of the gcd of every pair, the moduli are multiplied
+ * together in a product tree, and the product P is reduced down a
+ * remainder tree, modulo the squares of the tree nodes. At the leaves,
+ * gcd(n, (P mod n^2) / n) is the product of the primes of n that
+ * are shared with another modulus.
+ *
+ * Every level of the trees is split between all cores
+ */
+
+#define RSA_IMPLEMENT
+#include "rsa.h"
+
+#define BASE64_IMPLEMENT
+#include "base64.h"
+
+#define FILE_IMPLEMENT
+#include "file.h"
+
+#define DEBUG_IMPLEMENT
+#include "debug.h"
+
+#define SHA256_IMPLEMENT
+#include "sha256.h"
+
+#ifdef RSA_MONT
+#define MONT_IMPLEMENT
+#include "mont.h"
+#endif // RSA_MONT
+
+#define KEYRING_IMPLEMENT
+#include "keyring.h"
+
+#define RANDOM_IMPLEMENT
+#include "random.h"
+
+#define CHACHA20POLY1305_IMPLEMENT
+#include "chacha20poly1305.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <argp.h>
+#include <unistd.h>
+#include <pthread.h>
+
+
+#define PKEY_FILE "pkey"
+
+
+static char doc[] = "keyaudit - find RSA keys that share a prime";
+
+static char args_doc[] = "[FILE|DIR]...";
+
+static struct argp_option options[] =
+{
+  { "keyring", 'k', "FILE", 0, "Keyring file, every public key is audited" },
+  { "quiet",   'q', 0,      0, "Don't produce any output" },
+  { "debug",   'x', 0,      0, "Output debug messages" },
+  { 0 }
+};
+
+struct args
+{
+  char** paths;
+  size_t path_count;
+  char*  keyring;
+  bool   quiet;
+  bool   debug;
+};
+
+struct args args =
+{
+  .paths      = NULL,
+  .path_count = 0,
+  .keyring    = NULL,
+  .quiet      = false,
+  .debug      = false
+};
+
+/*
+ * This is the option parsing function used by argp
+ */
+static error_t opt_parse(int key, char* arg, struct argp_state* state)
+{
+  struct args* args = state->input;
+
+  switch(key)
+  {
+    case 'k':
+      args->keyring = arg;
+      break;
+
+    case 'q':
+      if(args->debug) argp_usage(state);
+
+      args->quiet = true;
+      break;
+
+    case 'x':
+      if(args->quiet) argp_usage(state);
+
+      args->debug = true;
+      break;
+
+    case ARGP_KEY_ARGS:
+      args->paths      = state->argv + state->next;
+      args->path_count = state->argc - state->next;
+      break;
+
+    case ARGP_KEY_END:
+      if(args->path_count == 0 && !args->keyring) argp_usage(state);
+      break;
+
+    default:
+      return ARGP_ERR_UNKNOWN;
+  }
+
+  return 0;
+}
+
+/*
+ * An audited key, with the file or keyring name it came from
+ */
+typedef struct
+{
+  char* name;
+  mpz_t n;
+} audit_key_t;
+
+static audit_key_t* keys = NULL;
+
+static size_t key_count    = 0;
+static size_t key_capacity = 0;
+
+/*
+ * Add a modulus to the audited keys
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to allocate memory
+ */
+static int key_add(const char* name, mpz_srcptr n)
+{
+  if(key_count == key_capacity)
+  {
+    size_t new_capacity = key_capacity ? (key_capacity * 2) : 1024;
+
+    audit_key_t* new_keys = realloc(keys, sizeof(audit_key_t) * new_capacity);
+
+    if(!new_keys) return 1;
+
+    keys         = new_keys;
+    key_capacity = new_capacity;
+  }
+
+  keys[key_count].name = strdup(name);
+
+  mpz_init_set(keys[key_count].n, n);
+
+  key_count++;
+
+  return 0;
+}
+
+/*
+ * Free the audited keys
+ */
+static void keys_free(void)
+{
+  for(size_t index = 0; index < key_count; index++)
+  {
+    free(keys[index].name);
+
+    mpz_clear(keys[index].n);
+  }
+
+  free(keys);
+}
+
+/*
+ * Load a base64 encoded public key file
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to read the file
+ * - 2 | The file is not an RSA public key
+ */
+static int file_key_load(const char* filepath)
+{
+  size_t file_size = file_size_get(filepath);
+
+  if(file_size == 0) return 1;
+
+  char* base64 = malloc(sizeof(char) * file_size);
+
+  if(!base64) return 1;
+
+  if(file_read(base64, file_size, filepath) == 0)
+  {
+    free(base64);
+
+    return 1;
+  }
+
+  char*  buffer;
+  size_t buffer_size;
+
+  int status = base64_decode(&buffer, &buffer_size, base64, file_size);
+
+  free(base64);
+
+  if(status != 0) return 2;
+
+  pkey_t key;
+
+  status = rsa_pkey_decode(&key, buffer, buffer_size);
+
+  free(buffer);
+
+  if(status != 0) return 2;
+
+  status = key_add(filepath, key.n);
+
+  rsa_pkey_free(&key);
+
+  return (status == 0) ? 0 : 1;
+}
+
+/*
+ * Load the public key files in a path
+ *
+ * A file is loaded as it is, and a directory
+ * is searched for files named PKEY_FILE
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The path is missing or unreadable
+ * - 2 | No public key was found in the path
+ */
+static int path_keys_load(const char* path)
+{
+  if(access(path, R_OK) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keyaudit: %s: %s\n", path, strerror(errno));
+
+    return 1;
+  }
+
+  char** files = NULL;
+  size_t count = 0;
+
+  files_get(&files, &count, path, -1);
+
+  size_t loaded = 0;
+
+  for(size_t index = 0; index < count; index++)
+  {
+    const char* name = strrchr(files[index], '/');
+
+    name = name ? (name + 1) : files[index];
+
+    if(strcmp(files[index], path) != 0 && strcmp(name, PKEY_FILE) != 0) continue;
+
+    int status = file_key_load(files[index]);
+
+    if(status == 0)
+    {
+      loaded++;
+    }
+    else if(!args.quiet)
+    {
+      fprintf(stderr, "keyaudit: %s: %s\n", files[index],
+        (status == 1) ? "Failed to read file" : "Not an RSA public key");
+    }
+  }
+
+  files_free(files, count);
+
+  if(loaded == 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keyaudit: %s: No public key found\n", path);
+
+    return 2;
+  }
+
+  return 0;
+}
+
+/*
+ * Load every public key in the keyring
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to open the keyring
+ * - 2 | No public key was found in the keyring
+ */
+static int keyring_keys_load(const char* path)
+{
+  keyring_t keyring;
+
+  if(keyring_open(&keyring, path) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keyaudit: Failed to open keyring\n");
+
+    return 1;
+  }
+
+  size_t loaded = 0;
+
+  for(size_t index = 0; index < keyring.count; index++)
+  {
+    keyring_key_t found;
+
+    if(keyring_key_get(&found, &keyring, index) != 0) continue;
+
+    if(found.type != KEYRING_PUBLIC) continue;
+
+    pkey_t key;
+
+    if(rsa_pkey_decode(&key, found.key, found.size) != 0) continue;
+
+    char name[KEYRING_NAME_SIZE + 16];
+
+    snprintf(name, sizeof(name), "%s:%s", path, found.name);
+
+    if(key_add(name, key.n) == 0) loaded++;
+
+    rsa_pkey_free(&key);
+  }
+
+  keyring_close(&keyring);
+
+  if(loaded == 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keyaudit: %s: No public key found\n", path);
+
+    return 2;
+  }
+
+  return 0;
+}
+
+/*
+ * A level of the product tree or the remainder tree
+ */
+typedef struct
+{
+  mpz_t* values;
+  size_t count;
+} level_t;
+
+/*
+ * The part of a level that one thread makes
+ *
+ * The thread makes the values index, index + step, index + 2 * step...
+ */
+typedef struct
+{
+  const level_t* source; // The level the values are made from
+  const level_t* tree;   // The product tree level of the made level
+  level_t*       target; // The level that is made
+  size_t         index;
+  size_t         step;
+} level_job_t;
+
+/*
+ * Get the amount of threads, one for every core
+ */
+static size_t threads_get(void)
+{
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+  return (cores > 0) ? cores : 1;
+}
+
+/*
+ * Make the values of a product tree level, from the level below
+ */
+static void* product_thread(void* arg)
+{
+  level_job_t* job = arg;
+
+  for(size_t index = job->index; index < job->target->count; index += job->step)
+  {
+    if(2 * index + 1 < job->source->count)
+    {
+      mpz_mul(job->target->values[index], job->source->values[2 * index], job->source->values[2 * index + 1]);
+    }
+    else mpz_set(job->target->values[index], job->source->values[2 * index]);
+  }
+
+  return NULL;
+}
+
+/*
+ * Make the values of a remainder tree level, from the level above
+ *
+ * Every value is the value above it, modulo the square of its tree node
+ */
+static void* remainder_thread(void* arg)
+{
+  level_job_t* job = arg;
+
+  mpz_t square;
+  mpz_init(square);
+
+  for(size_t index = job->index; index < job->target->count; index += job->step)
+  {
+    mpz_mul(square, job->tree->values[index], job->tree->values[index]);
+
+    mpz_mod(job->target->values[index], job->source->values[index / 2], square);
+  }
+
+  mpz_clear(square);
+
+  return NULL;
+}
+
+/*
+ * Make the shared factors of the moduli, from the remainders of the leaves
+ */
+static void* gcd_thread(void* arg)
+{
+  level_job_t* job = arg;
+
+  for(size_t index = job->index; index < job->target->count; index += job->step)
+  {
+    mpz_divexact(job->target->values[index], job->source->values[index], job->tree->values[index]);
+
+    mpz_gcd(job->target->values[index], job->target->values[index], job->tree->values[index]);
+  }
+
+  return NULL;
+}
+
+/*
+ * Run a level function on all cores
+ *
+ * The calling thread makes the first part, and every
+ * part whose thread couldn't be created
+ */
+static void level_threads_run(void* (*level_func)(void*), const level_t* source, const level_t* tree, level_t* target)
+{
+  size_t threads = threads_get();
+
+  if(threads > target->count) threads = target->count;
+
+  pthread_t   thread_ids[threads];
+  level_job_t jobs[threads];
+  bool        created[threads];
+
+  for(size_t index = 0; index < threads; index++)
+  {
+    jobs[index] = (level_job_t) { source, tree, target, index, threads };
+  }
+
+  for(size_t index = 1; index < threads; index++)
+  {
+    created[index] = (pthread_create(&thread_ids[index], NULL, level_func, &jobs[index]) == 0);
+  }
+
+  level_func(&jobs[0]);
+
+  for(size_t index = 1; index < threads; index++)
+  {
+    if(created[index])
+    {
+      pthread_join(thread_ids[index], NULL);
+    }
+    else level_func(&jobs[index]);
+  }
+}
+
+/*
+ * Allocate a level of count values
+ */
+static void level_init(level_t* level, size_t count)
+{
+  level->values = malloc(sizeof(mpz_t) * count);
+  level->count  = count;
+
+  for(size_t index = 0; index < count; index++)
+  {
+    mpz_init(level->values[index]);
+  }
+}
+
+/*
+ * Free the values of a level
+ */
+static void level_free(level_t* level)
+{
+  for(size_t index = 0; index < level->count; index++)
+  {
+    mpz_clear(level->values[index]);
+  }
+
+  free(level->values);
+
+  level->values = NULL;
+  level->count  = 0;
+}
+
+/*
+ * Get the factor of every modulus that it shares with the other moduli
+ *
+ * The factor is 1 if the modulus shares no prime
+ *
+ * PARAMS
+ * - mpz_t factors[] | The initialized factors, one for every key
+ */
+static void batch_gcd(mpz_t factors[])
+{
+  // The height of the product tree, where the top level has one value
+  size_t height = 1;
+
+  for(size_t count = key_count; count > 1; count = (count + 1) / 2) height++;
+
+  level_t tree[height];
+
+  // 1. The leaves of the product tree are the moduli
+  level_init(&tree[0], key_count);
+
+  for(size_t index = 0; index < key_count; index++)
+  {
+    mpz_set(tree[0].values[index], keys[index].n);
+  }
+
+  // 2. Multiply the pairs of every level, up to the product of all moduli
+  for(size_t level = 1; level < height; level++)
+  {
+    level_init(&tree[level], (tree[level - 1].count + 1) / 2);
+
+    level_threads_run(product_thread, &tree[level - 1], NULL, &tree[level]);
+
+    if(args.debug)
+      info_print("Product tree level %ld: %ld values", (long) level, (long) tree[level].count);
+  }
+
+  // 3. Reduce the product down the remainder tree
+  level_t upper = { NULL, 0 };
+
+  level_init(&upper, 1);
+
+  mpz_set(upper.values[0], tree[height - 1].values[0]);
+
+  level_free(&tree[height - 1]);
+
+  for(size_t level = height - 1; level-- > 0;)
+  {
+    level_t lower;
+
+    level_init(&lower, tree[level].count);
+
+    level_threads_run(remainder_thread, &upper, &tree[level], &lower);
+
+    level_free(&upper);
+
+    if(level > 0) level_free(&tree[level]);
+
+    upper = lower;
+
+    if(args.debug)
+      info_print("Remainder tree level %ld: %ld values", (long) level, (long) lower.count);
+  }
+
+  // 4. The shared factors, from the remainders modulo the squared moduli
+  level_t result = { factors, key_count };
+
+  if(height > 1)
+  {
+    level_threads_run(gcd_thread, &upper, &tree[0], &result);
+  }
+  else mpz_set_ui(factors[0], 1);
+
+  level_free(&upper);
+
+  level_free(&tree[0]);
+}
+
+/*
+ * Report the pairs of keys that share a prime
+ *
+ * Only the keys with a shared factor are compared,
+ * so this is fast even for many keys
+ *
+ * RETURN (size_t count)
+ * - The amount of keys that share a prime
+ */
+static size_t shared_keys_report(mpz_t factors[])
+{
+  size_t* shared = malloc(sizeof(size_t) * key_count);
+
+  if(!shared) return 0;
+
+  size_t count = 0;
+
+  for(size_t index = 0; index < key_count; index++)
+  {
+    if(mpz_cmp_ui(factors[index], 1) > 0) shared[count++] = index;
+  }
+
+  mpz_t gcd;
+  mpz_init(gcd);
+
+  for(size_t first = 0; first < count && !args.quiet; first++)
+  {
+    for(size_t second = first + 1; second < count; second++)
+    {
+      audit_key_t* a = &keys[shared[first]];
+      audit_key_t* b = &keys[shared[second]];
+
+      mpz_gcd(gcd, a->n, b->n);
+
+      if(mpz_cmp(a->n, b->n) == 0)
+      {
+        printf("%s and %s have the same modulus\n", a->name, b->name);
+      }
+      else if(mpz_cmp_ui(gcd, 1) > 0)
+      {
+        printf("%s and %s share a prime\n", a->name, b->name);
+      }
+    }
+  }
+
+  mpz_clear(gcd);
+
+  free(shared);
+
+  return count;
+}
+
+static struct argp argp = { options, opt_parse, args_doc, doc };
+
+/*
+ * RETURN (int status)
+ * - 0 | No keys share a prime
+ * - 1 | Failed to load keys, or a path has no keys
+ * - 2 | Some keys share a prime
+ */
+int main(int argc, char* argv[])
+{
+  argp_parse(&argp, argc, argv, 0, 0, &args);
+
+  if(args.debug)
+    info_print("Start of main");
+
+  // 1. Load the public keys, and remember if a path gave none
+  bool failed = false;
+
+  for(size_t index = 0; index < args.path_count; index++)
+  {
+    if(path_keys_load(args.paths[index]) != 0) failed = true;
+  }
+
+  if(args.keyring && keyring_keys_load(args.keyring) != 0)
+  {
+    failed = true;
+  }
+
+  if(key_count == 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keyaudit: No public key is loaded\n");
+
+    keys_free();
+
+    return 1;
+  }
+
+  if(args.debug)
+    info_print("Loaded %ld keys", (long) key_count);
+
+  // 2. Get the shared factors of all moduli
+  mpz_t* factors = malloc(sizeof(mpz_t) * key_count);
+
+  if(!factors)
+  {
+    keys_free();
+
+    return 1;
+  }
+
+  for(size_t index = 0; index < key_count; index++)
+  {
+    mpz_init(factors[index]);
+  }
+
+  batch_gcd(factors);
+
+  // 3. Report the keys that share a prime
+  size_t count = shared_keys_report(factors);
+
+  if(!args.quiet)
+    printf("%zu of %zu keys share a prime\n", count, key_count);
+
+  for(size_t index = 0; index < key_count; index++)
+  {
+    mpz_clear(factors[index]);
+  }
+
+  free(factors);
+
+  keys_free();
+
+  if(args.debug)
+    info_print("End of main");
+
+  if(count > 0) return 2;
+
+  return failed ? 1 : 0;
+}
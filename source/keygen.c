@@ -3,7 +3,7 @@
  *
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-11-21
+ * Last updated: 2026-10-19
  */
 
 #define RSA_IMPLEMENT
@@ -18,19 +18,83 @@
 #define DEBUG_IMPLEMENT
 #include "debug.h"
 
+#define SHA256_IMPLEMENT
+#include "sha256.h"
+
+#ifdef RSA_MONT
+#define MONT_IMPLEMENT
+#include "mont.h"
+#endif // RSA_MONT
+
+#define KEYRING_IMPLEMENT
+#include "keyring.h"
+
+#define X25519_IMPLEMENT
+#include "x25519.h"
+
+#define ED25519_IMPLEMENT
+#include "ed25519.h"
+
+#define SHA512_IMPLEMENT
+#include "sha512.h"
+
+#define MLKEM_IMPLEMENT
+#include "mlkem.h"
+
+#define SHA3_IMPLEMENT
+#include "sha3.h"
+
+#define RANDOM_IMPLEMENT
+#include "random.h"
+
+#define CHACHA20POLY1305_IMPLEMENT
+#include "chacha20poly1305.h"
+
 #include <stdio.h>
 #include <string.h>
-#include <time.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <argp.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <limits.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/stat.h>
 
 
 #define SKEY_FILE "skey"
 #define PKEY_FILE "pkey"
 
+// The X25519, Ed25519 and ML-KEM keys are kept next to the other keys
+#define X25519_SKEY_FILE  "skey.x25519"
+#define X25519_PKEY_FILE  "pkey.x25519"
+
+#define ED25519_SKEY_FILE "skey.ed25519"
+#define ED25519_PKEY_FILE "pkey.ed25519"
+
+#define MLKEM_SKEY_FILE   "skey.mlkem"
+#define MLKEM_PKEY_FILE   "pkey.mlkem"
+
 #define KEY_DIR "."
 
+#define POOL_COUNT 8
+
+#define POOL_KEY_PREFIX   "key-"
+#define POOL_TEMP_PREFIX  ".tmp-"
+#define POOL_CLAIM_PREFIX ".claim-"
+#define POOL_LOCK_FILE    ".lock"
+
+typedef enum
+{
+  TYPE_RSA,
+  TYPE_X25519,
+  TYPE_ED25519,
+  TYPE_MLKEM
+} ktype_t;
+
 
 static char doc[] = "keygen - asymetric key generation utillity";
 
@@ -38,31 +102,55 @@ static char args_doc[] = "";
 
 static struct argp_option options[] =
 {
-  { "dir",    'd', "DIR",   0, "Key directory" },
-  { "bytes",  'b', "COUNT", 0, "Key modulus size" },
-  { "force",  'f', 0,       0, "Overwrite dir keys" },
-  { "quiet",  'q', 0,       0, "Don't produce any output" },
-  { "silent", 's', 0,       OPTION_ALIAS },
-  { "debug",  'x', 0,       0, "Output debug messages" },
+  { "dir",      'd', "DIR",   0, "Key directory" },
+  { "type",     't', "TYPE",  0, "Key type, rsa, x25519, ed25519 or mlkem768" },
+  { "bytes",    'b', "COUNT", 0, "Key modulus size in bytes" },
+  { "primes",   'P', "COUNT", 0, "Amount of primes in the secret key" },
+  { "force",    'f', 0,       0, "Overwrite dir keys" },
+  { "extended", 'X', 0,       0, "Write the secret key in the extended format" },
+  { "pool",     'p', "DIR",   0, "Take the keys from a key pool" },
+  { "count",    'n', "COUNT", 0, "Keys to keep in the key pool" },
+  { "fill",     'F', 0,       0, "Only fill the key pool" },
+  { "keyring",  'k', "FILE",  0, "Add the keys to a keyring" },
+  { "name",     'N', "NAME",  0, "Name of the keys in the keyring" },
+  { "quiet",    'q', 0,       0, "Don't produce any output" },
+  { "silent",   's', 0,       OPTION_ALIAS },
+  { "debug",    'x', 0,       0, "Output debug messages" },
   { 0 }
 };
 
 struct args
 {
-  char*  dir;
-  size_t bytes;
-  bool   force;
-  bool   quiet;
-  bool   debug;
+  char*   dir;
+  ktype_t type;
+  size_t  bytes;
+  size_t  primes;
+  bool    force;
+  bool    extended;
+  char*   pool;
+  size_t  count;
+  bool    fill;
+  char*   keyring;
+  char*   name;
+  bool    quiet;
+  bool    debug;
 };
 
 struct args args =
 {
-  .dir   = KEY_DIR,
-  .bytes = 0,
-  .force = false,
-  .quiet = false,
-  .debug = false
+  .dir      = KEY_DIR,
+  .type     = TYPE_RSA,
+  .bytes    = 0,
+  .primes   = 2,
+  .force    = false,
+  .extended = false,
+  .pool     = NULL,
+  .count    = POOL_COUNT,
+  .fill     = false,
+  .keyring  = NULL,
+  .name     = NULL,
+  .quiet    = false,
+  .debug    = false
 };
 
 /*
@@ -78,14 +166,62 @@ static error_t opt_parse(int key, char* arg, struct argp_state* state)
       args->dir = arg;
       break;
 
+    case 't':
+      if(strcmp(arg, "rsa") == 0)
+      {
+        args->type = TYPE_RSA;
+      }
+      else if(strcmp(arg, "x25519") == 0)
+      {
+        args->type = TYPE_X25519;
+      }
+      else if(strcmp(arg, "ed25519") == 0)
+      {
+        args->type = TYPE_ED25519;
+      }
+      else if(strcmp(arg, "mlkem768") == 0)
+      {
+        args->type = TYPE_MLKEM;
+      }
+      else argp_usage(state);
+      break;
+
     case 'b':
       args->bytes = arg ? atoi(arg) : 0;
       break;
 
+    case 'P':
+      args->primes = arg ? atoi(arg) : 0;
+      break;
+
     case 'f':
       args->force = true;
       break;
 
+    case 'X':
+      args->extended = true;
+      break;
+
+    case 'p':
+      args->pool = arg;
+      break;
+
+    case 'n':
+      args->count = arg ? atoi(arg) : 0;
+      break;
+
+    case 'F':
+      args->fill = true;
+      break;
+
+    case 'k':
+      args->keyring = arg;
+      break;
+
+    case 'N':
+      args->name = arg;
+      break;
+
     case 'q': case 's':
       if(args->debug) argp_usage(state);
 
@@ -164,7 +300,7 @@ static int pkey_base64_encode(char** result, size_t* size, const pkey_t* key)
 /*
  *
  */
-static int pkey_handler(pkey_t* key)
+static int pkey_handler(pkey_t* key, const char* dir)
 {
   char*  base64;
   size_t size;
@@ -174,67 +310,783 @@ static int pkey_handler(pkey_t* key)
     return 1;
   }
 
-  if(dir_file_size_get(args.dir, PKEY_FILE) > 0 && !args.force)
+  if(dir_file_size_get(dir, PKEY_FILE) > 0 && !args.force)
+  {
+    free(base64);
+
+    return 2;
+  }
+
+  size_t write_size = dir_file_write(base64, size, dir, PKEY_FILE);
+
+  free(base64);
+
+  return (write_size == size) ? 0 : 3;
+}
+
+/*
+ * Write the secret key file
+ *
+ * The extended format is binary, and is mapped by the programs
+ * that use the key, instead of decoded
+ */
+static int skey_handler(skey_t* key, const char* dir)
+{
+  char*  buffer;
+  size_t size;
+
+  int status = args.extended ? rsa_skey_ext_encode(&buffer, &size, key)
+                             : skey_base64_encode(&buffer, &size, key);
+
+  if(status != 0)
+  {
+    return 1;
+  }
+
+  if(dir_file_size_get(dir, SKEY_FILE) > 0 && !args.force)
   {
+    free(buffer);
+
     return 2;
   }
 
-  dir_file_write(base64, size, args.dir, PKEY_FILE);
+  size_t write_size = dir_file_write(buffer, size, dir, SKEY_FILE);
+
+  free(buffer);
+
+  return (write_size == size) ? 0 : 3;
+}
+
+/*
+ * Add the secret and the public key to the keyring
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to encode keys
+ * - 2 | The keyring already has the keys
+ * - 3 | Failed to add the keys
+ */
+static int keyring_handler(skey_t* skey, pkey_t* pkey)
+{
+  uint8_t fingerprint[32];
+
+  if(rsa_pkey_fingerprint(fingerprint, pkey) != 0)
+  {
+    return 1;
+  }
+
+  char*  buffer;
+  size_t size;
+
+  if(rsa_pkey_encode(&buffer, &size, pkey) != 0)
+  {
+    return 1;
+  }
+
+  int status = keyring_key_add(args.keyring, args.name, KEYRING_PUBLIC, fingerprint, buffer, size);
+
+  free(buffer);
+
+  if(status != 0) return (status == 2) ? 2 : 3;
+
+  if(rsa_skey_encode(&buffer, &size, skey) != 0)
+  {
+    return 1;
+  }
+
+  status = keyring_key_add(args.keyring, args.name, KEYRING_SECRET, fingerprint, buffer, size);
+
+  free(buffer);
+
+  if(status != 0) return (status == 2) ? 2 : 3;
 
   return 0;
 }
 
 /*
+ * Write an encoded X25519, Ed25519 or ML-KEM key as base64 to the key directory
  *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to encode the key
+ * - 2 | The file already exists
+ * - 3 | Failed to write the file
  */
-static int skey_handler(skey_t* key)
+static int curve_key_handler(const uint8_t* encoded, size_t encoded_size, const char* dir, const char* name)
 {
   char*  base64;
   size_t size;
 
-  if(skey_base64_encode(&base64, &size, key) != 0)
+  if(base64_encode(&base64, &size, encoded, encoded_size) != 0)
+  {
+    return 1;
+  }
+
+  if(dir_file_size_get(dir, name) > 0 && !args.force)
+  {
+    free(base64);
+
+    return 2;
+  }
+
+  size_t write_size = dir_file_write(base64, size, dir, name);
+
+  free(base64);
+
+  return (write_size == size) ? 0 : 3;
+}
+
+/*
+ * Generate X25519 or Ed25519 keys, and write them to their own key files
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to generate the keys
+ * - 2 | Failed to write the keys
+ */
+static int curve_handler(void)
+{
+  uint8_t skey[32];
+  uint8_t pkey[32];
+
+  // Both kinds of keys have the same encoded size
+  uint8_t encoded_skey[X25519_ENCODED_SIZE];
+  uint8_t encoded_pkey[X25519_ENCODED_SIZE];
+
+  const char* skey_name;
+  const char* pkey_name;
+
+  int status;
+
+  if(args.type == TYPE_X25519)
   {
+    skey_name = X25519_SKEY_FILE;
+    pkey_name = X25519_PKEY_FILE;
+
+    status = x25519_keys_gen(skey, pkey);
+
+    x25519_key_encode(encoded_skey, skey);
+    x25519_key_encode(encoded_pkey, pkey);
+  }
+  else
+  {
+    skey_name = ED25519_SKEY_FILE;
+    pkey_name = ED25519_PKEY_FILE;
+
+    status = ed25519_keys_gen(skey, pkey);
+
+    ed25519_key_encode(encoded_skey, skey);
+    ed25519_key_encode(encoded_pkey, pkey);
+  }
+
+  memset(skey, '\0', sizeof(skey));
+
+  if(status != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keygen : Failed to generate keys\n");
+
+    memset(encoded_skey, '\0', sizeof(encoded_skey));
+
     return 1;
   }
 
-  if(dir_file_size_get(args.dir, SKEY_FILE) > 0 && !args.force)
+  status = 0;
+
+  if(curve_key_handler(encoded_pkey, sizeof(encoded_pkey), args.dir, pkey_name) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keygen : Failed to write public key\n");
+
+    status = 2;
+  }
+
+  if(curve_key_handler(encoded_skey, sizeof(encoded_skey), args.dir, skey_name) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keygen : Failed to write secret key\n");
+
+    status = 2;
+  }
+
+  memset(encoded_skey, '\0', sizeof(encoded_skey));
+
+  return status;
+}
+
+/*
+ * Generate ML-KEM-768 keys, and write them to their own key files
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to generate the keys
+ * - 2 | Failed to write the keys
+ */
+static int mlkem_handler(void)
+{
+  uint8_t skey[MLKEM_SKEY_SIZE];
+  uint8_t pkey[MLKEM_PKEY_SIZE];
+
+  if(mlkem_keys_gen(pkey, skey) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keygen : Failed to generate keys\n");
+
+    return 1;
+  }
+
+  uint8_t encoded_skey[MLKEM_ENCODED_SIZE(MLKEM_SKEY_SIZE)];
+  uint8_t encoded_pkey[MLKEM_ENCODED_SIZE(MLKEM_PKEY_SIZE)];
+
+  mlkem_key_encode(encoded_skey, skey, MLKEM_SKEY_SIZE);
+  mlkem_key_encode(encoded_pkey, pkey, MLKEM_PKEY_SIZE);
+
+  memset(skey, '\0', sizeof(skey));
+
+  int status = 0;
+
+  if(curve_key_handler(encoded_pkey, sizeof(encoded_pkey), args.dir, MLKEM_PKEY_FILE) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keygen : Failed to write public key\n");
+
+    status = 2;
+  }
+
+  if(curve_key_handler(encoded_skey, sizeof(encoded_skey), args.dir, MLKEM_SKEY_FILE) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keygen : Failed to write secret key\n");
+
+    status = 2;
+  }
+
+  memset(encoded_skey, '\0', sizeof(encoded_skey));
+
+  return status;
+}
+
+/*
+ * Check if the modulus size is supported by rsa_keys_gen
+ */
+static bool modulus_bits_valid(size_t bits)
+{
+  return (bits >= RSA_MODULUS_MIN && bits <= RSA_MODULUS_MAX && bits % 16 == 0);
+}
+
+/*
+ * Get the name prefix of the ready keypairs of a modulus size
+ *
+ * The ready keypairs are named key-<bits>-<random>, and
+ * keypairs with more than two primes key-<bits>p<primes>-<random>
+ */
+static void pool_prefix_get(char prefix[32], size_t bits)
+{
+  if(args.primes > 2)
+  {
+    snprintf(prefix, 32, "%s%zup%zu-", POOL_KEY_PREFIX, bits, args.primes);
+  }
+  else snprintf(prefix, 32, "%s%zu-", POOL_KEY_PREFIX, bits);
+}
+
+/*
+ * Count the ready keypairs in the key pool
+ */
+static size_t pool_keys_count(const char* pool, size_t bits)
+{
+  DIR* dir = opendir(pool);
+
+  if(!dir) return 0;
+
+  char prefix[32];
+  pool_prefix_get(prefix, bits);
+
+  size_t count = 0;
+
+  struct dirent* entry;
+
+  while((entry = readdir(dir)))
+  {
+    if(strncmp(entry->d_name, prefix, strlen(prefix)) == 0) count++;
+  }
+
+  closedir(dir);
+
+  return count;
+}
+
+/*
+ * Remove the key files and the keypair directory
+ */
+static void pool_dir_remove(const char* dirpath)
+{
+  dir_file_remove(dirpath, PKEY_FILE);
+  dir_file_remove(dirpath, SKEY_FILE);
+
+  rmdir(dirpath);
+}
+
+/*
+ * Remove the keypair directories left in the key pool by crashed runs
+ *
+ * The temporary directories are only created by the process that
+ * fills the pool, so when the pool is locked, they are all left over.
+ * A claimed directory is left over if its process is no longer running.
+ */
+static void pool_stale_remove(const char* pool)
+{
+  DIR* dir = opendir(pool);
+
+  if(!dir) return;
+
+  struct dirent* entry;
+
+  while((entry = readdir(dir)))
+  {
+    bool stale = (strncmp(entry->d_name, POOL_TEMP_PREFIX, strlen(POOL_TEMP_PREFIX)) == 0);
+
+    if(strncmp(entry->d_name, POOL_CLAIM_PREFIX, strlen(POOL_CLAIM_PREFIX)) == 0)
+    {
+      pid_t pid = atoi(entry->d_name + strlen(POOL_CLAIM_PREFIX));
+
+      stale = (pid > 0 && kill(pid, 0) != 0 && errno == ESRCH);
+    }
+
+    if(!stale) continue;
+
+    char path[strlen(pool) + 1 + strlen(entry->d_name) + 1];
+
+    sprintf(path, "%s/%s", pool, entry->d_name);
+
+    pool_dir_remove(path);
+  }
+
+  closedir(dir);
+}
+
+/*
+ * Generate a keypair into the key pool
+ *
+ * The keys are written to a temporary directory, which is renamed
+ * when both keys are written. That way, a keypair that is not
+ * completely written is never handed out.
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to create temporary directory
+ * - 2 | Failed to generate keys
+ * - 3 | Failed to write keys
+ * - 4 | Failed to make keypair ready
+ */
+static int pool_key_gen(const char* pool, size_t bits)
+{
+  char temp[strlen(pool) + 32];
+
+  sprintf(temp, "%s/%sXXXXXX", pool, POOL_TEMP_PREFIX);
+
+  if(!mkdtemp(temp)) return 1;
+
+  skey_t skey;
+  pkey_t pkey;
+
+  if(rsa_multi_keys_gen(&skey, &pkey, bits, args.primes) != 0)
   {
+    rmdir(temp);
+
     return 2;
   }
 
-  dir_file_write(base64, size, args.dir, SKEY_FILE);
+  int status = (pkey_handler(&pkey, temp) != 0 || skey_handler(&skey, temp) != 0);
+
+  rsa_keys_free(&skey, &pkey);
+
+  if(status != 0)
+  {
+    pool_dir_remove(temp);
+
+    return 3;
+  }
+
+  char prefix[32];
+  pool_prefix_get(prefix, bits);
+
+  char name[strlen(pool) + 64];
+
+  sprintf(name, "%s/%s%s", pool, prefix, temp + strlen(pool) + 1 + strlen(POOL_TEMP_PREFIX));
+
+  if(rename(temp, name) != 0)
+  {
+    pool_dir_remove(temp);
+
+    return 4;
+  }
+
+  return 0;
+}
+
+/*
+ * Fill the key pool, until it has count ready keypairs
+ *
+ * Only one process fills the pool at a time. If another process
+ * is already filling it, this function returns directly.
+ *
+ * The directories left by crashed runs are removed first.
+ *
+ * RETURN (int status)
+ * - 0 | Success, or the pool is filled by another process
+ * - 1 | Failed to lock the pool
+ * - 2 | Failed to generate keypair
+ */
+static int pool_fill(const char* pool, size_t bits, size_t count)
+{
+  char lockpath[strlen(pool) + 1 + strlen(POOL_LOCK_FILE) + 1];
+
+  sprintf(lockpath, "%s/%s", pool, POOL_LOCK_FILE);
+
+  int fd = open(lockpath, O_RDWR | O_CREAT, 0600);
+
+  if(fd == -1) return 1;
+
+  if(flock(fd, LOCK_EX | LOCK_NB) != 0)
+  {
+    close(fd);
+
+    return (errno == EWOULDBLOCK) ? 0 : 1;
+  }
+
+  pool_stale_remove(pool);
+
+  int status = 0;
+
+  while(pool_keys_count(pool, bits) < count)
+  {
+    if(pool_key_gen(pool, bits) != 0)
+    {
+      status = 2;
+
+      break;
+    }
+  }
+
+  flock(fd, LOCK_UN);
+
+  close(fd);
+
+  return status;
+}
+
+/*
+ * Fill the key pool in a background process
+ *
+ * The background process detaches from the terminal and the
+ * output of the caller, so the caller can return directly
+ */
+static void pool_fill_background(const char* pool, size_t bits, size_t count)
+{
+  if(fork() != 0) return;
+
+  setsid();
+
+  freopen("/dev/null", "r", stdin);
+  freopen("/dev/null", "w", stdout);
+  freopen("/dev/null", "w", stderr);
+
+  _exit(pool_fill(pool, bits, count));
+}
+
+/*
+ * Move a key file from one directory to another
+ *
+ * If the directories are on different file systems,
+ * the key file is copied and then removed instead
+ */
+static int pool_key_move(const char* from, const char* to, const char* name)
+{
+  char old_path[strlen(from) + 1 + strlen(name) + 1];
+  char new_path[strlen(to)   + 1 + strlen(name) + 1];
+
+  sprintf(old_path, "%s/%s", from, name);
+  sprintf(new_path, "%s/%s", to,   name);
+
+  if(rename(old_path, new_path) == 0) return 0;
+
+  if(errno != EXDEV) return 1;
+
+  size_t size = file_size_get(old_path);
+
+  char* buffer = malloc(sizeof(char) * (size + 1));
+
+  if(!buffer) return 2;
+
+  if(file_read(buffer, size, old_path) != size || file_write(buffer, size, new_path) != size)
+  {
+    free(buffer);
+
+    return 3;
+  }
+
+  free(buffer);
+
+  return file_remove(old_path);
+}
+
+/*
+ * Claim a ready keypair from the key pool, and move it to dir
+ *
+ * The keypair is claimed by renaming its directory.
+ * Only one process can succeed in renaming it,
+ * so a keypair is never handed out twice.
+ *
+ * If the keys can't be moved, the claimed directory
+ * is renamed back, so the keypair is ready again.
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The dir already has keys
+ * - 2 | The pool has no ready keypair
+ * - 3 | Failed to move the keys
+ */
+static int pool_key_claim(const char* pool, size_t bits, const char* dir)
+{
+  if(!args.force && (dir_file_size_get(dir, PKEY_FILE) > 0 || dir_file_size_get(dir, SKEY_FILE) > 0))
+  {
+    return 1;
+  }
+
+  DIR* pool_dir = opendir(pool);
+
+  if(!pool_dir) return 2;
+
+  char prefix[32];
+  pool_prefix_get(prefix, bits);
+
+  char claim[strlen(pool) + 32];
+
+  sprintf(claim, "%s/%s%d", pool, POOL_CLAIM_PREFIX, (int) getpid());
+
+  char path[strlen(pool) + 1 + NAME_MAX + 1];
+
+  int status = 2;
+
+  struct dirent* entry;
+
+  while((entry = readdir(pool_dir)))
+  {
+    if(strncmp(entry->d_name, prefix, strlen(prefix)) != 0) continue;
+
+    sprintf(path, "%s/%s", pool, entry->d_name);
+
+    if(rename(path, claim) == 0)
+    {
+      status = 0;
+
+      break;
+    }
+  }
+
+  closedir(pool_dir);
+
+  if(status != 0) return status;
+
+  // If the keys can't be moved, the keypair is put back in the pool
+  if(pool_key_move(claim, dir, PKEY_FILE) != 0)
+  {
+    if(rename(claim, path) != 0) pool_dir_remove(claim);
+
+    return 3;
+  }
+
+  if(pool_key_move(claim, dir, SKEY_FILE) != 0)
+  {
+    if(pool_key_move(dir, claim, PKEY_FILE) != 0 || rename(claim, path) != 0)
+    {
+      pool_dir_remove(claim);
+    }
+
+    return 3;
+  }
+
+  rmdir(claim);
 
   return 0;
 }
 
+/*
+ * Hand out a keypair from the key pool, and refill the pool
+ *
+ * If the pool is empty, the keypair is generated directly
+ *
+ * RETURN (int status)
+ * - 0 | Success, a keypair was handed out
+ * - 1 | The pool is empty
+ * - 2 | Failed to hand out a keypair
+ */
+static int pool_handler(size_t bits)
+{
+  if(mkdir(args.pool, 0700) != 0 && errno != EEXIST)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keygen : Failed to create key pool\n");
+
+    return 2;
+  }
+
+  if(args.fill) return 0;
+
+  int status = pool_key_claim(args.pool, bits, args.dir);
+
+  if(status == 1)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keygen : Key directory already has keys\n");
+
+    return 2;
+  }
+  else if(status == 3)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keygen : Failed to move pool keys\n");
+
+    return 2;
+  }
+
+  return (status == 0) ? 0 : 1;
+}
+
 static struct argp argp = { options, opt_parse, args_doc, doc };
 
 /*
  * RETURN (int status)
  * - 0 | Success
+ * - 1 | Invalid key modulus size or amount of primes
+ * - 2 | Failed to use key pool
+ * - 3 | The keyring keys have no name
+ * - 4 | Failed to add keys to keyring
  */
 int main(int argc, char* argv[])
 {
   argp_parse(&argp, argc, argv, 0, 0, &args);
 
-  srand(time(NULL));
-
   if(args.debug)
     info_print("Start of main");
 
+  // X25519, Ed25519 and ML-KEM keys are fast to generate, and are only written as key files
+  if(args.type != TYPE_RSA)
+  {
+    if(args.pool || args.keyring)
+    {
+      if(!args.quiet)
+        fprintf(stderr, "keygen : Only RSA keys can be pooled or added to a keyring\n");
+
+      return 1;
+    }
+
+    int status = (args.type == TYPE_MLKEM) ? mlkem_handler() : curve_handler();
+
+    if(args.debug)
+      info_print("End of main");
+
+    return status;
+  }
+
+  size_t bits = args.bytes ? (args.bytes * 8) : RSA_MODULUS_DEFAULT;
+
+  if(!modulus_bits_valid(bits))
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keygen : Invalid key modulus size\n");
+
+    return 1;
+  }
+
+  if(args.primes < 2 || args.primes > RSA_PRIMES_LIMIT(bits))
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keygen : Invalid amount of primes, %d is the most for the size\n", RSA_PRIMES_LIMIT(bits));
+
+    return 1;
+  }
+
+  if(args.keyring && !args.name)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keygen : The keys in a keyring need a name\n");
+
+    return 3;
+  }
+
+  // The keys for a keyring are always generated directly
+  if(args.pool && !args.keyring)
+  {
+    int status = pool_handler(bits);
+
+    if(status == 2) return 2;
+
+    if(args.fill)
+    {
+      if(pool_fill(args.pool, bits, args.count) != 0)
+      {
+        if(!args.quiet)
+          fprintf(stderr, "keygen : Failed to fill key pool\n");
+
+        return 2;
+      }
+
+      return 0;
+    }
+
+    // The caller has already got its keys, refill the pool in the background
+    fflush(NULL);
+
+    pool_fill_background(args.pool, bits, args.count);
+
+    if(status == 0)
+    {
+      if(args.debug)
+        info_print("End of main");
+
+      return 0;
+    }
+
+    // The pool is empty, generate the keys directly
+  }
+
   skey_t skey;
   pkey_t pkey;
 
-  rsa_keys_gen(&skey, &pkey);
+  if(rsa_multi_keys_gen(&skey, &pkey, bits, args.primes) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "keygen : Invalid key modulus size\n");
+
+    return 1;
+  }
 
 
-  if(pkey_handler(&pkey) != 0)
+  if(args.keyring)
+  {
+    int status = keyring_handler(&skey, &pkey);
+
+    if(status != 0 && !args.quiet)
+    {
+      if(status == 2)
+        fprintf(stderr, "keygen : Keyring already has the name or the keys\n");
+      else
+        fprintf(stderr, "keygen : Failed to add keys to keyring\n");
+    }
+
+    rsa_keys_free(&skey, &pkey);
+
+    return (status == 0) ? 0 : 4;
+  }
+
+  if(pkey_handler(&pkey, args.dir) != 0)
   {
     if(!args.quiet)
       fprintf(stderr, "keygen : Failed to write public key\n");
   }
 
-  if(skey_handler(&skey) != 0)
+  if(skey_handler(&skey, args.dir) != 0)
   {
     if(!args.quiet)
       fprintf(stderr, "keygen : Failed to write secret key\n");
@@ -0,0 +1,650 @@
+/*
+ * keyring.h - memory mapped binary keyring with sorted indexes
+ *
+ * Written by Hampus Fridholm
+ *
+ * Last updated: 2026-10-19
+ *
+ *
+ * In main compilation unit; define KEYRING_IMPLEMENT
+ *
+ *
+ * The keyring is one file, with fixed size records of encoded keys.
+ * Behind the records come two sorted indexes, one by fingerprint and
+ * one by name, so a key is found by binary search in the mapped file,
+ * without decoding any other key.
+ *
+ * The keyring stores the keys as they are encoded,
+ * and the fingerprints as they are given.
+ *
+ *
+ * These are the available funtions:
+ *
+ * int  keyring_open(keyring_t* keyring, const char* path)
+ *
+ * void keyring_close(keyring_t* keyring)
+ *
+ *
+ * int  keyring_fingerprint_find(keyring_key_t* key, const keyring_t* keyring, const uint8_t fingerprint[32], uint32_t type)
+ *
+ * int  keyring_name_find(keyring_key_t* key, const keyring_t* keyring, const char* name, uint32_t type)
+ *
+ * int  keyring_key_get(keyring_key_t* key, const keyring_t* keyring, size_t index)
+ *
+ *
+ * int  keyring_key_add(const char* path, const char* name, uint32_t type, const uint8_t fingerprint[32], const void* key, size_t size)
+ */
+
+/*
+ * From here on, until KEYRING_IMPLEMENT,
+ * it is like a normal header file with declarations
+ */
+
+#ifndef KEYRING_H
+#define KEYRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The types of keys in the keyring
+ */
+#define KEYRING_PUBLIC 0
+#define KEYRING_SECRET 1
+
+/*
+ * The longest name of a key, including the terminating null byte
+ */
+#define KEYRING_NAME_SIZE 64
+
+/*
+ * The largest encoded key, which fits an encoded 4096 bit secret key
+ */
+#define KEYRING_KEY_MAX 2560
+
+/*
+ * An opened keyring, mapped into memory
+ */
+typedef struct
+{
+  uint8_t* map;   // The mapped file
+  size_t   size;  // The size of the mapped file
+  size_t   count; // The amount of keys
+} keyring_t;
+
+/*
+ * A key in the keyring
+ *
+ * The pointers point into the mapped file,
+ * so they are only valid until the keyring is closed
+ */
+typedef struct
+{
+  const char*    name;
+  const uint8_t* fingerprint;
+  uint32_t       type;
+  const uint8_t* key;
+  size_t         size;
+} keyring_key_t;
+
+extern int  keyring_open(keyring_t* keyring, const char* path);
+
+extern void keyring_close(keyring_t* keyring);
+
+
+extern int  keyring_fingerprint_find(keyring_key_t* key, const keyring_t* keyring, const uint8_t fingerprint[32], uint32_t type);
+
+extern int  keyring_name_find(keyring_key_t* key, const keyring_t* keyring, const char* name, uint32_t type);
+
+extern int  keyring_key_get(keyring_key_t* key, const keyring_t* keyring, size_t index);
+
+
+extern int  keyring_key_add(const char* path, const char* name, uint32_t type, const uint8_t fingerprint[32], const void* key, size_t size);
+
+#endif // KEYRING_H
+
+/*
+ * This header library file uses _IMPLEMENT guards
+ *
+ * If KEYRING_IMPLEMENT is defined, the definitions will be included
+ */
+
+#ifdef KEYRING_IMPLEMENT
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+/*
+ * The file starts with this header:
+ *
+ * magic (8), version (4), key count (4), record size (4), reserved (12)
+ */
+#define KEYRING_MAGIC       "KEYRING"
+#define KEYRING_VERSION     1
+#define KEYRING_HEADER_SIZE 32
+
+/*
+ * A record: name, fingerprint, type, key size and the encoded key
+ */
+#define KEYRING_RECORD_NAME        0
+#define KEYRING_RECORD_FINGERPRINT (KEYRING_RECORD_NAME + KEYRING_NAME_SIZE)
+#define KEYRING_RECORD_TYPE        (KEYRING_RECORD_FINGERPRINT + 32)
+#define KEYRING_RECORD_KEY_SIZE    (KEYRING_RECORD_TYPE + 4)
+#define KEYRING_RECORD_KEY         (KEYRING_RECORD_KEY_SIZE + 4)
+#define KEYRING_RECORD_SIZE        (KEYRING_RECORD_KEY + KEYRING_KEY_MAX)
+
+/*
+ * An index entry: the sorted value, the type and the record index
+ *
+ * The type is big-endian, so the entries can be sorted with memcmp
+ */
+#define KEYRING_FINGERPRINT_ENTRY (32 + 4 + 4)
+#define KEYRING_NAME_ENTRY        (KEYRING_NAME_SIZE + 4 + 4)
+
+/*
+ * The size of a keyring file with count keys
+ */
+#define KEYRING_FILE_SIZE(COUNT) (KEYRING_HEADER_SIZE + \
+  (COUNT) * (KEYRING_RECORD_SIZE + KEYRING_FINGERPRINT_ENTRY + KEYRING_NAME_ENTRY))
+
+#define KEYRING_WORD_WRITE(BYTES, WORD) \
+  do { \
+    (BYTES)[0] = (uint8_t) ((WORD) >> 24); \
+    (BYTES)[1] = (uint8_t) ((WORD) >> 16); \
+    (BYTES)[2] = (uint8_t) ((WORD) >>  8); \
+    (BYTES)[3] = (uint8_t)  (WORD);        \
+  } while(0)
+
+#define KEYRING_WORD_READ(BYTES) \
+  (((uint32_t) (BYTES)[0] << 24) | ((uint32_t) (BYTES)[1] << 16) | \
+   ((uint32_t) (BYTES)[2] <<  8) |  (uint32_t) (BYTES)[3])
+
+/*
+ * Get the parts of a keyring with count keys
+ */
+static inline uint8_t* keyring_records(uint8_t* map)
+{
+  return map + KEYRING_HEADER_SIZE;
+}
+
+static inline uint8_t* keyring_fingerprint_index(uint8_t* map, size_t count)
+{
+  return keyring_records(map) + count * KEYRING_RECORD_SIZE;
+}
+
+static inline uint8_t* keyring_name_index(uint8_t* map, size_t count)
+{
+  return keyring_fingerprint_index(map, count) + count * KEYRING_FINGERPRINT_ENTRY;
+}
+
+/*
+ * Compare the fingerprint and the type of two fingerprint entries
+ */
+static int keyring_fingerprint_compare(const void* entry1, const void* entry2)
+{
+  return memcmp(entry1, entry2, 32 + 4);
+}
+
+/*
+ * Compare the name and the type of two name entries
+ */
+static int keyring_name_compare(const void* entry1, const void* entry2)
+{
+  return memcmp(entry1, entry2, KEYRING_NAME_SIZE + 4);
+}
+
+/*
+ * Open the keyring and map it into memory
+ *
+ * The keyring has to be closed with keyring_close
+ *
+ * PARAMS
+ * - keyring_t* keyring | The opened keyring
+ * - const char* path   | The path to the keyring file
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to open or map the file
+ * - 3 | The file is not a valid keyring
+ */
+int keyring_open(keyring_t* keyring, const char* path)
+{
+  if(!keyring || !path)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  int fd = open(path, O_RDONLY);
+
+  if(fd == -1) return 2;
+
+  struct stat info;
+
+  if(fstat(fd, &info) != 0)
+  {
+    close(fd);
+
+    return 2;
+  }
+
+  size_t size = info.st_size;
+
+  if(size < KEYRING_HEADER_SIZE)
+  {
+    close(fd);
+
+    errno = EINVAL; // Invalid argument
+
+    return 3;
+  }
+
+  uint8_t* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+
+  // The mapping stays valid after the file is closed
+  close(fd);
+
+  if(map == MAP_FAILED) return 2;
+
+  // Check the header, and that the file has room for every key
+  size_t count = KEYRING_WORD_READ(map + 12);
+
+  if(memcmp(map, KEYRING_MAGIC, sizeof(KEYRING_MAGIC)) != 0 ||
+     KEYRING_WORD_READ(map + 8)  != KEYRING_VERSION ||
+     KEYRING_WORD_READ(map + 16) != KEYRING_RECORD_SIZE ||
+     size != KEYRING_FILE_SIZE(count))
+  {
+    munmap(map, size);
+
+    errno = EINVAL; // Invalid argument
+
+    return 3;
+  }
+
+  keyring->map   = map;
+  keyring->size  = size;
+  keyring->count = count;
+
+  return 0;
+}
+
+/*
+ * Close the keyring, and unmap it from memory
+ */
+void keyring_close(keyring_t* keyring)
+{
+  if(!keyring || !keyring->map) return;
+
+  munmap(keyring->map, keyring->size);
+
+  keyring->map   = NULL;
+  keyring->size  = 0;
+  keyring->count = 0;
+}
+
+/*
+ * Get the key of the record, that the index entry points to
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 3 | The keyring is damaged
+ */
+static inline int keyring_entry_key(keyring_key_t* key, const keyring_t* keyring, const uint8_t* entry, size_t entry_size)
+{
+  size_t index = KEYRING_WORD_READ(entry + entry_size - 4);
+
+  if(index >= keyring->count) return 3;
+
+  const uint8_t* record = keyring_records(keyring->map) + index * KEYRING_RECORD_SIZE;
+
+  size_t size = KEYRING_WORD_READ(record + KEYRING_RECORD_KEY_SIZE);
+
+  if(size > KEYRING_KEY_MAX || record[KEYRING_RECORD_FINGERPRINT - 1] != '\0') return 3;
+
+  key->name        = (const char*) (record + KEYRING_RECORD_NAME);
+  key->fingerprint = record + KEYRING_RECORD_FINGERPRINT;
+  key->type        = KEYRING_WORD_READ(record + KEYRING_RECORD_TYPE);
+  key->key         = record + KEYRING_RECORD_KEY;
+  key->size        = size;
+
+  return 0;
+}
+
+/*
+ * Find the key with the fingerprint and the type
+ *
+ * The key is found by binary search in the fingerprint index
+ *
+ * PARAMS
+ * - keyring_key_t* key             | The found key
+ * - const keyring_t* keyring       | The keyring
+ * - const uint8_t fingerprint[32]  | The fingerprint of the key
+ * - uint32_t type                  | KEYRING_PUBLIC or KEYRING_SECRET
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The key was not found
+ * - 3 | The keyring is damaged
+ */
+int keyring_fingerprint_find(keyring_key_t* key, const keyring_t* keyring, const uint8_t fingerprint[32], uint32_t type)
+{
+  if(!key || !keyring || !keyring->map || !fingerprint)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  uint8_t search[KEYRING_FINGERPRINT_ENTRY];
+
+  memcpy(search, fingerprint, 32);
+
+  KEYRING_WORD_WRITE(search + 32, type);
+
+  uint8_t* index = keyring_fingerprint_index(keyring->map, keyring->count);
+
+  uint8_t* entry = bsearch(search, index, keyring->count, KEYRING_FINGERPRINT_ENTRY, keyring_fingerprint_compare);
+
+  if(!entry) return 2;
+
+  return keyring_entry_key(key, keyring, entry, KEYRING_FINGERPRINT_ENTRY);
+}
+
+/*
+ * Find the key with the name and the type
+ *
+ * The key is found by binary search in the name index
+ *
+ * PARAMS
+ * - keyring_key_t* key       | The found key
+ * - const keyring_t* keyring | The keyring
+ * - const char* name         | The name of the key
+ * - uint32_t type            | KEYRING_PUBLIC or KEYRING_SECRET
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The key was not found
+ * - 3 | The keyring is damaged
+ */
+int keyring_name_find(keyring_key_t* key, const keyring_t* keyring, const char* name, uint32_t type)
+{
+  if(!key || !keyring || !keyring->map || !name)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  if(strlen(name) >= KEYRING_NAME_SIZE) return 2;
+
+  uint8_t search[KEYRING_NAME_ENTRY];
+
+  memset(search, '\0', KEYRING_NAME_SIZE);
+
+  memcpy(search, name, strlen(name));
+
+  KEYRING_WORD_WRITE(search + KEYRING_NAME_SIZE, type);
+
+  uint8_t* index = keyring_name_index(keyring->map, keyring->count);
+
+  uint8_t* entry = bsearch(search, index, keyring->count, KEYRING_NAME_ENTRY, keyring_name_compare);
+
+  if(!entry) return 2;
+
+  return keyring_entry_key(key, keyring, entry, KEYRING_NAME_ENTRY);
+}
+
+/*
+ * Get the key of a record, to go through every key in the keyring
+ *
+ * PARAMS
+ * - keyring_key_t* key       | The key
+ * - const keyring_t* keyring | The keyring
+ * - size_t index             | The index of the record, below keyring->count
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The index is not in the keyring
+ * - 3 | The keyring is damaged
+ */
+int keyring_key_get(keyring_key_t* key, const keyring_t* keyring, size_t index)
+{
+  if(!key || !keyring || !keyring->map)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  if(index >= keyring->count) return 2;
+
+  uint8_t entry[4];
+
+  KEYRING_WORD_WRITE(entry, (uint32_t) index);
+
+  return keyring_entry_key(key, keyring, entry, sizeof(entry));
+}
+
+/*
+ * Create the file content of the old keyring with one more key
+ *
+ * The records are kept in place, the new record is put last,
+ * and both indexes are sorted again
+ */
+static inline uint8_t* keyring_add_create(const keyring_t* old, const char* name, uint32_t type, const uint8_t fingerprint[32], const void* key, size_t size)
+{
+  size_t count = old->count + 1;
+
+  uint8_t* map = calloc(KEYRING_FILE_SIZE(count), sizeof(uint8_t));
+
+  if(!map) return NULL;
+
+  // 1. The header
+  memcpy(map, KEYRING_MAGIC, sizeof(KEYRING_MAGIC));
+
+  KEYRING_WORD_WRITE(map + 8,  KEYRING_VERSION);
+  KEYRING_WORD_WRITE(map + 12, (uint32_t) count);
+  KEYRING_WORD_WRITE(map + 16, KEYRING_RECORD_SIZE);
+
+  // 2. The records
+  uint8_t* records = keyring_records(map);
+
+  if(old->count > 0)
+  {
+    memcpy(records, keyring_records(old->map), old->count * KEYRING_RECORD_SIZE);
+  }
+
+  uint8_t* record = records + old->count * KEYRING_RECORD_SIZE;
+
+  memcpy(record + KEYRING_RECORD_NAME, name, strlen(name));
+  memcpy(record + KEYRING_RECORD_FINGERPRINT, fingerprint, 32);
+
+  KEYRING_WORD_WRITE(record + KEYRING_RECORD_TYPE,     type);
+  KEYRING_WORD_WRITE(record + KEYRING_RECORD_KEY_SIZE, (uint32_t) size);
+
+  memcpy(record + KEYRING_RECORD_KEY, key, size);
+
+  // 3. The indexes, created from the records and then sorted
+  uint8_t* fingerprint_index = keyring_fingerprint_index(map, count);
+  uint8_t* name_index        = keyring_name_index(map, count);
+
+  for(size_t index = 0; index < count; index++)
+  {
+    record = records + index * KEYRING_RECORD_SIZE;
+
+    uint8_t* entry = fingerprint_index + index * KEYRING_FINGERPRINT_ENTRY;
+
+    memcpy(entry,      record + KEYRING_RECORD_FINGERPRINT, 32);
+    memcpy(entry + 32, record + KEYRING_RECORD_TYPE, 4);
+
+    KEYRING_WORD_WRITE(entry + 36, (uint32_t) index);
+
+    entry = name_index + index * KEYRING_NAME_ENTRY;
+
+    memcpy(entry,                     record + KEYRING_RECORD_NAME, KEYRING_NAME_SIZE);
+    memcpy(entry + KEYRING_NAME_SIZE, record + KEYRING_RECORD_TYPE, 4);
+
+    KEYRING_WORD_WRITE(entry + KEYRING_NAME_SIZE + 4, (uint32_t) index);
+  }
+
+  qsort(fingerprint_index, count, KEYRING_FINGERPRINT_ENTRY, keyring_fingerprint_compare);
+
+  qsort(name_index, count, KEYRING_NAME_ENTRY, keyring_name_compare);
+
+  return map;
+}
+
+/*
+ * Write the keyring file, by writing a temporary file and renaming it
+ *
+ * That way, a reader never maps a keyring that is half written
+ */
+static inline int keyring_file_write(const char* path, const uint8_t* map, size_t size)
+{
+  char temp[strlen(path) + 8];
+
+  sprintf(temp, "%s.XXXXXX", path);
+
+  int fd = mkstemp(temp);
+
+  if(fd == -1) return 1;
+
+  size_t written = 0;
+
+  while(written < size)
+  {
+    ssize_t result = write(fd, map + written, size - written);
+
+    if(result <= 0) break;
+
+    written += result;
+  }
+
+  if(written != size || fsync(fd) != 0 || fchmod(fd, 0600) != 0)
+  {
+    close(fd);
+
+    unlink(temp);
+
+    return 1;
+  }
+
+  close(fd);
+
+  if(rename(temp, path) != 0)
+  {
+    unlink(temp);
+
+    return 1;
+  }
+
+  return 0;
+}
+
+/*
+ * Add a key to the keyring, and create the keyring if it doesn't exist
+ *
+ * The whole keyring is written again, with the key added.
+ * Keyrings are added to one at a time, using a lock file next to it
+ *
+ * PARAMS
+ * - const char* path              | The path to the keyring file
+ * - const char* name              | The name of the key
+ * - uint32_t type                 | KEYRING_PUBLIC or KEYRING_SECRET
+ * - const uint8_t fingerprint[32] | The fingerprint of the key
+ * - const void* key               | The encoded key
+ * - size_t size                   | The size of the encoded key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | A key with the name or the fingerprint already exists
+ * - 3 | Failed to read the keyring
+ * - 4 | Failed to write the keyring
+ */
+int keyring_key_add(const char* path, const char* name, uint32_t type, const uint8_t fingerprint[32], const void* key, size_t size)
+{
+  if(!path || !name || !fingerprint || !key)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  if(strlen(name) == 0 || strlen(name) >= KEYRING_NAME_SIZE || size > KEYRING_KEY_MAX)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 1;
+  }
+
+  // 1. Lock the keyring, so no other key is added at the same time
+  char lockpath[strlen(path) + 6];
+
+  sprintf(lockpath, "%s.lock", path);
+
+  int lock = open(lockpath, O_RDWR | O_CREAT, 0600);
+
+  if(lock == -1) return 4;
+
+  if(flock(lock, LOCK_EX) != 0)
+  {
+    close(lock);
+
+    return 4;
+  }
+
+  // 2. Open the old keyring, if there is one
+  keyring_t old = { 0 };
+
+  int status = keyring_open(&old, path);
+
+  if(status != 0 && !(status == 2 && errno == ENOENT))
+  {
+    close(lock);
+
+    return 3;
+  }
+
+  // 3. Check that the key is not already in the keyring
+  keyring_key_t found;
+
+  if(old.map && (keyring_name_find(&found, &old, name, type) != 2 ||
+     keyring_fingerprint_find(&found, &old, fingerprint, type) != 2))
+  {
+    keyring_close(&old);
+
+    close(lock);
+
+    return 2;
+  }
+
+  // 4. Write the new keyring
+  uint8_t* map = keyring_add_create(&old, name, type, fingerprint, key, size);
+
+  size_t count = old.count + 1;
+
+  keyring_close(&old);
+
+  status = (map && keyring_file_write(path, map, KEYRING_FILE_SIZE(count)) == 0) ? 0 : 4;
+
+  free(map);
+
+  close(lock);
+
+  return status;
+}
+
+#endif // KEYRING_IMPLEMENT
@@ -0,0 +1,1350 @@
+/*
+ * mlkem.h - implementation of the ML-KEM-768 key encapsulation
+ *
+ * Written by Hampus Fridholm
+ *
+ * Credit: https://csrc.nist.gov/pubs/fips/203/final
+ *         https://github.com/pq-crystals/kyber
+ *
+ * Last updated: 2026-10-19
+ *
+ *
+ * In main compilation unit; define MLKEM_IMPLEMENT
+ *
+ * mlkem.h includes sha3.h, so define SHA3_IMPLEMENT after it
+ *
+ * The seeds come from random.h, so define RANDOM_IMPLEMENT after it
+ *
+ *
+ * The polynomials have 256 signed 16-bit coefficients, which are
+ * multiplied in the NTT domain with Montgomery and Barrett reductions
+ *
+ * The NTT, the inverse NTT and the pointwise multiplication have an AVX2
+ * version, doing 16 coefficients at a time, which is picked at runtime
+ * when the processor supports it. It does exactly the same arithmetic
+ * as the portable version, so both give the same bytes
+ *
+ *
+ * These are the available funtions:
+ *
+ * int mlkem_keys_gen(uint8_t pkey[MLKEM_PKEY_SIZE], uint8_t skey[MLKEM_SKEY_SIZE])
+ *
+ * int mlkem_keys_derive(uint8_t pkey[MLKEM_PKEY_SIZE], uint8_t skey[MLKEM_SKEY_SIZE], const uint8_t seed[64])
+ *
+ * int mlkem_pkey_get(uint8_t pkey[MLKEM_PKEY_SIZE], const uint8_t skey[MLKEM_SKEY_SIZE])
+ *
+ *
+ * int mlkem_encaps(uint8_t ciphertext[MLKEM_CIPHERTEXT_SIZE], uint8_t shared[32], const uint8_t pkey[MLKEM_PKEY_SIZE])
+ *
+ * int mlkem_encaps_derive(uint8_t ciphertext[MLKEM_CIPHERTEXT_SIZE], uint8_t shared[32], const uint8_t pkey[MLKEM_PKEY_SIZE], const uint8_t seed[32])
+ *
+ * int mlkem_decaps(uint8_t shared[32], const uint8_t ciphertext[MLKEM_CIPHERTEXT_SIZE], const uint8_t skey[MLKEM_SKEY_SIZE])
+ *
+ *
+ * int mlkem_key_encode(uint8_t* result, const uint8_t* key, size_t size)
+ *
+ * int mlkem_key_decode(uint8_t* key, size_t size, const void* message, size_t msize)
+ */
+
+/*
+ * From here on, until MLKEM_IMPLEMENT,
+ * it is like a normal header file with declarations
+ */
+
+#ifndef MLKEM_H
+#define MLKEM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sha3.h"
+
+/*
+ * The parameters of ML-KEM-768
+ */
+#define MLKEM_N    256
+#define MLKEM_Q    3329
+#define MLKEM_K    3
+#define MLKEM_ETA1 2
+#define MLKEM_ETA2 2
+#define MLKEM_DU   10
+#define MLKEM_DV   4
+
+#define MLKEM_POLY_SIZE (MLKEM_N * 12 / 8)
+
+/*
+ * The sizes of the keys, the ciphertext and the shared secret
+ */
+#define MLKEM_PKEY_SIZE       (MLKEM_K * MLKEM_POLY_SIZE + 32)
+#define MLKEM_SKEY_SIZE       (MLKEM_K * MLKEM_POLY_SIZE + MLKEM_PKEY_SIZE + 64)
+#define MLKEM_CIPHERTEXT_SIZE (MLKEM_K * MLKEM_N * MLKEM_DU / 8 + MLKEM_N * MLKEM_DV / 8)
+#define MLKEM_SHARED_SIZE     32
+
+/*
+ * The encoded keys are
+ *
+ * - 4 bytes | MLKEM_KEY_ID (big-endian)
+ * - n bytes | The key, MLKEM_SKEY_SIZE or MLKEM_PKEY_SIZE bytes
+ *
+ * The ID is never the modulus size of an RSA key,
+ * and the secret and public keys are told apart by their sizes
+ */
+#define MLKEM_KEY_ID 0x0F203768
+
+#define MLKEM_ENCODED_SIZE(size) (4 + (size))
+
+extern int mlkem_keys_gen(uint8_t pkey[MLKEM_PKEY_SIZE], uint8_t skey[MLKEM_SKEY_SIZE]);
+
+extern int mlkem_keys_derive(uint8_t pkey[MLKEM_PKEY_SIZE], uint8_t skey[MLKEM_SKEY_SIZE], const uint8_t seed[64]);
+
+extern int mlkem_pkey_get(uint8_t pkey[MLKEM_PKEY_SIZE], const uint8_t skey[MLKEM_SKEY_SIZE]);
+
+
+extern int mlkem_encaps(uint8_t ciphertext[MLKEM_CIPHERTEXT_SIZE], uint8_t shared[32], const uint8_t pkey[MLKEM_PKEY_SIZE]);
+
+extern int mlkem_encaps_derive(uint8_t ciphertext[MLKEM_CIPHERTEXT_SIZE], uint8_t shared[32], const uint8_t pkey[MLKEM_PKEY_SIZE], const uint8_t seed[32]);
+
+extern int mlkem_decaps(uint8_t shared[32], const uint8_t ciphertext[MLKEM_CIPHERTEXT_SIZE], const uint8_t skey[MLKEM_SKEY_SIZE]);
+
+
+extern int mlkem_key_encode(uint8_t* result, const uint8_t* key, size_t size);
+
+extern int mlkem_key_decode(uint8_t* key, size_t size, const void* message, size_t msize);
+
+#endif // MLKEM_H
+
+/*
+ * This header library file uses _IMPLEMENT guards
+ *
+ * If MLKEM_IMPLEMENT is defined, the definitions will be included
+ */
+
+#ifdef MLKEM_IMPLEMENT
+
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include "random.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MLKEM_AVX2
+#include <immintrin.h>
+#endif
+
+#define MLKEM_QINV -3327 // q^-1 mod 2^16
+#define MLKEM_MONT -1044 // 2^16 mod q
+
+/*
+ * A polynomial, aligned for the AVX2 loads and stores
+ */
+typedef struct
+{
+  int16_t coeffs[MLKEM_N];
+} __attribute__((aligned(32))) mlkem_poly_t;
+
+typedef struct
+{
+  mlkem_poly_t vec[MLKEM_K];
+} mlkem_polyvec_t;
+
+// The powers of the root of unity 17, in bit-reversed order and Montgomery form
+static const int16_t MLKEM_ZETAS[128] = {
+  -1044,  -758,  -359, -1517,  1493,  1422,   287,   202,  -171,   622,  1577,   182,   962, -1202, -1474,  1468,
+    573, -1325,   264,   383,  -829,  1458, -1602,  -130,  -681,  1017,   732,   608, -1542,   411,  -205, -1571,
+   1223,   652,  -552,  1015, -1293,  1491,  -282, -1544,   516,    -8,  -320,  -666, -1618, -1162,   126,  1469,
+   -853,   -90,  -271,   830,   107, -1421,  -247,  -951,  -398,   961, -1508,  -725,   448, -1065,   677, -1275,
+  -1103,   430,   555,   843, -1251,   871,  1550,   105,   422,   587,   177,  -235,  -291,  -460,  1574,  1653,
+   -246,   778,  1159,  -147,  -777,  1483,  -602,  1119, -1590,   644,  -872,   349,   418,   329,  -156,   -75,
+    817,  1097,   603,   610,  1322, -1285, -1465,   384, -1215,  -136,  1218, -1335,  -874,   220, -1187, -1659,
+  -1185, -1530, -1278,   794, -1510,  -854,  -870,   478,  -108,  -308,   996,   991,   958, -1460,  1522,  1628
+};
+
+/*
+ * Montgomery reduction, a * 2^-16 mod q, in (-q, q) for |a| < q 2^15
+ */
+static inline int16_t mlkem_montgomery_reduce(int32_t a)
+{
+  int16_t t = (int16_t) a * MLKEM_QINV;
+
+  return (int16_t) ((a - (int32_t) t * MLKEM_Q) >> 16);
+}
+
+/*
+ * Barrett reduction, a mod q, centered in [-(q - 1) / 2, (q - 1) / 2]
+ */
+static inline int16_t mlkem_barrett_reduce(int16_t a)
+{
+  const int16_t v = ((1 << 26) + MLKEM_Q / 2) / MLKEM_Q;
+
+  int16_t t = ((int32_t) v * a + (1 << 25)) >> 26;
+
+  return a - t * MLKEM_Q;
+}
+
+/*
+ * Multiply in the Montgomery domain, a * b * 2^-16 mod q
+ */
+static inline int16_t mlkem_fqmul(int16_t a, int16_t b)
+{
+  return mlkem_montgomery_reduce((int32_t) a * b);
+}
+
+/*
+ * The forward NTT, the coefficients end up in bit-reversed order
+ *
+ * The coefficients grow by at most q per layer, and are not reduced
+ */
+static void mlkem_ntt(int16_t r[MLKEM_N])
+{
+  size_t k = 1;
+
+  for(size_t len = 128; len >= 2; len >>= 1)
+  {
+    for(size_t start = 0; start < MLKEM_N; start += 2 * len)
+    {
+      int16_t zeta = MLKEM_ZETAS[k++];
+
+      for(size_t j = start; j < start + len; j++)
+      {
+        int16_t t = mlkem_fqmul(zeta, r[j + len]);
+
+        r[j + len] = r[j] - t;
+        r[j]       = r[j] + t;
+      }
+    }
+  }
+}
+
+/*
+ * The inverse NTT, which also multiplies by 2^16
+ * (the inverse of the Montgomery factor of the pointwise products)
+ */
+static void mlkem_invntt(int16_t r[MLKEM_N])
+{
+  const int16_t f = 1441; // 2^32 / 128 mod q
+
+  size_t k = 127;
+
+  for(size_t len = 2; len <= 128; len <<= 1)
+  {
+    for(size_t start = 0; start < MLKEM_N; start += 2 * len)
+    {
+      int16_t zeta = MLKEM_ZETAS[k--];
+
+      for(size_t j = start; j < start + len; j++)
+      {
+        int16_t t = r[j];
+
+        r[j]       = mlkem_barrett_reduce(t + r[j + len]);
+        r[j + len] = mlkem_fqmul(zeta, r[j + len] - t);
+      }
+    }
+  }
+
+  for(size_t j = 0; j < MLKEM_N; j++)
+  {
+    r[j] = mlkem_fqmul(r[j], f);
+  }
+}
+
+/*
+ * Multiply two degree-one polynomials modulo (X^2 - zeta)
+ */
+static inline void mlkem_basemul(int16_t r[2], const int16_t a[2], const int16_t b[2], int16_t zeta)
+{
+  r[0]  = mlkem_fqmul(a[1], b[1]);
+  r[0]  = mlkem_fqmul(r[0], zeta);
+  r[0] += mlkem_fqmul(a[0], b[0]);
+
+  r[1]  = mlkem_fqmul(a[0], b[1]);
+  r[1] += mlkem_fqmul(a[1], b[0]);
+}
+
+/*
+ * Reduce every coefficient with Barrett reduction
+ */
+static void mlkem_reduce(int16_t r[MLKEM_N])
+{
+  for(size_t index = 0; index < MLKEM_N; index++)
+  {
+    r[index] = mlkem_barrett_reduce(r[index]);
+  }
+}
+
+/*
+ * r = sum of a[i] * b[i] in the NTT domain, times 2^-16, reduced
+ */
+static void mlkem_basemul_acc(int16_t r[MLKEM_N], const mlkem_poly_t a[MLKEM_K], const mlkem_poly_t b[MLKEM_K])
+{
+  int16_t t[2];
+
+  memset(r, 0, sizeof(int16_t) * MLKEM_N);
+
+  for(size_t i = 0; i < MLKEM_K; i++)
+  {
+    const int16_t* ac = a[i].coeffs;
+    const int16_t* bc = b[i].coeffs;
+
+    for(size_t j = 0; j < MLKEM_N / 4; j++)
+    {
+      mlkem_basemul(t, ac + 4 * j, bc + 4 * j, MLKEM_ZETAS[64 + j]);
+
+      r[4 * j]     += t[0];
+      r[4 * j + 1] += t[1];
+
+      mlkem_basemul(t, ac + 4 * j + 2, bc + 4 * j + 2, -MLKEM_ZETAS[64 + j]);
+
+      r[4 * j + 2] += t[0];
+      r[4 * j + 3] += t[1];
+    }
+  }
+
+  mlkem_reduce(r);
+}
+
+#ifdef MLKEM_AVX2
+
+#define MLKEM_AVX2_TARGET __attribute__((target("avx2")))
+
+/*
+ * 16 Montgomery multiplications, bqinv is b * q^-1 mod 2^16
+ *
+ * The low halves of a * b and t * q are equal, so the
+ * difference of the high halves is the exact reduction
+ */
+static inline MLKEM_AVX2_TARGET __m256i mlkem_fqmul_avx2(__m256i a, __m256i b, __m256i bqinv)
+{
+  __m256i t = _mm256_mullo_epi16(a, bqinv);
+
+  __m256i high = _mm256_mulhi_epi16(a, b);
+
+  t = _mm256_mulhi_epi16(t, _mm256_set1_epi16(MLKEM_Q));
+
+  return _mm256_sub_epi16(high, t);
+}
+
+/*
+ * 16 Montgomery multiplications, by a vector of zetas
+ */
+static inline MLKEM_AVX2_TARGET __m256i mlkem_zetamul_avx2(__m256i a, __m256i zetas)
+{
+  return mlkem_fqmul_avx2(a, zetas, _mm256_mullo_epi16(zetas, _mm256_set1_epi16(MLKEM_QINV)));
+}
+
+/*
+ * 16 Barrett reductions, rounding the quotient as the portable version
+ */
+static inline MLKEM_AVX2_TARGET __m256i mlkem_barrett_reduce_avx2(__m256i a)
+{
+  __m256i t = _mm256_mulhi_epi16(a, _mm256_set1_epi16(((1 << 26) + MLKEM_Q / 2) / MLKEM_Q));
+
+  t = _mm256_srai_epi16(_mm256_add_epi16(t, _mm256_set1_epi16(1 << 9)), 10);
+
+  return _mm256_sub_epi16(a, _mm256_mullo_epi16(t, _mm256_set1_epi16(MLKEM_Q)));
+}
+
+/*
+ * The forward butterfly, of 16 coefficient pairs
+ */
+static inline MLKEM_AVX2_TARGET void mlkem_butterfly_avx2(__m256i* a, __m256i* b, __m256i zetas)
+{
+  __m256i t = mlkem_zetamul_avx2(*b, zetas);
+
+  *b = _mm256_sub_epi16(*a, t);
+  *a = _mm256_add_epi16(*a, t);
+}
+
+/*
+ * The inverse butterfly, of 16 coefficient pairs
+ */
+static inline MLKEM_AVX2_TARGET void mlkem_invbutterfly_avx2(__m256i* a, __m256i* b, __m256i zetas)
+{
+  __m256i t = *a;
+
+  *a = mlkem_barrett_reduce_avx2(_mm256_add_epi16(t, *b));
+  *b = mlkem_zetamul_avx2(_mm256_sub_epi16(*b, t), zetas);
+}
+
+/*
+ * The 16-bit zeta, repeated in 32 and 64 bits
+ */
+#define MLKEM_ZETA32(zeta) ((int32_t) ((uint16_t) (zeta) * 0x00010001U))
+#define MLKEM_ZETA64(zeta) ((int64_t) ((uint16_t) (zeta) * 0x0001000100010001ULL))
+
+/*
+ * The layers of length 8, 4 and 2 are inside the 16 coefficients of a vector
+ *
+ * Two vectors, a and b, are rearranged so that the pairs of every layer
+ * are in the same lanes of two vectors, and are then arranged back:
+ *
+ * - 8 | The 128-bit halves are swapped between a and b
+ * - 4 | The 64-bit quarters are interleaved
+ * - 2 | The 32-bit words are first sorted, odd after even, then interleaved
+ *
+ * The zetas are listed in the order of the blocks of the layer
+ */
+static inline MLKEM_AVX2_TARGET void mlkem_layer8_avx2(__m256i* a, __m256i* b, const int16_t z[2], bool inverse)
+{
+  __m256i x = _mm256_permute2x128_si256(*a, *b, 0x20);
+  __m256i y = _mm256_permute2x128_si256(*a, *b, 0x31);
+
+  __m256i zetas = _mm256_setr_m128i(_mm_set1_epi16(z[0]), _mm_set1_epi16(z[1]));
+
+  if(inverse)
+  {
+    mlkem_invbutterfly_avx2(&x, &y, zetas);
+  }
+  else mlkem_butterfly_avx2(&x, &y, zetas);
+
+  *a = _mm256_permute2x128_si256(x, y, 0x20);
+  *b = _mm256_permute2x128_si256(x, y, 0x31);
+}
+
+static inline MLKEM_AVX2_TARGET void mlkem_layer4_avx2(__m256i* a, __m256i* b, const int16_t z[4], bool inverse)
+{
+  __m256i x = _mm256_unpacklo_epi64(*a, *b);
+  __m256i y = _mm256_unpackhi_epi64(*a, *b);
+
+  __m256i zetas = _mm256_setr_epi64x(MLKEM_ZETA64(z[0]), MLKEM_ZETA64(z[2]), MLKEM_ZETA64(z[1]), MLKEM_ZETA64(z[3]));
+
+  if(inverse)
+  {
+    mlkem_invbutterfly_avx2(&x, &y, zetas);
+  }
+  else mlkem_butterfly_avx2(&x, &y, zetas);
+
+  *a = _mm256_unpacklo_epi64(x, y);
+  *b = _mm256_unpackhi_epi64(x, y);
+}
+
+static inline MLKEM_AVX2_TARGET void mlkem_layer2_avx2(__m256i* a, __m256i* b, const int16_t z[8], bool inverse)
+{
+  __m256i sa = _mm256_shuffle_epi32(*a, 0xD8);
+  __m256i sb = _mm256_shuffle_epi32(*b, 0xD8);
+
+  __m256i x = _mm256_unpacklo_epi64(sa, sb);
+  __m256i y = _mm256_unpackhi_epi64(sa, sb);
+
+  __m256i zetas = _mm256_setr_epi32(MLKEM_ZETA32(z[0]), MLKEM_ZETA32(z[1]), MLKEM_ZETA32(z[4]), MLKEM_ZETA32(z[5]),
+                                    MLKEM_ZETA32(z[2]), MLKEM_ZETA32(z[3]), MLKEM_ZETA32(z[6]), MLKEM_ZETA32(z[7]));
+
+  if(inverse)
+  {
+    mlkem_invbutterfly_avx2(&x, &y, zetas);
+  }
+  else mlkem_butterfly_avx2(&x, &y, zetas);
+
+  *a = _mm256_shuffle_epi32(_mm256_unpacklo_epi64(x, y), 0xD8);
+  *b = _mm256_shuffle_epi32(_mm256_unpackhi_epi64(x, y), 0xD8);
+}
+
+/*
+ * The forward NTT, followed by a Barrett reduction, 16 coefficients at a time
+ */
+static MLKEM_AVX2_TARGET void mlkem_ntt_avx2(int16_t r[MLKEM_N])
+{
+  __m256i* v = (__m256i*) r;
+
+  // 1. The layers of length 128 down to 16 are between whole vectors
+  size_t k = 1;
+
+  for(size_t len = 8; len >= 1; len >>= 1)
+  {
+    for(size_t start = 0; start < 16; start += 2 * len)
+    {
+      __m256i zetas = _mm256_set1_epi16(MLKEM_ZETAS[k++]);
+
+      for(size_t j = start; j < start + len; j++)
+      {
+        mlkem_butterfly_avx2(&v[j], &v[j + len], zetas);
+      }
+    }
+  }
+
+  // 2. The layers of length 8, 4 and 2 are done in pairs of vectors
+  for(size_t p = 0; p < 8; p++)
+  {
+    __m256i a = v[2 * p];
+    __m256i b = v[2 * p + 1];
+
+    mlkem_layer8_avx2(&a, &b, MLKEM_ZETAS + 16 + 2 * p, false);
+
+    mlkem_layer4_avx2(&a, &b, MLKEM_ZETAS + 32 + 4 * p, false);
+
+    mlkem_layer2_avx2(&a, &b, MLKEM_ZETAS + 64 + 8 * p, false);
+
+    v[2 * p]     = mlkem_barrett_reduce_avx2(a);
+    v[2 * p + 1] = mlkem_barrett_reduce_avx2(b);
+  }
+}
+
+/*
+ * The inverse NTT, 16 coefficients at a time
+ */
+static MLKEM_AVX2_TARGET void mlkem_invntt_avx2(int16_t r[MLKEM_N])
+{
+  __m256i* v = (__m256i*) r;
+
+  // 1. The layers of length 2, 4 and 8, with the zetas in falling order
+  int16_t z[8];
+
+  for(size_t p = 0; p < 8; p++)
+  {
+    __m256i a = v[2 * p];
+    __m256i b = v[2 * p + 1];
+
+    for(size_t i = 0; i < 8; i++) z[i] = MLKEM_ZETAS[127 - (8 * p + i)];
+
+    mlkem_layer2_avx2(&a, &b, z, true);
+
+    for(size_t i = 0; i < 4; i++) z[i] = MLKEM_ZETAS[63 - (4 * p + i)];
+
+    mlkem_layer4_avx2(&a, &b, z, true);
+
+    for(size_t i = 0; i < 2; i++) z[i] = MLKEM_ZETAS[31 - (2 * p + i)];
+
+    mlkem_layer8_avx2(&a, &b, z, true);
+
+    v[2 * p]     = a;
+    v[2 * p + 1] = b;
+  }
+
+  // 2. The layers of length 16 up to 128 are between whole vectors
+  size_t k = 15;
+
+  for(size_t len = 1; len <= 8; len <<= 1)
+  {
+    for(size_t start = 0; start < 16; start += 2 * len)
+    {
+      __m256i zetas = _mm256_set1_epi16(MLKEM_ZETAS[k--]);
+
+      for(size_t j = start; j < start + len; j++)
+      {
+        mlkem_invbutterfly_avx2(&v[j], &v[j + len], zetas);
+      }
+    }
+  }
+
+  __m256i f = _mm256_set1_epi16(1441);
+
+  for(size_t j = 0; j < 16; j++)
+  {
+    v[j] = mlkem_zetamul_avx2(v[j], f);
+  }
+}
+
+/*
+ * Swap the neighbouring 16-bit coefficients
+ */
+static inline MLKEM_AVX2_TARGET __m256i mlkem_swap_avx2(__m256i a)
+{
+  return _mm256_or_si256(_mm256_slli_epi32(a, 16), _mm256_srli_epi32(a, 16));
+}
+
+/*
+ * The pointwise multiplication and accumulation, 8 basemuls at a time
+ *
+ * The even lanes get a0 b0 + a1 b1 zeta, and the odd lanes a0 b1 + a1 b0
+ */
+static MLKEM_AVX2_TARGET void mlkem_basemul_acc_avx2(int16_t r[MLKEM_N], const mlkem_poly_t a[MLKEM_K], const mlkem_poly_t b[MLKEM_K])
+{
+  __m256i* rv = (__m256i*) r;
+
+  __m256i qinv = _mm256_set1_epi16(MLKEM_QINV);
+
+  for(size_t j = 0; j < 16; j++)
+  {
+    // The zetas in the odd lanes: zeta, -zeta for every four coefficients
+    __m128i z4 = _mm_loadl_epi64((const __m128i*) (MLKEM_ZETAS + 64 + 4 * j));
+
+    z4 = _mm_unpacklo_epi16(z4, _mm_sub_epi16(_mm_setzero_si128(), z4));
+
+    __m256i zetas = _mm256_slli_epi32(_mm256_cvtepu16_epi32(z4), 16);
+
+    __m256i sum = _mm256_setzero_si256();
+
+    for(size_t i = 0; i < MLKEM_K; i++)
+    {
+      __m256i av = _mm256_load_si256((const __m256i*) a[i].coeffs + j);
+      __m256i bv = _mm256_load_si256((const __m256i*) b[i].coeffs + j);
+
+      __m256i bqinv = _mm256_mullo_epi16(bv, qinv);
+
+      // a0 b0, a1 b1 and a1 b0, a0 b1
+      __m256i prod = mlkem_fqmul_avx2(av, bv, bqinv);
+      __m256i mixd = mlkem_fqmul_avx2(mlkem_swap_avx2(av), bv, bqinv);
+
+      __m256i even = _mm256_blend_epi16(prod, mlkem_zetamul_avx2(prod, zetas), 0xAA);
+
+      even = _mm256_add_epi16(even, mlkem_swap_avx2(even));
+      mixd = _mm256_add_epi16(mixd, mlkem_swap_avx2(mixd));
+
+      sum = _mm256_add_epi16(sum, _mm256_blend_epi16(even, mixd, 0xAA));
+    }
+
+    rv[j] = mlkem_barrett_reduce_avx2(sum);
+  }
+}
+
+/*
+ * Check if the processor supports AVX2, only once
+ */
+static inline bool mlkem_avx2_supported(void)
+{
+  static int supported = -1;
+
+  if(supported == -1)
+  {
+    supported = __builtin_cpu_supports("avx2") ? 1 : 0;
+  }
+
+  return supported;
+}
+
+#endif // MLKEM_AVX2
+
+/*
+ * The NTT of the polynomial, with reduced coefficients
+ */
+static void mlkem_poly_ntt(mlkem_poly_t* r)
+{
+#ifdef MLKEM_AVX2
+  if(mlkem_avx2_supported())
+  {
+    mlkem_ntt_avx2(r->coeffs);
+
+    return;
+  }
+#endif
+
+  mlkem_ntt(r->coeffs);
+
+  mlkem_reduce(r->coeffs);
+}
+
+/*
+ * The inverse NTT of the polynomial
+ */
+static void mlkem_poly_invntt(mlkem_poly_t* r)
+{
+#ifdef MLKEM_AVX2
+  if(mlkem_avx2_supported())
+  {
+    mlkem_invntt_avx2(r->coeffs);
+
+    return;
+  }
+#endif
+
+  mlkem_invntt(r->coeffs);
+}
+
+/*
+ * The inner product of two vectors of polynomials in the NTT domain
+ */
+static void mlkem_poly_basemul_acc(mlkem_poly_t* r, const mlkem_polyvec_t* a, const mlkem_polyvec_t* b)
+{
+#ifdef MLKEM_AVX2
+  if(mlkem_avx2_supported())
+  {
+    mlkem_basemul_acc_avx2(r->coeffs, a->vec, b->vec);
+
+    return;
+  }
+#endif
+
+  mlkem_basemul_acc(r->coeffs, a->vec, b->vec);
+}
+
+/*
+ * r = a + b, without reduction
+ */
+static void mlkem_poly_add(mlkem_poly_t* r, const mlkem_poly_t* a, const mlkem_poly_t* b)
+{
+  for(size_t index = 0; index < MLKEM_N; index++)
+  {
+    r->coeffs[index] = a->coeffs[index] + b->coeffs[index];
+  }
+}
+
+/*
+ * Write the 256 values of d bits each, as little-endian bits
+ */
+static void mlkem_bits_write(uint8_t* bytes, const uint16_t values[MLKEM_N], int d)
+{
+  uint32_t buffer = 0;
+  int bits = 0;
+
+  for(size_t index = 0; index < MLKEM_N; index++)
+  {
+    buffer |= (uint32_t) values[index] << bits;
+    bits   += d;
+
+    for(; bits >= 8; bits -= 8, buffer >>= 8)
+    {
+      *bytes++ = (uint8_t) buffer;
+    }
+  }
+}
+
+/*
+ * Read 256 values of d bits each, as little-endian bits
+ */
+static void mlkem_bits_read(uint16_t values[MLKEM_N], const uint8_t* bytes, int d)
+{
+  uint32_t buffer = 0;
+  int bits = 0;
+
+  for(size_t index = 0; index < MLKEM_N; index++)
+  {
+    for(; bits < d; bits += 8)
+    {
+      buffer |= (uint32_t) *bytes++ << bits;
+    }
+
+    values[index] = buffer & ((1U << d) - 1);
+
+    buffer >>= d;
+    bits   -= d;
+  }
+}
+
+/*
+ * Map a coefficient in (-q, q) to [0, q)
+ */
+static inline uint16_t mlkem_canonical(int16_t a)
+{
+  return (uint16_t) (a + ((a >> 15) & MLKEM_Q));
+}
+
+/*
+ * Compress and write the polynomial with d bits per coefficient,
+ * round(2^d / q * x) mod 2^d, where d = 12 is no compression
+ */
+static void mlkem_poly_write(uint8_t* bytes, const mlkem_poly_t* a, int d)
+{
+  uint16_t values[MLKEM_N];
+
+  for(size_t index = 0; index < MLKEM_N; index++)
+  {
+    uint32_t x = mlkem_canonical(a->coeffs[index]);
+
+    if(d < 12)
+    {
+      // The division by the constant q is a multiplication, without branches
+      x = (((x << d) + MLKEM_Q / 2) / MLKEM_Q) & ((1U << d) - 1);
+    }
+
+    values[index] = (uint16_t) x;
+  }
+
+  mlkem_bits_write(bytes, values, d);
+}
+
+/*
+ * Read and decompress the polynomial with d bits per coefficient,
+ * round(q / 2^d * y), where d = 12 is no compression
+ */
+static void mlkem_poly_read(mlkem_poly_t* r, const uint8_t* bytes, int d)
+{
+  uint16_t values[MLKEM_N];
+
+  mlkem_bits_read(values, bytes, d);
+
+  for(size_t index = 0; index < MLKEM_N; index++)
+  {
+    if(d < 12)
+    {
+      r->coeffs[index] = (int16_t) (((uint32_t) values[index] * MLKEM_Q + (1U << (d - 1))) >> d);
+    }
+    else r->coeffs[index] = (int16_t) values[index];
+  }
+}
+
+/*
+ * Sample a uniform polynomial in the NTT domain, from SHAKE128(rho || j || i)
+ */
+static void mlkem_poly_uniform(mlkem_poly_t* r, const uint8_t rho[32], uint8_t j, uint8_t i)
+{
+  uint8_t seed[34];
+
+  memcpy(seed, rho, 32);
+
+  seed[32] = j;
+  seed[33] = i;
+
+  sha3_ctx_t ctx;
+
+  shake128_init(&ctx);
+
+  sha3_update(&ctx, seed, sizeof(seed));
+
+  uint8_t buffer[SHAKE128_RATE];
+
+  size_t count = 0;
+
+  while(count < MLKEM_N)
+  {
+    sha3_squeeze(&ctx, buffer, sizeof(buffer));
+
+    for(size_t pos = 0; pos + 3 <= sizeof(buffer) && count < MLKEM_N; pos += 3)
+    {
+      uint16_t d1 = ((uint16_t) buffer[pos]          | ((uint16_t) buffer[pos + 1] << 8)) & 0xFFF;
+      uint16_t d2 = ((uint16_t) buffer[pos + 1] >> 4) | ((uint16_t) buffer[pos + 2] << 4);
+
+      if(d1 < MLKEM_Q) r->coeffs[count++] = (int16_t) d1;
+
+      if(d2 < MLKEM_Q && count < MLKEM_N) r->coeffs[count++] = (int16_t) d2;
+    }
+  }
+}
+
+/*
+ * Generate the matrix A, or its transpose, from the seed rho
+ */
+static void mlkem_matrix_gen(mlkem_polyvec_t a[MLKEM_K], const uint8_t rho[32], bool transposed)
+{
+  for(uint8_t i = 0; i < MLKEM_K; i++)
+  {
+    for(uint8_t j = 0; j < MLKEM_K; j++)
+    {
+      if(transposed)
+      {
+        mlkem_poly_uniform(&a[i].vec[j], rho, i, j);
+      }
+      else mlkem_poly_uniform(&a[i].vec[j], rho, j, i);
+    }
+  }
+}
+
+/*
+ * Sample a noise polynomial from the centered binomial distribution
+ * with eta = 2, from the 128 bytes of PRF(sigma, nonce) = SHAKE256(sigma || nonce)
+ */
+static void mlkem_poly_noise(mlkem_poly_t* r, const uint8_t sigma[32], uint8_t nonce)
+{
+  uint8_t seed[33];
+
+  memcpy(seed, sigma, 32);
+
+  seed[32] = nonce;
+
+  uint8_t buffer[64 * MLKEM_ETA1];
+
+  shake256(buffer, sizeof(buffer), seed, sizeof(seed));
+
+  for(size_t i = 0; i < MLKEM_N / 8; i++)
+  {
+    uint32_t t = (uint32_t) buffer[4 * i]             | ((uint32_t) buffer[4 * i + 1] << 8) |
+                 ((uint32_t) buffer[4 * i + 2] << 16) | ((uint32_t) buffer[4 * i + 3] << 24);
+
+    // Every 2 bits becomes the sum of the bits
+    uint32_t d = (t & 0x55555555) + ((t >> 1) & 0x55555555);
+
+    for(size_t j = 0; j < 8; j++)
+    {
+      int16_t a = (d >> (4 * j))     & 0x3;
+      int16_t b = (d >> (4 * j + 2)) & 0x3;
+
+      r->coeffs[8 * i + j] = a - b;
+    }
+  }
+
+  memset(buffer, 0, sizeof(buffer));
+}
+
+/*
+ * K-PKE key generation, from the 32-byte seed d
+ */
+static void mlkem_pke_keys_gen(uint8_t pkey[MLKEM_PKEY_SIZE], uint8_t skey[MLKEM_K * MLKEM_POLY_SIZE], const uint8_t d[32])
+{
+  // 1. (rho, sigma) = G(d || k)
+  uint8_t buffer[64];
+
+  memcpy(buffer, d, 32);
+
+  buffer[32] = MLKEM_K;
+
+  sha3_512(buffer, buffer, 33);
+
+  const uint8_t* rho   = buffer;
+  const uint8_t* sigma = buffer + 32;
+
+  mlkem_polyvec_t a[MLKEM_K];
+
+  mlkem_matrix_gen(a, rho, false);
+
+  // 2. The secret s and the error e, in the NTT domain
+  mlkem_polyvec_t s, e;
+
+  uint8_t nonce = 0;
+
+  for(size_t i = 0; i < MLKEM_K; i++) mlkem_poly_noise(&s.vec[i], sigma, nonce++);
+
+  for(size_t i = 0; i < MLKEM_K; i++) mlkem_poly_noise(&e.vec[i], sigma, nonce++);
+
+  for(size_t i = 0; i < MLKEM_K; i++)
+  {
+    mlkem_poly_ntt(&s.vec[i]);
+    mlkem_poly_ntt(&e.vec[i]);
+  }
+
+  // 3. t = A s + e, where the 2^-16 of the products is cancelled by 2^32 mod q
+  for(size_t i = 0; i < MLKEM_K; i++)
+  {
+    mlkem_poly_t t;
+
+    mlkem_poly_basemul_acc(&t, &a[i], &s);
+
+    for(size_t j = 0; j < MLKEM_N; j++)
+    {
+      t.coeffs[j] = mlkem_fqmul(t.coeffs[j], 1353);
+    }
+
+    mlkem_poly_add(&t, &t, &e.vec[i]);
+
+    mlkem_reduce(t.coeffs);
+
+    mlkem_poly_write(pkey + i * MLKEM_POLY_SIZE, &t, 12);
+
+    mlkem_poly_write(skey + i * MLKEM_POLY_SIZE, &s.vec[i], 12);
+  }
+
+  memcpy(pkey + MLKEM_K * MLKEM_POLY_SIZE, rho, 32);
+
+  memset(buffer, 0, sizeof(buffer));
+  memset(&s, 0, sizeof(s));
+  memset(&e, 0, sizeof(e));
+}
+
+/*
+ * K-PKE encryption of the 32-byte message m, with the randomness r
+ */
+static void mlkem_pke_encrypt(uint8_t ciphertext[MLKEM_CIPHERTEXT_SIZE], const uint8_t pkey[MLKEM_PKEY_SIZE], const uint8_t m[32], const uint8_t r[32])
+{
+  mlkem_polyvec_t t;
+
+  for(size_t i = 0; i < MLKEM_K; i++)
+  {
+    mlkem_poly_read(&t.vec[i], pkey + i * MLKEM_POLY_SIZE, 12);
+  }
+
+  mlkem_polyvec_t at[MLKEM_K];
+
+  mlkem_matrix_gen(at, pkey + MLKEM_K * MLKEM_POLY_SIZE, true);
+
+  // 1. The secret y and the errors e1 and e2
+  mlkem_polyvec_t y, e1;
+  mlkem_poly_t e2;
+
+  uint8_t nonce = 0;
+
+  for(size_t i = 0; i < MLKEM_K; i++) mlkem_poly_noise(&y.vec[i], r, nonce++);
+
+  for(size_t i = 0; i < MLKEM_K; i++) mlkem_poly_noise(&e1.vec[i], r, nonce++);
+
+  mlkem_poly_noise(&e2, r, nonce++);
+
+  for(size_t i = 0; i < MLKEM_K; i++) mlkem_poly_ntt(&y.vec[i]);
+
+  // 2. u = A^T y + e1
+  for(size_t i = 0; i < MLKEM_K; i++)
+  {
+    mlkem_poly_t u;
+
+    mlkem_poly_basemul_acc(&u, &at[i], &y);
+
+    mlkem_poly_invntt(&u);
+
+    mlkem_poly_add(&u, &u, &e1.vec[i]);
+
+    mlkem_reduce(u.coeffs);
+
+    mlkem_poly_write(ciphertext + i * (MLKEM_N * MLKEM_DU / 8), &u, MLKEM_DU);
+  }
+
+  // 3. v = t^T y + e2 + the message, where every bit is 0 or (q + 1) / 2
+  mlkem_poly_t v;
+
+  mlkem_poly_basemul_acc(&v, &t, &y);
+
+  mlkem_poly_invntt(&v);
+
+  mlkem_poly_add(&v, &v, &e2);
+
+  for(size_t j = 0; j < MLKEM_N; j++)
+  {
+    int16_t mask = -(int16_t) ((m[j / 8] >> (j % 8)) & 1);
+
+    v.coeffs[j] += mask & ((MLKEM_Q + 1) / 2);
+  }
+
+  mlkem_reduce(v.coeffs);
+
+  mlkem_poly_write(ciphertext + MLKEM_K * (MLKEM_N * MLKEM_DU / 8), &v, MLKEM_DV);
+
+  memset(&y, 0, sizeof(y));
+  memset(&e1, 0, sizeof(e1));
+  memset(&e2, 0, sizeof(e2));
+}
+
+/*
+ * K-PKE decryption of the 32-byte message m
+ */
+static void mlkem_pke_decrypt(uint8_t m[32], const uint8_t skey[MLKEM_K * MLKEM_POLY_SIZE], const uint8_t ciphertext[MLKEM_CIPHERTEXT_SIZE])
+{
+  mlkem_polyvec_t u, s;
+
+  for(size_t i = 0; i < MLKEM_K; i++)
+  {
+    mlkem_poly_read(&u.vec[i], ciphertext + i * (MLKEM_N * MLKEM_DU / 8), MLKEM_DU);
+
+    mlkem_poly_ntt(&u.vec[i]);
+
+    mlkem_poly_read(&s.vec[i], skey + i * MLKEM_POLY_SIZE, 12);
+  }
+
+  mlkem_poly_t v, w;
+
+  mlkem_poly_read(&v, ciphertext + MLKEM_K * (MLKEM_N * MLKEM_DU / 8), MLKEM_DV);
+
+  // w = v - s^T u, and every coefficient near (q + 1) / 2 is a one bit
+  mlkem_poly_basemul_acc(&w, &s, &u);
+
+  mlkem_poly_invntt(&w);
+
+  for(size_t j = 0; j < MLKEM_N; j++)
+  {
+    w.coeffs[j] = v.coeffs[j] - w.coeffs[j];
+  }
+
+  mlkem_reduce(w.coeffs);
+
+  memset(m, 0, 32);
+
+  for(size_t j = 0; j < MLKEM_N; j++)
+  {
+    uint32_t x = mlkem_canonical(w.coeffs[j]);
+
+    x = (((x << 1) + MLKEM_Q / 2) / MLKEM_Q) & 1;
+
+    m[j / 8] |= (uint8_t) (x << (j % 8));
+  }
+
+  memset(&s, 0, sizeof(s));
+  memset(&w, 0, sizeof(w));
+}
+
+/*
+ * Derive the keys from a 64-byte seed, d || z
+ *
+ * The secret key is: the K-PKE secret key, the public key, H(public key), z
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ */
+int mlkem_keys_derive(uint8_t pkey[MLKEM_PKEY_SIZE], uint8_t skey[MLKEM_SKEY_SIZE], const uint8_t seed[64])
+{
+  if(!pkey || !skey || !seed)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  mlkem_pke_keys_gen(pkey, skey, seed);
+
+  uint8_t* skey_pkey = skey + MLKEM_K * MLKEM_POLY_SIZE;
+
+  memcpy(skey_pkey, pkey, MLKEM_PKEY_SIZE);
+
+  sha3_256(skey_pkey + MLKEM_PKEY_SIZE, pkey, MLKEM_PKEY_SIZE);
+
+  memcpy(skey_pkey + MLKEM_PKEY_SIZE + 32, seed + 32, 32);
+
+  return 0;
+}
+
+/*
+ * Generate a random secret key and its public key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to get random bytes
+ */
+int mlkem_keys_gen(uint8_t pkey[MLKEM_PKEY_SIZE], uint8_t skey[MLKEM_SKEY_SIZE])
+{
+  if(!pkey || !skey)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  uint8_t seed[64];
+
+  if(random_bytes(seed, sizeof(seed)) != 0) return 2;
+
+  int status = mlkem_keys_derive(pkey, skey, seed);
+
+  memset(seed, 0, sizeof(seed));
+
+  return status;
+}
+
+/*
+ * Get the public key of the secret key, which holds a copy of it
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ */
+int mlkem_pkey_get(uint8_t pkey[MLKEM_PKEY_SIZE], const uint8_t skey[MLKEM_SKEY_SIZE])
+{
+  if(!pkey || !skey)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  memcpy(pkey, skey + MLKEM_K * MLKEM_POLY_SIZE, MLKEM_PKEY_SIZE);
+
+  return 0;
+}
+
+/*
+ * Encapsulate a shared secret from the 32-byte seed m
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The public key is invalid, its coefficients are not below q
+ */
+int mlkem_encaps_derive(uint8_t ciphertext[MLKEM_CIPHERTEXT_SIZE], uint8_t shared[32], const uint8_t pkey[MLKEM_PKEY_SIZE], const uint8_t seed[32])
+{
+  if(!ciphertext || !shared || !pkey || !seed)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  // 1. The modulus check of the public key
+  uint16_t values[MLKEM_N];
+
+  for(size_t i = 0; i < MLKEM_K; i++)
+  {
+    mlkem_bits_read(values, pkey + i * MLKEM_POLY_SIZE, 12);
+
+    for(size_t j = 0; j < MLKEM_N; j++)
+    {
+      if(values[j] >= MLKEM_Q)
+      {
+        errno = EINVAL; // Invalid argument
+
+        return 2;
+      }
+    }
+  }
+
+  // 2. (K, r) = G(m || H(pkey))
+  uint8_t buffer[64];
+  uint8_t kr[64];
+
+  memcpy(buffer, seed, 32);
+
+  sha3_256(buffer + 32, pkey, MLKEM_PKEY_SIZE);
+
+  sha3_512(kr, buffer, sizeof(buffer));
+
+  mlkem_pke_encrypt(ciphertext, pkey, seed, kr + 32);
+
+  memcpy(shared, kr, 32);
+
+  memset(kr, 0, sizeof(kr));
+
+  return 0;
+}
+
+/*
+ * Encapsulate a random shared secret to the public key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The public key is invalid
+ * - 3 | Failed to get random bytes
+ */
+int mlkem_encaps(uint8_t ciphertext[MLKEM_CIPHERTEXT_SIZE], uint8_t shared[32], const uint8_t pkey[MLKEM_PKEY_SIZE])
+{
+  uint8_t seed[32];
+
+  if(random_bytes(seed, sizeof(seed)) != 0) return 3;
+
+  int status = mlkem_encaps_derive(ciphertext, shared, pkey, seed);
+
+  memset(seed, 0, sizeof(seed));
+
+  return status;
+}
+
+/*
+ * Decapsulate the shared secret of the ciphertext
+ *
+ * A ciphertext which doesn't re-encrypt to itself gets the implicit
+ * rejection secret J(z || ciphertext), which is chosen without branching
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The secret key is invalid, its hash of the public key doesn't match
+ */
+int mlkem_decaps(uint8_t shared[32], const uint8_t ciphertext[MLKEM_CIPHERTEXT_SIZE], const uint8_t skey[MLKEM_SKEY_SIZE])
+{
+  if(!shared || !ciphertext || !skey)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  const uint8_t* pkey = skey + MLKEM_K * MLKEM_POLY_SIZE;
+  const uint8_t* hash = pkey + MLKEM_PKEY_SIZE;
+  const uint8_t* z    = hash + 32;
+
+  // 1. The hash check of the secret key
+  uint8_t buffer[64];
+
+  sha3_256(buffer, pkey, MLKEM_PKEY_SIZE);
+
+  if(memcmp(buffer, hash, 32) != 0)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  // 2. Decrypt m, and (K, r) = G(m || H(pkey))
+  uint8_t kr[64];
+
+  mlkem_pke_decrypt(buffer, skey, ciphertext);
+
+  memcpy(buffer + 32, hash, 32);
+
+  sha3_512(kr, buffer, sizeof(buffer));
+
+  // 3. Re-encrypt m, and compare the ciphertexts
+  uint8_t compare[MLKEM_CIPHERTEXT_SIZE];
+
+  mlkem_pke_encrypt(compare, pkey, buffer, kr + 32);
+
+  uint8_t diff = 0;
+
+  for(size_t index = 0; index < MLKEM_CIPHERTEXT_SIZE; index++)
+  {
+    diff |= compare[index] ^ ciphertext[index];
+  }
+
+  // 4. The rejection secret, J(z || ciphertext)
+  sha3_ctx_t ctx;
+
+  shake256_init(&ctx);
+
+  sha3_update(&ctx, z, 32);
+  sha3_update(&ctx, ciphertext, MLKEM_CIPHERTEXT_SIZE);
+
+  sha3_squeeze(&ctx, shared, 32);
+
+  // The mask is all ones when the ciphertexts are equal
+  uint8_t mask = (uint8_t) (((uint32_t) diff - 1) >> 8);
+
+  for(size_t index = 0; index < 32; index++)
+  {
+    shared[index] ^= mask & (shared[index] ^ kr[index]);
+  }
+
+  memset(buffer, 0, sizeof(buffer));
+  memset(kr, 0, sizeof(kr));
+
+  return 0;
+}
+
+/*
+ * Encode a secret or public key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ */
+int mlkem_key_encode(uint8_t* result, const uint8_t* key, size_t size)
+{
+  if(!result || !key)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  if(size != MLKEM_SKEY_SIZE && size != MLKEM_PKEY_SIZE)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 1;
+  }
+
+  result[0] = (uint8_t) (MLKEM_KEY_ID >> 24);
+  result[1] = (uint8_t) (MLKEM_KEY_ID >> 16);
+  result[2] = (uint8_t) (MLKEM_KEY_ID >>  8);
+  result[3] = (uint8_t)  MLKEM_KEY_ID;
+
+  memcpy(result + 4, key, size);
+
+  return 0;
+}
+
+/*
+ * Decode an encoded secret or public key, of the expected size
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The message is not an ML-KEM key of that size
+ */
+int mlkem_key_decode(uint8_t* key, size_t size, const void* message, size_t msize)
+{
+  if(!key || !message)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  const uint8_t* bytes = message;
+
+  if(msize != MLKEM_ENCODED_SIZE(size))
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  uint32_t id = ((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16) |
+                ((uint32_t) bytes[2] <<  8) |  (uint32_t) bytes[3];
+
+  if(id != MLKEM_KEY_ID)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  memcpy(key, bytes + 4, size);
+
+  return 0;
+}
+
+#endif // MLKEM_IMPLEMENT
@@ -0,0 +1,754 @@
+/*
+ * mont.h - fixed-size constant-time Montgomery arithmetic
+ *
+ * Written by Hampus Fridholm
+ *
+ * Credit: https://en.wikipedia.org/wiki/Montgomery_modular_multiplication
+ *         https://www.intel.com/content/www/us/en/content-details/671507
+ *
+ * Last updated: 2026-10-19
+ *
+ *
+ * In main compilation unit; define MONT_IMPLEMENT
+ *
+ *
+ * The moduli are odd numbers of 16, 24 or 32 limbs (64 bits), which
+ * are the primes of 2048, 3072 and 4096 bit RSA keys. The limb counts
+ * are fixed at compile time, so no memory is allocated, and the
+ * exponentiation takes the same time for all values and exponents.
+ *
+ * Where the CPU has MULX and ADX, the rows of the multiplications
+ * use two independent carry chains.
+ *
+ *
+ * These are the available funtions:
+ *
+ * bool mont_supported(size_t limbs)
+ *
+ * int  mont_ctx_init(mont_ctx_t* ctx, const uint64_t* modulus, size_t limbs)
+ *
+ * int  mont_powm(uint64_t* result, const uint64_t* base, const uint64_t* exp, const mont_ctx_t* ctx)
+ */
+
+/*
+ * From here on, until MONT_IMPLEMENT,
+ * it is like a normal header file with declarations
+ */
+
+#ifndef MONT_H
+#define MONT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * The largest modulus, in limbs
+ */
+#define MONT_LIMBS_MAX 32
+
+/*
+ * The modulus and its Montgomery constants, R = 2^(64 * limbs)
+ */
+typedef struct
+{
+  size_t   limbs;                 // The size of the modulus in limbs
+  uint64_t ninv;                  // -modulus^-1 mod 2^64
+  uint64_t n[MONT_LIMBS_MAX];     // The modulus
+  uint64_t rr[MONT_LIMBS_MAX];    // R^2 mod modulus
+} mont_ctx_t;
+
+extern bool mont_supported(size_t limbs);
+
+extern int  mont_ctx_init(mont_ctx_t* ctx, const uint64_t* modulus, size_t limbs);
+
+extern int  mont_powm(uint64_t* result, const uint64_t* base, const uint64_t* exp, const mont_ctx_t* ctx);
+
+#endif // MONT_H
+
+/*
+ * This header library file uses _IMPLEMENT guards
+ *
+ * If MONT_IMPLEMENT is defined, the definitions will be included
+ */
+
+#ifdef MONT_IMPLEMENT
+
+#include <string.h>
+#include <errno.h>
+
+#if defined(__x86_64__)
+#define MONT_ADX
+#include <emmintrin.h>
+#endif
+
+/*
+ * The bits of the exponent in every window of the exponentiation
+ */
+#define MONT_WINDOW 5
+
+#define MONT_TABLE_SIZE (1 << MONT_WINDOW)
+
+/*
+ * Add the limbs of a times d to the limbs of t
+ *
+ * RETURN (uint64_t carry)
+ * - The limb above t
+ */
+static inline uint64_t mont_addmul_c(uint64_t* t, const uint64_t* a, size_t count, uint64_t d)
+{
+  unsigned __int128 carry = 0;
+
+  for(size_t index = 0; index < count; index++)
+  {
+    carry += (unsigned __int128) a[index] * d + t[index];
+
+    t[index] = (uint64_t) carry;
+
+    carry >>= 64;
+  }
+
+  return (uint64_t) carry;
+}
+
+#ifdef MONT_ADX
+
+/*
+ * Add the limbs of a times d to the limbs of t, using MULX and ADX
+ *
+ * The high halves of the products are added in the carry chain
+ * of ADCX, and the limbs of t in the overflow chain of ADOX.
+ * The loop only uses LEA and JRCXZ, which leave both flags alone
+ *
+ * RETURN (uint64_t carry)
+ * - The limb above t
+ *
+ * EXPECT
+ * - count is at least 1
+ */
+static inline uint64_t mont_addmul_adx(uint64_t* t, const uint64_t* a, size_t count, uint64_t d)
+{
+  uint64_t carry = 0, low, high;
+
+  __asm__ volatile (
+    "xor    %k[low], %k[low]\n\t"
+    "1:\n\t"
+    "mulx   (%[a]), %[low], %[high]\n\t"
+    "adcx   %[carry], %[low]\n\t"
+    "adox   (%[t]), %[low]\n\t"
+    "mov    %[low], (%[t])\n\t"
+    "mov    %[high], %[carry]\n\t"
+    "lea    8(%[a]), %[a]\n\t"
+    "lea    8(%[t]), %[t]\n\t"
+    "lea    -1(%[count]), %[count]\n\t"
+    "jrcxz  2f\n\t"
+    "jmp    1b\n\t"
+    "2:\n\t"
+    "mov    $0, %[low]\n\t"
+    "adcx   %[low], %[carry]\n\t"
+    "adox   %[low], %[carry]\n\t"
+    : [carry] "+&r" (carry), [low] "=&r" (low), [high] "=&r" (high),
+      [a] "+&r" (a), [t] "+&r" (t), [count] "+&c" (count)
+    : "d" (d)
+    : "cc", "memory"
+  );
+
+  return carry;
+}
+
+/*
+ * The same as mont_addmul_adx, four limbs at a time,
+ * and the carry is added to the first limb of t
+ *
+ * EXPECT
+ * - count is a multiple of 4, and at least 4
+ */
+static inline uint64_t mont_addmul4_adx(uint64_t* t, const uint64_t* a, size_t count, uint64_t d, uint64_t carry)
+{
+  uint64_t low, high;
+
+  count /= 4;
+
+  __asm__ volatile (
+    "xor    %k[low], %k[low]\n\t"
+    "1:\n\t"
+    "mulx   (%[a]), %[low], %[high]\n\t"
+    "adcx   %[carry], %[low]\n\t"
+    "adox   (%[t]), %[low]\n\t"
+    "mov    %[low], (%[t])\n\t"
+    "mulx   8(%[a]), %[low], %[carry]\n\t"
+    "adcx   %[high], %[low]\n\t"
+    "adox   8(%[t]), %[low]\n\t"
+    "mov    %[low], 8(%[t])\n\t"
+    "mulx   16(%[a]), %[low], %[high]\n\t"
+    "adcx   %[carry], %[low]\n\t"
+    "adox   16(%[t]), %[low]\n\t"
+    "mov    %[low], 16(%[t])\n\t"
+    "mulx   24(%[a]), %[low], %[carry]\n\t"
+    "adcx   %[high], %[low]\n\t"
+    "adox   24(%[t]), %[low]\n\t"
+    "mov    %[low], 24(%[t])\n\t"
+    "lea    32(%[a]), %[a]\n\t"
+    "lea    32(%[t]), %[t]\n\t"
+    "lea    -1(%[count]), %[count]\n\t"
+    "jrcxz  2f\n\t"
+    "jmp    1b\n\t"
+    "2:\n\t"
+    "mov    $0, %[low]\n\t"
+    "adcx   %[low], %[carry]\n\t"
+    "adox   %[low], %[carry]\n\t"
+    : [carry] "+&r" (carry), [low] "=&r" (low), [high] "=&r" (high),
+      [a] "+&r" (a), [t] "+&r" (t), [count] "+&c" (count)
+    : "d" (d)
+    : "cc", "memory"
+  );
+
+  return carry;
+}
+
+#endif // MONT_ADX
+
+/*
+ * Add the limbs of a times d to the limbs of t, with the fastest instructions
+ */
+__attribute__((always_inline))
+static inline uint64_t mont_addmul(uint64_t* t, const uint64_t* a, size_t count, uint64_t d, bool adx)
+{
+#ifdef MONT_ADX
+  if(adx)
+  {
+    size_t rest = count % 4;
+
+    // The first limbs one at a time, and the rest four at a time
+    uint64_t carry = (rest > 0) ? mont_addmul_adx(t, a, rest, d) : 0;
+
+    if(count == rest) return carry;
+
+    return mont_addmul4_adx(t + rest, a + rest, count - rest, d, carry);
+  }
+#endif // MONT_ADX
+
+  return mont_addmul_c(t, a, count, d);
+}
+
+/*
+ * Add the limbs of b to the limbs of a
+ *
+ * RETURN (uint64_t carry)
+ */
+static inline uint64_t mont_add(uint64_t* result, const uint64_t* a, const uint64_t* b, size_t count)
+{
+#ifdef MONT_ADX
+  uint64_t carry = 0, value;
+
+  __asm__ volatile (
+    "clc\n\t"
+    "1:\n\t"
+    "mov    (%[a]), %[value]\n\t"
+    "adc    (%[b]), %[value]\n\t"
+    "mov    %[value], (%[result])\n\t"
+    "lea    8(%[a]), %[a]\n\t"
+    "lea    8(%[b]), %[b]\n\t"
+    "lea    8(%[result]), %[result]\n\t"
+    "lea    -1(%[count]), %[count]\n\t"
+    "jrcxz  2f\n\t"
+    "jmp    1b\n\t"
+    "2:\n\t"
+    "adc    $0, %[carry]\n\t"
+    : [carry] "+&r" (carry), [value] "=&r" (value), [result] "+&r" (result),
+      [a] "+&r" (a), [b] "+&r" (b), [count] "+&c" (count)
+    :
+    : "cc", "memory"
+  );
+
+  return carry;
+#else
+  unsigned __int128 carry = 0;
+
+  for(size_t index = 0; index < count; index++)
+  {
+    carry += (unsigned __int128) a[index] + b[index];
+
+    result[index] = (uint64_t) carry;
+
+    carry >>= 64;
+  }
+
+  return (uint64_t) carry;
+#endif // MONT_ADX
+}
+
+/*
+ * Subtract the limbs of b from the limbs of a
+ *
+ * RETURN (uint64_t borrow)
+ */
+static inline uint64_t mont_sub(uint64_t* result, const uint64_t* a, const uint64_t* b, size_t count)
+{
+#ifdef MONT_ADX
+  uint64_t borrow = 0, value;
+
+  __asm__ volatile (
+    "clc\n\t"
+    "1:\n\t"
+    "mov    (%[a]), %[value]\n\t"
+    "sbb    (%[b]), %[value]\n\t"
+    "mov    %[value], (%[result])\n\t"
+    "lea    8(%[a]), %[a]\n\t"
+    "lea    8(%[b]), %[b]\n\t"
+    "lea    8(%[result]), %[result]\n\t"
+    "lea    -1(%[count]), %[count]\n\t"
+    "jrcxz  2f\n\t"
+    "jmp    1b\n\t"
+    "2:\n\t"
+    "adc    $0, %[borrow]\n\t"
+    : [borrow] "+&r" (borrow), [value] "=&r" (value), [result] "+&r" (result),
+      [a] "+&r" (a), [b] "+&r" (b), [count] "+&c" (count)
+    :
+    : "cc", "memory"
+  );
+
+  return borrow;
+#else
+  uint64_t borrow = 0;
+
+  for(size_t index = 0; index < count; index++)
+  {
+    unsigned __int128 diff = (unsigned __int128) a[index] - b[index] - borrow;
+
+    result[index] = (uint64_t) diff;
+
+    borrow = (uint64_t) (diff >> 64) & 1;
+  }
+
+  return borrow;
+#endif // MONT_ADX
+}
+
+/*
+ * Double the limbs of t, and add the squares of the limbs of a
+ *
+ * t has twice as many limbs as a, and the result must fit in t
+ */
+static inline void mont_sqr_diag(uint64_t* t, const uint64_t* a, size_t count, bool adx)
+{
+#ifdef MONT_ADX
+  if(adx)
+  {
+    uint64_t low, high, value;
+
+    // The doubling is done in the ADCX chain, and the squares are added in the ADOX chain
+    __asm__ volatile (
+      "xor    %k[low], %k[low]\n\t"
+      "1:\n\t"
+      "mov    (%[a]), %%rdx\n\t"
+      "mulx   %%rdx, %[low], %[high]\n\t"
+      "mov    (%[t]), %[value]\n\t"
+      "adcx   %[value], %[value]\n\t"
+      "adox   %[low], %[value]\n\t"
+      "mov    %[value], (%[t])\n\t"
+      "mov    8(%[t]), %[value]\n\t"
+      "adcx   %[value], %[value]\n\t"
+      "adox   %[high], %[value]\n\t"
+      "mov    %[value], 8(%[t])\n\t"
+      "lea    8(%[a]), %[a]\n\t"
+      "lea    16(%[t]), %[t]\n\t"
+      "lea    -1(%[count]), %[count]\n\t"
+      "jrcxz  2f\n\t"
+      "jmp    1b\n\t"
+      "2:\n\t"
+      : [low] "=&r" (low), [high] "=&r" (high), [value] "=&r" (value),
+        [a] "+&r" (a), [t] "+&r" (t), [count] "+&c" (count)
+      :
+      : "rdx", "cc", "memory"
+    );
+
+    return;
+  }
+#endif // MONT_ADX
+
+  uint64_t shift = 0;
+
+  unsigned __int128 carry = 0;
+
+  for(size_t index = 0; index < count; index++)
+  {
+    unsigned __int128 square = (unsigned __int128) a[index] * a[index];
+
+    uint64_t low  = (t[2 * index]     << 1) | shift;
+    uint64_t high = (t[2 * index + 1] << 1) | (t[2 * index] >> 63);
+
+    shift = t[2 * index + 1] >> 63;
+
+    carry += (unsigned __int128) low + (uint64_t) square;
+
+    t[2 * index] = (uint64_t) carry;
+
+    carry = (carry >> 64) + high + (uint64_t) (square >> 64);
+
+    t[2 * index + 1] = (uint64_t) carry;
+
+    carry >>= 64;
+  }
+}
+
+/*
+ * Reduce the double sized t to the result, r = t / R mod n
+ *
+ * The result is fully reduced, without branching on the values
+ *
+ * EXPECT
+ * - t is less than n * R
+ */
+__attribute__((always_inline))
+static inline void mont_redc(uint64_t* result, uint64_t* t, const mont_ctx_t* ctx, size_t limbs, bool adx)
+{
+  // 1. Clear the low limbs one by one, keeping the carries in their place
+  for(size_t index = 0; index < limbs; index++)
+  {
+    uint64_t m = t[index] * ctx->ninv;
+
+    t[index] = mont_addmul(t + index, ctx->n, limbs, m, adx);
+  }
+
+  // 2. Add the carries to the high limbs
+  uint64_t carry = mont_add(t + limbs, t + limbs, t, limbs);
+
+  // 3. Subtract n, if the sum is not less than n
+  uint64_t borrow = mont_sub(t, t + limbs, ctx->n, limbs);
+
+  // The difference is used if there was a carry, or no borrow
+  uint64_t mask = -(carry | (borrow ^ 1));
+
+#ifdef MONT_ADX
+  __m128i masks = _mm_set1_epi64x(mask);
+
+  for(size_t index = 0; index < limbs; index += 2)
+  {
+    __m128i diff = _mm_loadu_si128((const __m128i*) &t[index]);
+    __m128i sum  = _mm_loadu_si128((const __m128i*) &t[limbs + index]);
+
+    _mm_storeu_si128((__m128i*) &result[index], _mm_or_si128(_mm_and_si128(diff, masks), _mm_andnot_si128(masks, sum)));
+  }
+#else
+  for(size_t index = 0; index < limbs; index++)
+  {
+    result[index] = (t[index] & mask) | (t[limbs + index] & ~mask);
+  }
+#endif // MONT_ADX
+}
+
+/*
+ * Montgomery multiplication, r = a * b / R mod n
+ *
+ * The result may be the same as a or b
+ */
+__attribute__((always_inline))
+static inline void mont_mul(uint64_t* result, const uint64_t* a, const uint64_t* b, const mont_ctx_t* ctx, size_t limbs, bool adx)
+{
+  uint64_t t[2 * MONT_LIMBS_MAX];
+
+  memset(t, 0, sizeof(uint64_t) * limbs);
+
+  for(size_t index = 0; index < limbs; index++)
+  {
+    t[limbs + index] = mont_addmul(t + index, a, limbs, b[index], adx);
+  }
+
+  mont_redc(result, t, ctx, limbs, adx);
+}
+
+/*
+ * Montgomery squaring, r = a * a / R mod n
+ *
+ * The products of different limbs are only calculated once,
+ * and then doubled, so it does about half the multiplications
+ */
+__attribute__((always_inline))
+static inline void mont_sqr(uint64_t* result, const uint64_t* a, const mont_ctx_t* ctx, size_t limbs, bool adx)
+{
+  uint64_t t[2 * MONT_LIMBS_MAX];
+
+  memset(t, 0, sizeof(uint64_t) * 2 * limbs);
+
+  // 1. The products a[i] * a[j] where i < j
+  for(size_t index = 0; index + 1 < limbs; index++)
+  {
+    t[index + limbs] = mont_addmul(t + 2 * index + 1, a + index + 1, limbs - index - 1, a[index], adx);
+  }
+
+  // 2. Double them, and add the squares a[i] * a[i]
+  mont_sqr_diag(t, a, limbs, adx);
+
+  mont_redc(result, t, ctx, limbs, adx);
+}
+
+/*
+ * Select entry index of the table, reading every entry,
+ * so the memory access does not leak the index
+ */
+__attribute__((always_inline))
+static inline void mont_table_select(uint64_t* result, uint64_t table[][MONT_LIMBS_MAX], uint64_t index, size_t limbs)
+{
+#ifdef MONT_ADX
+  __m128i masks[MONT_TABLE_SIZE];
+
+  for(uint64_t entry = 0; entry < MONT_TABLE_SIZE; entry++)
+  {
+    uint64_t diff = entry ^ index;
+
+    // All ones if the entry is the index, otherwise zero
+    masks[entry] = _mm_set1_epi64x(((diff | -diff) >> 63) - 1);
+  }
+
+  // The limb counts are even, so two limbs are selected at a time
+  for(size_t limb = 0; limb < limbs; limb += 2)
+  {
+    __m128i value = _mm_setzero_si128();
+
+    for(uint64_t entry = 0; entry < MONT_TABLE_SIZE; entry++)
+    {
+      value = _mm_or_si128(value, _mm_and_si128(_mm_loadu_si128((const __m128i*) &table[entry][limb]), masks[entry]));
+    }
+
+    _mm_storeu_si128((__m128i*) &result[limb], value);
+  }
+#else
+  memset(result, 0, sizeof(uint64_t) * limbs);
+
+  for(uint64_t entry = 0; entry < MONT_TABLE_SIZE; entry++)
+  {
+    uint64_t diff = entry ^ index;
+
+    // All ones if the entry is the index, otherwise zero
+    uint64_t mask = ((diff | -diff) >> 63) - 1;
+
+    for(size_t limb = 0; limb < limbs; limb++)
+    {
+      result[limb] |= table[entry][limb] & mask;
+    }
+  }
+#endif // MONT_ADX
+}
+
+/*
+ * Get the window of exponent bits, starting at bit
+ */
+static inline uint64_t mont_window_get(const uint64_t* exp, size_t bit, size_t limbs)
+{
+  size_t limb  = bit / 64;
+  size_t shift = bit % 64;
+
+  uint64_t window = exp[limb] >> shift;
+
+  if(shift + MONT_WINDOW > 64 && limb + 1 < limbs)
+  {
+    window |= exp[limb + 1] << (64 - shift);
+  }
+
+  return window & (MONT_TABLE_SIZE - 1);
+}
+
+/*
+ * Raise the base to the exponent, with fixed windows
+ *
+ * Every bit of the exponent limbs is processed, and every window
+ * does one multiplication, also when the window is zero
+ */
+__attribute__((always_inline))
+static inline void mont_powm_limbs(uint64_t* result, const uint64_t* base, const uint64_t* exp, const mont_ctx_t* ctx, size_t limbs, bool adx)
+{
+  uint64_t table[MONT_TABLE_SIZE][MONT_LIMBS_MAX];
+
+  uint64_t power[MONT_LIMBS_MAX];
+
+  uint64_t one[MONT_LIMBS_MAX] = { 1 };
+
+  // 1. The table has the powers 0 to 2^window - 1, in Montgomery form
+  mont_mul(table[0], ctx->rr, one, ctx, limbs, adx);
+
+  mont_mul(table[1], base, ctx->rr, ctx, limbs, adx);
+
+  for(size_t entry = 2; entry < MONT_TABLE_SIZE; entry++)
+  {
+    mont_mul(table[entry], table[entry - 1], table[1], ctx, limbs, adx);
+  }
+
+  // 2. Go through the windows, from the top of the exponent
+  size_t windows = (64 * limbs + MONT_WINDOW - 1) / MONT_WINDOW;
+
+  memcpy(power, table[0], sizeof(uint64_t) * limbs);
+
+  for(size_t window = windows; window-- > 0;)
+  {
+    if(window + 1 < windows)
+    {
+      for(size_t bit = 0; bit < MONT_WINDOW; bit++)
+      {
+        mont_sqr(power, power, ctx, limbs, adx);
+      }
+    }
+
+    uint64_t entry[MONT_LIMBS_MAX];
+
+    mont_table_select(entry, table, mont_window_get(exp, window * MONT_WINDOW, limbs), limbs);
+
+    mont_mul(power, power, entry, ctx, limbs, adx);
+  }
+
+  // 3. Convert the power out of Montgomery form
+  mont_mul(result, power, one, ctx, limbs, adx);
+}
+
+/*
+ * Define the exponentiation for a fixed amount of limbs
+ */
+#define MONT_POWM_DEFINE(LIMBS) \
+  static void mont_powm_##LIMBS(uint64_t* result, const uint64_t* base, const uint64_t* exp, const mont_ctx_t* ctx, bool adx) \
+  { \
+    mont_powm_limbs(result, base, exp, ctx, LIMBS, adx); \
+  }
+
+MONT_POWM_DEFINE(16)
+MONT_POWM_DEFINE(24)
+MONT_POWM_DEFINE(32)
+
+/*
+ * Check if the modulus size is supported
+ */
+bool mont_supported(size_t limbs)
+{
+  return (limbs == 16 || limbs == 24 || limbs == 32);
+}
+
+/*
+ * Initialize the context with the modulus
+ *
+ * PARAMS
+ * - mont_ctx_t* ctx         | The context
+ * - const uint64_t* modulus | The odd modulus
+ * - size_t limbs            | The size of the modulus in limbs
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input, or the size is not supported
+ */
+int mont_ctx_init(mont_ctx_t* ctx, const uint64_t* modulus, size_t limbs)
+{
+  if(!ctx || !modulus || !mont_supported(limbs) || !(modulus[0] & 1))
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 1;
+  }
+
+  ctx->limbs = limbs;
+
+  memcpy(ctx->n, modulus, sizeof(uint64_t) * limbs);
+
+  // 1. ninv, by Newton's method: every step doubles the correct bits
+  uint64_t inverse = modulus[0];
+
+  for(int step = 0; step < 5; step++)
+  {
+    inverse *= 2 - modulus[0] * inverse;
+  }
+
+  ctx->ninv = -inverse;
+
+  // 2. R^2 mod n, by doubling 1 modulo n, 2 * 64 * limbs times
+  uint64_t* value = ctx->rr;
+
+  memset(value, 0, sizeof(uint64_t) * limbs);
+
+  value[0] = 1;
+
+  for(size_t step = 0; step < 2 * 64 * limbs; step++)
+  {
+    uint64_t carry = value[limbs - 1] >> 63;
+
+    for(size_t index = limbs; index-- > 1;)
+    {
+      value[index] = (value[index] << 1) | (value[index - 1] >> 63);
+    }
+
+    value[0] <<= 1;
+
+    uint64_t diff[MONT_LIMBS_MAX];
+
+    uint64_t borrow = 0;
+
+    for(size_t index = 0; index < limbs; index++)
+    {
+      unsigned __int128 result = (unsigned __int128) value[index] - modulus[index] - borrow;
+
+      diff[index] = (uint64_t) result;
+
+      borrow = (uint64_t) (result >> 64) & 1;
+    }
+
+    uint64_t mask = -(carry | (borrow ^ 1));
+
+    for(size_t index = 0; index < limbs; index++)
+    {
+      value[index] = (diff[index] & mask) | (value[index] & ~mask);
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Raise the base to the exponent modulo the modulus of the context
+ *
+ * The exponentiation takes the same time for all bases and exponents
+ *
+ * PARAMS
+ * - uint64_t* result     | The power, ctx->limbs limbs
+ * - const uint64_t* base | The base, less than the modulus
+ * - const uint64_t* exp  | The exponent, ctx->limbs limbs
+ * - mont_ctx_t* ctx      | The context of the modulus
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ */
+int mont_powm(uint64_t* result, const uint64_t* base, const uint64_t* exp, const mont_ctx_t* ctx)
+{
+  if(!result || !base || !exp || !ctx)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  bool adx = false;
+
+#ifdef MONT_ADX
+  adx = (__builtin_cpu_supports("adx") && __builtin_cpu_supports("bmi2"));
+#endif // MONT_ADX
+
+  switch(ctx->limbs)
+  {
+    case 16:
+      mont_powm_16(result, base, exp, ctx, adx);
+      break;
+
+    case 24:
+      mont_powm_24(result, base, exp, ctx, adx);
+      break;
+
+    case 32:
+      mont_powm_32(result, base, exp, ctx, adx);
+      break;
+
+    default:
+      errno = EINVAL; // Invalid argument
+
+      return 1;
+  }
+
+  return 0;
+}
+
+#endif // MONT_IMPLEMENT
@@ -0,0 +1,261 @@
+/*
+ * random.h - cryptographically secure random bytes
+ *
+ * Written by Hampus Fridholm
+ *
+ * Credit: https://blog.cr.yp.to/20170723-random.html
+ *
+ * Last updated: 2026-10-19
+ *
+ *
+ * In main compilation unit; define RANDOM_IMPLEMENT
+ *
+ * The random bytes are a ChaCha20 keystream of chacha20poly1305.h,
+ * so define CHACHA20POLY1305_IMPLEMENT as well
+ *
+ * The program has to be linked with -pthread
+ *
+ *
+ * Every thread has its own generator, so the threads never wait
+ * for each other. The key of a generator comes from getrandom(),
+ * and is mixed with new bytes from getrandom() when
+ * - the generator has made RANDOM_RESEED_SIZE bytes
+ * - the process has forked, so a child never repeats its parent
+ *
+ * After every request, the key is replaced by the first bytes of
+ * the keystream, so bytes that are handed out can't be recreated
+ * from a later state of the generator
+ *
+ *
+ * These are the available funtions:
+ *
+ * int random_bytes(void* buffer, size_t size)
+ */
+
+/*
+ * From here on, until RANDOM_IMPLEMENT,
+ * it is like a normal header file with declarations
+ */
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "chacha20poly1305.h"
+
+extern int random_bytes(void* buffer, size_t size);
+
+#endif // RANDOM_H
+
+/*
+ * This header library file uses _IMPLEMENT guards
+ *
+ * If RANDOM_IMPLEMENT is defined, the definitions will be included
+ */
+
+#ifdef RANDOM_IMPLEMENT
+
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/random.h>
+
+/*
+ * Small requests are taken from a buffer of keystream,
+ * larger requests are written directly with the keystream
+ */
+#define RANDOM_BUFFER_SIZE 1024
+
+/*
+ * Large requests are made in chunks, with a new key for every chunk
+ */
+#define RANDOM_CHUNK_SIZE  (1 << 20)
+
+/*
+ * The amount of bytes a key is used for, before new bytes are mixed in
+ */
+#define RANDOM_RESEED_SIZE (1ULL << 30)
+
+typedef struct
+{
+  uint8_t  key[CHACHA20_KEY_SIZE];
+  uint8_t  buffer[RANDOM_BUFFER_SIZE];
+  size_t   index;                       // The first unused byte in buffer
+  uint64_t output;                      // The amount of bytes since the seed
+  uint64_t generation;                  // The fork generation of the seed
+  bool     seeded;
+} random_ctx_t;
+
+static __thread random_ctx_t random_ctx;
+
+/*
+ * The generation is increased in the child after every fork
+ */
+static uint64_t random_generation = 0;
+
+static pthread_once_t random_once = PTHREAD_ONCE_INIT;
+
+static void random_fork_child(void)
+{
+  random_generation++;
+}
+
+static void random_fork_handler_add(void)
+{
+  pthread_atfork(NULL, NULL, random_fork_child);
+}
+
+/*
+ * Mix new bytes from getrandom() into the key
+ *
+ * The bytes left in the buffer are made with the old key,
+ * so they are thrown away
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to get random bytes
+ */
+static int random_seed(random_ctx_t* ctx)
+{
+  pthread_once(&random_once, random_fork_handler_add);
+
+  uint8_t seed[CHACHA20_KEY_SIZE];
+
+  size_t size = 0;
+
+  while(size < sizeof(seed))
+  {
+    ssize_t result = getrandom(seed + size, sizeof(seed) - size, 0);
+
+    if(result < 0)
+    {
+      if(errno == EINTR) continue;
+
+      return 1;
+    }
+
+    size += result;
+  }
+
+  for(size_t index = 0; index < CHACHA20_KEY_SIZE; index++)
+  {
+    ctx->key[index] ^= seed[index];
+  }
+
+  memset(seed, '\0', sizeof(seed));
+
+  memset(ctx->buffer, '\0', RANDOM_BUFFER_SIZE);
+
+  ctx->index      = RANDOM_BUFFER_SIZE;
+  ctx->output     = 0;
+  ctx->generation = random_generation;
+  ctx->seeded     = true;
+
+  return 0;
+}
+
+/*
+ * Write keystream to the result, and replace the key
+ *
+ * Block 0 of the keystream is the next key,
+ * and the blocks after it are the result
+ *
+ * EXPECT
+ * - size is at most RANDOM_CHUNK_SIZE
+ */
+static void random_stream(random_ctx_t* ctx, uint8_t* result, size_t size)
+{
+  static const uint8_t nonce[CHACHA20_NONCE_SIZE] = { 0 };
+
+  memset(result, '\0', size);
+
+  chacha20_xor(result, result, size, ctx->key, nonce, 1);
+
+  uint8_t block[64] = { 0 };
+
+  chacha20_xor(block, block, sizeof(block), ctx->key, nonce, 0);
+
+  memcpy(ctx->key, block, CHACHA20_KEY_SIZE);
+
+  memset(block, '\0', sizeof(block));
+
+  ctx->output += size;
+}
+
+/*
+ * Fill the buffer with random bytes
+ *
+ * It is safe to call from many threads at the same time,
+ * and from both processes after a fork
+ *
+ * PARAMS
+ * - void* buffer | The buffer to fill
+ * - size_t size  | The amount of bytes
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to get random bytes
+ */
+int random_bytes(void* buffer, size_t size)
+{
+  if(!buffer && size > 0)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  random_ctx_t* ctx = &random_ctx;
+
+  uint8_t* bytes = buffer;
+
+  while(size > 0)
+  {
+    if(!ctx->seeded || ctx->generation != random_generation ||
+       ctx->output >= RANDOM_RESEED_SIZE)
+    {
+      if(random_seed(ctx) != 0) return 2;
+    }
+
+    // Large requests don't go through the buffer
+    if(size >= RANDOM_BUFFER_SIZE)
+    {
+      size_t chunk_size = (size < RANDOM_CHUNK_SIZE) ? size : RANDOM_CHUNK_SIZE;
+
+      random_stream(ctx, bytes, chunk_size);
+
+      bytes += chunk_size;
+      size  -= chunk_size;
+
+      continue;
+    }
+
+    if(ctx->index == RANDOM_BUFFER_SIZE)
+    {
+      random_stream(ctx, ctx->buffer, RANDOM_BUFFER_SIZE);
+
+      ctx->index = 0;
+    }
+
+    size_t copy_size = RANDOM_BUFFER_SIZE - ctx->index;
+
+    if(copy_size > size) copy_size = size;
+
+    memcpy(bytes, ctx->buffer + ctx->index, copy_size);
+
+    // The handed out bytes are not kept
+    memset(ctx->buffer + ctx->index, '\0', copy_size);
+
+    ctx->index += copy_size;
+    bytes      += copy_size;
+    size       -= copy_size;
+  }
+
+  return 0;
+}
+
+#endif // RANDOM_IMPLEMENT
@@ -7,13 +7,25 @@
  * https://en.wikipedia.org/wiki/RSA_(cryptosystem)
  * https://gmplib.org
  *
- * Last updated: 2025-02-25
+ * Last updated: 2026-10-19
  *
  *
  * In main compilation unit; define RSA_IMPLEMENT
  *
+ * The signatures use sha256.h, so define SHA256_IMPLEMENT as well
  *
- * void rsa_keys_gen(skey_t* skey, pkey_t* pkey)
+ * The primes are searched from random.h bytes, so define RANDOM_IMPLEMENT as well
+ *
+ * If RSA_MONT is defined, the secret key exponentiations of 16, 24 and
+ * 32 limb primes use the fixed-size Montgomery backend of mont.h,
+ * so define MONT_IMPLEMENT as well
+ *
+ * The program has to be linked with -pthread
+ *
+ *
+ * int  rsa_keys_gen(skey_t* skey, pkey_t* pkey, size_t bits)
+ *
+ * int  rsa_multi_keys_gen(skey_t* skey, pkey_t* pkey, size_t bits, size_t primes)
  *
  *
  * int  rsa_encrypt(void* result, size_t* rsize, const void* message, size_t size, pkey_t* key)
@@ -21,16 +33,52 @@
  * int  rsa_decrypt(void* result, size_t* rsize, const void* message, size_t size, skey_t* key)
  *
  *
+ * int  rsa_ctx_pkey_init(rsa_ctx_t* ctx, const pkey_t* key)
+ *
+ * int  rsa_ctx_skey_init(rsa_ctx_t* ctx, const skey_t* key)
+ *
+ * int  rsa_ctx_encrypt(void* result, size_t* rsize, const void* message, size_t size, rsa_ctx_t* ctx)
+ *
+ * int  rsa_ctx_decrypt(void* result, size_t* rsize, const void* message, size_t size, rsa_ctx_t* ctx)
+ *
+ * void rsa_ctx_free(rsa_ctx_t* ctx)
+ *
+ *
+ * int  rsa_decrypt_batch(void* results[], size_t rsizes[], const void* messages[], const size_t sizes[], size_t count, const skey_t* key, size_t threads)
+ *
+ *
+ * int  rsa_sign(void* signature, size_t* ssize, const void* message, size_t size, skey_t* key)
+ *
+ * int  rsa_verify(const void* signature, size_t ssize, const void* message, size_t size, pkey_t* key)
+ *
+ * int  rsa_ctx_sign(void* signature, size_t* ssize, const void* message, size_t size, rsa_ctx_t* ctx)
+ *
+ * int  rsa_ctx_verify(const void* signature, size_t ssize, const void* message, size_t size, rsa_ctx_t* ctx)
+ *
+ * int  rsa_verify_batch(int results[], const void* signatures[], const size_t ssizes[], const void* messages[], const size_t sizes[], pkey_t* keys[], size_t count, size_t threads)
+ *
+ *
  * int  rsa_skey_encode(char** result, size_t* size, const skey_t* key)
  *
  * int  rsa_skey_decode(skey_t* key, const void* message, size_t size)
  *
+ * int  rsa_skey_ext_encode(char** result, size_t* size, const skey_t* key)
+ *
+ * int  rsa_skey_ext_decode(skey_t* key, const void* message, size_t size)
+ *
+ * int  rsa_skey_ext_load(skey_t* key, const char* path)
+ *
  *
  * int  rsa_pkey_encode(char** result, size_t* size, const pkey_t* key)
  *
  * int  rsa_pkey_decode(pkey_t* key, const void* message, size_t size)
  *
  *
+ * int  rsa_pkey_fingerprint(uint8_t fingerprint[32], const pkey_t* key)
+ *
+ * int  rsa_skey_fingerprint(uint8_t fingerprint[32], const skey_t* key)
+ *
+ *
  * void rsa_keys_free(skey_t* skey, pkey_t* pkey)
  *
  * void rsa_skey_free(skey_t* key)
@@ -42,32 +90,115 @@
 #define RSA_H
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <gmp.h>
 
-#define MODULUS_SIZE 512
+#include "sha256.h"
+
+#include "random.h"
+
+/*
+ * The Montgomery backend works on 64-bit limbs
+ */
+#if defined(RSA_MONT) && GMP_NUMB_BITS != 64
+#undef RSA_MONT
+#endif
+
+#ifdef RSA_MONT
+#include "mont.h"
+#endif // RSA_MONT
+
+/*
+ * The modulus size (in bits) is a property of every key,
+ * and is stored together with the key when it is encoded
+ */
+#define RSA_MODULUS_DEFAULT 2048
+#define RSA_MODULUS_MIN     1024
+#define RSA_MODULUS_MAX     4096
+
+/*
+ * The public exponent of generated keys
+ */
+#define RSA_EXPONENT 65537
+
+/*
+ * The messages are padded with OAEP, using SHA-256
+ */
+#define RSA_HASH_SIZE 32
 
-#define ENCRYPT_SIZE  (MODULUS_SIZE / 8)
+/*
+ * The amount of bytes that can be encrypted using a key,
+ * that has a modulus of SIZE bytes
+ */
+#define RSA_MESSAGE_SIZE(SIZE) ((SIZE) - 2 * RSA_HASH_SIZE - 2)
 
-#define BUFFER_SIZE  ((MODULUS_SIZE / 8) / 2)
+/*
+ * A secret key can have more than two primes (multi-prime RSA),
+ * which makes the decryption and the key generation faster
+ *
+ * The primes must be large enough to not be found by the
+ * elliptic curve method, so more primes need a larger modulus
+ */
+#define RSA_PRIMES_MAX 4
 
-#define MESSAGE_SIZE ((MODULUS_SIZE / 8) - 11)
+#define RSA_PRIMES_LIMIT(BITS) (((BITS) >= 4096) ? 4 : ((BITS) >= 2048) ? 3 : 2)
 
 typedef struct
 {
+  size_t size; // Modulus size in bytes
   mpz_t n; // Modulus
   mpz_t e; // Public exponent
 } pkey_t;
 
 typedef struct
 {
+  size_t size; // Modulus size in bytes
   mpz_t n; // Modulus
   mpz_t e; // Public exponent
   mpz_t d; // Private exponent
   mpz_t p; // Prime p
   mpz_t q; // Prime q
+  mpz_t dp;   // d mod (p - 1)
+  mpz_t dq;   // d mod (q - 1)
+  mpz_t qinv; // Inverse of q mod p
+  size_t primes; // The amount of primes
+  mpz_t r[RSA_PRIMES_MAX - 2];  // The other primes
+  mpz_t dr[RSA_PRIMES_MAX - 2]; // d mod (r - 1)
+  mpz_t tr[RSA_PRIMES_MAX - 2]; // Inverse of the earlier primes' product mod r
+  bool            view;                  // If the values point into an extended encoding
+  const void*     map;                   // The mapped extended encoding, or NULL
+  size_t          map_size;              // The size of the mapped encoding
+  const uint64_t* rrs[RSA_PRIMES_MAX];   // R^2 mod the primes, from an extended encoding, or NULL (RSA_MONT)
+  uint64_t        ninvs[RSA_PRIMES_MAX]; // -prime^-1 mod 2^64, from an extended encoding (RSA_MONT)
 } skey_t;
 
-extern void rsa_keys_gen(skey_t* skey, pkey_t* pkey);
+/*
+ * The context of repeated operations with one key
+ *
+ * It owns copies of the key values and the scratch memory,
+ * so the operations do no setup and no heap allocation
+ */
+typedef struct
+{
+  size_t     size;                     // Modulus size in bytes
+  bool       secret;                   // If the context is bound to a secret key
+  size_t     count;                    // The amount of moduli, n or the primes
+  mpz_t      moduli[RSA_PRIMES_MAX];   // The modulus n, or the primes p, q and r
+  mpz_t      exps[RSA_PRIMES_MAX];     // The exponent e, or dp, dq and dr
+  mpz_t      coeffs[RSA_PRIMES_MAX];   // The CRT coefficients qinv and tr
+  mpz_t      products[RSA_PRIMES_MAX + 1]; // The products of the earlier primes, lastly n
+  mpz_t      e;                        // The public exponent, to check the signatures
+  mpz_t      values[3];                // Scratch values
+  mp_limb_t* scratch;                  // Scratch limbs, for the exponentiations
+#ifdef RSA_MONT
+  mont_ctx_t monts[RSA_PRIMES_MAX];    // The Montgomery contexts of the primes
+#endif // RSA_MONT
+} rsa_ctx_t;
+
+extern int  rsa_keys_gen(skey_t* skey, pkey_t* pkey, size_t bits);
+
+extern int  rsa_multi_keys_gen(skey_t* skey, pkey_t* pkey, size_t bits, size_t primes);
 
 
 extern int  rsa_encrypt(void* result, size_t* rsize, const void* message, size_t size, pkey_t* key);
@@ -75,16 +206,52 @@ extern int  rsa_encrypt(void* result, size_t* rsize, const void* message, size_t
 extern int  rsa_decrypt(void* result, size_t* rsize, const void* message, size_t size, skey_t* key);
 
 
+extern int  rsa_ctx_pkey_init(rsa_ctx_t* ctx, const pkey_t* key);
+
+extern int  rsa_ctx_skey_init(rsa_ctx_t* ctx, const skey_t* key);
+
+extern int  rsa_ctx_encrypt(void* result, size_t* rsize, const void* message, size_t size, rsa_ctx_t* ctx);
+
+extern int  rsa_ctx_decrypt(void* result, size_t* rsize, const void* message, size_t size, rsa_ctx_t* ctx);
+
+extern void rsa_ctx_free(rsa_ctx_t* ctx);
+
+
+extern int  rsa_decrypt_batch(void* results[], size_t rsizes[], const void* messages[], const size_t sizes[], size_t count, const skey_t* key, size_t threads);
+
+
+extern int  rsa_sign(void* signature, size_t* ssize, const void* message, size_t size, skey_t* key);
+
+extern int  rsa_verify(const void* signature, size_t ssize, const void* message, size_t size, pkey_t* key);
+
+extern int  rsa_ctx_sign(void* signature, size_t* ssize, const void* message, size_t size, rsa_ctx_t* ctx);
+
+extern int  rsa_ctx_verify(const void* signature, size_t ssize, const void* message, size_t size, rsa_ctx_t* ctx);
+
+extern int  rsa_verify_batch(int results[], const void* signatures[], const size_t ssizes[], const void* messages[], const size_t sizes[], pkey_t* keys[], size_t count, size_t threads);
+
+
 extern int  rsa_skey_encode(char** result, size_t* size, const skey_t* key);
 
 extern int  rsa_skey_decode(skey_t* key, const void* message, size_t size);
 
+extern int  rsa_skey_ext_encode(char** result, size_t* size, const skey_t* key);
+
+extern int  rsa_skey_ext_decode(skey_t* key, const void* message, size_t size);
+
+extern int  rsa_skey_ext_load(skey_t* key, const char* path);
+
 
 extern int  rsa_pkey_encode(char** result, size_t* size, const pkey_t* key);
 
 extern int  rsa_pkey_decode(pkey_t* key, const void* message, size_t size);
 
 
+extern int  rsa_pkey_fingerprint(uint8_t fingerprint[32], const pkey_t* key);
+
+extern int  rsa_skey_fingerprint(uint8_t fingerprint[32], const skey_t* key);
+
+
 extern void rsa_keys_free(skey_t* skey, pkey_t* pkey);
 
 extern void rsa_skey_free(skey_t* key);
@@ -101,9 +268,16 @@ extern void rsa_pkey_free(pkey_t* key);
 
 #ifdef RSA_IMPLEMENT
 
+#include <stdint.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /*
  * Duplicate a mpz_t variable
@@ -158,444 +332,2919 @@ static inline int rsa_choose_d(mpz_t d, const mpz_t e, const mpz_t phi)
 }
 
 /*
- * Generate a random prime number
+ * Generate a random base, from which a prime is searched for
+ *
+ * The three highest bits are set, so that the product of up to
+ * four primes has the full size, and the lowest bit is set to make it odd
  *
  * CREDIT
  * https://github.com/gilgad13/rsa-gmp/blob/master/rsa.c
  *
  * PARAMS
- * - mpz_t prime | The prime number
+ * - mpz_t base  | The random base
+ * - size_t size | The size of the base in bytes
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to get random bytes
  *
  * EXPECT
- * - prime is initted and allocated
+ * - base is initted and allocated
  */
-static inline void rsa_prime_gen(mpz_t prime)
+static inline int rsa_prime_base_gen(mpz_t base, size_t size)
 {
-  char buffer[BUFFER_SIZE];
-
-  for (int index = 0; index < BUFFER_SIZE; index++)
-  {
-    buffer[index] = rand() % 0xFF;
-  }
+  uint8_t buffer[size];
 
-  buffer[0] |= 0xC0;
+  if (random_bytes(buffer, size) != 0) return 1;
 
-  buffer[BUFFER_SIZE - 1] |= 0x01;
+  buffer[0] |= 0xE0;
 
-  mpz_t tmp;
-  mpz_init(tmp);
+  buffer[size - 1] |= 0x01;
 
-  mpz_import(tmp, BUFFER_SIZE, 1, sizeof(buffer[0]), 0, 0, buffer);
+  mpz_import(base, size, 1, sizeof(buffer[0]), 0, 0, buffer);
 
-  mpz_nextprime(prime, tmp);
+  memset(buffer, '\0', size);
 
-  mpz_clear(tmp);
+  return 0;
 }
 
 /*
- * Tweak the prime number to be a good choise
+ * The strong probable prime test (Miller-Rabin) of n to base
+ *
+ * PARAMS
+ * - mpz_srcptr n    | The odd number to test, at least 5
+ * - mpz_srcptr base | The base, between 2 and n - 2
+ *
+ * RETURN (bool result)
+ * - true  | n is a strong probable prime to base
+ * - false | n is composite
  */
-static inline void rsa_prime_tweak(mpz_t prime, mpz_t e)
+static inline bool rsa_miller_rabin(mpz_srcptr n, mpz_srcptr base)
 {
-  mpz_t tmp;
-  mpz_init(tmp);
+  mpz_t n1, d, y;
+  mpz_inits(n1, d, y, NULL);
+
+  // n - 1 = d * 2^s, with d odd
+  mpz_sub_ui(n1, n, 1);
+
+  size_t s = mpz_scan1(n1, 0);
+
+  mpz_tdiv_q_2exp(d, n1, s);
 
-  mpz_mod(tmp, prime, e);
+  mpz_powm(y, base, d, n);
 
-  // prime must not be congruent to 1 mod e
-  while (mpz_cmp_ui(tmp, 1) == 0)
+  bool result = (mpz_cmp_ui(y, 1) == 0 || mpz_cmp(y, n1) == 0);
+
+  for (size_t index = 1; index < s && !result; index++)
   {
-    mpz_nextprime(prime, prime);
+    mpz_powm_ui(y, y, 2, n);
+
+    if (mpz_cmp(y, n1) == 0) result = true;
 
-    mpz_mod(tmp, prime, e);
+    // 1 is only reached from n - 1, or from a non-trivial root of 1
+    else if (mpz_cmp_ui(y, 1) == 0) break;
   }
 
-  mpz_clear(tmp);
+  mpz_clears(n1, d, y, NULL);
+
+  return result;
 }
 
 /*
- * Generate the two large primes p and q
+ * The strong Lucas probable prime test of n,
+ * with the parameters of Selfridge's method A
  *
- * The primes should be good, based on exponent e
+ * D is the first of 5, -7, 9, -11, ... with jacobi(D / n) = -1,
+ * P = 1 and Q = (1 - D) / 4
  *
- * The primes should not be the same number
+ * Only the V-sequence is calculated, with a ladder of V_j and V_j+1.
+ * U_k is zero when D * U_k = 2 * V_k+1 - V_k is zero, so U_k itself
+ * is not needed, and there is no halving mod n.
+ *
+ * Credit: https://en.wikipedia.org/wiki/Lucas_pseudoprime
+ *
+ * PARAMS
+ * - mpz_srcptr n | The odd number to test, at least 5
+ *
+ * RETURN (bool result)
+ * - true  | n is a strong Lucas probable prime
+ * - false | n is composite
  */
-static inline void rsa_primes_gen(mpz_t p, mpz_t q, mpz_t e)
+static inline bool rsa_lucas_test(mpz_srcptr n)
 {
-  rsa_prime_gen(p);
+  // 1. Find D
+  long d = 5;
 
-  rsa_prime_tweak(p, e);
+  while (true)
+  {
+    int jacobi = mpz_si_kronecker(d, n);
 
-  do
+    if (jacobi == -1) break;
+
+    if (jacobi == 0 && mpz_cmpabs_ui(n, labs(d)) != 0) return false;
+
+    // A square has no D, so the search would never end
+    if (d == 13 && mpz_perfect_square_p(n)) return false;
+
+    d = (d > 0) ? -(d + 2) : -(d - 2);
+  }
+
+  long q = (1 - d) / 4;
+
+  mpz_t k, vl, vh, qk, qh;
+  mpz_inits(k, vl, vh, qk, qh, NULL);
+
+  // 2. n + 1 = k * 2^s, with k odd
+  mpz_add_ui(k, n, 1);
+
+  size_t s = mpz_scan1(k, 0);
+
+  mpz_tdiv_q_2exp(k, k, s);
+
+  // 3. Calculate V_k, V_k+1 and Q^k, from V_0 = 2, V_1 = P and Q^0 = 1
+  mpz_set_ui(vl, 2);
+  mpz_set_ui(vh, 1);
+  mpz_set_ui(qk, 1);
+
+  for (size_t bit = mpz_sizeinbase(k, 2); bit-- > 0;)
+  {
+    if (mpz_tstbit(k, bit))
+    {
+      // V_2j+1 = V_j * V_j+1 - P * Q^j and V_2j+2 = V_j+1^2 - 2 * Q^j+1
+      mpz_mul(vl, vl, vh);
+      mpz_sub(vl, vl, qk);
+      mpz_mod(vl, vl, n);
+
+      mpz_mul_si(qh, qk, q);
+
+      mpz_mul(vh, vh, vh);
+      mpz_submul_ui(vh, qh, 2);
+      mpz_mod(vh, vh, n);
+
+      // Q^2j+1 = Q^j * Q^j+1
+      mpz_mul(qk, qk, qh);
+      mpz_mod(qk, qk, n);
+    }
+    else
+    {
+      // V_2j+1 = V_j * V_j+1 - P * Q^j and V_2j = V_j^2 - 2 * Q^j
+      mpz_mul(vh, vh, vl);
+      mpz_sub(vh, vh, qk);
+      mpz_mod(vh, vh, n);
+
+      mpz_mul(vl, vl, vl);
+      mpz_submul_ui(vl, qk, 2);
+      mpz_mod(vl, vl, n);
+
+      mpz_mul(qk, qk, qk);
+      mpz_mod(qk, qk, n);
+    }
+  }
+
+  // 4. n is a strong Lucas probable prime,
+  //    if U_k = 0 or V_(k * 2^r) = 0 for some r < s
+  mpz_mul_2exp(vh, vh, 1);
+  mpz_sub(vh, vh, vl);
+
+  bool result = mpz_divisible_p(vh, n) || (mpz_sgn(vl) == 0);
+
+  for (size_t index = 1; index < s && !result; index++)
   {
-    rsa_prime_gen(q);
+    mpz_mul(vl, vl, vl);
+    mpz_submul_ui(vl, qk, 2);
+    mpz_mod(vl, vl, n);
 
-    rsa_prime_tweak(q, e);
+    mpz_mul(qk, qk, qk);
+    mpz_mod(qk, qk, n);
+
+    result = (mpz_sgn(vl) == 0);
   }
-  while (mpz_cmp(p, q) == 0);
+
+  mpz_clears(k, vl, vh, qk, qh, NULL);
+
+  return result;
 }
 
 /*
- * Generate the p, q, n, e and d values needed for the keys
+ * The amount of Miller-Rabin rounds with random bases, after the
+ * Baillie-PSW test, for a random prime candidate of the size
  *
- * Probably: Only do the operation once, and remove the for loop
+ * Credit: FIPS 186-4, table C.3 (M-R tests followed by a Lucas test)
  */
-static inline void rsa_key_values_gen(mpz_t p, mpz_t q, mpz_t n, mpz_t e, mpz_t d, mpz_t phi)
+static inline size_t rsa_prime_rounds(size_t bits)
 {
-  // 1. Choose e
-  mpz_set_ui(e, 3);
+  if (bits >= 1536) return 3;
 
-  for (size_t count = 1; count <= 100; count++)
-  {
-    // 2. Generate large primes p and q
-    rsa_primes_gen(p, q, e);
-
-    // 3. Multiply p and q to get n
-    mpz_mul(n, p, q);
-
-    // 4. Calculate phi
-    mpz_phi(phi, p, q);
+  if (bits >= 1024) return 4;
 
-    // 5. Choose d
-    if (rsa_choose_d(d, e, phi) == 0) break;
+  if (bits >=  512) return 5;
 
-    printf("Failed to generate key values: %ld\n", count);
-  }
+  // Smaller primes are only used by small test keys
+  return 7;
 }
 
 /*
- * Generate the secret and the public keys
+ * Test if a random candidate is a probable prime
+ *
+ * The Baillie-PSW test (Miller-Rabin to base 2 and a strong Lucas test)
+ * is followed by Miller-Rabin rounds with random bases, as many as the
+ * size of the candidate needs. Most composites fail the first round,
+ * so the other rounds are only made for the primes.
+ *
+ * The candidates are already sieved with the small primes,
+ * so there is no trial division here
+ *
+ * PARAMS
+ * - mpz_srcptr n          | The candidate
+ * - gmp_randstate_t state | The state of the random bases
+ *
+ * RETURN (bool result)
+ * - true  | n is a probable prime
+ * - false | n is composite
  */
-void rsa_keys_gen(skey_t* skey, pkey_t* pkey)
+static inline bool rsa_prime_test(mpz_srcptr n, gmp_randstate_t state)
 {
-  mpz_t p, q, n, e, d, phi;
+  if (mpz_cmp_ui(n, 5) < 0) return (mpz_cmp_ui(n, 2) == 0 || mpz_cmp_ui(n, 3) == 0);
 
-  mpz_inits(p, q, n, e, d, phi, NULL);
+  if (mpz_even_p(n)) return false;
 
-  rsa_key_values_gen(p, q, n, e, d, phi);
+  mpz_t base, range;
+  mpz_init_set_ui(base, 2);
+  mpz_init(range);
 
-  if (pkey)
-  {
-    mpz_dup(pkey->n, n);
-    mpz_dup(pkey->e, e);
-  }
+  bool result = rsa_miller_rabin(n, base) && rsa_lucas_test(n);
 
-  if (skey)
+  size_t rounds = rsa_prime_rounds(mpz_sizeinbase(n, 2));
+
+  // The random bases are between 2 and n - 2
+  mpz_sub_ui(range, n, 3);
+
+  for (size_t round = 0; round < rounds && result; round++)
   {
-    mpz_dup(skey->n, n);
-    mpz_dup(skey->e, e);
-    mpz_dup(skey->d, d);
-    mpz_dup(skey->p, p);
-    mpz_dup(skey->q, q);
+    mpz_urandomm(base, state, range);
+    mpz_add_ui(base, base, 2);
+
+    result = rsa_miller_rabin(n, base);
   }
 
-  mpz_clears(p, q, n, e, d, phi, NULL);
+  mpz_clears(base, range, NULL);
+
+  return result;
 }
 
 /*
- * Free the secret and the public keys
+ * The amount of bytes in the random seed of every search thread
  */
-void rsa_keys_free(skey_t* skey, pkey_t* pkey)
-{
-  if (pkey) rsa_pkey_free(pkey);
+#define RSA_SEED_SIZE 32
 
-  if (skey) rsa_skey_free(skey);
-}
+/*
+ * The amount of odd candidates in every window of a prime search
+ */
+#define RSA_PRIME_WINDOW 1024
 
+/*
+ * The search for one prime
+ *
+ * The candidates after the base are split into windows,
+ * and the threads take the next window whenever they need one.
+ * That way no candidate is tested twice.
+ */
 typedef struct
 {
-  size_t ns;
-  char   n[ENCRYPT_SIZE];
-  size_t es;
-  char   e[1];
-} pkey_enc_t;
+  mpz_t  base;   // The odd base of the search
+  size_t window; // The next window to search
+  bool   found;  // If the prime has been found
+  mpz_t  prime;  // The found prime
+} rsa_search_t;
 
 /*
- * It is important to initialize the skey_enc_t to 0,
- * otherwise the result would be written uninitialized values
- *
- * The function allocates memory to result, that has to be freed
+ * The prime searches shared by the threads
  */
-int rsa_pkey_encode(char** result, size_t* size, const pkey_t* key)
+typedef struct
 {
-  if (!result || !size || !key)
-  {
-    errno = EFAULT; // Bad address
-
-    return 1;
-  }
+  rsa_search_t*   searches;
+  size_t          count;
+  mpz_srcptr      e;
+  pthread_mutex_t lock;
+} rsa_searches_t;
 
-  // 1. Serialize the public key cryptography values
-  pkey_enc_t key_enc = { 0 };
-
-  mpz_export(key_enc.n, &key_enc.ns, 1, sizeof(char), 0, 0, key->n);
+/*
+ * The amount of small odd primes in the sieve
+ */
+#define RSA_SIEVE_PRIMES 2048
 
-  mpz_export(key_enc.e, &key_enc.es, 1, sizeof(char), 0, 0, key->e);
+/*
+ * The small odd primes, used to sieve the windows
+ */
+static uint32_t rsa_sieve_primes[RSA_SIEVE_PRIMES];
 
+static pthread_once_t rsa_sieve_once = PTHREAD_ONCE_INIT;
 
-  // 2. Allocate and populate result
-  size_t result_size = sizeof(pkey_enc_t);
+/*
+ * Create the small odd primes, using the sieve of Eratosthenes
+ *
+ * This function is only called once, by pthread_once
+ */
+static void rsa_sieve_primes_create(void)
+{
+  // The 2048th odd prime is below 18000
+  static bool composite[18000];
 
-  char* temp_result = malloc(sizeof(char) * result_size);
+  size_t count = 0;
 
-  if (!temp_result)
+  for (uint32_t number = 3; number < 18000 && count < RSA_SIEVE_PRIMES; number += 2)
   {
-    errno = ENOMEM; // Out of memory
-
-    return 2;
-  }
+    if (composite[number]) continue;
 
-  *result = temp_result;
+    rsa_sieve_primes[count++] = number;
 
-  if (size) *size = result_size;
-
-  memcpy(*result, &key_enc, sizeof(pkey_enc_t));
-
-  return 0;
+    for (uint32_t multiple = number * number; multiple < 18000; multiple += 2 * number)
+    {
+      composite[multiple] = true;
+    }
+  }
 }
 
 /*
- * Initialize public key struct variables
+ * Mark the candidates in the window, that are congruent to value mod modulus
+ *
+ * The candidates are start + 2 * index, and start is odd
+ *
+ * PARAMS
+ * - bool* sieve      | The marked candidates
+ * - uint32_t rest    | The start mod modulus
+ * - uint32_t value   | The value to mark
+ * - uint32_t modulus | The odd modulus
  */
-static inline void rsa_pkey_init(pkey_t* key)
+static inline void rsa_sieve_mark(bool* sieve, uint32_t rest, uint32_t value, uint32_t modulus)
 {
-  mpz_init(key->n);
-  mpz_init(key->e);
+  // 2 * index = value - rest (mod modulus), and (modulus + 1) / 2 is the inverse of 2
+  uint64_t index = (uint64_t) ((value + modulus - rest) % modulus) * ((modulus + 1) / 2) % modulus;
+
+  for (; index < RSA_PRIME_WINDOW; index += modulus)
+  {
+    sieve[index] = true;
+  }
 }
 
 /*
- * Free public key struct variables
+ * Sieve the window of candidates, starting at start
+ *
+ * Candidates divisible by a small prime are composite, and
+ * candidates congruent to 1 mod e can not be used, because
+ * then e is not invertible mod phi and no d exists.
+ * Both are rejected here, before any Miller-Rabin test
+ *
+ * PARAMS
+ * - bool* sieve       | The rejected candidates
+ * - const mpz_t start | The first (odd) candidate
+ * - mpz_srcptr e      | The public exponent
  */
-void rsa_pkey_free(pkey_t* key)
+static inline void rsa_window_sieve(bool* sieve, const mpz_t start, mpz_srcptr e)
 {
-  mpz_clear(key->n);
-  mpz_clear(key->e);
+  pthread_once(&rsa_sieve_once, rsa_sieve_primes_create);
+
+  memset(sieve, false, sizeof(bool) * RSA_PRIME_WINDOW);
+
+  for (size_t index = 0; index < RSA_SIEVE_PRIMES; index++)
+  {
+    uint32_t prime = rsa_sieve_primes[index];
+
+    rsa_sieve_mark(sieve, mpz_fdiv_ui(start, prime), 0, prime);
+  }
+
+  uint32_t exponent = mpz_get_ui(e);
+
+  if (exponent > 1)
+  {
+    rsa_sieve_mark(sieve, mpz_fdiv_ui(start, exponent), 1, exponent);
+  }
 }
 
 /*
- * Decode encoded public key struct
+ * Take the next window of an unfinished search
+ *
+ * The thread stays on its current search, as long as it is not finished
+ *
+ * RETURN (rsa_search_t* search)
+ * - NULL | All searches are finished
  */
-int rsa_pkey_decode(pkey_t* key, const void* message, size_t size)
+static inline rsa_search_t* rsa_window_take(rsa_searches_t* searches, size_t* current, size_t* window)
 {
-  if (!key || !message)
-  {
-    errno = EFAULT; // Bad address
+  rsa_search_t* search = NULL;
 
-    return 1;
-  }
+  pthread_mutex_lock(&searches->lock);
 
-  if (size != sizeof(pkey_enc_t))
+  for (size_t index = 0; index < searches->count; index++)
   {
-    errno = EINVAL; // Invalid argument
+    size_t next = (*current + index) % searches->count;
 
-    return 2;
+    if (!searches->searches[next].found)
+    {
+      search = &searches->searches[next];
+
+      *current = next;
+
+      *window = search->window++;
+
+      break;
+    }
   }
 
-  pkey_enc_t key_enc = { 0 };
+  pthread_mutex_unlock(&searches->lock);
 
-  memcpy(&key_enc, message, sizeof(pkey_enc_t));
+  return search;
+}
 
-  rsa_pkey_init(key);
+/*
+ * Report a found prime, if the search has not already been finished
+ */
+static inline void rsa_prime_found(rsa_searches_t* searches, rsa_search_t* search, mpz_t prime)
+{
+  pthread_mutex_lock(&searches->lock);
 
-  mpz_import(key->n, key_enc.ns, 1, sizeof(char), 0, 0, key_enc.n);
+  if (!search->found)
+  {
+    mpz_set(search->prime, prime);
 
-  mpz_import(key->e, key_enc.es, 1, sizeof(char), 0, 0, key_enc.e);
+    __atomic_store_n(&search->found, true, __ATOMIC_RELEASE);
+  }
 
-  return 0;
+  pthread_mutex_unlock(&searches->lock);
 }
 
+/*
+ * The argument of a search thread
+ */
 typedef struct
 {
-  size_t ns;
-  char   n[ENCRYPT_SIZE];
-  size_t es;
-  char   e[1];
-  size_t ds;
-  char   d[ENCRYPT_SIZE];
-  size_t ps;
-  char   p[BUFFER_SIZE];
-  size_t qs;
-  char   q[BUFFER_SIZE];
-} skey_enc_t;
+  rsa_searches_t* searches;
+  size_t          start;
+  uint8_t         seed[RSA_SEED_SIZE]; // The seed of the random bases
+} rsa_search_arg_t;
 
 /*
- * It is important to initialize the skey_enc_t to 0,
- * otherwise the result would be written uninitialized values
+ * This is the thread function, searching windows until all primes are found
  *
- * The function allocates memory to result, that has to be freed
+ * A thread cancels its window as soon as the search is finished
+ * by another thread, and moves on to a search that is not finished
  */
-int rsa_skey_encode(char** result, size_t* size, const skey_t* key)
+static void* rsa_prime_search_thread(void* arg)
 {
-  if (!result || !size || !key)
-  {
-    errno = EFAULT; // Bad address
+  rsa_searches_t* searches = ((rsa_search_arg_t*) arg)->searches;
 
-    return 1;
-  }
+  size_t current = ((rsa_search_arg_t*) arg)->start;
 
-  // 1. Serialize the secret key cryptography values
-  skey_enc_t key_enc = { 0 };
+  mpz_t candidate, prime;
+  mpz_inits(candidate, prime, NULL);
 
-  mpz_export(key_enc.n, &key_enc.ns, 1, sizeof(char), 0, 0, key->n);
+  gmp_randstate_t state;
+  gmp_randinit_default(state);
 
-  mpz_export(key_enc.e, &key_enc.es, 1, sizeof(char), 0, 0, key->e);
+  mpz_import(prime, RSA_SEED_SIZE, 1, 1, 0, 0, ((rsa_search_arg_t*) arg)->seed);
+  gmp_randseed(state, prime);
 
-  mpz_export(key_enc.d, &key_enc.ds, 1, sizeof(char), 0, 0, key->d);
+  bool sieve[RSA_PRIME_WINDOW];
 
-  mpz_export(key_enc.p, &key_enc.ps, 1, sizeof(char), 0, 0, key->p);
+  size_t window;
+  rsa_search_t* search;
 
-  mpz_export(key_enc.q, &key_enc.qs, 1, sizeof(char), 0, 0, key->q);
+  while ((search = rsa_window_take(searches, &current, &window)))
+  {
+    // candidate = base + 2 * (window * RSA_PRIME_WINDOW)
+    mpz_set_ui(candidate, window);
+    mpz_mul_ui(candidate, candidate, 2 * RSA_PRIME_WINDOW);
+    mpz_add(candidate, candidate, search->base);
 
+    rsa_window_sieve(sieve, candidate, searches->e);
 
-  // 2. Allocate and populate memory of result
-  size_t result_size = sizeof(skey_enc_t);
+    for (size_t index = 0; index < RSA_PRIME_WINDOW; index++)
+    {
+      if (__atomic_load_n(&search->found, __ATOMIC_ACQUIRE)) break;
 
-  char* temp_result = malloc(sizeof(char) * result_size);
+      if (sieve[index]) continue;
 
-  if (!temp_result)
-  {
-    errno = ENOMEM; // Out of memory
+      // candidate = start + 2 * index
+      mpz_add_ui(prime, candidate, 2 * index);
 
-    return 2;
-  }
+      if (rsa_prime_test(prime, state))
+      {
+        rsa_prime_found(searches, search, prime);
 
-  *result = temp_result;
+        break;
+      }
+    }
+  }
 
-  if (size) *size = result_size;
+  gmp_randclear(state);
 
-  memcpy(*result, &key_enc, sizeof(skey_enc_t));
+  mpz_clears(candidate, prime, NULL);
 
-  return 0;
+  return NULL;
 }
 
 /*
- * Initialize secret key struct variables
+ * Get the amount of threads to search for primes with
  */
-static inline void rsa_skey_init(skey_t* key)
+static inline size_t rsa_threads_get(void)
 {
-  mpz_init(key->n);
-  mpz_init(key->e);
-  mpz_init(key->d);
-  mpz_init(key->p);
-  mpz_init(key->q);
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+  return (cores > 0) ? cores : 1;
 }
 
 /*
- * Free secret key struct variables
+ * Search for a number of primes at the same time
+ *
+ * Every prime has its own random base, and all cores search
+ * through the windows of the unfinished primes
+ *
+ * PARAMS
+ * - mpz_t* primes        | The found primes
+ * - size_t count         | The amount of primes
+ * - mpz_srcptr e         | The public exponent
+ * - const size_t sizes[] | The sizes of the primes in bytes
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to get random bytes
+ */
+static inline int rsa_primes_search(mpz_t* primes, size_t count, mpz_srcptr e, const size_t sizes[])
+{
+  rsa_search_t search_array[count];
+
+  for (size_t index = 0; index < count; index++)
+  {
+    mpz_init(search_array[index].base);
+    mpz_init(search_array[index].prime);
+
+    search_array[index].window = 0;
+    search_array[index].found  = false;
+  }
+
+  size_t threads = rsa_threads_get();
+
+  // Every thread has its own seed for the random bases
+  uint8_t seeds[threads][RSA_SEED_SIZE];
+
+  bool failed = (random_bytes(seeds, sizeof(seeds)) != 0);
+
+  for (size_t index = 0; index < count && !failed; index++)
+  {
+    failed = (rsa_prime_base_gen(search_array[index].base, sizes[index]) != 0);
+  }
+
+  if (failed)
+  {
+    for (size_t index = 0; index < count; index++)
+    {
+      mpz_clear(search_array[index].base);
+      mpz_clear(search_array[index].prime);
+    }
+
+    return 1;
+  }
+
+  rsa_searches_t searches = {
+    .searches = search_array,
+    .count    = count,
+    .e        = e
+  };
+
+  pthread_mutex_init(&searches.lock, NULL);
+
+  // 1. Start the threads, spread over the primes
+  pthread_t        thread_ids[threads];
+  rsa_search_arg_t thread_args[threads];
+  bool             created[threads];
+
+  for (size_t index = 0; index < threads; index++)
+  {
+    thread_args[index] = (rsa_search_arg_t) { &searches, index % count };
+
+    memcpy(thread_args[index].seed, seeds[index], RSA_SEED_SIZE);
+  }
+
+  memset(seeds, '\0', sizeof(seeds));
+
+  for (size_t index = 1; index < threads; index++)
+  {
+    created[index] = (pthread_create(&thread_ids[index], NULL, rsa_prime_search_thread, &thread_args[index]) == 0);
+  }
+
+  // 2. The calling thread is searching as well
+  rsa_prime_search_thread(&thread_args[0]);
+
+  for (size_t index = 1; index < threads; index++)
+  {
+    if (created[index]) pthread_join(thread_ids[index], NULL);
+  }
+
+  // 3. Hand out the found primes
+  for (size_t index = 0; index < count; index++)
+  {
+    mpz_set(primes[index], search_array[index].prime);
+
+    mpz_clear(search_array[index].base);
+    mpz_clear(search_array[index].prime);
+  }
+
+  memset(thread_args, '\0', sizeof(thread_args));
+
+  pthread_mutex_destroy(&searches.lock);
+
+  return 0;
+}
+
+/*
+ * Generate the large primes of the key
+ *
+ * The bytes of the modulus are split between the primes,
+ * so that their product has exactly the size of the modulus
+ *
+ * The primes should be good, based on exponent e
+ *
+ * The primes should not be the same number
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to get random bytes
+ */
+static inline int rsa_primes_gen(mpz_t* primes, size_t count, mpz_t e, size_t bits)
+{
+  size_t sizes[count];
+
+  for (size_t index = 0; index < count; index++)
+  {
+    sizes[index] = (bits / 8) / count + (index < (bits / 8) % count);
+  }
+
+  bool distinct;
+
+  do
+  {
+    if (rsa_primes_search(primes, count, e, sizes) != 0) return 1;
+
+    distinct = true;
+
+    for (size_t index = 1; index < count; index++)
+    {
+      for (size_t other = 0; other < index; other++)
+      {
+        if (mpz_cmp(primes[index], primes[other]) == 0) distinct = false;
+      }
+    }
+  }
+  while (!distinct);
+
+  return 0;
+}
+
+/*
+ * Generate the primes, n, e and d values needed for the keys
+ *
+ * The prime search rejects primes congruent to 1 mod e,
+ * so d exists for the first primes
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to get random bytes
+ */
+static inline int rsa_key_values_gen(mpz_t* primes, size_t count, mpz_t n, mpz_t e, mpz_t d, mpz_t phi, size_t bits)
+{
+  // 1. Choose e
+  mpz_set_ui(e, RSA_EXPONENT);
+
+  do
+  {
+    // 2. Generate the large primes
+    if (rsa_primes_gen(primes, count, e, bits) != 0) return 1;
+
+    // 3. Multiply the primes to get n
+    mpz_mul(n, primes[0], primes[1]);
+
+    // 4. Calculate phi
+    mpz_phi(phi, primes[0], primes[1]);
+
+    for (size_t index = 2; index < count; index++)
+    {
+      mpz_mul(n, n, primes[index]);
+
+      mpz_sub_ui(primes[index], primes[index], 1);
+      mpz_mul(phi, phi, primes[index]);
+      mpz_add_ui(primes[index], primes[index], 1);
+    }
+  }
+  // 5. Choose d
+  while (rsa_choose_d(d, e, phi) != 0);
+
+  return 0;
+}
+
+/*
+ * Generate the values needed to decrypt using the Chinese Remainder Theorem
+ *
+ * dp = d mod (p - 1), dq = d mod (q - 1) and qinv = q^-1 mod p
+ *
+ * For every other prime r, dr = d mod (r - 1) and
+ * tr = (p * q * ... up to r)^-1 mod r
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc8017#section-3.2
+ */
+static inline void rsa_crt_values_gen(skey_t* key)
+{
+  mpz_t tmp;
+  mpz_init(tmp);
+
+  mpz_sub_ui(tmp, key->p, 1);
+  mpz_mod(key->dp, key->d, tmp);
+
+  mpz_sub_ui(tmp, key->q, 1);
+  mpz_mod(key->dq, key->d, tmp);
+
+  mpz_invert(key->qinv, key->q, key->p);
+
+  mpz_t product;
+  mpz_init(product);
+
+  mpz_mul(product, key->p, key->q);
+
+  for (size_t index = 0; index + 2 < key->primes; index++)
+  {
+    mpz_sub_ui(tmp, key->r[index], 1);
+    mpz_mod(key->dr[index], key->d, tmp);
+
+    mpz_invert(key->tr[index], product, key->r[index]);
+
+    mpz_mul(product, product, key->r[index]);
+  }
+
+  mpz_clears(tmp, product, NULL);
+}
+
+/*
+ * Initialize secret key struct variables
+ */
+static inline void rsa_skey_init(skey_t* key)
+{
+  mpz_init(key->n);
+  mpz_init(key->e);
+  mpz_init(key->d);
+  mpz_init(key->p);
+  mpz_init(key->q);
+  mpz_init(key->dp);
+  mpz_init(key->dq);
+  mpz_init(key->qinv);
+
+  for (size_t index = 0; index < RSA_PRIMES_MAX - 2; index++)
+  {
+    mpz_inits(key->r[index], key->dr[index], key->tr[index], NULL);
+  }
+
+  key->primes = 2;
+
+  key->view     = false;
+  key->map      = NULL;
+  key->map_size = 0;
+
+  for (size_t index = 0; index < RSA_PRIMES_MAX; index++)
+  {
+    key->rrs[index] = NULL;
+  }
+}
+
+/*
+ * Generate the secret and the public keys
+ *
+ * PARAMS
+ * - skey_t* skey | The secret key, or NULL
+ * - pkey_t* pkey | The public key, or NULL
+ * - size_t bits  | The modulus size in bits
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Invalid modulus size
+ * - 2 | Failed to get random bytes
+ */
+int rsa_keys_gen(skey_t* skey, pkey_t* pkey, size_t bits)
+{
+  return rsa_multi_keys_gen(skey, pkey, bits, 2);
+}
+
+/*
+ * Generate the secret and the public keys, with more than two primes
+ *
+ * The public key is the same as for two primes, only the secret
+ * key has the other primes. A modulus of 2048 bits can have
+ * 3 primes, and a modulus of 4096 bits can have 4 primes
+ *
+ * PARAMS
+ * - skey_t* skey  | The secret key, or NULL
+ * - pkey_t* pkey  | The public key, or NULL
+ * - size_t bits   | The modulus size in bits
+ * - size_t primes | The amount of primes
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Invalid modulus size or amount of primes
+ * - 2 | Failed to get random bytes
+ */
+int rsa_multi_keys_gen(skey_t* skey, pkey_t* pkey, size_t bits, size_t primes)
+{
+  // The primes are half of the modulus, in whole bytes
+  if (bits < RSA_MODULUS_MIN || bits > RSA_MODULUS_MAX || bits % 16 != 0)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 1;
+  }
+
+  if (primes < 2 || primes > RSA_PRIMES_LIMIT(bits))
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 1;
+  }
+
+  mpz_t prime_values[primes];
+
+  for (size_t index = 0; index < primes; index++)
+  {
+    mpz_init(prime_values[index]);
+  }
+
+  mpz_t n, e, d, phi;
+
+  mpz_inits(n, e, d, phi, NULL);
+
+  if (rsa_key_values_gen(prime_values, primes, n, e, d, phi, bits) != 0)
+  {
+    for (size_t index = 0; index < primes; index++)
+    {
+      mpz_clear(prime_values[index]);
+    }
+
+    mpz_clears(n, e, d, phi, NULL);
+
+    return 2;
+  }
+
+  if (pkey)
+  {
+    pkey->size = bits / 8;
+
+    mpz_dup(pkey->n, n);
+    mpz_dup(pkey->e, e);
+  }
+
+  if (skey)
+  {
+    rsa_skey_init(skey);
+
+    skey->size   = bits / 8;
+    skey->primes = primes;
+
+    mpz_set(skey->n, n);
+    mpz_set(skey->e, e);
+    mpz_set(skey->d, d);
+    mpz_set(skey->p, prime_values[0]);
+    mpz_set(skey->q, prime_values[1]);
+
+    for (size_t index = 2; index < primes; index++)
+    {
+      mpz_set(skey->r[index - 2], prime_values[index]);
+    }
+
+    rsa_crt_values_gen(skey);
+  }
+
+  for (size_t index = 0; index < primes; index++)
+  {
+    mpz_clear(prime_values[index]);
+  }
+
+  mpz_clears(n, e, d, phi, NULL);
+
+  return 0;
+}
+
+/*
+ * Free the secret and the public keys
+ */
+void rsa_keys_free(skey_t* skey, pkey_t* pkey)
+{
+  if (pkey) rsa_pkey_free(pkey);
+
+  if (skey) rsa_skey_free(skey);
+}
+
+/*
+ * The encoded keys are independent of architecture and modulus size
+ *
+ * - 4 bytes | The modulus size in bits
+ *
+ * Then every value of the key follows, as
+ *
+ * - 4 bytes | The size of the value in bytes
+ * - n bytes | The value
+ *
+ * All numbers are stored in big-endian byte order
+ */
+#define RSA_WORD_WRITE(BYTES, WORD) \
+  do { \
+    (BYTES)[0] = (uint8_t) ((WORD) >> 24); \
+    (BYTES)[1] = (uint8_t) ((WORD) >> 16); \
+    (BYTES)[2] = (uint8_t) ((WORD) >>  8); \
+    (BYTES)[3] = (uint8_t)  (WORD);        \
+  } while(0)
+
+#define RSA_WORD_READ(BYTES) \
+  (((uint32_t) (BYTES)[0] << 24) | ((uint32_t) (BYTES)[1] << 16) | \
+   ((uint32_t) (BYTES)[2] <<  8) |  (uint32_t) (BYTES)[3])
+
+/*
+ * Get the amount of bytes mpz_export writes for the value
+ */
+static inline size_t mpz_bytes(mpz_srcptr value)
+{
+  return (mpz_sgn(value) == 0) ? 0 : (mpz_sizeinbase(value, 2) + 7) / 8;
+}
+
+/*
+ * Encode the modulus size and the values of a key
+ *
+ * The function allocates memory to result, that has to be freed
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to allocate memory
+ */
+static inline int rsa_values_encode(char** result, size_t* size, size_t bits, mpz_srcptr values[], size_t count)
+{
+  // 1. Calculate the size of the result
+  size_t result_size = 4;
+
+  for (size_t index = 0; index < count; index++)
+  {
+    result_size += 4 + mpz_bytes(values[index]);
+  }
+
+  uint8_t* temp_result = malloc(sizeof(uint8_t) * result_size);
+
+  if (!temp_result)
+  {
+    errno = ENOMEM; // Out of memory
+
+    return 1;
+  }
+
+  // 2. Write the modulus size and every value
+  RSA_WORD_WRITE(temp_result, bits);
+
+  size_t offset = 4;
+
+  for (size_t index = 0; index < count; index++)
+  {
+    size_t value_size;
+
+    mpz_export(temp_result + offset + 4, &value_size, 1, sizeof(char), 0, 0, values[index]);
+
+    RSA_WORD_WRITE(temp_result + offset, value_size);
+
+    offset += 4 + value_size;
+  }
+
+  *result = (char*) temp_result;
+
+  if (size) *size = result_size;
+
+  return 0;
+}
+
+/*
+ * Decode the modulus size and the values of a key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The encoded key is invalid
+ */
+static inline int rsa_values_decode(mpz_ptr values[], size_t count, size_t* bits, const void* message, size_t size)
+{
+  const uint8_t* bytes = message;
+
+  if (size < 4)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 1;
+  }
+
+  *bits = RSA_WORD_READ(bytes);
+
+  if (*bits < RSA_MODULUS_MIN || *bits > RSA_MODULUS_MAX || *bits % 16 != 0)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 1;
+  }
+
+  size_t offset = 4;
+
+  for (size_t index = 0; index < count; index++)
+  {
+    if (size - offset < 4)
+    {
+      errno = EINVAL; // Invalid argument
+
+      return 1;
+    }
+
+    size_t value_size = RSA_WORD_READ(bytes + offset);
+
+    // No value of the key is larger than the modulus
+    if (value_size > *bits / 8 || size - offset - 4 < value_size)
+    {
+      errno = EINVAL; // Invalid argument
+
+      return 1;
+    }
+
+    mpz_import(values[index], value_size, 1, sizeof(char), 0, 0, bytes + offset + 4);
+
+    offset += 4 + value_size;
+  }
+
+  if (offset != size)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 1;
+  }
+
+  return 0;
+}
+
+/*
+ * Encode public key struct
+ *
+ * The function allocates memory to result, that has to be freed
+ */
+int rsa_pkey_encode(char** result, size_t* size, const pkey_t* key)
+{
+  if (!result || !size || !key)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  mpz_srcptr values[] = { key->n, key->e };
+
+  if (rsa_values_encode(result, size, key->size * 8, values, 2) != 0)
+  {
+    return 2;
+  }
+
+  return 0;
+}
+
+/*
+ * Initialize public key struct variables
+ */
+static inline void rsa_pkey_init(pkey_t* key)
+{
+  mpz_init(key->n);
+  mpz_init(key->e);
+}
+
+/*
+ * Free public key struct variables
+ */
+void rsa_pkey_free(pkey_t* key)
+{
+  mpz_clear(key->n);
+  mpz_clear(key->e);
+}
+
+/*
+ * Decode encoded public key struct
+ */
+int rsa_pkey_decode(pkey_t* key, const void* message, size_t size)
+{
+  if (!key || !message)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  rsa_pkey_init(key);
+
+  mpz_ptr values[] = { key->n, key->e };
+
+  size_t bits;
+
+  if (rsa_values_decode(values, 2, &bits, message, size) != 0)
+  {
+    rsa_pkey_free(key);
+
+    return 2;
+  }
+
+  key->size = bits / 8;
+
+  return 0;
+}
+
+/*
+ * The amount of encoded values of a secret key with PRIMES primes
+ *
+ * Every prime after p and q adds r, dr and tr, in that order
+ */
+#define RSA_SKEY_VALUES(PRIMES) (8 + 3 * ((PRIMES) - 2))
+
+/*
+ * Get the values of the secret key, in the order they are encoded
+ *
+ * RETURN (size_t count)
+ */
+static inline size_t rsa_skey_values(mpz_ptr values[], const skey_t* key)
+{
+  mpz_srcptr key_values[] = {
+    key->n, key->e, key->d, key->p, key->q, key->dp, key->dq, key->qinv
+  };
+
+  size_t count = 0;
+
+  for (; count < 8; count++)
+  {
+    values[count] = (mpz_ptr) key_values[count];
+  }
+
+  for (size_t index = 0; index + 2 < key->primes; index++)
+  {
+    values[count++] = (mpz_ptr) key->r[index];
+    values[count++] = (mpz_ptr) key->dr[index];
+    values[count++] = (mpz_ptr) key->tr[index];
+  }
+
+  return count;
+}
+
+/*
+ * Count the encoded values, without decoding them
+ *
+ * RETURN (size_t count)
+ * - 0 | The encoded key is invalid
+ */
+static inline size_t rsa_values_count(const void* message, size_t size)
+{
+  const uint8_t* bytes = message;
+
+  if (size < 4) return 0;
+
+  size_t offset = 4;
+  size_t count  = 0;
+
+  while (offset < size)
+  {
+    if (size - offset < 4) return 0;
+
+    size_t value_size = RSA_WORD_READ(bytes + offset);
+
+    if (size - offset - 4 < value_size) return 0;
+
+    offset += 4 + value_size;
+
+    count++;
+  }
+
+  return count;
+}
+
+/*
+ * Encode secret key struct
+ *
+ * The function allocates memory to result, that has to be freed
+ */
+int rsa_skey_encode(char** result, size_t* size, const skey_t* key)
+{
+  if (!result || !size || !key)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  mpz_ptr values[RSA_SKEY_VALUES(RSA_PRIMES_MAX)];
+
+  size_t count = rsa_skey_values(values, key);
+
+  if (rsa_values_encode(result, size, key->size * 8, (mpz_srcptr*) values, count) != 0)
+  {
+    return 2;
+  }
+
+  return 0;
+}
+
+/*
+ * Free secret key struct variables
+ *
+ * The values of a view point into the encoding, so they are not freed
+ */
+void rsa_skey_free(skey_t* key)
+{
+  if (key->map) munmap((void*) key->map, key->map_size);
+
+  key->map = NULL;
+
+  if (key->view) return;
+
+  mpz_clear(key->n);
+  mpz_clear(key->e);
+  mpz_clear(key->d);
+  mpz_clear(key->p);
+  mpz_clear(key->q);
+  mpz_clear(key->dp);
+  mpz_clear(key->dq);
+  mpz_clear(key->qinv);
+
+  for (size_t index = 0; index < RSA_PRIMES_MAX - 2; index++)
+  {
+    mpz_clears(key->r[index], key->dr[index], key->tr[index], NULL);
+  }
+}
+
+/*
+ * Decode encoded secret key struct
+ */
+int rsa_skey_decode(skey_t* key, const void* message, size_t size)
+{
+  if (!key || !message)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  // The amount of values tells the amount of primes
+  size_t count = rsa_values_count(message, size);
+
+  if (count < RSA_SKEY_VALUES(2) || count > RSA_SKEY_VALUES(RSA_PRIMES_MAX) ||
+      (count - RSA_SKEY_VALUES(2)) % 3 != 0)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  rsa_skey_init(key);
+
+  key->primes = 2 + (count - RSA_SKEY_VALUES(2)) / 3;
+
+  mpz_ptr values[RSA_SKEY_VALUES(RSA_PRIMES_MAX)];
+
+  rsa_skey_values(values, key);
+
+  size_t bits;
+
+  if (rsa_values_decode(values, count, &bits, message, size) != 0)
+  {
+    rsa_skey_free(key);
+
+    return 2;
+  }
+
+  key->size = bits / 8;
+
+  return 0;
+}
+
+/*
+ * The extended secret key has the values as 64-bit words, so that
+ * a 64-bit little-endian machine uses the words as GMP limbs directly
+ *
+ * - 4 bytes | RSA_EXT_MAGIC, "RSAX"
+ * - 4 bytes | RSA_EXT_VERSION
+ * - 4 bytes | The modulus size in bits
+ * - 4 bytes | The amount of primes
+ *
+ * Then every value follows, as
+ *
+ * - 8 bytes     | The amount of words
+ * - 8 * n bytes | The words, least significant first
+ *
+ * First come the values of rsa_skey_encode, and then the Montgomery
+ * constants of every prime: ninv and R^2 mod the prime, which has
+ * as many words as the prime
+ *
+ * All numbers are stored in little-endian byte order,
+ * so every value starts 8-byte aligned
+ */
+#define RSA_EXT_MAGIC   0x58415352 // "RSAX"
+#define RSA_EXT_VERSION 1
+
+#define RSA_EXT_HEADER_SIZE 16
+
+#if GMP_NUMB_BITS == 64 && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define RSA_EXT_NATIVE
+#endif
+
+#define RSA_LE_WORD_WRITE(BYTES, WORD) \
+  do { \
+    (BYTES)[0] = (uint8_t)  (WORD);        \
+    (BYTES)[1] = (uint8_t) ((WORD) >>  8); \
+    (BYTES)[2] = (uint8_t) ((WORD) >> 16); \
+    (BYTES)[3] = (uint8_t) ((WORD) >> 24); \
+  } while(0)
+
+#define RSA_LE_WORD_READ(BYTES) \
+  ( (uint32_t) (BYTES)[0]        | ((uint32_t) (BYTES)[1] <<  8) | \
+   ((uint32_t) (BYTES)[2] << 16) | ((uint32_t) (BYTES)[3] << 24))
+
+/*
+ * Get the amount of 64-bit words of the value
+ */
+static inline size_t rsa_ext_words(mpz_srcptr value)
+{
+  return (mpz_sgn(value) == 0) ? 0 : (mpz_sizeinbase(value, 2) + 63) / 64;
+}
+
+/*
+ * Write a value as words, padded with zeros
+ *
+ * RETURN (size_t size)
+ * - The amount of written bytes
+ */
+static inline size_t rsa_ext_value_write(uint8_t* bytes, mpz_srcptr value, size_t words)
+{
+  RSA_LE_WORD_WRITE(bytes, words);
+  RSA_LE_WORD_WRITE(bytes + 4, 0);
+
+  memset(bytes + 8, 0, 8 * words);
+
+  mpz_export(bytes + 8, NULL, -1, 8, -1, 0, value);
+
+  return 8 + 8 * words;
+}
+
+/*
+ * Read a value, as a view of the words or as a copy
+ *
+ * RETURN (const uint8_t* words)
+ * - NULL | The encoded value is invalid
+ */
+static inline const uint8_t* rsa_ext_value_read(mpz_ptr value, size_t* words, const uint8_t* bytes, size_t* offset, size_t size, bool view)
+{
+  if (size - *offset < 8 || RSA_LE_WORD_READ(bytes + *offset + 4) != 0) return NULL;
+
+  *words = RSA_LE_WORD_READ(bytes + *offset);
+
+  if ((size - *offset - 8) / 8 < *words) return NULL;
+
+  const uint8_t* value_words = bytes + *offset + 8;
+
+  if (view)
+  {
+    mpz_roinit_n(value, (const mp_limb_t*) value_words, *words);
+  }
+  else mpz_import(value, *words, -1, 8, -1, 0, value_words);
+
+  *offset += 8 + 8 * *words;
+
+  return value_words;
+}
+
+/*
+ * Get the primes of the key: p, q and r
+ *
+ * RETURN (size_t count)
+ */
+static inline size_t rsa_skey_primes(mpz_srcptr primes[], const skey_t* key)
+{
+  primes[0] = key->p;
+  primes[1] = key->q;
+
+  for (size_t index = 2; index < key->primes; index++)
+  {
+    primes[index] = key->r[index - 2];
+  }
+
+  return key->primes;
+}
+
+/*
+ * Calculate the Montgomery constants of the prime, R = 2^(64 * words):
+ * -prime^-1 mod 2^64 and R^2 mod prime
+ */
+static inline void rsa_ext_constants(mpz_t ninv, mpz_t rr, mpz_srcptr prime)
+{
+  size_t words = rsa_ext_words(prime);
+
+  mpz_set_ui(rr, 0);
+  mpz_setbit(rr, 64);
+
+  mpz_invert(ninv, prime, rr);
+  mpz_sub(ninv, rr, ninv);
+
+  mpz_set_ui(rr, 0);
+  mpz_setbit(rr, 2 * 64 * words);
+  mpz_mod(rr, rr, prime);
+}
+
+/*
+ * Encode secret key struct in the extended format
+ *
+ * The function allocates memory to result, that has to be freed
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to allocate memory
+ */
+int rsa_skey_ext_encode(char** result, size_t* size, const skey_t* key)
+{
+  if (!result || !size || !key)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  mpz_ptr values[RSA_SKEY_VALUES(RSA_PRIMES_MAX)];
+
+  size_t count = rsa_skey_values(values, key);
+
+  mpz_srcptr primes[RSA_PRIMES_MAX];
+
+  rsa_skey_primes(primes, key);
+
+  // 1. Calculate the size of the result
+  size_t result_size = RSA_EXT_HEADER_SIZE;
+
+  for (size_t index = 0; index < count; index++)
+  {
+    result_size += 8 + 8 * rsa_ext_words(values[index]);
+  }
+
+  for (size_t index = 0; index < key->primes; index++)
+  {
+    result_size += (8 + 8) + (8 + 8 * rsa_ext_words(primes[index]));
+  }
+
+  uint8_t* temp_result = malloc(sizeof(uint8_t) * result_size);
+
+  if (!temp_result)
+  {
+    errno = ENOMEM; // Out of memory
+
+    return 2;
+  }
+
+  // 2. Write the header and the values
+  RSA_LE_WORD_WRITE(temp_result,      RSA_EXT_MAGIC);
+  RSA_LE_WORD_WRITE(temp_result + 4,  RSA_EXT_VERSION);
+  RSA_LE_WORD_WRITE(temp_result + 8,  key->size * 8);
+  RSA_LE_WORD_WRITE(temp_result + 12, key->primes);
+
+  size_t offset = RSA_EXT_HEADER_SIZE;
+
+  for (size_t index = 0; index < count; index++)
+  {
+    offset += rsa_ext_value_write(temp_result + offset, values[index], rsa_ext_words(values[index]));
+  }
+
+  // 3. Write the Montgomery constants
+  mpz_t ninv, rr;
+  mpz_inits(ninv, rr, NULL);
+
+  for (size_t index = 0; index < key->primes; index++)
+  {
+    rsa_ext_constants(ninv, rr, primes[index]);
+
+    offset += rsa_ext_value_write(temp_result + offset, ninv, 1);
+
+    offset += rsa_ext_value_write(temp_result + offset, rr, rsa_ext_words(primes[index]));
+  }
+
+  mpz_clears(ninv, rr, NULL);
+
+  *result = (char*) temp_result;
+  *size   = result_size;
+
+  return 0;
+}
+
+/*
+ * Decode secret key struct in the extended format
+ *
+ * On a 64-bit little-endian machine, the values are views of the
+ * words in the message, without any copy. Then the message has to be
+ * kept until the key is freed, and the values can't be changed.
+ *
+ * The Montgomery constants are checked against the primes, and are
+ * only used by the Montgomery backend, if RSA_MONT is defined.
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The encoded key is invalid
+ */
+int rsa_skey_ext_decode(skey_t* key, const void* message, size_t size)
+{
+  if (!key || !message)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  const uint8_t* bytes = message;
+
+  if (size < RSA_EXT_HEADER_SIZE || RSA_LE_WORD_READ(bytes) != RSA_EXT_MAGIC ||
+      RSA_LE_WORD_READ(bytes + 4) != RSA_EXT_VERSION)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  size_t bits   = RSA_LE_WORD_READ(bytes + 8);
+  size_t primes = RSA_LE_WORD_READ(bytes + 12);
+
+  if (bits < RSA_MODULUS_MIN || bits > RSA_MODULUS_MAX || bits % 16 != 0 ||
+      primes < 2 || primes > RSA_PRIMES_MAX)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  // 1. The values are views if the words are limbs in the right place
+#ifdef RSA_EXT_NATIVE
+  bool view = ((uintptr_t) message % sizeof(mp_limb_t) == 0);
+#else
+  bool view = false;
+#endif
+
+  rsa_skey_init(key);
+
+  if (view)
+  {
+    // The views replace the values, which are not freed
+    rsa_skey_free(key);
+
+    key->view = true;
+  }
+
+  key->primes = primes;
+
+  // 2. Read the values
+  mpz_ptr values[RSA_SKEY_VALUES(RSA_PRIMES_MAX)];
+
+  size_t count = rsa_skey_values(values, key);
+
+  size_t offset = RSA_EXT_HEADER_SIZE;
+
+  size_t words;
+
+  for (size_t index = 0; index < count; index++)
+  {
+    if (!rsa_ext_value_read(values[index], &words, bytes, &offset, size, view))
+    {
+      if (!view) rsa_skey_free(key);
+
+      errno = EINVAL; // Invalid argument
+
+      return 2;
+    }
+  }
+
+  // 3. Read and check the Montgomery constants, only used with the views
+  mpz_srcptr prime_values[RSA_PRIMES_MAX];
+
+  rsa_skey_primes(prime_values, key);
+
+  mpz_t ninv_value, rr_value;
+  mpz_inits(ninv_value, rr_value, NULL);
+
+  for (size_t index = 0; index < primes; index++)
+  {
+    bool valid = (mpz_sgn(prime_values[index]) > 0 && mpz_odd_p(prime_values[index]));
+
+    if (valid) rsa_ext_constants(ninv_value, rr_value, prime_values[index]);
+
+    mpz_t constant;
+
+    if (!view) mpz_init(constant);
+
+    const uint8_t* ninv = valid ? rsa_ext_value_read(constant, &words, bytes, &offset, size, view) : NULL;
+
+    valid = (ninv && words == 1 && mpz_cmp(constant, ninv_value) == 0);
+
+    const uint8_t* rr = valid ? rsa_ext_value_read(constant, &words, bytes, &offset, size, view) : NULL;
+
+    valid = (rr && words == rsa_ext_words(prime_values[index]) && mpz_cmp(constant, rr_value) == 0);
+
+    if (!view) mpz_clear(constant);
+
+    if (!valid)
+    {
+      mpz_clears(ninv_value, rr_value, NULL);
+
+      if (!view) rsa_skey_free(key);
+
+      errno = EINVAL; // Invalid argument
+
+      return 2;
+    }
+
+    if (view)
+    {
+      key->ninvs[index] = *(const uint64_t*) ninv;
+      key->rrs[index]   = (const uint64_t*) rr;
+    }
+  }
+
+  mpz_clears(ninv_value, rr_value, NULL);
+
+  if (offset != size)
+  {
+    if (!view) rsa_skey_free(key);
+
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  key->size = bits / 8;
+
+  return 0;
+}
+
+/*
+ * Load a secret key file in the extended format
+ *
+ * The file is mapped into memory, and the values are views of it
+ * when possible. The mapping is removed by rsa_skey_free.
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to map the file
+ * - 3 | The encoded key is invalid
+ */
+int rsa_skey_ext_load(skey_t* key, const char* path)
+{
+  if (!key || !path)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  int fd = open(path, O_RDONLY);
+
+  if (fd == -1) return 2;
+
+  struct stat file_stat;
+
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size < RSA_EXT_HEADER_SIZE)
+  {
+    close(fd);
+
+    return 2;
+  }
+
+  size_t size = file_stat.st_size;
+
+  void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  close(fd);
+
+  if (map == MAP_FAILED) return 2;
+
+  if (rsa_skey_ext_decode(key, map, size) != 0)
+  {
+    munmap(map, size);
+
+    return 3;
+  }
+
+  // The copied values don't need the file
+  if (!key->view)
+  {
+    munmap(map, size);
+
+    return 0;
+  }
+
+  key->map      = map;
+  key->map_size = size;
+
+  return 0;
+}
+
+/*
+ * Get the fingerprint of the public values of a key
+ *
+ * The fingerprint is the SHA-256 digest of the encoded public key
+ */
+static inline int rsa_fingerprint(uint8_t fingerprint[32], size_t size, mpz_srcptr n, mpz_srcptr e)
+{
+  mpz_srcptr values[] = { n, e };
+
+  char*  buffer;
+  size_t buffer_size;
+
+  if (rsa_values_encode(&buffer, &buffer_size, size * 8, values, 2) != 0)
+  {
+    return 2;
+  }
+
+  sha256_ctx_t ctx;
+
+  sha256_init(&ctx);
+  sha256_update(&ctx, buffer, buffer_size);
+  sha256_final(fingerprint, &ctx);
+
+  free(buffer);
+
+  return 0;
+}
+
+/*
+ * Get the fingerprint of the public key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to encode key
+ */
+int rsa_pkey_fingerprint(uint8_t fingerprint[32], const pkey_t* key)
+{
+  if (!fingerprint || !key)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  return rsa_fingerprint(fingerprint, key->size, key->n, key->e);
+}
+
+/*
+ * Get the fingerprint of the secret key
+ *
+ * It is the same as the fingerprint of the matching public key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to encode key
+ */
+int rsa_skey_fingerprint(uint8_t fingerprint[32], const skey_t* key)
+{
+  if (!fingerprint || !key)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  return rsa_fingerprint(fingerprint, key->size, key->n, key->e);
+}
+
+/*
+ * Copy the value to count limbs, padded with zeros
+ *
+ * EXPECT
+ * - value fits in count limbs
+ */
+static inline void rsa_limbs_get(mp_limb_t* limbs, size_t count, const mpz_t value)
+{
+  size_t size = mpz_size(value);
+
+  mpn_copyi(limbs, mpz_limbs_read(value), size);
+
+  mpn_zero(limbs + size, count - size);
+}
+
+/*
+ * Copy count limbs to the value
+ *
+ * EXPECT
+ * - value has room for count limbs, so it is not reallocated
+ */
+static inline void rsa_limbs_set(mpz_t value, const mp_limb_t* limbs, size_t count)
+{
+  mpn_copyi(mpz_limbs_write(value, count), limbs, count);
+
+  mpz_limbs_finish(value, count);
+}
+
+/*
+ * Get the scratch limbs needed by rsa_ctx_powm for the modulus: the base,
+ * the power and the scratch of mpn_sec_powm
+ *
+ * The Montgomery backend also keeps the exponent limbs in the scratch
+ */
+static inline size_t rsa_ctx_scratch_size(mpz_srcptr modulus, mpz_srcptr exp)
+{
+  size_t limbs = mpz_size(modulus);
+
+#ifdef RSA_MONT
+  return 3 * limbs + mpn_sec_powm_itch(limbs, mpz_sizeinbase(exp, 2), limbs);
+#else
+  return 2 * limbs + mpn_sec_powm_itch(limbs, mpz_sizeinbase(exp, 2), limbs);
+#endif // RSA_MONT
+}
+
+/*
+ * Initialize the context with the moduli and the exponents
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to allocate memory
  */
-void rsa_skey_free(skey_t* key)
+static inline int rsa_ctx_init(rsa_ctx_t* ctx, size_t size, mpz_srcptr moduli[], mpz_srcptr exps[], size_t count)
 {
-  mpz_clear(key->n);
-  mpz_clear(key->e);
-  mpz_clear(key->d);
-  mpz_clear(key->p);
-  mpz_clear(key->q);
+  size_t scratch_size = 0;
+
+  for (size_t index = 0; index < count; index++)
+  {
+    if (mpz_sgn(moduli[index]) <= 0 || mpz_even_p(moduli[index]) || mpz_sgn(exps[index]) <= 0)
+    {
+      errno = EINVAL; // Invalid argument
+
+      return 1;
+    }
+
+    size_t modulus_scratch = rsa_ctx_scratch_size(moduli[index], exps[index]);
+
+    if (modulus_scratch > scratch_size) scratch_size = modulus_scratch;
+  }
+
+  ctx->scratch = malloc(sizeof(mp_limb_t) * scratch_size);
+
+  if (!ctx->scratch)
+  {
+    errno = ENOMEM; // Out of memory
+
+    return 2;
+  }
+
+  ctx->size  = size;
+  ctx->count = count;
+
+  for (size_t index = 0; index < count; index++)
+  {
+    mpz_init_set(ctx->moduli[index], moduli[index]);
+    mpz_init_set(ctx->exps[index], exps[index]);
+
+#ifdef RSA_MONT
+    // The backend is only bound by rsa_ctx_skey_init, for the secret exponents
+    ctx->monts[index].limbs = 0;
+#endif // RSA_MONT
+  }
+
+  for (size_t index = 0; index < RSA_PRIMES_MAX; index++)
+  {
+    mpz_inits(ctx->coeffs[index], ctx->products[index], NULL);
+  }
+
+  mpz_inits(ctx->products[RSA_PRIMES_MAX], ctx->e, NULL);
+
+  // The values have room for the message, and for the products of the CRT
+  size_t bits = 8 * size + 4 * GMP_NUMB_BITS;
+
+  mpz_init2(ctx->values[0], bits);
+  mpz_init2(ctx->values[1], bits);
+  mpz_init2(ctx->values[2], bits);
+
+  return 0;
+}
+
+/*
+ * Bind a context to the public key
+ *
+ * The context has to be freed with rsa_ctx_free
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to allocate memory
+ */
+int rsa_ctx_pkey_init(rsa_ctx_t* ctx, const pkey_t* key)
+{
+  if (!ctx || !key)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  mpz_srcptr moduli[] = { key->n };
+  mpz_srcptr exps[]   = { key->e };
+
+  ctx->secret = false;
+
+  return rsa_ctx_init(ctx, key->size, moduli, exps, 1);
+}
+
+/*
+ * Bind a context to the secret key
+ *
+ * The context decrypts using the Chinese Remainder Theorem,
+ * with one exponentiation for every prime of the key
+ *
+ * The context has to be freed with rsa_ctx_free
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to allocate memory
+ */
+int rsa_ctx_skey_init(rsa_ctx_t* ctx, const skey_t* key)
+{
+  if (!ctx || !key)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  if (key->primes < 2 || key->primes > RSA_PRIMES_MAX)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 1;
+  }
+
+  mpz_srcptr moduli[RSA_PRIMES_MAX] = { key->p,  key->q  };
+  mpz_srcptr exps[RSA_PRIMES_MAX]   = { key->dp, key->dq };
+
+  for (size_t index = 2; index < key->primes; index++)
+  {
+    moduli[index] = key->r[index - 2];
+    exps[index]   = key->dr[index - 2];
+  }
+
+  ctx->secret = true;
+
+  int status = rsa_ctx_init(ctx, key->size, moduli, exps, key->primes);
+
+  if (status != 0) return status;
+
+#ifdef RSA_MONT
+  // The backend is only used for primes of supported sizes
+  for (size_t index = 0; index < key->primes; index++)
+  {
+    size_t limbs = mpz_size(moduli[index]);
+
+    if (!mont_supported(limbs)) continue;
+
+    const uint64_t* modulus = (const uint64_t*) mpz_limbs_read(ctx->moduli[index]);
+
+    // An extended encoding has the constants, so they are not calculated again
+    if (key->rrs[index])
+    {
+      mont_ctx_t* mont = &ctx->monts[index];
+
+      mont->limbs = limbs;
+      mont->ninv  = key->ninvs[index];
+
+      memcpy(mont->n,  modulus,          sizeof(uint64_t) * limbs);
+      memcpy(mont->rr, key->rrs[index], sizeof(uint64_t) * limbs);
+    }
+    else mont_ctx_init(&ctx->monts[index], modulus, limbs);
+  }
+#endif // RSA_MONT
+
+  mpz_set(ctx->coeffs[1], key->qinv);
+
+  mpz_set(ctx->e, key->e);
+
+  // products[index] is the product of the primes before index,
+  // so products[primes] is the modulus n
+  mpz_mul(ctx->products[2], key->p, key->q);
+
+  for (size_t index = 2; index < key->primes; index++)
+  {
+    mpz_set(ctx->coeffs[index], key->tr[index - 2]);
+
+    mpz_mul(ctx->products[index + 1], ctx->products[index], key->r[index - 2]);
+  }
+
+  return 0;
+}
+
+/*
+ * Free the context
+ */
+void rsa_ctx_free(rsa_ctx_t* ctx)
+{
+  if (!ctx) return;
+
+  for (size_t index = 0; index < ctx->count; index++)
+  {
+    mpz_clears(ctx->moduli[index], ctx->exps[index], NULL);
+  }
+
+  for (size_t index = 0; index < RSA_PRIMES_MAX; index++)
+  {
+    mpz_clears(ctx->coeffs[index], ctx->products[index], NULL);
+  }
+
+  mpz_clears(ctx->products[RSA_PRIMES_MAX], ctx->e, NULL);
+
+  mpz_clears(ctx->values[0], ctx->values[1], ctx->values[2], NULL);
+
+  free(ctx->scratch);
+
+  ctx->scratch = NULL;
+  ctx->count   = 0;
+}
+
+/*
+ * Raise the value to the exponent of modulus index, using the context scratch
+ *
+ * The exponentiation takes the same time for all values and exponents
+ * of the same size, so it does not leak the secret exponents
+ */
+static inline void rsa_ctx_powm(rsa_ctx_t* ctx, mpz_t result, const mpz_t value, size_t index)
+{
+  mpz_srcptr modulus = ctx->moduli[index];
+  mpz_srcptr exp     = ctx->exps[index];
+
+  size_t limbs = mpz_size(modulus);
+
+  mp_limb_t* base    = ctx->scratch;
+  mp_limb_t* power   = base + limbs;
+  mp_limb_t* scratch = power + limbs;
+
+  mpz_mod(result, value, modulus);
+
+  rsa_limbs_get(base, limbs, result);
+
+#ifdef RSA_MONT
+  if (ctx->monts[index].limbs != 0)
+  {
+    mp_limb_t* exp_limbs = power + limbs;
+
+    rsa_limbs_get(exp_limbs, limbs, exp);
+
+    mont_powm((uint64_t*) power, (const uint64_t*) base, (const uint64_t*) exp_limbs, &ctx->monts[index]);
+
+    rsa_limbs_set(result, power, limbs);
+
+    return;
+  }
+#endif // RSA_MONT
+
+  mpn_sec_powm(power, base, limbs, mpz_limbs_read(exp), mpz_sizeinbase(exp, 2), mpz_limbs_read(modulus), limbs, scratch);
+
+  rsa_limbs_set(result, power, limbs);
+}
+
+/*
+ * Write the value as exactly size bytes, with leading zero bytes
+ *
+ * EXPECT
+ * - value fits in size bytes
+ */
+static inline void rsa_value_write(void* result, size_t size, const mpz_t value)
+{
+  size_t value_size = mpz_bytes(value);
+
+  memset(result, 0, size - value_size);
+
+  mpz_export((uint8_t*) result + (size - value_size), NULL, 1, sizeof(char), 0, 0, value);
+}
+
+/*
+ * XOR the target with the mask generated from the seed, using MGF1 with SHA-256
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc8017#appendix-B.2.1
+ */
+static inline void rsa_mgf1_xor(uint8_t* target, size_t size, const uint8_t* seed, size_t seed_size)
+{
+  uint8_t digest[RSA_HASH_SIZE];
+
+  for (uint32_t counter = 0; size > 0; counter++)
+  {
+    uint8_t count[4] = { counter >> 24, counter >> 16, counter >> 8, counter };
+
+    sha256_ctx_t sha;
+
+    sha256_init(&sha);
+    sha256_update(&sha, seed, seed_size);
+    sha256_update(&sha, count, sizeof(count));
+    sha256_final(digest, &sha);
+
+    size_t part = (size < RSA_HASH_SIZE) ? size : RSA_HASH_SIZE;
+
+    for (size_t index = 0; index < part; index++)
+    {
+      target[index] ^= digest[index];
+    }
+
+    target += part;
+    size   -= part;
+  }
+}
+
+/*
+ * Get the hash of the empty label, used by OAEP
+ */
+static inline void rsa_label_hash(uint8_t hash[RSA_HASH_SIZE])
+{
+  sha256_ctx_t sha;
+
+  sha256_init(&sha);
+  sha256_final(hash, &sha);
+}
+
+/*
+ * Encode the message into size bytes, using EME-OAEP with SHA-256
+ *
+ * 0x00 maskedSeed maskedDB, where DB is lHash 0x00 ... 0x00 0x01 message
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc8017#section-7.1.1
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to get random bytes
+ *
+ * EXPECT
+ * - msize is at most RSA_MESSAGE_SIZE(size)
+ */
+static inline int rsa_oaep_encode(uint8_t* encoded, size_t size, const void* message, size_t msize)
+{
+  uint8_t* seed  = encoded + 1;
+  uint8_t* block = encoded + 1 + RSA_HASH_SIZE;
+
+  size_t block_size = size - 1 - RSA_HASH_SIZE;
+
+  encoded[0] = 0x00;
+
+  if (random_bytes(seed, RSA_HASH_SIZE) != 0) return 1;
+
+  rsa_label_hash(block);
+
+  memset(block + RSA_HASH_SIZE, 0x00, block_size - RSA_HASH_SIZE - msize - 1);
+
+  block[block_size - msize - 1] = 0x01;
+
+  memcpy(block + block_size - msize, message, msize);
+
+  rsa_mgf1_xor(block, block_size, seed, RSA_HASH_SIZE);
+
+  rsa_mgf1_xor(seed, RSA_HASH_SIZE, block, block_size);
+
+  return 0;
+}
+
+/*
+ * Decode the message from size bytes of EME-OAEP with SHA-256, in place
+ *
+ * Every kind of invalid encoding is found without branching on
+ * the decrypted bytes, so they look the same from the outside
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc8017#section-7.1.2
+ *
+ * PARAMS
+ * - uint8_t* encoded  | The encoded message, is decoded in place
+ * - size_t size       | The size of the encoded message
+ * - size_t* offset    | The offset of the message in encoded
+ *
+ * RETURN (size_t msize)
+ * - The size of the message, or SIZE_MAX if the encoding is invalid
+ */
+static inline size_t rsa_oaep_decode(uint8_t* encoded, size_t size, size_t* offset)
+{
+  uint8_t* seed  = encoded + 1;
+  uint8_t* block = encoded + 1 + RSA_HASH_SIZE;
+
+  size_t block_size = size - 1 - RSA_HASH_SIZE;
+
+  rsa_mgf1_xor(seed, RSA_HASH_SIZE, block, block_size);
+
+  rsa_mgf1_xor(block, block_size, seed, RSA_HASH_SIZE);
+
+  uint8_t hash[RSA_HASH_SIZE];
+
+  rsa_label_hash(hash);
+
+  // bad is 0 as long as the encoding is valid
+  uint8_t bad = encoded[0];
+
+  for (size_t index = 0; index < RSA_HASH_SIZE; index++)
+  {
+    bad |= block[index] ^ hash[index];
+  }
+
+  // found becomes 0xff at the 0x01 separator, after the zero padding
+  uint8_t found = 0x00;
+
+  size_t separator = 0;
+
+  for (size_t index = RSA_HASH_SIZE; index < block_size; index++)
+  {
+    uint8_t one  = -(uint8_t) (block[index] == 0x01);
+    uint8_t zero = -(uint8_t) (block[index] == 0x00);
+
+    separator |= index & (size_t) -(size_t) (one & ~found & 1);
+
+    bad |= ~found & ~one & ~zero;
+
+    found |= one;
+  }
+
+  bad |= ~found;
+
+  if (bad != 0) return SIZE_MAX;
+
+  *offset = 1 + RSA_HASH_SIZE + separator + 1;
+
+  return block_size - separator - 1;
+}
+
+/*
+ * Encrypt message using the context of a public key
+ *
+ * The message is padded with RSAES-OAEP, using SHA-256
+ *
+ * The result is always ctx->size bytes
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to get random bytes
+ */
+int rsa_ctx_encrypt(void* result, size_t* rsize, const void* message, size_t size, rsa_ctx_t* ctx)
+{
+  if (!result || !message || !ctx || ctx->secret)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  // A modulus smaller than the OAEP padding can't encrypt anything
+  if (ctx->size < 2 * RSA_HASH_SIZE + 2 || size > RSA_MESSAGE_SIZE(ctx->size))
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 1;
+  }
+
+  uint8_t encoded[ctx->size];
+
+  if (rsa_oaep_encode(encoded, ctx->size, message, size) != 0) return 2;
+
+  mpz_import(ctx->values[0], ctx->size, 1, sizeof(char), 0, 0, encoded);
+
+  rsa_ctx_powm(ctx, ctx->values[1], ctx->values[0], 0);
+
+  rsa_value_write(result, ctx->size, ctx->values[1]);
+
+  if (rsize) *rsize = ctx->size;
+
+  return 0;
+}
+
+/*
+ * Raise the first scratch value to the secret exponent d, in place
+ *
+ * The Chinese Remainder Theorem is used: one exponentiation
+ * modulo every prime (a fraction of the size of n), which are
+ * then combined into the result modulo n, one prime at a time
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc8017#section-5.1.2
+ */
+static inline void rsa_ctx_crt(rsa_ctx_t* ctx)
+{
+  mpz_ptr c  = ctx->values[0];
+  mpz_ptr mp = ctx->values[1];
+  mpz_ptr m  = ctx->values[2];
+
+  // 1. mp = c^dp mod p and m = c^dq mod q
+  rsa_ctx_powm(ctx, mp, c, 0);
+  rsa_ctx_powm(ctx, m,  c, 1);
+
+  // 2. m = mq + q * ((mp - mq) * qinv mod p)
+  mpz_sub(mp, mp, m);
+  mpz_mul(mp, mp, ctx->coeffs[1]);
+  mpz_mod(mp, mp, ctx->moduli[0]);
+
+  mpz_addmul(m, mp, ctx->moduli[1]);
+
+  // 3. For every other prime: m = m + R * ((mr - m) * tr mod r)
+  for (size_t index = 2; index < ctx->count; index++)
+  {
+    rsa_ctx_powm(ctx, mp, c, index);
+
+    mpz_sub(mp, mp, m);
+    mpz_mul(mp, mp, ctx->coeffs[index]);
+    mpz_mod(mp, mp, ctx->moduli[index]);
+
+    mpz_addmul(m, mp, ctx->products[index]);
+  }
+
+  mpz_swap(c, m);
 }
 
 /*
- * Decode encoded secret key struct
+ * Decrypt encrypted message using the context of a secret key
+ *
+ * The message is decrypted using the Chinese Remainder Theorem,
+ * and the RSAES-OAEP padding is removed
+ *
+ * The result has to fit RSA_MESSAGE_SIZE(ctx->size) bytes
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Decryption error
  */
-int rsa_skey_decode(skey_t* key, const void* message, size_t size)
+int rsa_ctx_decrypt(void* result, size_t* rsize, const void* message, size_t size, rsa_ctx_t* ctx)
 {
-  if (!key || !message)
+  if (!result || !message || !ctx || !ctx->secret)
   {
     errno = EFAULT; // Bad address
 
     return 1;
   }
 
-  if (size != sizeof(skey_enc_t))
+  if (ctx->size < 2 * RSA_HASH_SIZE + 2 || size > ctx->size)
   {
     errno = EINVAL; // Invalid argument
 
+    return 1;
+  }
+
+  mpz_import(ctx->values[0], size, 1, sizeof(char), 0, 0, message);
+
+  // The ciphertext has to be less than n, RSADP step 1
+  if (mpz_cmp(ctx->values[0], ctx->products[ctx->count]) >= 0)
+  {
+    errno = EBADMSG; // Bad message
+
     return 2;
   }
 
-  skey_enc_t key_enc = { 0 };
+  rsa_ctx_crt(ctx);
 
-  memcpy(&key_enc, message, sizeof(skey_enc_t));
+  uint8_t encoded[ctx->size];
 
-  rsa_skey_init(key);
+  rsa_value_write(encoded, ctx->size, ctx->values[0]);
+
+  size_t offset;
 
-  mpz_import(key->n, key_enc.ns, 1, sizeof(char), 0, 0, key_enc.n);
+  size_t msize = rsa_oaep_decode(encoded, ctx->size, &offset);
 
-  mpz_import(key->e, key_enc.es, 1, sizeof(char), 0, 0, key_enc.e);
+  if (msize == SIZE_MAX)
+  {
+    memset(encoded, '\0', ctx->size);
+
+    errno = EBADMSG; // Bad message
+
+    return 2;
+  }
 
-  mpz_import(key->d, key_enc.ds, 1, sizeof(char), 0, 0, key_enc.d);
+  memcpy(result, encoded + offset, msize);
 
-  mpz_import(key->p, key_enc.ps, 1, sizeof(char), 0, 0, key_enc.p);
+  if (rsize) *rsize = msize;
 
-  mpz_import(key->q, key_enc.qs, 1, sizeof(char), 0, 0, key_enc.q);
+  memset(encoded, '\0', ctx->size);
 
   return 0;
 }
 
 /*
  * Encrypt message using RSA public key
+ *
+ * For repeated operations with one key, use rsa_ctx_encrypt
+ *
+ * The result has to fit key->size bytes
  */
 int rsa_encrypt(void* result, size_t* rsize, const void* message, size_t size, pkey_t* key)
 {
-  if (size > MESSAGE_SIZE)
+  rsa_ctx_t ctx;
+
+  if (rsa_ctx_pkey_init(&ctx, key) != 0) return 1;
+
+  int status = rsa_ctx_encrypt(result, rsize, message, size, &ctx);
+
+  rsa_ctx_free(&ctx);
+
+  return status;
+}
+
+/*
+ * Decrypt encrypted message using RSA secret key (private key)
+ *
+ * For repeated operations with one key, use rsa_ctx_decrypt
+ *
+ * The result has to fit key->size bytes
+ */
+int rsa_decrypt(void* result, size_t* rsize, const void* message, size_t size, skey_t* key)
+{
+  rsa_ctx_t ctx;
+
+  if (rsa_ctx_skey_init(&ctx, key) != 0) return 1;
+
+  int status = rsa_ctx_decrypt(result, rsize, message, size, &ctx);
+
+  rsa_ctx_free(&ctx);
+
+  return status;
+}
+
+/*
+ * A batch of messages, shared by the decrypting threads
+ */
+typedef struct
+{
+  void**        results;
+  size_t*       rsizes;
+  const void**  messages;
+  const size_t* sizes;
+  size_t        count;
+  const skey_t* key;
+  size_t        next;   // The next message to decrypt
+  size_t        failed; // The amount of failed messages
+} rsa_batch_t;
+
+/*
+ * This is the thread function, decrypting messages until the batch is done
+ *
+ * Every thread has its own context, and takes the next message
+ * whenever it is done with one, so slow messages don't stall the others
+ */
+static void* rsa_decrypt_batch_thread(void* arg)
+{
+  rsa_batch_t* batch = arg;
+
+  rsa_ctx_t ctx;
+
+  if (rsa_ctx_skey_init(&ctx, batch->key) != 0)
+  {
+    return (void*) 1;
+  }
+
+  size_t index;
+
+  while ((index = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED)) < batch->count)
+  {
+    if (rsa_ctx_decrypt(batch->results[index], &batch->rsizes[index], batch->messages[index], batch->sizes[index], &ctx) != 0)
+    {
+      batch->rsizes[index] = SIZE_MAX;
+
+      __atomic_fetch_add(&batch->failed, 1, __ATOMIC_RELAXED);
+    }
+  }
+
+  rsa_ctx_free(&ctx);
+
+  return NULL;
+}
+
+/*
+ * Decrypt a batch of messages with one secret key, using many threads
+ *
+ * Every result has to fit key->size bytes
+ *
+ * PARAMS
+ * - void* results[]         | The decrypted messages
+ * - size_t rsizes[]         | The sizes of the decrypted messages
+ * - const void* messages[]  | The encrypted messages
+ * - const size_t sizes[]    | The sizes of the encrypted messages
+ * - size_t count            | The amount of messages
+ * - const skey_t* key       | The secret key
+ * - size_t threads          | The amount of threads, or 0 for all cores
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to create the contexts
+ * - 3 | Some messages failed, their sizes are set to SIZE_MAX
+ */
+int rsa_decrypt_batch(void* results[], size_t rsizes[], const void* messages[], const size_t sizes[], size_t count, const skey_t* key, size_t threads)
+{
+  if (!results || !rsizes || !messages || !sizes || !key)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  rsa_batch_t batch = {
+    .results  = results,
+    .rsizes   = rsizes,
+    .messages = messages,
+    .sizes    = sizes,
+    .count    = count,
+    .key      = key,
+    .next     = 0,
+    .failed   = 0
+  };
+
+  if (threads == 0) threads = rsa_threads_get();
+
+  if (threads > count) threads = count;
+
+  if (threads == 0) return 0;
+
+  // 1. Start the threads, the calling thread is one of them
+  pthread_t thread_ids[threads];
+  bool      created[threads];
+
+  for (size_t index = 1; index < threads; index++)
+  {
+    created[index] = (pthread_create(&thread_ids[index], NULL, rsa_decrypt_batch_thread, &batch) == 0);
+  }
+
+  rsa_decrypt_batch_thread(&batch);
+
+  // 2. Wait for the threads to finish
+  for (size_t index = 1; index < threads; index++)
+  {
+    if (created[index]) pthread_join(thread_ids[index], NULL);
+  }
+
+  // If every thread failed to create its context, the messages are left
+  if (batch.next < count)
+  {
+    errno = ENOMEM; // Out of memory
+
+    return 2;
+  }
+
+  return (batch.failed > 0) ? 3 : 0;
+}
+
+/*
+ * The DER encoded DigestInfo of SHA-256, which comes before the digest
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc8017#section-9.2
+ */
+static const uint8_t RSA_SHA256_PREFIX[19] =
+{
+  0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01,
+  0x65, 0x03, 0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20
+};
+
+/*
+ * The size of the DigestInfo and the SHA-256 digest
+ */
+#define RSA_DIGEST_INFO_SIZE (sizeof(RSA_SHA256_PREFIX) + 32)
+
+/*
+ * Encode the message into size bytes, using EMSA-PKCS1-v1_5 with SHA-256
+ *
+ * 0x00 0x01 0xff ... 0xff 0x00 DigestInfo
+ *
+ * EXPECT
+ * - size is at least RSA_DIGEST_INFO_SIZE + 11
+ */
+static inline void rsa_pkcs1_encode(uint8_t* encoded, size_t size, const void* message, size_t msize)
+{
+  sha256_ctx_t sha;
+
+  sha256_init(&sha);
+  sha256_update(&sha, message, msize);
+
+  size_t padding = size - RSA_DIGEST_INFO_SIZE - 3;
+
+  encoded[0] = 0x00;
+  encoded[1] = 0x01;
+
+  memset(encoded + 2, 0xff, padding);
+
+  encoded[2 + padding] = 0x00;
+
+  memcpy(encoded + 3 + padding, RSA_SHA256_PREFIX, sizeof(RSA_SHA256_PREFIX));
+
+  sha256_final(encoded + 3 + padding + sizeof(RSA_SHA256_PREFIX), &sha);
+}
+
+/*
+ * Sign message using the context of a secret key
+ *
+ * The signature is RSASSA-PKCS1-v1_5 with SHA-256,
+ * computed using the Chinese Remainder Theorem
+ *
+ * The signature is always ctx->size bytes
+ *
+ * The signature is checked with the public exponent before it is
+ * written, because a fault in one of the exponentiations of the CRT
+ * would give a signature that reveals a prime of the key
+ * (the Bellcore attack, by Boneh, DeMillo and Lipton)
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The signature is faulty, and is zeroed
+ */
+int rsa_ctx_sign(void* signature, size_t* ssize, const void* message, size_t size, rsa_ctx_t* ctx)
+{
+  if (!signature || !message || !ctx || !ctx->secret)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  if (ctx->size < RSA_DIGEST_INFO_SIZE + 11)
   {
     errno = EINVAL; // Invalid argument
 
     return 1;
   }
 
-  mpz_t m, r;
+  uint8_t encoded[ctx->size];
+
+  rsa_pkcs1_encode(encoded, ctx->size, message, size);
+
+  mpz_import(ctx->values[0], ctx->size, 1, sizeof(char), 0, 0, encoded);
+
+  rsa_ctx_crt(ctx);
 
-  mpz_inits(m, r, NULL);
+  // The signature raised to e has to give the encoded message back
+  mpz_powm(ctx->values[1], ctx->values[0], ctx->e, ctx->products[ctx->count]);
 
-  mpz_import(m, size, 1, sizeof(char), 0, 0, message);
+  mpz_import(ctx->values[2], ctx->size, 1, sizeof(char), 0, 0, encoded);
 
-  mpz_powm(r, m, key->e, key->n);
+  if (mpz_cmp(ctx->values[1], ctx->values[2]) != 0)
+  {
+    mpz_set_ui(ctx->values[0], 0);
+
+    memset(signature, '\0', ctx->size);
 
-  /*
-  gmp_printf("m: %Zd\n", m);
-  gmp_printf("d: %ld\n", mpz_sizeinbase(key->e, 2));
-  gmp_printf("n: %ld\n", mpz_sizeinbase(key->n, 2));
-  gmp_printf("r: %Zd\n", r);
-  */
+    errno = EIO; // Input/output error
+
+    return 2;
+  }
 
-  mpz_export(result, rsize, 1, sizeof(char), 0, 0, r);
+  rsa_value_write(signature, ctx->size, ctx->values[0]);
 
-  mpz_clears(m, r, NULL);
+  if (ssize) *ssize = ctx->size;
 
   return 0;
 }
 
 /*
- * Decrypt encrypted message using RSA secret key (private key)
+ * Verify the signature of message using the context of a public key
+ *
+ * RETURN (int status)
+ * - 0 | The signature is valid
+ * - 1 | Bad input
+ * - 2 | The signature is invalid
  */
-int rsa_decrypt(void* result, size_t* rsize, const void* message, size_t size, skey_t* key)
+int rsa_ctx_verify(const void* signature, size_t ssize, const void* message, size_t size, rsa_ctx_t* ctx)
 {
-  if (size > ENCRYPT_SIZE)
+  if (!signature || !message || !ctx || ctx->secret)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  if (ctx->size < RSA_DIGEST_INFO_SIZE + 11)
   {
     errno = EINVAL; // Invalid argument
 
     return 1;
   }
 
-  mpz_t m, r;
+  if (ssize != ctx->size) return 2;
 
-  mpz_inits(m, r, NULL);
+  mpz_import(ctx->values[0], ssize, 1, sizeof(char), 0, 0, signature);
 
-  mpz_import(m, size, 1, sizeof(char), 0, 0, message);
+  if (mpz_cmp(ctx->values[0], ctx->moduli[0]) >= 0) return 2;
 
-  mpz_powm(r, m, key->d, key->n);
+  rsa_ctx_powm(ctx, ctx->values[1], ctx->values[0], 0);
 
-  /*
-  gmp_printf("m: %Zd\n", m);
-  gmp_printf("d: %ld\n", mpz_sizeinbase(key->d, 2));
-  gmp_printf("n: %ld\n", mpz_sizeinbase(key->n, 2));
-  gmp_printf("r: %Zd\n", r);
-  */
+  uint8_t encoded[ctx->size];
+  uint8_t expected[ctx->size];
 
-  mpz_export(result, rsize, 1, sizeof(char), 0, 0, r);
+  rsa_value_write(encoded, ctx->size, ctx->values[1]);
 
-  mpz_clears(m, r, NULL);
+  rsa_pkcs1_encode(expected, ctx->size, message, size);
 
-  return 0;
+  return (memcmp(encoded, expected, ctx->size) == 0) ? 0 : 2;
+}
+
+/*
+ * Sign message using RSA secret key
+ *
+ * For repeated operations with one key, use rsa_ctx_sign
+ *
+ * The signature is always key->size bytes
+ */
+int rsa_sign(void* signature, size_t* ssize, const void* message, size_t size, skey_t* key)
+{
+  rsa_ctx_t ctx;
+
+  if (rsa_ctx_skey_init(&ctx, key) != 0) return 1;
+
+  int status = rsa_ctx_sign(signature, ssize, message, size, &ctx);
+
+  rsa_ctx_free(&ctx);
+
+  return status;
+}
+
+/*
+ * Verify the signature of message using RSA public key
+ *
+ * For repeated operations with one key, use rsa_ctx_verify
+ *
+ * RETURN (int status)
+ * - 0 | The signature is valid
+ * - 1 | Bad input
+ * - 2 | The signature is invalid
+ */
+int rsa_verify(const void* signature, size_t ssize, const void* message, size_t size, pkey_t* key)
+{
+  rsa_ctx_t ctx;
+
+  if (rsa_ctx_pkey_init(&ctx, key) != 0) return 1;
+
+  int status = rsa_ctx_verify(signature, ssize, message, size, &ctx);
+
+  rsa_ctx_free(&ctx);
+
+  return status;
+}
+
+/*
+ * The amount of public key contexts every verifying thread keeps
+ */
+#define RSA_VERIFY_CONTEXTS 8
+
+/*
+ * A batch of signatures, shared by the verifying threads
+ */
+typedef struct
+{
+  int*          results;
+  const void**  signatures;
+  const size_t* ssizes;
+  const void**  messages;
+  const size_t* sizes;
+  pkey_t**      keys;
+  size_t        count;
+  size_t        next;   // The next signature to verify
+  size_t        failed; // The amount of invalid signatures
+} rsa_verify_batch_t;
+
+/*
+ * The cached contexts of a verifying thread
+ */
+typedef struct
+{
+  const pkey_t* keys[RSA_VERIFY_CONTEXTS];
+  rsa_ctx_t     ctxs[RSA_VERIFY_CONTEXTS];
+  size_t        next; // The next context to replace
+} rsa_ctx_cache_t;
+
+/*
+ * Get the context of the key from the cache
+ *
+ * If the key is not cached, the oldest context is replaced
+ *
+ * RETURN (rsa_ctx_t* ctx)
+ * - NULL | Failed to create context
+ */
+static inline rsa_ctx_t* rsa_ctx_cache_get(rsa_ctx_cache_t* cache, const pkey_t* key)
+{
+  for (size_t index = 0; index < RSA_VERIFY_CONTEXTS; index++)
+  {
+    if (cache->keys[index] == key) return &cache->ctxs[index];
+  }
+
+  size_t index = cache->next;
+
+  cache->next = (cache->next + 1) % RSA_VERIFY_CONTEXTS;
+
+  if (cache->keys[index])
+  {
+    rsa_ctx_free(&cache->ctxs[index]);
+
+    cache->keys[index] = NULL;
+  }
+
+  if (rsa_ctx_pkey_init(&cache->ctxs[index], key) != 0) return NULL;
+
+  cache->keys[index] = key;
+
+  return &cache->ctxs[index];
+}
+
+/*
+ * This is the thread function, verifying signatures until the batch is done
+ *
+ * Every thread caches the contexts of the keys it has used,
+ * so signatures by the same key share one context
+ */
+static void* rsa_verify_batch_thread(void* arg)
+{
+  rsa_verify_batch_t* batch = arg;
+
+  rsa_ctx_cache_t cache = { 0 };
+
+  size_t index;
+
+  while ((index = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED)) < batch->count)
+  {
+    rsa_ctx_t* ctx = rsa_ctx_cache_get(&cache, batch->keys[index]);
+
+    int status = ctx ? rsa_ctx_verify(batch->signatures[index], batch->ssizes[index], batch->messages[index], batch->sizes[index], ctx) : 1;
+
+    batch->results[index] = status;
+
+    if (status != 0) __atomic_fetch_add(&batch->failed, 1, __ATOMIC_RELAXED);
+  }
+
+  for (size_t index = 0; index < RSA_VERIFY_CONTEXTS; index++)
+  {
+    if (cache.keys[index]) rsa_ctx_free(&cache.ctxs[index]);
+  }
+
+  return NULL;
+}
+
+/*
+ * Verify a batch of signatures, using many threads
+ *
+ * Every signature has its own public key. Signatures by the
+ * same key should point to the same pkey_t, so they share a context
+ *
+ * PARAMS
+ * - int results[]            | The status of every signature, as rsa_verify
+ * - const void* signatures[] | The signatures
+ * - const size_t ssizes[]    | The sizes of the signatures
+ * - const void* messages[]   | The signed messages
+ * - const size_t sizes[]     | The sizes of the messages
+ * - pkey_t* keys[]           | The public keys
+ * - size_t count             | The amount of signatures
+ * - size_t threads           | The amount of threads, or 0 for all cores
+ *
+ * RETURN (int status)
+ * - 0 | Every signature is valid
+ * - 1 | Bad input
+ * - 2 | Some signatures are invalid
+ */
+int rsa_verify_batch(int results[], const void* signatures[], const size_t ssizes[], const void* messages[], const size_t sizes[], pkey_t* keys[], size_t count, size_t threads)
+{
+  if (!results || !signatures || !ssizes || !messages || !sizes || !keys)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  rsa_verify_batch_t batch = {
+    .results    = results,
+    .signatures = signatures,
+    .ssizes     = ssizes,
+    .messages   = messages,
+    .sizes      = sizes,
+    .keys       = keys,
+    .count      = count,
+    .next       = 0,
+    .failed     = 0
+  };
+
+  if (threads == 0) threads = rsa_threads_get();
+
+  if (threads > count) threads = count;
+
+  if (threads == 0) return 0;
+
+  // 1. Start the threads, the calling thread is one of them
+  pthread_t thread_ids[threads];
+  bool      created[threads];
+
+  for (size_t index = 1; index < threads; index++)
+  {
+    created[index] = (pthread_create(&thread_ids[index], NULL, rsa_verify_batch_thread, &batch) == 0);
+  }
+
+  rsa_verify_batch_thread(&batch);
+
+  // 2. Wait for the threads to finish
+  for (size_t index = 1; index < threads; index++)
+  {
+    if (created[index]) pthread_join(thread_ids[index], NULL);
+  }
+
+  return (batch.failed > 0) ? 2 : 0;
 }
 
 #endif // RSA_IMPLEMENT
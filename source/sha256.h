@@ -5,7 +5,7 @@
  *
  * Credit: https://sha256algorithm.com
  *
- * Last updated: 2024-12-06
+ * Last updated: 2026-10-18
  *
  *
  * In main compilation unit; define SHA256_IMPLEMENT
@@ -14,6 +14,20 @@
  * These are the available funtions:
  *
  * char* sha256(char hash[64], const void* message, size_t size)
+ *
+ *
+ * void  sha256_init(sha256_ctx_t* ctx)
+ *
+ * void  sha256_update(sha256_ctx_t* ctx, const void* message, size_t size)
+ *
+ * void  sha256_final(uint8_t digest[32], const sha256_ctx_t* ctx)
+ *
+ * void  sha256_ctx_copy(sha256_ctx_t* copy, const sha256_ctx_t* ctx)
+ *
+ *
+ * int   sha256_midstate_export(uint8_t midstate[SHA256_MIDSTATE_SIZE], const sha256_ctx_t* ctx)
+ *
+ * int   sha256_midstate_import(sha256_ctx_t* ctx, const uint8_t midstate[SHA256_MIDSTATE_SIZE])
  */
 
 /*
@@ -25,9 +39,42 @@
 #define SHA256_H
 
 #include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The midstate is the 8 "h"-values and the amount of hashed bytes
+ */
+#define SHA256_MIDSTATE_SIZE 40
+
+/*
+ * Streaming context, used to hash a message piece by piece
+ *
+ * A context can be copied after a shared prefix has been hashed,
+ * and every copy can then be used to hash a different suffix
+ */
+typedef struct
+{
+  uint32_t hs[8];     // The "h"-values
+  uint64_t size;      // The amount of hashed bytes
+  uint8_t  chunk[64]; // The bytes not yet hashed
+} sha256_ctx_t;
 
 extern char* sha256(char hash[64], const void* message, size_t size);
 
+
+extern void  sha256_init(sha256_ctx_t* ctx);
+
+extern void  sha256_update(sha256_ctx_t* ctx, const void* message, size_t size);
+
+extern void  sha256_final(uint8_t digest[32], const sha256_ctx_t* ctx);
+
+extern void  sha256_ctx_copy(sha256_ctx_t* copy, const sha256_ctx_t* ctx);
+
+
+extern int   sha256_midstate_export(uint8_t midstate[SHA256_MIDSTATE_SIZE], const sha256_ctx_t* ctx);
+
+extern int   sha256_midstate_import(sha256_ctx_t* ctx, const uint8_t midstate[SHA256_MIDSTATE_SIZE]);
+
 #endif // SHA256_H
 
 /*
@@ -38,27 +85,27 @@ extern char* sha256(char hash[64], const void* message, size_t size);
 
 #ifdef SHA256_IMPLEMENT
 
-#include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <errno.h>
 
 /*
- * Create a SHA256 hash of the inputted "h"-values
+ * Create a SHA256 hash of the inputted digest
  *
  * PARAMS
- * - char hash[64]      | A pointer to the "will be created"-hash
- * - const uint32 hs[8] | The "h"-values which to create the hash from
+ * - char hash[64]            | A pointer to the "will be created"-hash
+ * - const uint8_t digest[32] | The digest which to create the hash from
  *
  * RETURN (char* hash)
  */
-static inline char* sha_hs_hash(char hash[64], const uint32_t hs[8])
+static inline char* sha_digest_hash(char hash[64], const uint8_t digest[32])
 {
   char temp_hash[64 + 1];
 
-  for(uint8_t index = 0; index < 8; index++)
+  for(uint8_t index = 0; index < 32; index++)
   {
-    sprintf(temp_hash + (index * 8), "%08x", hs[index]);
+    sprintf(temp_hash + (index * 2), "%02x", digest[index]);
   }
 
   strncpy(hash, temp_hash, sizeof(char) * 64);
@@ -194,130 +241,259 @@ static inline void sha_hs_chunk_update(uint32_t hs[8], const uint32_t chunk[16])
 }
 
 /*
- * These bit manipulation macros is ment for 32-bit words
+ * Read a big-endian 32-bit word from bytes
+ */
+#define SHA_WORD_READ(BYTES) \
+  (((uint32_t) (BYTES)[0] << 24) | ((uint32_t) (BYTES)[1] << 16) | \
+   ((uint32_t) (BYTES)[2] <<  8) |  (uint32_t) (BYTES)[3])
+
+/*
+ * Write a 32-bit word as big-endian bytes
+ */
+#define SHA_WORD_WRITE(BYTES, WORD) \
+  do { \
+    (BYTES)[0] = (uint8_t) ((WORD) >> 24); \
+    (BYTES)[1] = (uint8_t) ((WORD) >> 16); \
+    (BYTES)[2] = (uint8_t) ((WORD) >>  8); \
+    (BYTES)[3] = (uint8_t)  (WORD);        \
+  } while(0)
+
+/*
+ * Update the "h"-values with the 64 bytes in the inputted chunk
  *
- * BIT refers to the bit in the words at a specific index
+ * PARAMS
+ * - uint32_t hs[8]          | The "will be updated" "h"-values
+ * - const uint8_t bytes[64] | The current chunk of the message
  */
+static inline void sha_hs_bytes_update(uint32_t hs[8], const uint8_t bytes[64])
+{
+  uint32_t chunk[16];
+
+  for(uint8_t index = 0; index < 16; index++)
+  {
+    chunk[index] = SHA_WORD_READ(bytes + (index * 4));
+  }
 
-// Note: (BIT >> 5) is equivalent to (BIT / 32)
-#define SHA_BIT_WORD(WORDS, BIT) (WORDS)[(BIT) >> 5]
+  sha_hs_chunk_update(hs, chunk);
+}
 
-// Note: (BIT & 0b11111) is equivalent to (BIT % 32)
-#define SHA_WORD_BIT(BIT) (31 - ((BIT) & 0b11111))
+/*
+ * Initialize the context, before hashing a new message
+ *
+ * PARAMS
+ * - sha256_ctx_t* ctx | The context to initialize
+ */
+void sha256_init(sha256_ctx_t* ctx)
+{
+  // first 32 bits of the fractional parts of the square roots of the first 8 primes
+  static const uint32_t SHA_HS[8] = {
+    0x6a09e667,
+    0xbb67ae85,
+    0x3c6ef372,
+    0xa54ff53a,
+    0x510e527f,
+    0x9b05688c,
+    0x1f83d9ab,
+    0x5be0cd19
+  };
 
-#define SHA_BIT_SET(WORDS, BIT) (SHA_BIT_WORD(WORDS, BIT) |=  SHA_LSHIFT(1, SHA_WORD_BIT(BIT)))
+  memcpy(ctx->hs, SHA_HS, sizeof(SHA_HS));
 
-#define SHA_BIT_OFF(WORDS, BIT) (SHA_BIT_WORD(WORDS, BIT) &= ~SHA_LSHIFT(1, SHA_WORD_BIT(BIT)))
+  ctx->size = 0;
+}
 
 /*
- * Prepend the binary representation of the message to the message block
+ * Hash the next part of the message
+ *
+ * Only whole chunks are hashed, the rest is buffered in the context
  *
  * PARAMS
- * - uint32_t* block     | The message block to prepend the message to
- * - const void* message | The message to prepend
+ * - sha256_ctx_t* ctx   | The context
+ * - const void* message | The next part of the message
  * - size_t size         | The amount of bytes (8 bits)
  */
-static inline void sha_block_message_prepend(uint32_t* block, const void* message, size_t size)
+void sha256_update(sha256_ctx_t* ctx, const void* message, size_t size)
 {
-  for(size_t index = 0; index < size; index++)
+  const uint8_t* bytes = message;
+
+  size_t buffered = ctx->size & 0b111111;
+
+  ctx->size += size;
+
+  // 1. Fill up and hash the buffered chunk
+  if(buffered > 0)
   {
-    for(uint8_t bit = 0; bit < 8; bit++)
-    {
-      char word = ((char*) message)[index];
-
-      if(word & SHA_LSHIFT(1, (7 - bit)))
-      {
-        SHA_BIT_SET(block, (index * 8) + bit);
-      }
-      else SHA_BIT_OFF(block, (index * 8) + bit);
-    }
+    size_t count = (size < 64 - buffered) ? size : 64 - buffered;
+
+    memcpy(ctx->chunk + buffered, bytes, count);
+
+    bytes += count;
+    size  -= count;
+
+    if(buffered + count < 64) return;
+
+    sha_hs_bytes_update(ctx->hs, ctx->chunk);
   }
+
+  // 2. Hash the whole chunks directly from the message
+  for(; size >= 64; bytes += 64, size -= 64)
+  {
+    sha_hs_bytes_update(ctx->hs, bytes);
+  }
+
+  // 3. Buffer the rest of the message
+  memcpy(ctx->chunk, bytes, size);
 }
 
 /*
- * Calculate the initial amount of chunks (no extra chunk)
+ * Create the SHA256 digest of the hashed message
+ *
+ * The context is left untouched, so more bytes can be hashed after
  *
- * This is the equivalent to ceil(size / 64)
+ * PARAMS
+ * - uint8_t digest[32]      | The "will be created"-digest
+ * - const sha256_ctx_t* ctx | The context
  */
-#define SHA_INITIAL_CHUNKS(SIZE) (((SIZE) & 0b111111) ? ((SIZE) >> 6) + 1 : (SIZE) >> 6)
+void sha256_final(uint8_t digest[32], const sha256_ctx_t* ctx)
+{
+  uint32_t hs[8];
+
+  memcpy(hs, ctx->hs, sizeof(hs));
+
+  size_t buffered = ctx->size & 0b111111;
+
+  // 1. Append a single '1' to the buffered message
+  uint8_t chunk[64];
+
+  memcpy(chunk, ctx->chunk, buffered);
+
+  chunk[buffered++] = 0x80;
+
+  // 2. If the length does not fit, an extra chunk is needed
+  if(buffered > 56)
+  {
+    memset(chunk + buffered, 0, 64 - buffered);
+
+    sha_hs_bytes_update(hs, chunk);
+
+    buffered = 0;
+  }
+
+  // 3. Add zeros between the message and the length integer
+  memset(chunk + buffered, 0, 56 - buffered);
+
+  // 4. The length is the amount of bits (1 byte = 8 bits)
+  uint64_t length = ctx->size * 8;
+
+  SHA_WORD_WRITE(chunk + 56, (uint32_t) (length >> 32));
+  SHA_WORD_WRITE(chunk + 60, (uint32_t)  length);
+
+  sha_hs_bytes_update(hs, chunk);
+
+  for(uint8_t index = 0; index < 8; index++)
+  {
+    SHA_WORD_WRITE(digest + (index * 4), hs[index]);
+  }
+}
 
 /*
- * Check if an extra chunk is needed
+ * Copy the context, including the buffered bytes
  *
- * Either if the message would occupy the 1-bit and the length bits
- *     or if the message already occupies a whole chunk
+ * PARAMS
+ * - sha256_ctx_t* copy      | The "will be created"-copy
+ * - const sha256_ctx_t* ctx | The context to copy
  */
-#define SHA_EXTRA_CHUNK(SIZE) \
-  ((((SIZE) & 0b111000) == 0b111000) || (((SIZE) & 0b111111) == 0b000000))
+void sha256_ctx_copy(sha256_ctx_t* copy, const sha256_ctx_t* ctx)
+{
+  size_t buffered = ctx->size & 0b111111;
+
+  memcpy(copy->hs, ctx->hs, sizeof(ctx->hs));
 
-#define SHA_CHUNKS(SIZE) \
-  (SHA_EXTRA_CHUNK(SIZE) ? (SHA_INITIAL_CHUNKS(SIZE) + 1) :  SHA_INITIAL_CHUNKS(SIZE))
+  copy->size = ctx->size;
 
-#define SHA_ZEROS(SIZE, CHUNKS) (((CHUNKS) * 64 - (SIZE)) * 8 - 64 - 1)
+  memcpy(copy->chunk, ctx->chunk, buffered);
+}
 
 /*
- * Create the message block needed to generate the SHA256 hash
+ * Export the midstate of the context as bytes
+ *
+ * The midstate only exists when a whole number of chunks has been hashed
  *
  * PARAMS
- * - uint32_t* block     | A pointer to the beginning of the block
- * - size_t chunks       | The amount of chunks in the block
- * - uint16_t zeros      | The amount of zeros between the message and the length
- * - const void* message | The message to hash
- * - size_t size         | The amount of bytes (8 bits)
+ * - uint8_t midstate[40]     | The "will be created"-midstate
+ * - const sha256_ctx_t* ctx | The context
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The context has buffered bytes
  */
-static inline void sha_block_create(uint32_t* block, size_t chunks, uint16_t zeros, const void* message, size_t size)
+int sha256_midstate_export(uint8_t midstate[SHA256_MIDSTATE_SIZE], const sha256_ctx_t* ctx)
 {
-  // 1. Copy the encoded message to the message block
-  sha_block_message_prepend(block, message, size);
+  if(!midstate || !ctx)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
 
-  // 2. Append a single '1' to the encoded message
-  SHA_BIT_SET(block, size * 8);
+  if(ctx->size & 0b111111)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
 
-  // 3. Add zeros between the encoded message and the length integer
-  for(size_t index = 0; index < zeros; index++)
+  for(uint8_t index = 0; index < 8; index++)
   {
-    SHA_BIT_OFF(block, size * 8 + 1 + index);
+    SHA_WORD_WRITE(midstate + (index * 4), ctx->hs[index]);
   }
-  // 4. Copy binary representation of length to end of block
-  // The length is the amount of bits (1 byte = 8 bits)
-  uint64_t length = (uint64_t) size * 8;
 
-  block[(chunks * 16) - 2] = (uint32_t) (length >> 32);
-  block[(chunks * 16) - 1] = (uint32_t) length;
+  SHA_WORD_WRITE(midstate + 32, (uint32_t) (ctx->size >> 32));
+  SHA_WORD_WRITE(midstate + 36, (uint32_t)  ctx->size);
+
+  return 0;
 }
 
 /*
- * Create a SHA256 hash of the inputted message block
+ * Import an exported midstate into the context
  *
  * PARAMS
- * - char hash[64]         | A pointer to the "will be created"-hash
- * - const uint32_t* block | The block to hash 
- * - size_t chunks         | The amount of chunks (512 bits)
+ * - sha256_ctx_t* ctx          | The "will be created"-context
+ * - const uint8_t midstate[40] | The exported midstate
  *
- * RETURN (char* hash)
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The midstate is invalid
  */
-static inline char* sha_block_hash(char hash[64], const uint32_t* block, size_t chunks)
+int sha256_midstate_import(sha256_ctx_t* ctx, const uint8_t midstate[SHA256_MIDSTATE_SIZE])
 {
-  // first 32 bits of the fractional parts of the square roots of the first 8 primes
-  uint32_t hs[8] = {
-    0x6a09e667,
-    0xbb67ae85,
-    0x3c6ef372,
-    0xa54ff53a,
-    0x510e527f,
-    0x9b05688c,
-    0x1f83d9ab,
-    0x5be0cd19
-  };
+  if(!ctx || !midstate)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  uint64_t size = ((uint64_t) SHA_WORD_READ(midstate + 32) << 32) |
+                              SHA_WORD_READ(midstate + 36);
 
-  // Update the "h"-values with every chunk in the block
-  for(size_t index = 0; index < chunks; index++)
+  if(size & 0b111111)
   {
-    // block + (index * 16) points to the current chunk
-    sha_hs_chunk_update(hs, block + (index * 16));
+    errno = EINVAL; // Invalid argument
+
+    return 2;
   }
 
-  return sha_hs_hash(hash, hs); 
+  for(uint8_t index = 0; index < 8; index++)
+  {
+    ctx->hs[index] = SHA_WORD_READ(midstate + (index * 4));
+  }
+
+  ctx->size = size;
+
+  return 0;
 }
 
 /*
@@ -334,18 +510,17 @@ static inline char* sha_block_hash(char hash[64], const uint32_t* block, size_t
  */
 char* sha256(char hash[64], const void* message, size_t size)
 {
-  size_t   chunks = SHA_CHUNKS(size);
-  uint16_t zeros  = SHA_ZEROS (size, chunks);
+  sha256_ctx_t ctx;
 
-  uint32_t* block = malloc(sizeof(uint32_t) * chunks * 16);
+  sha256_init(&ctx);
 
-  sha_block_create(block, chunks, zeros, message, size);
+  sha256_update(&ctx, message, size);
 
-  hash = sha_block_hash(hash, block, chunks);
+  uint8_t digest[32];
 
-  free(block);
+  sha256_final(digest, &ctx);
 
-  return hash;
+  return sha_digest_hash(hash, digest);
 }
 
 #endif // SHA256_IMPLEMENT
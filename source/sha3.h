@@ -0,0 +1,394 @@
+/*
+ * sha3.h - implementation of the SHA3 and SHAKE algorithms
+ *
+ * Written by Hampus Fridholm
+ *
+ * Credit: https://csrc.nist.gov/pubs/fips/202/final
+ *         https://keccak.team/keccak_specs_summary.html
+ *
+ * Last updated: 2026-10-19
+ *
+ *
+ * In main compilation unit; define SHA3_IMPLEMENT
+ *
+ *
+ * These are the available funtions:
+ *
+ * void sha3_256(uint8_t digest[32], const void* message, size_t size)
+ *
+ * void sha3_512(uint8_t digest[64], const void* message, size_t size)
+ *
+ * void shake128(void* result, size_t rsize, const void* message, size_t size)
+ *
+ * void shake256(void* result, size_t rsize, const void* message, size_t size)
+ *
+ *
+ * void shake128_init(sha3_ctx_t* ctx)
+ *
+ * void shake256_init(sha3_ctx_t* ctx)
+ *
+ * void sha3_update(sha3_ctx_t* ctx, const void* message, size_t size)
+ *
+ * void sha3_squeeze(sha3_ctx_t* ctx, void* result, size_t rsize)
+ */
+
+/*
+ * From here on, until SHA3_IMPLEMENT,
+ * it is like a normal header file with declarations
+ */
+
+#ifndef SHA3_H
+#define SHA3_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * The rates of the sponges, in bytes
+ */
+#define SHAKE128_RATE 168
+#define SHAKE256_RATE 136
+#define SHA3_256_RATE 136
+#define SHA3_512_RATE 72
+
+/*
+ * Streaming context, which absorbs a message piece by piece,
+ * and then squeezes out any amount of bytes
+ */
+typedef struct
+{
+  uint64_t state[25];
+  size_t   rate;     // The bytes absorbed or squeezed per permutation
+  size_t   offset;   // The position in the current block
+  uint8_t  suffix;   // The domain separation bits of the padding
+  bool     squeezing;
+} sha3_ctx_t;
+
+extern void sha3_256(uint8_t digest[32], const void* message, size_t size);
+
+extern void sha3_512(uint8_t digest[64], const void* message, size_t size);
+
+extern void shake128(void* result, size_t rsize, const void* message, size_t size);
+
+extern void shake256(void* result, size_t rsize, const void* message, size_t size);
+
+
+extern void shake128_init(sha3_ctx_t* ctx);
+
+extern void shake256_init(sha3_ctx_t* ctx);
+
+extern void sha3_update(sha3_ctx_t* ctx, const void* message, size_t size);
+
+extern void sha3_squeeze(sha3_ctx_t* ctx, void* result, size_t rsize);
+
+#endif // SHA3_H
+
+/*
+ * This header library file uses _IMPLEMENT guards
+ *
+ * If SHA3_IMPLEMENT is defined, the definitions will be included
+ */
+
+#ifdef SHA3_IMPLEMENT
+
+#include <string.h>
+
+#define KECCAK_ROTATE(a, b) (((a) << (b)) | ((a) >> (64 - (b))))
+
+// The round constants of iota
+static const uint64_t KECCAK_RC[24] = {
+  0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000,
+  0x000000000000808b, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
+  0x000000000000008a, 0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
+  0x000000008000808b, 0x800000000000008b, 0x8000000000008089, 0x8000000000008003,
+  0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
+  0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+};
+
+/*
+ * One row of chi, the only non-linear step
+ */
+#define KECCAK_CHI(a, b, y) \
+  a[y]     = b[y]     ^ (~b[y + 1] & b[y + 2]); \
+  a[y + 1] = b[y + 1] ^ (~b[y + 2] & b[y + 3]); \
+  a[y + 2] = b[y + 2] ^ (~b[y + 3] & b[y + 4]); \
+  a[y + 3] = b[y + 3] ^ (~b[y + 4] & b[y]);     \
+  a[y + 4] = b[y + 4] ^ (~b[y]     & b[y + 1]);
+
+/*
+ * The Keccak-f[1600] permutation
+ *
+ * The steps are written out lane by lane, because
+ * the loops over the lanes are much slower without unrolling
+ *
+ * PARAMS
+ * - uint64_t a[25] | The state, lane x + 5 y
+ */
+static void keccak_permute(uint64_t a[25])
+{
+  uint64_t b[25];
+
+  for(int round = 0; round < 24; round++)
+  {
+    // 1. theta, xor every column with its two neighbour columns
+    uint64_t c0 = a[0] ^ a[5] ^ a[10] ^ a[15] ^ a[20];
+    uint64_t c1 = a[1] ^ a[6] ^ a[11] ^ a[16] ^ a[21];
+    uint64_t c2 = a[2] ^ a[7] ^ a[12] ^ a[17] ^ a[22];
+    uint64_t c3 = a[3] ^ a[8] ^ a[13] ^ a[18] ^ a[23];
+    uint64_t c4 = a[4] ^ a[9] ^ a[14] ^ a[19] ^ a[24];
+
+    uint64_t d0 = c4 ^ KECCAK_ROTATE(c1, 1);
+    uint64_t d1 = c0 ^ KECCAK_ROTATE(c2, 1);
+    uint64_t d2 = c1 ^ KECCAK_ROTATE(c3, 1);
+    uint64_t d3 = c2 ^ KECCAK_ROTATE(c4, 1);
+    uint64_t d4 = c3 ^ KECCAK_ROTATE(c0, 1);
+
+    // 2. rho and pi, rotate every lane and move (x, y) to (y, 2 x + 3 y)
+    b[0]  = a[0] ^ d0;
+    b[1]  = KECCAK_ROTATE(a[6]  ^ d1, 44);
+    b[2]  = KECCAK_ROTATE(a[12] ^ d2, 43);
+    b[3]  = KECCAK_ROTATE(a[18] ^ d3, 21);
+    b[4]  = KECCAK_ROTATE(a[24] ^ d4, 14);
+    b[5]  = KECCAK_ROTATE(a[3]  ^ d3, 28);
+    b[6]  = KECCAK_ROTATE(a[9]  ^ d4, 20);
+    b[7]  = KECCAK_ROTATE(a[10] ^ d0, 3);
+    b[8]  = KECCAK_ROTATE(a[16] ^ d1, 45);
+    b[9]  = KECCAK_ROTATE(a[22] ^ d2, 61);
+    b[10] = KECCAK_ROTATE(a[1]  ^ d1, 1);
+    b[11] = KECCAK_ROTATE(a[7]  ^ d2, 6);
+    b[12] = KECCAK_ROTATE(a[13] ^ d3, 25);
+    b[13] = KECCAK_ROTATE(a[19] ^ d4, 8);
+    b[14] = KECCAK_ROTATE(a[20] ^ d0, 18);
+    b[15] = KECCAK_ROTATE(a[4]  ^ d4, 27);
+    b[16] = KECCAK_ROTATE(a[5]  ^ d0, 36);
+    b[17] = KECCAK_ROTATE(a[11] ^ d1, 10);
+    b[18] = KECCAK_ROTATE(a[17] ^ d2, 15);
+    b[19] = KECCAK_ROTATE(a[23] ^ d3, 56);
+    b[20] = KECCAK_ROTATE(a[2]  ^ d2, 62);
+    b[21] = KECCAK_ROTATE(a[8]  ^ d3, 55);
+    b[22] = KECCAK_ROTATE(a[14] ^ d4, 39);
+    b[23] = KECCAK_ROTATE(a[15] ^ d0, 41);
+    b[24] = KECCAK_ROTATE(a[21] ^ d1, 2);
+
+    // 3. chi
+    KECCAK_CHI(a, b, 0);
+    KECCAK_CHI(a, b, 5);
+    KECCAK_CHI(a, b, 10);
+    KECCAK_CHI(a, b, 15);
+    KECCAK_CHI(a, b, 20);
+
+    // 4. iota
+    a[0] ^= KECCAK_RC[round];
+  }
+}
+
+/*
+ * Read a little-endian lane from bytes
+ */
+static inline uint64_t keccak_lane_read(const uint8_t* bytes)
+{
+  uint64_t lane = 0;
+
+  for(int index = 7; index >= 0; index--)
+  {
+    lane = (lane << 8) | bytes[index];
+  }
+
+  return lane;
+}
+
+/*
+ * Write a lane as little-endian bytes
+ */
+static inline void keccak_lane_write(uint8_t* bytes, uint64_t lane)
+{
+  for(int index = 0; index < 8; index++)
+  {
+    bytes[index] = (uint8_t) (lane >> (8 * index));
+  }
+}
+
+/*
+ * Xor a byte into the state, the lanes are little-endian
+ */
+static inline void keccak_byte_xor(uint64_t state[25], size_t index, uint8_t byte)
+{
+  state[index / 8] ^= (uint64_t) byte << (8 * (index % 8));
+}
+
+/*
+ * Initialize the context of a sponge
+ */
+static inline void sha3_init(sha3_ctx_t* ctx, size_t rate, uint8_t suffix)
+{
+  memset(ctx->state, 0, sizeof(ctx->state));
+
+  ctx->rate      = rate;
+  ctx->offset    = 0;
+  ctx->suffix    = suffix;
+  ctx->squeezing = false;
+}
+
+/*
+ * Initialize the context of SHAKE128
+ */
+void shake128_init(sha3_ctx_t* ctx)
+{
+  sha3_init(ctx, SHAKE128_RATE, 0x1F);
+}
+
+/*
+ * Initialize the context of SHAKE256
+ */
+void shake256_init(sha3_ctx_t* ctx)
+{
+  sha3_init(ctx, SHAKE256_RATE, 0x1F);
+}
+
+/*
+ * Absorb the next part of the message
+ *
+ * PARAMS
+ * - sha3_ctx_t* ctx     | The context, which is not squeezing yet
+ * - const void* message | The next part of the message
+ * - size_t size         | The amount of bytes
+ */
+void sha3_update(sha3_ctx_t* ctx, const void* message, size_t size)
+{
+  const uint8_t* bytes = message;
+
+  size_t index = 0;
+
+  while(index < size)
+  {
+    // Whole lanes are xored at once, when the offset is at a lane
+    if(ctx->offset % 8 == 0 && size - index >= 8)
+    {
+      ctx->state[ctx->offset / 8] ^= keccak_lane_read(bytes + index);
+
+      ctx->offset += 8;
+      index       += 8;
+    }
+    else keccak_byte_xor(ctx->state, ctx->offset++, bytes[index++]);
+
+    if(ctx->offset == ctx->rate)
+    {
+      keccak_permute(ctx->state);
+
+      ctx->offset = 0;
+    }
+  }
+}
+
+/*
+ * Squeeze the next bytes out of the sponge
+ *
+ * The first call pads the message, and after it nothing can be absorbed
+ *
+ * PARAMS
+ * - sha3_ctx_t* ctx | The context
+ * - void* result    | The squeezed bytes
+ * - size_t rsize    | The amount of bytes
+ */
+void sha3_squeeze(sha3_ctx_t* ctx, void* result, size_t rsize)
+{
+  uint8_t* bytes = result;
+
+  if(!ctx->squeezing)
+  {
+    // The suffix bits, then the final bit of the pad10*1 padding
+    keccak_byte_xor(ctx->state, ctx->offset, ctx->suffix);
+
+    keccak_byte_xor(ctx->state, ctx->rate - 1, 0x80);
+
+    keccak_permute(ctx->state);
+
+    ctx->offset    = 0;
+    ctx->squeezing = true;
+  }
+
+  size_t index = 0;
+
+  while(index < rsize)
+  {
+    if(ctx->offset == ctx->rate)
+    {
+      keccak_permute(ctx->state);
+
+      ctx->offset = 0;
+    }
+
+    if(ctx->offset % 8 == 0 && rsize - index >= 8)
+    {
+      keccak_lane_write(bytes + index, ctx->state[ctx->offset / 8]);
+
+      ctx->offset += 8;
+      index       += 8;
+    }
+    else
+    {
+      bytes[index++] = (uint8_t) (ctx->state[ctx->offset / 8] >> (8 * (ctx->offset % 8)));
+
+      ctx->offset++;
+    }
+  }
+}
+
+/*
+ * Create the SHA3-256 digest of the message
+ */
+void sha3_256(uint8_t digest[32], const void* message, size_t size)
+{
+  sha3_ctx_t ctx;
+
+  sha3_init(&ctx, SHA3_256_RATE, 0x06);
+
+  sha3_update(&ctx, message, size);
+
+  sha3_squeeze(&ctx, digest, 32);
+}
+
+/*
+ * Create the SHA3-512 digest of the message
+ */
+void sha3_512(uint8_t digest[64], const void* message, size_t size)
+{
+  sha3_ctx_t ctx;
+
+  sha3_init(&ctx, SHA3_512_RATE, 0x06);
+
+  sha3_update(&ctx, message, size);
+
+  sha3_squeeze(&ctx, digest, 64);
+}
+
+/*
+ * Squeeze rsize bytes of SHAKE128 out of the message
+ */
+void shake128(void* result, size_t rsize, const void* message, size_t size)
+{
+  sha3_ctx_t ctx;
+
+  shake128_init(&ctx);
+
+  sha3_update(&ctx, message, size);
+
+  sha3_squeeze(&ctx, result, rsize);
+}
+
+/*
+ * Squeeze rsize bytes of SHAKE256 out of the message
+ */
+void shake256(void* result, size_t rsize, const void* message, size_t size)
+{
+  sha3_ctx_t ctx;
+
+  shake256_init(&ctx);
+
+  sha3_update(&ctx, message, size);
+
+  sha3_squeeze(&ctx, result, rsize);
+}
+
+#endif // SHA3_IMPLEMENT
@@ -0,0 +1,338 @@
+/*
+ * sha512.h - implementation of the SHA512 algorithm
+ *
+ * Written by Hampus Fridholm
+ *
+ * Credit: https://csrc.nist.gov/pubs/fips/180-4/upd1/final
+ *
+ * Last updated: 2026-10-19
+ *
+ *
+ * In main compilation unit; define SHA512_IMPLEMENT
+ *
+ *
+ * These are the available funtions:
+ *
+ * char* sha512(char hash[128], const void* message, size_t size)
+ *
+ *
+ * void  sha512_init(sha512_ctx_t* ctx)
+ *
+ * void  sha512_update(sha512_ctx_t* ctx, const void* message, size_t size)
+ *
+ * void  sha512_final(uint8_t digest[64], const sha512_ctx_t* ctx)
+ */
+
+/*
+ * From here on, until SHA512_IMPLEMENT,
+ * it is like a normal header file with declarations
+ */
+
+#ifndef SHA512_H
+#define SHA512_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Streaming context, used to hash a message piece by piece
+ */
+typedef struct
+{
+  uint64_t hs[8];      // The "h"-values
+  uint64_t size;       // The amount of hashed bytes
+  uint8_t  chunk[128]; // The bytes not yet hashed
+} sha512_ctx_t;
+
+extern char* sha512(char hash[128], const void* message, size_t size);
+
+
+extern void  sha512_init(sha512_ctx_t* ctx);
+
+extern void  sha512_update(sha512_ctx_t* ctx, const void* message, size_t size);
+
+extern void  sha512_final(uint8_t digest[64], const sha512_ctx_t* ctx);
+
+#endif // SHA512_H
+
+/*
+ * This header library file uses _IMPLEMENT guards
+ *
+ * If SHA512_IMPLEMENT is defined, the definitions will be included
+ */
+
+#ifdef SHA512_IMPLEMENT
+
+#include <string.h>
+#include <stdio.h>
+
+#define SHA512_RROTATE(a, b) (((a) >> (b)) | ((a) << (64 - (b))))
+
+#define SHA512_SIG0(x) (SHA512_RROTATE(x, 1) ^ SHA512_RROTATE(x, 8) ^ ((x) >> 7))
+#define SHA512_SIG1(x) (SHA512_RROTATE(x, 19) ^ SHA512_RROTATE(x, 61) ^ ((x) >> 6))
+
+#define SHA512_SUM0(x) (SHA512_RROTATE(x, 28) ^ SHA512_RROTATE(x, 34) ^ SHA512_RROTATE(x, 39))
+#define SHA512_SUM1(x) (SHA512_RROTATE(x, 14) ^ SHA512_RROTATE(x, 18) ^ SHA512_RROTATE(x, 41))
+
+#define SHA512_CHOISE(e, f, g) (((e) & (f)) ^ (~(e) & (g)))
+#define SHA512_MAJORITY(a, b, c) (((a) & (b)) ^ ((a) & (c)) ^ ((b) & (c)))
+
+// first 64 bits of the fractional parts of the cube roots of the first 80 primes
+static const uint64_t SHA512_K[80] = {
+  0x428a2f98d728ae22, 0x7137449123ef65cd, 0xb5c0fbcfec4d3b2f, 0xe9b5dba58189dbbc,
+  0x3956c25bf348b538, 0x59f111f1b605d019, 0x923f82a4af194f9b, 0xab1c5ed5da6d8118,
+  0xd807aa98a3030242, 0x12835b0145706fbe, 0x243185be4ee4b28c, 0x550c7dc3d5ffb4e2,
+  0x72be5d74f27b896f, 0x80deb1fe3b1696b1, 0x9bdc06a725c71235, 0xc19bf174cf692694,
+  0xe49b69c19ef14ad2, 0xefbe4786384f25e3, 0x0fc19dc68b8cd5b5, 0x240ca1cc77ac9c65,
+  0x2de92c6f592b0275, 0x4a7484aa6ea6e483, 0x5cb0a9dcbd41fbd4, 0x76f988da831153b5,
+  0x983e5152ee66dfab, 0xa831c66d2db43210, 0xb00327c898fb213f, 0xbf597fc7beef0ee4,
+  0xc6e00bf33da88fc2, 0xd5a79147930aa725, 0x06ca6351e003826f, 0x142929670a0e6e70,
+  0x27b70a8546d22ffc, 0x2e1b21385c26c926, 0x4d2c6dfc5ac42aed, 0x53380d139d95b3df,
+  0x650a73548baf63de, 0x766a0abb3c77b2a8, 0x81c2c92e47edaee6, 0x92722c851482353b,
+  0xa2bfe8a14cf10364, 0xa81a664bbc423001, 0xc24b8b70d0f89791, 0xc76c51a30654be30,
+  0xd192e819d6ef5218, 0xd69906245565a910, 0xf40e35855771202a, 0x106aa07032bbd1b8,
+  0x19a4c116b8d2d0c8, 0x1e376c085141ab53, 0x2748774cdf8eeb99, 0x34b0bcb5e19b48a8,
+  0x391c0cb3c5c95a63, 0x4ed8aa4ae3418acb, 0x5b9cca4f7763e373, 0x682e6ff3d6b2b8a3,
+  0x748f82ee5defb2fc, 0x78a5636f43172f60, 0x84c87814a1f0ab72, 0x8cc702081a6439ec,
+  0x90befffa23631e28, 0xa4506cebde82bde9, 0xbef9a3f7b2c67915, 0xc67178f2e372532b,
+  0xca273eceea26619c, 0xd186b8c721c0c207, 0xeada7dd6cde0eb1e, 0xf57d4f7fee6ed178,
+  0x06f067aa72176fba, 0x0a637dc5a2c898a6, 0x113f9804bef90dae, 0x1b710b35131c471b,
+  0x28db77f523047d84, 0x32caab7b40c72493, 0x3c9ebe0a15c9bebc, 0x431d67c49c100d4c,
+  0x4cc5d4becb3e42b6, 0x597f299cfc657e2a, 0x5fcb6fab3ad6faec, 0x6c44198c4a475817
+};
+
+/*
+ * Read a big-endian 64-bit word from bytes
+ */
+static inline uint64_t sha512_word_read(const uint8_t* bytes)
+{
+  uint64_t word = 0;
+
+  for(uint8_t index = 0; index < 8; index++)
+  {
+    word = (word << 8) | bytes[index];
+  }
+
+  return word;
+}
+
+/*
+ * Write a 64-bit word as big-endian bytes
+ */
+static inline void sha512_word_write(uint8_t* bytes, uint64_t word)
+{
+  for(uint8_t index = 0; index < 8; index++)
+  {
+    bytes[index] = (uint8_t) (word >> (56 - 8 * index));
+  }
+}
+
+/*
+ * Update the "h"-values with the 128 bytes in the inputted chunk
+ *
+ * PARAMS
+ * - uint64_t hs[8]           | The "will be updated" "h"-values
+ * - const uint8_t bytes[128] | The current chunk of the message
+ */
+static inline void sha512_hs_bytes_update(uint64_t hs[8], const uint8_t bytes[128])
+{
+  // 1. Create an 80-entry message schedule array w[0..79] of 64-bit words
+  uint64_t w[80];
+
+  for(uint8_t index = 0; index < 16; index++)
+  {
+    w[index] = sha512_word_read(bytes + (index * 8));
+  }
+
+  for(uint8_t index = 16; index < 80; index++)
+  {
+    w[index] = w[index - 16] + SHA512_SIG0(w[index - 15]) + w[index - 7] + SHA512_SIG1(w[index - 2]);
+  }
+
+  // 2. Initialize working variables to the current hash value
+  uint64_t a = hs[0];
+  uint64_t b = hs[1];
+  uint64_t c = hs[2];
+  uint64_t d = hs[3];
+  uint64_t e = hs[4];
+  uint64_t f = hs[5];
+  uint64_t g = hs[6];
+  uint64_t h = hs[7];
+
+  for(uint8_t index = 0; index < 80; index++)
+  {
+    uint64_t t1 = h + SHA512_SUM1(e) + SHA512_CHOISE(e, f, g) + SHA512_K[index] + w[index];
+    uint64_t t2 = SHA512_SUM0(a) + SHA512_MAJORITY(a, b, c);
+
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+
+  // 3. Add the working variables to the current hash value
+  hs[0] += a;
+  hs[1] += b;
+  hs[2] += c;
+  hs[3] += d;
+  hs[4] += e;
+  hs[5] += f;
+  hs[6] += g;
+  hs[7] += h;
+}
+
+/*
+ * Initialize the context, before hashing a new message
+ *
+ * PARAMS
+ * - sha512_ctx_t* ctx | The context to initialize
+ */
+void sha512_init(sha512_ctx_t* ctx)
+{
+  // first 64 bits of the fractional parts of the square roots of the first 8 primes
+  static const uint64_t SHA512_HS[8] = {
+    0x6a09e667f3bcc908,
+    0xbb67ae8584caa73b,
+    0x3c6ef372fe94f82b,
+    0xa54ff53a5f1d36f1,
+    0x510e527fade682d1,
+    0x9b05688c2b3e6c1f,
+    0x1f83d9abfb41bd6b,
+    0x5be0cd19137e2179
+  };
+
+  memcpy(ctx->hs, SHA512_HS, sizeof(SHA512_HS));
+
+  ctx->size = 0;
+}
+
+/*
+ * Hash the next part of the message
+ *
+ * Only whole chunks are hashed, the rest is buffered in the context
+ *
+ * PARAMS
+ * - sha512_ctx_t* ctx   | The context
+ * - const void* message | The next part of the message
+ * - size_t size         | The amount of bytes (8 bits)
+ */
+void sha512_update(sha512_ctx_t* ctx, const void* message, size_t size)
+{
+  const uint8_t* bytes = message;
+
+  size_t buffered = ctx->size & 0b1111111;
+
+  ctx->size += size;
+
+  // 1. Fill up and hash the buffered chunk
+  if(buffered > 0)
+  {
+    size_t count = (size < 128 - buffered) ? size : 128 - buffered;
+
+    memcpy(ctx->chunk + buffered, bytes, count);
+
+    bytes += count;
+    size  -= count;
+
+    if(buffered + count < 128) return;
+
+    sha512_hs_bytes_update(ctx->hs, ctx->chunk);
+  }
+
+  // 2. Hash the whole chunks directly from the message
+  for(; size >= 128; bytes += 128, size -= 128)
+  {
+    sha512_hs_bytes_update(ctx->hs, bytes);
+  }
+
+  // 3. Buffer the rest of the message
+  memcpy(ctx->chunk, bytes, size);
+}
+
+/*
+ * Create the SHA512 digest of the hashed message
+ *
+ * The context is left untouched, so more bytes can be hashed after
+ *
+ * PARAMS
+ * - uint8_t digest[64]      | The "will be created"-digest
+ * - const sha512_ctx_t* ctx | The context
+ */
+void sha512_final(uint8_t digest[64], const sha512_ctx_t* ctx)
+{
+  uint64_t hs[8];
+
+  memcpy(hs, ctx->hs, sizeof(hs));
+
+  size_t buffered = ctx->size & 0b1111111;
+
+  // 1. Append a single '1' to the buffered message
+  uint8_t chunk[128];
+
+  memcpy(chunk, ctx->chunk, buffered);
+
+  chunk[buffered++] = 0x80;
+
+  // 2. If the length does not fit, an extra chunk is needed
+  if(buffered > 112)
+  {
+    memset(chunk + buffered, 0, 128 - buffered);
+
+    sha512_hs_bytes_update(hs, chunk);
+
+    buffered = 0;
+  }
+
+  // 3. Add zeros between the message and the 128-bit length integer
+  memset(chunk + buffered, 0, 120 - buffered);
+
+  // 4. The length is the amount of bits (1 byte = 8 bits)
+  sha512_word_write(chunk + 120, ctx->size * 8);
+
+  sha512_hs_bytes_update(hs, chunk);
+
+  for(uint8_t index = 0; index < 8; index++)
+  {
+    sha512_word_write(digest + (index * 8), hs[index]);
+  }
+}
+
+/*
+ * Create a SHA512 hash of the inputted message
+ *
+ * PARAMS
+ * - char hash[128]      | A pointer to the "will be created"-hash
+ * - const void* message | The message which to hash
+ * - size_t size         | The amount of bytes (8 bits)
+ *
+ * RETURN (char* hash)
+ */
+char* sha512(char hash[128], const void* message, size_t size)
+{
+  sha512_ctx_t ctx;
+
+  sha512_init(&ctx);
+
+  sha512_update(&ctx, message, size);
+
+  uint8_t digest[64];
+
+  sha512_final(digest, &ctx);
+
+  char temp_hash[128 + 1];
+
+  for(uint8_t index = 0; index < 64; index++)
+  {
+    sprintf(temp_hash + (index * 2), "%02x", digest[index]);
+  }
+
+  memcpy(hash, temp_hash, 128);
+
+  return hash;
+}
+
+#endif // SHA512_IMPLEMENT
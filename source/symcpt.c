@@ -3,7 +3,7 @@
  *
  * Written by Hampus Fridholm
  *
- * Last updated: 2024-11-15
+ * Last updated: 2026-10-19
  */
 
 #define AES_IMPLEMENT
@@ -12,30 +12,111 @@
 #define FILE_IMPLEMENT
 #include "file.h"
 
+#define CRC32C_IMPLEMENT
+#include "crc32c.h"
+
 #define DEBUG_IMPLEMENT
 #include "debug.h"
 
 #define SHA256_IMPLEMENT
 #include "sha256.h"
 
+#define BLAKE3_IMPLEMENT
+#include "blake3.h"
+
+#define ARGON2_IMPLEMENT
+#include "argon2.h"
+
+#define BLAKE2B_IMPLEMENT
+#include "blake2b.h"
+
+#define RANDOM_IMPLEMENT
+#include "random.h"
+
+#define CHACHA20POLY1305_IMPLEMENT
+#include "chacha20poly1305.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
 #include <unistd.h>
 #include <stdbool.h>
 #include <string.h>
+#include <errno.h>
 #include <argp.h>
 
 
 #define DEFAULT_CIPHER "aes256"
 
+#define DEFAULT_HASH   "argon2id"
+
+/*
+ * The default Argon2id costs, 64 MiB and 3 passes over 4 lanes
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc9106#section-4
+ */
+#define DEFAULT_MEMORY 65536
+#define DEFAULT_TIME   3
+#define DEFAULT_LANES  4
+
+/*
+ * Larger costs in a file header are refused,
+ * so a damaged header can't make symcpt use all memory
+ */
+#define MAX_MEMORY 4194304
+#define MAX_TIME   1024
+#define MAX_LANES  1024
+
+/*
+ * A file encrypted with an Argon2id key starts with this header
+ *
+ * - 4 bytes  | HEADER_ID (big-endian)
+ * - 4 bytes  | The memory in KiB (big-endian)
+ * - 4 bytes  | The amount of passes (big-endian)
+ * - 4 bytes  | The amount of lanes (big-endian)
+ * - 16 bytes | The salt
+ */
+#define HEADER_ID   0x41324944 // "A2ID"
+
+#define HEADER_SIZE (16 + ARGON2_SALT_SIZE)
+
+/*
+ * The password hash functions all create a 64 character hash
+ *
+ * Argon2id also needs a salt and costs, so it is not a hash_func_t
+ */
+typedef char* (*hash_func_t)(char hash[64], const void* message, size_t size);
+
+/*
+ * The ciphers all encrypt and decrypt with the signature of aes.h
+ */
+typedef int (*cipher_func_t)(uint8_t** result, size_t* rsize, const void* message, size_t msize, const void* key, ksize_t ksize);
+
+/*
+ * The cipher used for the payload
+ *
+ * min_size is the size of the smallest encrypted payload,
+ * which is the password hash and at least one byte
+ */
+typedef struct
+{
+  cipher_func_t encrypt;
+  cipher_func_t decrypt;
+  ksize_t       key_size;
+  size_t        min_size;
+} cipher_t;
+
 static char doc[] = "symcpt - symetric cryptography utillity";
 
 static char args_doc[] = "[INPUT] [OUTPUT]";
 
 static struct argp_option options[] =
 {
-  { "cipher",   'c', "STRING", 0, "AES cipher" },
+  { "cipher",   'c', "STRING", 0, "Cipher: aes256, aes192, aes128 or chacha20" },
+  { "hash",     'H', "STRING", 0, "Password hash: argon2id, sha256 or blake3" },
+  { "memory",   'm', "KIB",    0, "Argon2id memory in KiB" },
+  { "time",     't', "COUNT",  0, "Argon2id passes over the memory" },
+  { "lanes",    'l', "COUNT",  0, "Argon2id lanes, hashed in parallel" },
   { "password", 'p', "STRING", 0, "Encryption password" },
   { "encrypt",  'e', 0,        0, "Encrypt file" },
   { "decrypt",  'd', 0,        0, "Decrypt file" },
@@ -47,23 +128,59 @@ static struct argp_option options[] =
 
 struct args
 {
-  char* args[2];
-  char* cipher;
-  char* password;
-  bool  encrypt;
-  bool  quiet;
-  bool  debug;
+  char*    args[2];
+  char*    cipher;
+  char*    hash;
+  uint32_t memory;
+  uint32_t time;
+  uint32_t lanes;
+  char*    password;
+  bool     encrypt;
+  bool     quiet;
+  bool     debug;
 };
 
 struct args args =
 {
   .cipher   = DEFAULT_CIPHER,
+  .hash     = DEFAULT_HASH,
+  .memory   = DEFAULT_MEMORY,
+  .time     = DEFAULT_TIME,
+  .lanes    = DEFAULT_LANES,
   .password = NULL,
   .encrypt  = true,
   .quiet    = false,
   .debug    = false
 };
 
+/*
+ * Parse an Argon2id cost, which has to be a number from 1 to max
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The cost is not a number, or out of range
+ */
+static int cost_parse(uint32_t* cost, const char* arg, uint32_t max)
+{
+  char* end;
+
+  errno = 0;
+
+  unsigned long value = strtoul(arg, &end, 10);
+
+  // strtoul accepts a minus sign, and negates the value
+  if(errno != 0 || end == arg || *end != '\0' || strchr(arg, '-'))
+  {
+    return 1;
+  }
+
+  if(value < 1 || value > max) return 1;
+
+  *cost = (uint32_t) value;
+
+  return 0;
+}
+
 /*
  * This is the option parsing function used by argp
  */
@@ -77,6 +194,25 @@ static error_t opt_parse(int key, char* arg, struct argp_state* state)
       args->cipher = arg;
       break;
 
+    case 'H':
+      args->hash = arg;
+      break;
+
+    case 'm':
+      if(cost_parse(&args->memory, arg, MAX_MEMORY) != 0)
+        argp_error(state, "memory must be 1 to %d KiB", MAX_MEMORY);
+      break;
+
+    case 't':
+      if(cost_parse(&args->time, arg, MAX_TIME) != 0)
+        argp_error(state, "time must be 1 to %d passes", MAX_TIME);
+      break;
+
+    case 'l':
+      if(cost_parse(&args->lanes, arg, MAX_LANES) != 0)
+        argp_error(state, "lanes must be 1 to %d", MAX_LANES);
+      break;
+
     case 'p':
       args->password = arg;
       break;
@@ -109,6 +245,10 @@ static error_t opt_parse(int key, char* arg, struct argp_state* state)
 
     case ARGP_KEY_END:
       if(state->arg_num < 2) argp_usage(state);
+
+      // Argon2id needs at least 8 KiB of memory per lane
+      if(args->memory < 8 * args->lanes)
+        argp_error(state, "memory must be at least 8 KiB per lane");
       break;
 
     default:
@@ -118,17 +258,153 @@ static error_t opt_parse(int key, char* arg, struct argp_state* state)
   return 0;
 }
 
+/*
+ * Write a 32-bit word as big-endian bytes
+ */
+static void word_write(uint8_t bytes[4], uint32_t word)
+{
+  bytes[0] = (uint8_t) (word >> 24);
+  bytes[1] = (uint8_t) (word >> 16);
+  bytes[2] = (uint8_t) (word >>  8);
+  bytes[3] = (uint8_t)  word;
+}
+
+/*
+ * Read a 32-bit big-endian word
+ */
+static uint32_t word_read(const uint8_t bytes[4])
+{
+  return ((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16) |
+         ((uint32_t) bytes[2] <<  8) |  (uint32_t) bytes[3];
+}
+
+/*
+ * Hash the password to a key with Argon2id
+ *
+ * The tag is 64 bytes, like the hashes of the other functions
+ */
+static int argon2_key_get(char key[64], const void* password, size_t psize, const uint8_t salt[ARGON2_SALT_SIZE], const argon2_params_t* params)
+{
+  if(args.debug)
+    info_print("Argon2id: %ld KiB, %ld passes, %ld lanes", (long) params->memory, (long) params->time, (long) params->lanes);
+
+  return argon2id((uint8_t*) key, 64, password, psize, salt, ARGON2_SALT_SIZE, params, 0);
+}
+
+/*
+ * Create the key of a new file, and its header
+ *
+ * Argon2id gets a new salt, which is stored with the costs in the header.
+ * The other hashes have no header.
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to hash the password
+ */
+static int key_create(char key[64], uint8_t header[HEADER_SIZE], size_t* hsize, const void* password, size_t psize, hash_func_t hash_func)
+{
+  *hsize = 0;
+
+  if(hash_func)
+  {
+    return hash_func(key, password, psize) ? 0 : 1;
+  }
+
+  argon2_params_t params = { args.memory, args.time, args.lanes };
+
+  uint8_t* salt = header + 16;
+
+  if(random_bytes(salt, ARGON2_SALT_SIZE) != 0) return 1;
+
+  if(argon2_key_get(key, password, psize, salt, &params) != 0) return 1;
+
+  word_write(header,      HEADER_ID);
+  word_write(header + 4,  params.memory);
+  word_write(header + 8,  params.time);
+  word_write(header + 12, params.lanes);
+
+  *hsize = HEADER_SIZE;
+
+  return 0;
+}
+
+/*
+ * Get the key of an encrypted file, using the costs in its header
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to hash the password
+ * - 2 | The header is missing or invalid
+ */
+static int key_read(char key[64], size_t* hsize, const void* message, size_t msize, const void* password, size_t psize, hash_func_t hash_func)
+{
+  *hsize = 0;
+
+  if(hash_func)
+  {
+    return hash_func(key, password, psize) ? 0 : 1;
+  }
+
+  const uint8_t* header = message;
+
+  if(msize < HEADER_SIZE || word_read(header) != HEADER_ID)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "symcpt: File has no Argon2id header, it might use another hash\n");
+
+    return 2;
+  }
+
+  argon2_params_t params = {
+    .memory = word_read(header + 4),
+    .time   = word_read(header + 8),
+    .lanes  = word_read(header + 12)
+  };
+
+  if(params.memory > MAX_MEMORY || params.time > MAX_TIME || params.lanes > MAX_LANES)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "symcpt: Argon2id costs in header are to large\n");
+
+    return 2;
+  }
+
+  if(argon2_key_get(key, password, psize, header + 16, &params) != 0) return 1;
+
+  *hsize = HEADER_SIZE;
+
+  return 0;
+}
+
 /*
  * Symetric encrypt a message
+ *
+ * The result is: header, encrypted payload
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Supplied arguments invalid
+ * - 2 | Failed to encrypt the payload
+ * - 3 | Failed to hash the password
+ * - 4 | Failed to allocate memory
  */
-static int sym_encrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const void* password, size_t psize, ksize_t key_size)
+static int sym_encrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const void* password, size_t psize, const cipher_t* cipher, hash_func_t hash_func)
 {
   if(!result || !message || !password) return 1;
 
-  // 1. Hash the password to get aes key
+  // 1. Hash the password to get the key
   char hash[64];
 
-  sha256(hash, password, psize);
+  uint8_t header[HEADER_SIZE];
+  size_t  header_size;
+
+  if(key_create(hash, header, &header_size, password, psize, hash_func) != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "symcpt: Failed to hash password\n");
+
+    return 3;
+  }
 
 
   // 2. Concatonate the hash and the message to get payload
@@ -136,36 +412,96 @@ static int sym_encrypt(uint8_t** result, size_t* rsize, const void* message, siz
 
   uint8_t* payload = malloc(sizeof(uint8_t) * payload_size);
 
+  if(!payload)
+  {
+    errno = ENOMEM; // Out of memory
+
+    return 4;
+  }
+
   memcpy(payload, hash, 64);
 
   memcpy(payload + 64, message, msize);
 
 
-  // 3. Encrypt the payload using AES and hash as key
-  if(aes_encrypt(result, rsize, payload, payload_size, hash, key_size) != 0)
+  // 3. Encrypt the payload using the cipher and hash as key
+  uint8_t* encrypted;
+  size_t encrypted_size;
+
+  if(cipher->encrypt(&encrypted, &encrypted_size, payload, payload_size, hash, cipher->key_size) != 0)
   {
     free(payload);
 
     if(!args.quiet)
-      fprintf(stderr, "symcpt: Error: aes_encrypt\n");
+      fprintf(stderr, "symcpt: Failed to encrypt payload\n");
 
     return 2;
   }
 
   free(payload);
 
+  // 4. The header comes before the encrypted payload
+  size_t result_size = (header_size + encrypted_size);
+
+  if(rsize) *rsize = result_size;
+
+  *result = malloc(sizeof(uint8_t) * result_size);
+
+  if(!(*result))
+  {
+    free(encrypted);
+
+    errno = ENOMEM; // Out of memory
+
+    return 4;
+  }
+
+  memcpy(*result, header, header_size);
+
+  memcpy(*result + header_size, encrypted, encrypted_size);
+
+  free(encrypted);
+
   return 0;
 }
 
 /*
  * Decrypted a symetric encrypted message
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Supplied arguments invalid
+ * - 2 | The message is invalid
+ * - 3 | The password is wrong
+ * - 4 | Failed to hash the password
+ * - 5 | Failed to allocate memory
  */
-static int sym_decrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const void* password, size_t psize, ksize_t key_size)
+static int sym_decrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const void* password, size_t psize, const cipher_t* cipher, hash_func_t hash_func)
 {
   if(!result || !message || !password) return 1;
 
+  // 1. Hash the password to get the key, with the costs in the header
+  char hash[64];
+
+  size_t header_size;
+
+  int status = key_read(hash, &header_size, message, msize, password, psize, hash_func);
+
+  if(status == 2) return 2;
+
+  if(status != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "symcpt: Failed to hash password\n");
+
+    return 4;
+  }
+
+  message = (uint8_t*) message + header_size;
+  msize  -= header_size;
+
   // Check if the message is large enough
-  if(msize < AES_SIZE(65))
+  if(msize < cipher->min_size)
   {
     if(!args.quiet)
       fprintf(stderr, "symcpt: File is to small\n");
@@ -173,25 +509,20 @@ static int sym_decrypt(uint8_t** result, size_t* rsize, const void* message, siz
     return 2;
   }
 
-  // 1. Hash the password to get aes key
-  char hash[64];
-
-  sha256(hash, password, psize);
-  
   // 2. Decrypt message to get payload
   uint8_t* payload;
   size_t payload_size;
 
-  if(aes_decrypt(&payload, &payload_size, message, msize, hash, key_size) != 0)
+  if(cipher->decrypt(&payload, &payload_size, message, msize, hash, cipher->key_size) != 0)
   {
     if(!args.quiet)
-      fprintf(stderr, "symcpt: Error: aes_decrypt\n");
+      fprintf(stderr, "symcpt: Invalid decryption\n");
 
     return 2;
   }
 
   // 3. Compare the encrypted hash, to validate
-  if(memcmp(payload, hash, 64) != 0)
+  if(payload_size < 64 || memcmp(payload, hash, 64) != 0)
   {
     if(!args.quiet)
       fprintf(stderr, "symcpt: Invalid decryption\n");
@@ -208,6 +539,15 @@ static int sym_decrypt(uint8_t** result, size_t* rsize, const void* message, siz
 
   *result = malloc(sizeof(uint8_t) * result_size);
 
+  if(!(*result))
+  {
+    free(payload);
+
+    errno = ENOMEM; // Out of memory
+
+    return 5;
+  }
+
   memcpy(*result, payload + 64, result_size);
 
   free(payload);
@@ -216,28 +556,82 @@ static int sym_decrypt(uint8_t** result, size_t* rsize, const void* message, siz
 }
 
 /*
+ * ChaCha20-Poly1305 with the signature of aes.h,
+ * always using the first 32 bytes of the key
+ */
+static int chacha20_encrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const void* key, ksize_t ksize)
+{
+  return chacha20poly1305_encrypt(result, rsize, message, msize, key);
+}
+
+static int chacha20_decrypt(uint8_t** result, size_t* rsize, const void* message, size_t msize, const void* key, ksize_t ksize)
+{
+  return chacha20poly1305_decrypt(result, rsize, message, msize, key);
+}
+
+/*
+ * Get the cipher used to encrypt the payload
  *
+ * chacha20 is faster than AES without AES-NI, and it doesn't
+ * use any key dependent table lookups
  */
-static int key_size_get(ksize_t* key_size)
+static int cipher_get(cipher_t* cipher)
 {
+  *cipher = (cipher_t) { aes_encrypt, aes_decrypt, AES_NONE, AES_SIZE(65) };
+
   if(strcmp(args.cipher, "aes256") == 0)
   {
-    *key_size = AES_256;
+    cipher->key_size = AES_256;
 
     return 1;
   }
   else if(strcmp(args.cipher, "aes192") == 0)
   {
-    *key_size = AES_192;
+    cipher->key_size = AES_192;
 
     return 2;
   }
   else if(strcmp(args.cipher, "aes128") == 0)
   {
-    *key_size = AES_128;
+    cipher->key_size = AES_128;
+
+    return 3;
+  }
+  else if(strcmp(args.cipher, "chacha20") == 0)
+  {
+    *cipher = (cipher_t) { chacha20_encrypt, chacha20_decrypt, AES_NONE, CHACHA20POLY1305_SIZE(65) };
+
+    return 4;
+  }
+  else return 0;
+}
+
+/*
+ * Get the hash function used to hash the password
+ *
+ * blake3 is faster, but its hash is not the same as sha256.
+ * argon2id has no hash function, and is slow on purpose.
+ */
+static int hash_func_get(hash_func_t* hash_func)
+{
+  if(strcmp(args.hash, "argon2id") == 0)
+  {
+    *hash_func = NULL;
 
     return 3;
   }
+  else if(strcmp(args.hash, "sha256") == 0)
+  {
+    *hash_func = sha256;
+
+    return 1;
+  }
+  else if(strcmp(args.hash, "blake3") == 0)
+  {
+    *hash_func = blake3;
+
+    return 2;
+  }
   else return 0;
 }
 
@@ -262,35 +656,145 @@ static char* password_get(void)
 }
 
 /*
+ * Check the chunk checksums in front of the encrypted message
+ *
+ * This is done before decrypting, to catch a damaged file early
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The checksum table is damaged
+ * - 2 | Some chunks are damaged
+ * - 3 | Failed to allocate memory
+ */
+static int chunks_check(size_t* offset, const void* message, size_t size)
+{
+  size_t* damaged;
+  size_t  count;
+
+  int status = crc32c_table_check(offset, &damaged, &count, message, size);
+
+  if(status == 3)
+  {
+    if(!args.quiet)
+    {
+      for(size_t index = 0; index < count; index++)
+      {
+        fprintf(stderr, "symcpt: Chunk %zu is damaged\n", damaged[index]);
+      }
+    }
+
+    free(damaged);
+
+    return 2;
+  }
+  else if(status == 4)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "symcpt: Failed to allocate memory\n");
+
+    return 3;
+  }
+  else if(status != 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "symcpt: Checksum table is damaged\n");
+
+    return 1;
+  }
+
+  return 0;
+}
+
+/*
+ * Write the encrypted message, with the chunk checksums in front of it
  *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to add checksums
+ * - 2 | Failed to write file
  */
-static void encrypt_routine(const void* message, size_t msize, const void* password, size_t psize, ksize_t key_size)
+static int chunks_write(const void* message, size_t size, const char* filepath)
 {
   uint8_t* result;
   size_t rsize;
 
-  if(sym_encrypt(&result, &rsize, message, msize, password, psize, key_size) == 0)
+  if(crc32c_table_add(&result, &rsize, message, size) != 0)
   {
-    file_write(result, rsize, args.args[1]);
+    if(!args.quiet)
+      fprintf(stderr, "symcpt: Failed to add checksums\n");
+
+    return 1;
+  }
+
+  size_t write_size = file_write(result, rsize, filepath);
+
+  free(result);
+
+  if(write_size != rsize)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "symcpt: Failed to write file\n");
+
+    return 2;
+  }
+
+  return 0;
+}
+
+/*
+ * Encrypt the message, and write it to the output file
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to encrypt the file
+ */
+static int encrypt_routine(const void* message, size_t msize, const void* password, size_t psize, const cipher_t* cipher, hash_func_t hash_func)
+{
+  uint8_t* result;
+  size_t rsize;
 
-    free(result);
+  if(sym_encrypt(&result, &rsize, message, msize, password, psize, cipher, hash_func) != 0)
+  {
+    return 1;
   }
+
+  int status = chunks_write(result, rsize, args.args[1]);
+
+  free(result);
+
+  return (status == 0) ? 0 : 1;
 }
 
 /*
+ * Decrypt the message, and write it to the output file
  *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to decrypt the file
  */
-static void decrypt_routine(const void* message, size_t msize, const void* password, size_t psize, ksize_t key_size)
+static int decrypt_routine(const void* message, size_t msize, const void* password, size_t psize, const cipher_t* cipher, hash_func_t hash_func)
 {
   uint8_t* result;
   size_t rsize;
 
-  if(sym_decrypt(&result, &rsize, message, msize, password, psize, key_size) == 0)
+  if(sym_decrypt(&result, &rsize, message, msize, password, psize, cipher, hash_func) != 0)
   {
-    file_write(result, rsize, args.args[1]);
+    return 1;
+  }
+
+  size_t write_size = file_write(result, rsize, args.args[1]);
+
+  free(result);
 
-    free(result);
+  if(write_size != rsize)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "symcpt: Failed to write file\n");
+
+    return 1;
   }
+
+  return 0;
 }
 
 static struct argp argp = { options, opt_parse, args_doc, doc };
@@ -301,6 +805,10 @@ static struct argp argp = { options, opt_parse, args_doc, doc };
  * - 1 | Inputted file has no data
  * - 2 | Failed to read file
  * - 3 | Supplied cipher not supported
+ * - 4 | Supplied hash not supported
+ * - 5 | Inputted file is damaged
+ * - 6 | Failed to allocate memory
+ * - 7 | Failed to encrypt or decrypt file
  */
 int main(int argc, char* argv[])
 {
@@ -324,6 +832,14 @@ int main(int argc, char* argv[])
   // Read the file and store the data as the message
   char* message = malloc(sizeof(char) * size);
 
+  if(!message)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "symcpt: Failed to allocate memory\n");
+
+    return 6;
+  }
+
   if(file_read(message, size, args.args[0]) == 0)
   {
     if(!args.quiet)
@@ -332,14 +848,24 @@ int main(int argc, char* argv[])
     return 2;
   }
 
-  // Get the password for the aes ecryption/decryption
+  // Check the chunk checksums, before asking for the password
+  size_t offset = 0;
+
+  if(!args.encrypt && chunks_check(&offset, message, size) != 0)
+  {
+    free(message);
+
+    return 5;
+  }
+
+  // Get the password for the ecryption/decryption
   char* password = password_get();
 
 
-  // Get the AES key size
-  ksize_t key_size;
+  // Get the cipher and its key size
+  cipher_t cipher;
 
-  if(key_size_get(&key_size) == 0)
+  if(cipher_get(&cipher) == 0)
   {
     if(!args.quiet)
       fprintf(stderr, "symcpt: Cipher not supported\n");
@@ -347,13 +873,26 @@ int main(int argc, char* argv[])
     return 3;
   }
 
+  // Get the hash function for the password
+  hash_func_t hash_func;
+
+  if(hash_func_get(&hash_func) == 0)
+  {
+    if(!args.quiet)
+      fprintf(stderr, "symcpt: Hash not supported\n");
+
+    return 4;
+  }
+
+  int status;
+
   if(args.encrypt)
   {
-    encrypt_routine(message, size, password, strlen(password), key_size);
+    status = encrypt_routine(message, size, password, strlen(password), &cipher, hash_func);
   }
   else
   {
-    decrypt_routine(message, size, password, strlen(password), key_size);
+    status = decrypt_routine(message + offset, size - offset, password, strlen(password), &cipher, hash_func);
   }
 
   free(message);
@@ -362,5 +901,5 @@ int main(int argc, char* argv[])
   if(args.debug)
     info_print("End of main");
 
-  return 0;
+  return (status == 0) ? 0 : 7;
 }
@@ -0,0 +1,325 @@
+/*
+ * x25519.h - implementation of the X25519 key agreement
+ *
+ * Written by Hampus Fridholm
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc7748
+ *         https://cr.yp.to/ecdh.html
+ *
+ * Last updated: 2026-10-19
+ *
+ *
+ * In main compilation unit; define X25519_IMPLEMENT
+ *
+ * The secret keys come from random.h, so define RANDOM_IMPLEMENT as well
+ *
+ *
+ * The field arithmetic is in fe25519.h, and the Montgomery
+ * ladder does the same operations for every bit of the secret key,
+ * swapping the points with masks instead of branches
+ *
+ *
+ * These are the available funtions:
+ *
+ * int  x25519(uint8_t shared[32], const uint8_t skey[32], const uint8_t pkey[32])
+ *
+ * int  x25519_pkey_get(uint8_t pkey[32], const uint8_t skey[32])
+ *
+ * int  x25519_keys_gen(uint8_t skey[32], uint8_t pkey[32])
+ *
+ *
+ * int  x25519_key_encode(uint8_t result[X25519_ENCODED_SIZE], const uint8_t key[32])
+ *
+ * int  x25519_key_decode(uint8_t key[32], const void* message, size_t size)
+ */
+
+/*
+ * From here on, until X25519_IMPLEMENT,
+ * it is like a normal header file with declarations
+ */
+
+#ifndef X25519_H
+#define X25519_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The size of the keys and the shared secret
+ */
+#define X25519_KEY_SIZE 32
+
+/*
+ * The encoded keys are
+ *
+ * - 4 bytes  | X25519_KEY_ID (big-endian)
+ * - 32 bytes | The key
+ *
+ * An encoded RSA key starts with its modulus size in bits,
+ * which is never 25519, so the two kinds of keys can be told apart
+ */
+#define X25519_KEY_ID 25519
+
+#define X25519_ENCODED_SIZE (4 + X25519_KEY_SIZE)
+
+extern int  x25519(uint8_t shared[32], const uint8_t skey[32], const uint8_t pkey[32]);
+
+extern int  x25519_pkey_get(uint8_t pkey[32], const uint8_t skey[32]);
+
+extern int  x25519_keys_gen(uint8_t skey[32], uint8_t pkey[32]);
+
+
+extern int  x25519_key_encode(uint8_t result[X25519_ENCODED_SIZE], const uint8_t key[32]);
+
+extern int  x25519_key_decode(uint8_t key[32], const void* message, size_t size);
+
+#endif // X25519_H
+
+/*
+ * This header library file uses _IMPLEMENT guards
+ *
+ * If X25519_IMPLEMENT is defined, the definitions will be included
+ */
+
+#ifdef X25519_IMPLEMENT
+
+#include <string.h>
+#include <errno.h>
+
+#include "random.h"
+
+#include "fe25519.h"
+
+/*
+ * The Montgomery ladder, result = scalar * point (u-coordinates)
+ *
+ * Credit: https://datatracker.ietf.org/doc/html/rfc7748#section-5
+ */
+static void x25519_ladder(uint8_t result[32], const uint8_t scalar[32], const uint8_t point[32])
+{
+  uint8_t k[32];
+
+  memcpy(k, scalar, 32);
+
+  // Clamp the scalar
+  k[0]  &= 248;
+  k[31] &= 127;
+  k[31] |= 64;
+
+  fe_t x1, x2 = { 1 }, z2 = { 0 }, x3, z3 = { 1 };
+
+  fe_read(x1, point);
+
+  memcpy(x3, x1, sizeof(fe_t));
+
+  fe_t a, aa, b, bb, e, c, d, da, cb;
+
+  uint64_t swap = 0;
+
+  for(int bit = 254; bit >= 0; bit--)
+  {
+    uint64_t kt = (k[bit / 8] >> (bit % 8)) & 1;
+
+    swap ^= kt;
+
+    fe_cswap(x2, x3, swap);
+    fe_cswap(z2, z3, swap);
+
+    swap = kt;
+
+    fe_add(a, x2, z2);
+    fe_sq(aa, a);
+    fe_sub(b, x2, z2);
+    fe_sq(bb, b);
+    fe_sub(e, aa, bb);
+    fe_add(c, x3, z3);
+    fe_sub(d, x3, z3);
+    fe_mul(da, d, a);
+    fe_mul(cb, c, b);
+
+    fe_add(x3, da, cb);
+    fe_sq(x3, x3);
+
+    fe_sub(z3, da, cb);
+    fe_sq(z3, z3);
+    fe_mul(z3, z3, x1);
+
+    fe_mul(x2, aa, bb);
+
+    // z2 = e * (aa + a24 * e), where a24 = (486662 - 2) / 4
+    fe_mul_small(z2, e, 121665);
+    fe_add(z2, z2, aa);
+    fe_mul(z2, z2, e);
+  }
+
+  fe_cswap(x2, x3, swap);
+  fe_cswap(z2, z3, swap);
+
+  fe_invert(z2, z2);
+  fe_mul(x2, x2, z2);
+
+  fe_write(result, x2);
+
+  memset(k, 0, sizeof(k));
+}
+
+/*
+ * Calculate the shared secret of a secret key and another party's public key
+ *
+ * PARAMS
+ * - uint8_t shared[32]       | The shared secret
+ * - const uint8_t skey[32]   | The secret key
+ * - const uint8_t pkey[32]   | The public key of the other party
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The public key is of low order, the shared secret is zero
+ */
+int x25519(uint8_t shared[32], const uint8_t skey[32], const uint8_t pkey[32])
+{
+  if(!shared || !skey || !pkey)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  x25519_ladder(shared, skey, pkey);
+
+  // Check for the zero secret, without branching on the bytes
+  uint8_t bits = 0;
+
+  for(int index = 0; index < 32; index++)
+  {
+    bits |= shared[index];
+  }
+
+  if(bits == 0)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  return 0;
+}
+
+/*
+ * Get the public key of the secret key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ */
+int x25519_pkey_get(uint8_t pkey[32], const uint8_t skey[32])
+{
+  if(!pkey || !skey)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  static const uint8_t base[32] = { 9 };
+
+  x25519_ladder(pkey, skey, base);
+
+  return 0;
+}
+
+/*
+ * Generate a random secret key and its public key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | Failed to get random bytes
+ */
+int x25519_keys_gen(uint8_t skey[32], uint8_t pkey[32])
+{
+  if(!skey || !pkey)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  if(random_bytes(skey, 32) != 0) return 2;
+
+  // The secret key is stored clamped
+  skey[0]  &= 248;
+  skey[31] &= 127;
+  skey[31] |= 64;
+
+  return x25519_pkey_get(pkey, skey);
+}
+
+/*
+ * Encode a secret or public key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ */
+int x25519_key_encode(uint8_t result[X25519_ENCODED_SIZE], const uint8_t key[32])
+{
+  if(!result || !key)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  result[0] = (uint8_t) (X25519_KEY_ID >> 24);
+  result[1] = (uint8_t) (X25519_KEY_ID >> 16);
+  result[2] = (uint8_t) (X25519_KEY_ID >>  8);
+  result[3] = (uint8_t)  X25519_KEY_ID;
+
+  memcpy(result + 4, key, X25519_KEY_SIZE);
+
+  return 0;
+}
+
+/*
+ * Decode an encoded secret or public key
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ * - 2 | The message is not an X25519 key
+ */
+int x25519_key_decode(uint8_t key[32], const void* message, size_t size)
+{
+  if(!key || !message)
+  {
+    errno = EFAULT; // Bad address
+
+    return 1;
+  }
+
+  const uint8_t* bytes = message;
+
+  if(size != X25519_ENCODED_SIZE)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  uint32_t id = ((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16) |
+                ((uint32_t) bytes[2] <<  8) |  (uint32_t) bytes[3];
+
+  if(id != X25519_KEY_ID)
+  {
+    errno = EINVAL; // Invalid argument
+
+    return 2;
+  }
+
+  memcpy(key, bytes + 4, X25519_KEY_SIZE);
+
+  return 0;
+}
+
+#endif // X25519_IMPLEMENT